@@ -87,6 +87,7 @@ struct SearchResult {
     std::vector<SearchResultItem> items;  ///< Sorted results (nearest first)
     std::size_t total_candidates;         ///< Total candidates evaluated
     double query_time_ms;                 ///< Query execution time in milliseconds
+    std::size_t clusters_probed = 0;      ///< IVF: clusters actually scanned (0 for other indexes)
 };
 
 /**
@@ -118,6 +119,15 @@ struct SearchParams {
     std::size_t ef_search = 50;     ///< HNSW: expansion factor during search
     std::size_t n_probe = 10;       ///< IVF: number of clusters to probe
     std::optional<std::function<bool(std::uint64_t)>> filter;  ///< Optional ID filter
+
+    // Adaptive probing (IVF): n_probe is ignored and the number of clusters is
+    // chosen per query. After min_n_probe clusters, probing stops at the first
+    // cluster whose centroid distance exceeds probe_distance_ratio times the
+    // nearest one, or as soon as a probed cluster no longer improved the top-k.
+    bool adaptive_n_probe = false;       ///< IVF: choose the number of probed clusters per query
+    std::size_t min_n_probe = 1;         ///< IVF adaptive: lower bound on probed clusters
+    std::size_t max_n_probe = 64;        ///< IVF adaptive: upper bound on probed clusters
+    float probe_distance_ratio = 1.5f;   ///< IVF adaptive: centroid distance cut-off ratio
 };
 
 /**
@@ -139,6 +149,13 @@ struct IVFParams {
     std::size_t n_probe = 10;       ///< Default clusters to probe during search
     bool use_pq = false;            ///< Enable Product Quantization
     std::size_t pq_subvectors = 8;  ///< Number of PQ subvectors (if use_pq)
+    bool auto_rebalance = false;    ///< Split/merge inverted lists in the background as data drifts
+    float split_factor = 4.0f;      ///< Split lists larger than split_factor * (N / n_clusters)
+    float merge_factor = 0.1f;      ///< Merge lists smaller than merge_factor * (N / n_clusters)
+    bool use_hnsw_quantizer = false;       ///< Select clusters via an HNSW graph over the centroids
+    std::size_t quantizer_ef_search = 64;  ///< Expansion factor for the centroid graph search
+    std::size_t training_samples_per_cluster = 256;  ///< k-means training sample cap per cluster (0 = all vectors)
+    float balance_factor = 0.0f;    ///< Cap list sizes at build to balance_factor * (N / n_clusters) (0 = off, else >= 1)
 };
 
 /**
@@ -160,8 +177,16 @@ struct Config {
 
     // Storage configuration
     std::string data_path;      ///< Path for persistence (empty = in-memory)
-    bool enable_wal = false;    ///< Enable write-ahead logging
-    bool enable_mmap = false;   ///< Enable memory-mapped storage
+    bool enable_wal = false;    ///< Enable write-ahead logging (requires data_path)
+    std::size_t wal_sync_interval_ms = 0;  ///< WAL fsync period (0 = writes wait for their group commit)
+    bool enable_mmap = false;   ///< load() serves vectors (Flat) or the whole index (HNSW) from mapped files
+    bool rebuild_index_on_load = false;  ///< load() rebuilds the index from vectors.bin if index.bin is missing or stale
+    bool verify_on_load = false;         ///< load() checksums the vector block even when it does not read it (heap and mapped loads)
+    std::size_t max_snapshot_deltas = 0; ///< save() writes small change sets as delta files, up to this many (0 = always full)
+
+    // Segmented storage configuration
+    std::size_t memtable_capacity = 0;   ///< Inserts go to a Flat memtable of this size, built into index segments in the background (0 = one index)
+    std::size_t max_sealed_segments = 4; ///< Segments of similar size (one size tier) are merged beyond this count
 };
 
 // ============================================================================
@@ -175,6 +200,10 @@ struct Config {
  * For thread-safe implementations, a read lock is held for the lifetime
  * of the associated RecordRange object.
  *
+ * Records may be materialized on demand from index storage: the reference
+ * returned by operator* is valid until this iterator is advanced. Copy the
+ * record if it must outlive the current step.
+ *
  * Usage:
  * @code
  * auto records = db->all_records();
@@ -455,18 +484,48 @@ public:
 
     /**
      * @brief Flush all pending writes to storage.
+     *
+     * With enable_wal this commits the write-ahead log (cheap); otherwise
+     * it performs a full save().
+     *
      * @return ErrorCode indicating success or failure
      */
     virtual ErrorCode flush() = 0;
 
     /**
      * @brief Save database to the configured data path.
+     *
+     * The snapshot is the state at the start of the call. Inserts and
+     * removes only wait while that state is captured, not while the files
+     * are written, and are not part of this snapshot. With
+     * memtable_capacity > 0 the capture pins the immutable index segments
+     * and copies only the memtable, so its cost does not grow with the
+     * database. A single index copies its IDs (8 bytes per vector) and
+     * keeps the vectors and links that change until the files are written.
+     *
+     * With enable_wal the snapshot supersedes the log entries before it,
+     * which are dropped.
+     * With max_snapshot_deltas > 0, a save() that follows a save() or
+     * load() and changed few records only writes those changes to a delta
+     * file; once the limit is reached the next save() folds all deltas into
+     * a full snapshot.
+     *
      * @return ErrorCode indicating success or failure
      */
     virtual ErrorCode save() = 0;
 
     /**
      * @brief Load database from the configured data path.
+     *
+     * With enable_wal the log is replayed on top of the last snapshot (or on
+     * an empty database if none was saved yet), and later writes are
+     * appended to it. With rebuild_index_on_load, a missing, corrupt or
+     * unreadable index.bin is rebuilt from the vectors in vectors.bin.
+     *
+     * The vector block in vectors.bin is checksummed when it is read to
+     * rebuild the index; otherwise the index carries its own copy (or maps
+     * the block lazily) and the block is only verified with verify_on_load.
+     *
      * @return ErrorCode indicating success or failure
      */
     virtual ErrorCode load() = 0;
@@ -0,0 +1,140 @@
+/**
+ * @file checksum_stream.cpp
+ * @brief Implementation of the checksum stream filters
+ *
+ * @copyright MIT License
+ */
+
+#include "checksum_stream.h"
+#include "utils.h"
+#include <algorithm>
+#include <cstring>
+
+namespace lynx {
+
+// ============================================================================
+// ChecksumOutputBuffer
+// ============================================================================
+
+ChecksumOutputBuffer::ChecksumOutputBuffer(std::streambuf* target, std::size_t buffer_size)
+    : target_(target), buffer_(buffer_size) {
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+}
+
+ChecksumOutputBuffer::~ChecksumOutputBuffer() {
+    drain();
+}
+
+bool ChecksumOutputBuffer::forward(const char* data, std::size_t size) {
+    if (size == 0) {
+        return true;
+    }
+    crc_ = utils::crc32c(data, size, crc_);
+    bytes_ += size;
+    return target_->sputn(data, static_cast<std::streamsize>(size)) ==
+           static_cast<std::streamsize>(size);
+}
+
+bool ChecksumOutputBuffer::drain() {
+    const bool ok = forward(pbase(), static_cast<std::size_t>(pptr() - pbase()));
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+    return ok;
+}
+
+ChecksumOutputBuffer::int_type ChecksumOutputBuffer::overflow(int_type ch) {
+    if (!drain()) {
+        return traits_type::eof();
+    }
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+std::streamsize ChecksumOutputBuffer::xsputn(const char* s, std::streamsize n) {
+    const auto size = static_cast<std::size_t>(n);
+    if (size <= static_cast<std::size_t>(epptr() - pptr())) {
+        std::memcpy(pptr(), s, size);
+        pbump(static_cast<int>(n));
+        return n;
+    }
+
+    // Does not fit: empty the buffer, then pass large writes straight on
+    if (!drain()) {
+        return 0;
+    }
+    if (size >= buffer_.size()) {
+        return forward(s, size) ? n : 0;
+    }
+    std::memcpy(pptr(), s, size);
+    pbump(static_cast<int>(n));
+    return n;
+}
+
+int ChecksumOutputBuffer::sync() {
+    return drain() && target_->pubsync() == 0 ? 0 : -1;
+}
+
+// ============================================================================
+// ChecksumInputBuffer
+// ============================================================================
+
+ChecksumInputBuffer::ChecksumInputBuffer(std::streambuf* target, std::size_t buffer_size)
+    : target_(target), buffer_(buffer_size) {
+    setg(buffer_.data(), buffer_.data(), buffer_.data());
+}
+
+std::size_t ChecksumInputBuffer::fetch(char* data, std::size_t size) {
+    const std::streamsize got = target_->sgetn(data, static_cast<std::streamsize>(size));
+    if (got <= 0) {
+        return 0;
+    }
+    crc_ = utils::crc32c(data, static_cast<std::size_t>(got), crc_);
+    bytes_ += static_cast<std::uint64_t>(got);
+    return static_cast<std::size_t>(got);
+}
+
+ChecksumInputBuffer::int_type ChecksumInputBuffer::underflow() {
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+    const std::size_t got = fetch(buffer_.data(), buffer_.size());
+    setg(buffer_.data(), buffer_.data(), buffer_.data() + got);
+    return got > 0 ? traits_type::to_int_type(*gptr()) : traits_type::eof();
+}
+
+std::streamsize ChecksumInputBuffer::xsgetn(char* s, std::streamsize n) {
+    auto remaining = static_cast<std::size_t>(n);
+
+    // Buffered bytes first
+    const std::size_t buffered = std::min(remaining, static_cast<std::size_t>(egptr() - gptr()));
+    std::memcpy(s, gptr(), buffered);
+    gbump(static_cast<int>(buffered));
+    s += buffered;
+    remaining -= buffered;
+
+    // Large reads go straight into the caller's memory, small ones refill
+    while (remaining > 0) {
+        if (remaining >= buffer_.size()) {
+            const std::size_t got = fetch(s, remaining);
+            if (got == 0) {
+                break;
+            }
+            s += got;
+            remaining -= got;
+        } else {
+            if (traits_type::eq_int_type(underflow(), traits_type::eof())) {
+                break;
+            }
+            const std::size_t chunk = std::min(remaining, static_cast<std::size_t>(egptr() - gptr()));
+            std::memcpy(s, gptr(), chunk);
+            gbump(static_cast<int>(chunk));
+            s += chunk;
+            remaining -= chunk;
+        }
+    }
+    return n - static_cast<std::streamsize>(remaining);
+}
+
+} // namespace lynx
@@ -0,0 +1,99 @@
+/**
+ * @file checksum_stream.h
+ * @brief Buffered stream filters that checksum the bytes passing through
+ *
+ * Index serializers write and read a few bytes at a time through a
+ * std::ostream / std::istream. Wrapping the file in these filters turns
+ * that into large transfers to and from the file, and yields the CRC-32C
+ * of the whole stream as a by-product, without a second pass.
+ *
+ * @copyright MIT License
+ */
+
+#ifndef LYNX_CHECKSUM_STREAM_H
+#define LYNX_CHECKSUM_STREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <streambuf>
+#include <vector>
+
+namespace lynx {
+
+/// Transfer size used by the checksum filters
+inline constexpr std::size_t kChecksumBufferSize = std::size_t{1} << 20;
+
+/**
+ * @brief Output filter: buffers writes, forwards them to `target` in large
+ *        chunks and keeps a running CRC-32C of everything written.
+ *
+ * Writes larger than the buffer go straight through. crc() and bytes()
+ * cover what has been forwarded, so call pubsync() (or flush the stream)
+ * first. The destructor forwards any pending bytes.
+ */
+class ChecksumOutputBuffer : public std::streambuf {
+public:
+    explicit ChecksumOutputBuffer(std::streambuf* target,
+                                  std::size_t buffer_size = kChecksumBufferSize);
+    ~ChecksumOutputBuffer() override;
+
+    ChecksumOutputBuffer(const ChecksumOutputBuffer&) = delete;
+    ChecksumOutputBuffer& operator=(const ChecksumOutputBuffer&) = delete;
+
+    [[nodiscard]] std::uint32_t crc() const { return crc_; }
+    [[nodiscard]] std::uint64_t bytes() const { return bytes_; }
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+    int sync() override;
+
+private:
+    /// Forward a range to the target and fold it into the checksum
+    bool forward(const char* data, std::size_t size);
+
+    /// Forward the buffered bytes
+    bool drain();
+
+    std::streambuf* target_;
+    std::vector<char> buffer_;
+    std::uint32_t crc_ = 0;
+    std::uint64_t bytes_ = 0;
+};
+
+/**
+ * @brief Input filter: reads `target` in large chunks and keeps a running
+ *        CRC-32C of everything read from it.
+ *
+ * Seeking is not supported; skip with istream::ignore() instead. crc() and
+ * bytes() cover every byte fetched from the target, so read the stream to
+ * its end before comparing against a stored checksum.
+ */
+class ChecksumInputBuffer : public std::streambuf {
+public:
+    explicit ChecksumInputBuffer(std::streambuf* target,
+                                 std::size_t buffer_size = kChecksumBufferSize);
+
+    ChecksumInputBuffer(const ChecksumInputBuffer&) = delete;
+    ChecksumInputBuffer& operator=(const ChecksumInputBuffer&) = delete;
+
+    [[nodiscard]] std::uint32_t crc() const { return crc_; }
+    [[nodiscard]] std::uint64_t bytes() const { return bytes_; }
+
+protected:
+    int_type underflow() override;
+    std::streamsize xsgetn(char* s, std::streamsize n) override;
+
+private:
+    /// Read up to `size` bytes from the target and fold them into the checksum
+    std::size_t fetch(char* data, std::size_t size);
+
+    std::streambuf* target_;
+    std::vector<char> buffer_;
+    std::uint32_t crc_ = 0;
+    std::uint64_t bytes_ = 0;
+};
+
+} // namespace lynx
+
+#endif // LYNX_CHECKSUM_STREAM_H
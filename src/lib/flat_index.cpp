@@ -17,8 +17,21 @@ namespace lynx {
 // Constructor
 // ============================================================================
 
-FlatIndex::FlatIndex(std::size_t dimension, DistanceMetric metric)
-    : dimension_(dimension), metric_(metric) {}
+namespace {
+
+/// Minimum floats scanned per thread before a search is split; below this
+/// thread start-up costs more than the scan it saves.
+constexpr std::size_t kMinScanFloatsPerThread = std::size_t{1} << 18;
+
+/// Result ordering: by distance, ties by ID (independent of row order).
+bool closer(const SearchResultItem& a, const SearchResultItem& b) {
+    return a.distance < b.distance || (a.distance == b.distance && a.id < b.id);
+}
+
+} // namespace
+
+FlatIndex::FlatIndex(std::size_t dimension, DistanceMetric metric, std::size_t num_threads)
+    : dimension_(dimension), metric_(metric), num_threads_(num_threads), vectors_(dimension) {}
 
 // ============================================================================
 // IVectorIndex Interface Implementation
@@ -32,23 +45,44 @@ ErrorCode FlatIndex::add(std::uint64_t id, std::span<const float> vector) {
 
     // Add or update the vector with exclusive lock
     std::unique_lock lock(mutex_);
-    vectors_[id] = std::vector<float>(vector.begin(), vector.end());
+    store(id, vector);
     return ErrorCode::Ok;
 }
 
 ErrorCode FlatIndex::remove(std::uint64_t id) {
     std::unique_lock lock(mutex_);
-    auto it = vectors_.find(id);
-    if (it == vectors_.end()) {
+    auto it = id_to_row_.find(id);
+    if (it == id_to_row_.end()) {
         return ErrorCode::VectorNotFound;
     }
-    vectors_.erase(it);
+
+    // Move the last row into the freed slot to keep the matrix dense
+    const std::size_t slot = it->second;
+    const std::size_t last = ids_.size() - 1;
+    for_each_capture(captures_, [&](Capture& captured) { captured.rows.keep(id, row(slot)); });
+    id_to_row_.erase(it);
+    vectors_.move_last_to(slot);
+    if (slot != last) {
+        ids_[slot] = ids_[last];
+        id_to_row_[ids_[slot]] = slot;
+    }
+    ids_.pop_back();
     return ErrorCode::Ok;
 }
 
 bool FlatIndex::contains(std::uint64_t id) const {
     std::shared_lock lock(mutex_);
-    return vectors_.find(id) != vectors_.end();
+    return id_to_row_.find(id) != id_to_row_.end();
+}
+
+bool FlatIndex::get_vector(std::uint64_t id, std::span<float> out) const {
+    std::shared_lock lock(mutex_);
+    auto it = id_to_row_.find(id);
+    if (it == id_to_row_.end() || out.size() != dimension_) {
+        return false;
+    }
+    std::copy_n(row(it->second).begin(), dimension_, out.begin());
+    return true;
 }
 
 std::vector<SearchResultItem> FlatIndex::search(
@@ -61,31 +95,61 @@ std::vector<SearchResultItem> FlatIndex::search(
         return {};  // Return empty results on dimension mismatch
     }
 
+    if (k == 0) {
+        return {};
+    }
+
     std::shared_lock lock(mutex_);
 
-    // Brute-force search: calculate distance to all vectors
+    // Brute-force search: each thread scans a contiguous block of rows and
+    // keeps its best candidates in a bounded max-heap (worst at the front).
+    // The heaps live in fixed slices of a scratch buffer owned by the calling
+    // thread and reused across queries, so a query allocates nothing but its
+    // result. Workers reach it through the captured pointers, not by name
+    // (the name would resolve to the worker's own thread_local).
+    const std::size_t capacity = std::min(k, ids_.size());
+    const std::size_t threads = scan_thread_count();
+    thread_local std::vector<SearchResultItem> heap_scratch;
+    thread_local std::vector<std::size_t> heap_sizes;
+    heap_scratch.resize(threads * capacity);
+    heap_sizes.assign(threads, 0);
+    SearchResultItem* const heaps = heap_scratch.data();
+    std::size_t* const sizes = heap_sizes.data();
+
+    const std::size_t chunks = utils::parallel_for(ids_.size(), threads,
+        [&, heaps, sizes](std::size_t chunk, std::size_t begin, std::size_t end) {
+            SearchResultItem* const heap = heaps + chunk * capacity;
+            std::size_t size = 0;
+            for (std::size_t r = begin; r < end; ++r) {
+                // Apply filter if provided
+                if (params.filter && !(*params.filter)(ids_[r])) {
+                    continue;
+                }
+
+                const SearchResultItem item{ids_[r], calculate_distance(query, row(r))};
+                if (size < capacity) {
+                    heap[size++] = item;
+                    std::push_heap(heap, heap + size, closer);
+                } else if (closer(item, heap[0])) {
+                    std::pop_heap(heap, heap + size, closer);
+                    heap[size - 1] = item;
+                    std::push_heap(heap, heap + size, closer);
+                }
+            }
+            sizes[chunk] = size;
+        });
+
+    // Merge the per-thread candidates and keep the overall top-k
     std::vector<SearchResultItem> results;
-    results.reserve(vectors_.size());
-
-    for (const auto& [id, vector] : vectors_) {
-        // Apply filter if provided
-        if (params.filter && !(*params.filter)(id)) {
-            continue;
-        }
-
-        float distance = calculate_distance(query, vector);
-        results.push_back({id, distance});
+    results.reserve(chunks * capacity);
+    for (std::size_t c = 0; c < chunks; ++c) {
+        results.insert(results.end(), heaps + c * capacity, heaps + c * capacity + sizes[c]);
     }
-
-    // Sort by distance (ascending)
-    std::sort(results.begin(), results.end(),
-             [](const SearchResultItem& a, const SearchResultItem& b) {
-                 return a.distance < b.distance;
-             });
-
-    // Keep only top-k results
-    if (results.size() > k) {
-        results.resize(k);
+    if (results.size() > capacity) {
+        std::partial_sort(results.begin(), results.begin() + capacity, results.end(), closer);
+        results.resize(capacity);
+    } else {
+        std::sort(results.begin(), results.end(), closer);
     }
 
     return results;
@@ -95,19 +159,41 @@ ErrorCode FlatIndex::build(std::span<const VectorRecord> vectors) {
     std::unique_lock lock(mutex_);
 
     // Clear existing data
-    vectors_.clear();
+    clear_storage();
+    vectors_.reserve(vectors.size());
+    ids_.reserve(vectors.size());
+    id_to_row_.reserve(vectors.size());
 
     // Add all vectors (lock already held, use direct access)
     for (const auto& record : vectors) {
         // Validate dimension
         if (record.vector.size() != dimension_) {
             // On error, clear partially built index and return
-            vectors_.clear();
+            clear_storage();
             return ErrorCode::DimensionMismatch;
         }
-        vectors_[record.id] = std::vector<float>(record.vector.begin(), record.vector.end());
+        store(record.id, record.vector);
+    }
+
+    return ErrorCode::Ok;
+}
+
+ErrorCode FlatIndex::build(std::span<const std::uint64_t> ids, MatrixView vectors) {
+    if (ids.size() != vectors.rows()) {
+        return ErrorCode::InvalidParameter;
+    }
+    if (!vectors.empty() && vectors.dim() != dimension_) {
+        return ErrorCode::DimensionMismatch;
     }
 
+    std::unique_lock lock(mutex_);
+    clear_storage();
+    vectors_.reserve(ids.size());
+    ids_.reserve(ids.size());
+    id_to_row_.reserve(ids.size());
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        store(ids[i], vectors[i]);
+    }
     return ErrorCode::Ok;
 }
 
@@ -115,29 +201,17 @@ ErrorCode FlatIndex::serialize(std::ostream& out) const {
     std::shared_lock lock(mutex_);
 
     try {
-        // Write magic number and version
-        out.write(reinterpret_cast<const char*>(&kMagicNumber), sizeof(kMagicNumber));
-        out.write(reinterpret_cast<const char*>(&kVersion), sizeof(kVersion));
-
-        // Write dimension
-        out.write(reinterpret_cast<const char*>(&dimension_), sizeof(dimension_));
-
-        // Write metric
-        std::uint8_t metric_value = static_cast<std::uint8_t>(metric_);
-        out.write(reinterpret_cast<const char*>(&metric_value), sizeof(metric_value));
-
-        // Write number of vectors
-        std::size_t num_vectors = vectors_.size();
-        out.write(reinterpret_cast<const char*>(&num_vectors), sizeof(num_vectors));
+        const std::size_t num_vectors = ids_.size();
+        write_header(out, num_vectors);
 
         // Write each vector
-        for (const auto& [id, vector] : vectors_) {
+        for (std::size_t r = 0; r < num_vectors; ++r) {
             // Write vector ID
-            out.write(reinterpret_cast<const char*>(&id), sizeof(id));
+            out.write(reinterpret_cast<const char*>(&ids_[r]), sizeof(ids_[r]));
 
             // Write vector data
-            out.write(reinterpret_cast<const char*>(vector.data()),
-                     vector.size() * sizeof(float));
+            out.write(reinterpret_cast<const char*>(row(r).data()),
+                     dimension_ * sizeof(float));
         }
 
         if (!out.good()) {
@@ -151,64 +225,146 @@ ErrorCode FlatIndex::serialize(std::ostream& out) const {
     }
 }
 
-ErrorCode FlatIndex::deserialize(std::istream& in) {
-    std::unique_lock lock(mutex_);
+std::optional<IndexCapture> FlatIndex::capture() const {
+    auto captured = std::make_shared<Capture>();
+    {
+        std::unique_lock lock(mutex_);
+        captured->ids = ids_;
+        captures_.push_back(captured);
+    }
 
+    IndexCapture result;
+    result.serialize = [this, captured](std::ostream& out) {
+        return write_capture(out, *captured);
+    };
+    result.ids = [captured]() { return captured->ids; };
+    return result;
+}
+
+void FlatIndex::write_header(std::ostream& out, std::size_t num_vectors) const {
+    // Write magic number and version
+    out.write(reinterpret_cast<const char*>(&kMagicNumber), sizeof(kMagicNumber));
+    out.write(reinterpret_cast<const char*>(&kVersion), sizeof(kVersion));
+
+    // Write dimension
+    out.write(reinterpret_cast<const char*>(&dimension_), sizeof(dimension_));
+
+    // Write metric
+    std::uint8_t metric_value = static_cast<std::uint8_t>(metric_);
+    out.write(reinterpret_cast<const char*>(&metric_value), sizeof(metric_value));
+
+    // Write number of vectors
+    out.write(reinterpret_cast<const char*>(&num_vectors), sizeof(num_vectors));
+}
+
+ErrorCode FlatIndex::write_capture(std::ostream& out, const Capture& captured) const {
     try {
-        // Read and verify magic number
-        std::uint32_t magic_number;
-        in.read(reinterpret_cast<char*>(&magic_number), sizeof(magic_number));
-        if (magic_number != kMagicNumber) {
-            return ErrorCode::IOError;  // Invalid file format
+        const std::size_t num_vectors = captured.ids.size();
+        write_header(out, num_vectors);
+
+        // Copy a chunk of (ID, vector) entries at a time under the lock and
+        // write it after releasing the lock, so writers only wait for a copy
+        const std::size_t entry_bytes = sizeof(std::uint64_t) + dimension_ * sizeof(float);
+        const std::size_t chunk = std::max<std::size_t>(kCaptureReadBytes / entry_bytes, 1);
+        std::vector<char> buffer;
+        for (std::size_t begin = 0; begin < num_vectors; begin += chunk) {
+            const std::size_t end = std::min(begin + chunk, num_vectors);
+            buffer.resize((end - begin) * entry_bytes);
+            char* entry = buffer.data();
+            {
+                std::shared_lock lock(mutex_);
+                for (std::size_t r = begin; r < end; ++r, entry += entry_bytes) {
+                    const std::uint64_t id = captured.ids[r];
+                    std::span<const float> vector;
+                    if (const auto* kept = captured.rows.find(id)) {
+                        vector = *kept;
+                    } else if (auto it = id_to_row_.find(id); it != id_to_row_.end()) {
+                        vector = row(it->second);
+                    } else {
+                        return ErrorCode::InvalidState;
+                    }
+                    std::memcpy(entry, &id, sizeof(id));
+                    std::memcpy(entry + sizeof(id), vector.data(), dimension_ * sizeof(float));
+                }
+            }
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
         }
 
-        // Read and verify version
-        std::uint32_t version;
-        in.read(reinterpret_cast<char*>(&version), sizeof(version));
-        if (version != kVersion) {
-            return ErrorCode::IOError;  // Unsupported version
-        }
+        return out.good() ? ErrorCode::Ok : ErrorCode::IOError;
 
-        // Read dimension
-        std::size_t dimension;
-        in.read(reinterpret_cast<char*>(&dimension), sizeof(dimension));
-        if (dimension != dimension_) {
-            return ErrorCode::DimensionMismatch;
-        }
+    } catch (const std::exception&) {
+        return ErrorCode::IOError;
+    }
+}
 
-        // Read metric
-        std::uint8_t metric_value;
-        in.read(reinterpret_cast<char*>(&metric_value), sizeof(metric_value));
-        DistanceMetric loaded_metric = static_cast<DistanceMetric>(metric_value);
-        if (loaded_metric != metric_) {
-            return ErrorCode::InvalidParameter;
-        }
+ErrorCode FlatIndex::read_header(std::istream& in, std::size_t& num_vectors) const {
+    // Read and verify magic number
+    std::uint32_t magic_number;
+    in.read(reinterpret_cast<char*>(&magic_number), sizeof(magic_number));
+    if (magic_number != kMagicNumber) {
+        return ErrorCode::IOError;  // Invalid file format
+    }
+
+    // Read and verify version
+    std::uint32_t version;
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    if (version != kVersion) {
+        return ErrorCode::IOError;  // Unsupported version
+    }
 
-        // Read number of vectors
+    // Read dimension
+    std::size_t dimension;
+    in.read(reinterpret_cast<char*>(&dimension), sizeof(dimension));
+    if (dimension != dimension_) {
+        return ErrorCode::DimensionMismatch;
+    }
+
+    // Read metric
+    std::uint8_t metric_value;
+    in.read(reinterpret_cast<char*>(&metric_value), sizeof(metric_value));
+    DistanceMetric loaded_metric = static_cast<DistanceMetric>(metric_value);
+    if (loaded_metric != metric_) {
+        return ErrorCode::InvalidParameter;
+    }
+
+    // Read number of vectors
+    in.read(reinterpret_cast<char*>(&num_vectors), sizeof(num_vectors));
+    return in.good() ? ErrorCode::Ok : ErrorCode::IOError;
+}
+
+ErrorCode FlatIndex::deserialize(std::istream& in) {
+    std::unique_lock lock(mutex_);
+
+    try {
         std::size_t num_vectors;
-        in.read(reinterpret_cast<char*>(&num_vectors), sizeof(num_vectors));
+        ErrorCode result = read_header(in, num_vectors);
+        if (result != ErrorCode::Ok) {
+            return result;
+        }
 
         // Clear existing data
-        vectors_.clear();
+        clear_storage();
 
         // Read each vector
+        std::vector<float> vector(dimension_);
         for (std::size_t i = 0; i < num_vectors; ++i) {
             // Read vector ID
             std::uint64_t id;
             in.read(reinterpret_cast<char*>(&id), sizeof(id));
 
             // Read vector data
-            std::vector<float> vector(dimension_);
             in.read(reinterpret_cast<char*>(vector.data()),
                    vector.size() * sizeof(float));
+            if (!in.good()) {
+                break;
+            }
 
-            // Insert into map
-            vectors_[id] = std::move(vector);
+            store(id, vector);
         }
 
         if (!in.good()) {
             // Restore to empty state on error
-            vectors_.clear();
+            clear_storage();
             return ErrorCode::IOError;
         }
 
@@ -216,7 +372,40 @@ ErrorCode FlatIndex::deserialize(std::istream& in) {
 
     } catch (const std::exception&) {
         // Restore to empty state on exception
-        vectors_.clear();
+        clear_storage();
+        return ErrorCode::IOError;
+    }
+}
+
+std::vector<std::uint64_t> FlatIndex::storage_order() const {
+    std::shared_lock lock(mutex_);
+    return ids_;
+}
+
+ErrorCode FlatIndex::deserialize_mapped(std::istream& in, const MappedVectors& vectors) {
+    std::unique_lock lock(mutex_);
+
+    try {
+        std::size_t num_vectors;
+        ErrorCode result = read_header(in, num_vectors);
+        if (result != ErrorCode::Ok) {
+            return result;
+        }
+        if (num_vectors != vectors.ids.size()) {
+            return ErrorCode::IOError;
+        }
+
+        clear_storage();
+        vectors_.attach(vectors);
+        ids_.assign(vectors.ids.begin(), vectors.ids.end());
+        id_to_row_.reserve(ids_.size());
+        for (std::size_t r = 0; r < ids_.size(); ++r) {
+            id_to_row_.emplace(ids_[r], r);
+        }
+        return ErrorCode::Ok;
+
+    } catch (const std::exception&) {
+        clear_storage();
         return ErrorCode::IOError;
     }
 }
@@ -227,7 +416,7 @@ ErrorCode FlatIndex::deserialize(std::istream& in) {
 
 std::size_t FlatIndex::size() const {
     std::shared_lock lock(mutex_);
-    return vectors_.size();
+    return ids_.size();
 }
 
 std::size_t FlatIndex::dimension() const {
@@ -238,11 +427,13 @@ std::size_t FlatIndex::memory_usage() const {
     std::shared_lock lock(mutex_);
 
     // Calculate memory usage:
-    // - Map overhead (estimated)
-    // - Per-entry: key (uint64_t) + vector data (dimension * float)
+    // - Matrix capacity on the heap (mapped rows live in the page cache)
+    // - Row -> ID array
+    // - ID -> row map (estimated overhead per entry)
     std::size_t overhead = sizeof(FlatIndex);
-    std::size_t vector_storage = vectors_.size() * (sizeof(std::uint64_t) + dimension_ * sizeof(float));
-    std::size_t map_overhead = vectors_.size() * 32;  // Estimated overhead per map entry
+    std::size_t vector_storage = vectors_.memory_usage() +
+                                 ids_.capacity() * sizeof(std::uint64_t);
+    std::size_t map_overhead = id_to_row_.size() * 32;  // Estimated overhead per map entry
 
     return overhead + vector_storage + map_overhead;
 }
@@ -255,4 +446,35 @@ float FlatIndex::calculate_distance(std::span<const float> a, std::span<const fl
     return utils::calculate_distance(a, b, metric_);
 }
 
+void FlatIndex::store(std::uint64_t id, std::span<const float> vector) {
+    auto [it, inserted] = id_to_row_.try_emplace(id, ids_.size());
+    if (inserted) {
+        for_each_capture(captures_, [id](Capture& captured) { captured.rows.added.insert(id); });
+        ids_.push_back(id);
+        vectors_.append(vector);
+    } else {
+        for_each_capture(captures_, [&](Capture& captured) {
+            captured.rows.keep(id, row(it->second));
+        });
+        vectors_.assign(it->second, vector);
+    }
+}
+
+void FlatIndex::clear_storage() {
+    for_each_capture(captures_, [this](Capture& captured) {
+        for (std::size_t r = 0; r < ids_.size(); ++r) {
+            captured.rows.keep(ids_[r], row(r));
+        }
+    });
+    vectors_.clear();
+    ids_.clear();
+    id_to_row_.clear();
+}
+
+std::size_t FlatIndex::scan_thread_count() const {
+    const std::size_t by_work = std::max<std::size_t>(
+        ids_.size() * dimension_ / kMinScanFloatsPerThread, 1);
+    return std::min(utils::resolve_thread_count(num_threads_), by_work);
+}
+
 } // namespace lynx
@@ -13,7 +13,10 @@
 
 #include "../include/lynx/lynx.h"
 #include "lynx_intern.h"
+#include "utils.h"
+#include "vector_block.h"
 #include <vector>
+#include <memory>
 #include <unordered_map>
 #include <shared_mutex>
 #include <cstdint>
@@ -35,8 +38,16 @@ namespace lynx {
  * - Memory: O(N·D) for vector storage only
  * - Recall: 100% (exact search)
  *
+ * Vectors are stored as one dense, 64-byte aligned row-major matrix, so a
+ * search streams through memory sequentially. Removal moves the last row
+ * into the freed slot, keeping the matrix dense. Large scans are split into
+ * contiguous row ranges, one per thread, each keeping its own top-k heap.
+ * After deserialize_mapped() the matrix is served from the saved vector
+ * file instead of the heap.
+ *
  * Thread-safety: This class is thread-safe. Concurrent reads are supported
- * via std::shared_mutex. Writes are serialized.
+ * via std::shared_mutex. Writes are serialized. A search filter may be
+ * invoked concurrently from several threads.
  */
 class FlatIndex : public IVectorIndex {
 public:
@@ -48,8 +59,9 @@ public:
      * @brief Construct Flat index with configuration.
      * @param dimension Vector dimensionality
      * @param metric Distance metric to use
+     * @param num_threads Maximum threads per search scan (0 = hardware concurrency)
      */
-    FlatIndex(std::size_t dimension, DistanceMetric metric);
+    FlatIndex(std::size_t dimension, DistanceMetric metric, std::size_t num_threads = 0);
 
     ~FlatIndex() override = default;
 
@@ -81,11 +93,23 @@ public:
      */
     [[nodiscard]] bool contains(std::uint64_t id) const override;
 
+    /**
+     * @brief Copy a stored vector out of the index.
+     * @param id Vector identifier
+     * @param out Destination (dimension floats)
+     * @return true if the vector exists, false otherwise
+     */
+    [[nodiscard]] bool get_vector(std::uint64_t id, std::span<float> out) const override;
+
     /**
      * @brief Search for k nearest neighbors (exact search).
      *
      * Performs brute-force search by comparing the query vector with all
      * vectors in the index. This guarantees exact results (100% recall).
+     * Ties in distance are broken by ascending ID.
+     *
+     * Candidates are selected with bounded top-k heaps: O(N·D + N·log k)
+     * time and O(k) working memory per scan thread, reused across queries.
      *
      * @param query Query vector
      * @param k Number of neighbors to return
@@ -108,6 +132,15 @@ public:
      */
     ErrorCode build(std::span<const VectorRecord> vectors) override;
 
+    /**
+     * @brief Build index from IDs and a matrix view, reading vectors in place.
+     *
+     * @param ids One ID per row of vectors
+     * @param vectors Vector data (rows must equal ids.size())
+     * @return ErrorCode::Ok on success, error code otherwise
+     */
+    ErrorCode build(std::span<const std::uint64_t> ids, MatrixView vectors) override;
+
     /**
      * @brief Serialize index to output stream.
      *
@@ -129,6 +162,34 @@ public:
      */
     ErrorCode deserialize(std::istream& in) override;
 
+    /**
+     * @brief Pin the current vectors for writing out later.
+     *
+     * Copies the row -> ID order; rows overwritten or removed afterwards
+     * are kept until the capture is released, the others are read from
+     * the matrix while it is written.
+     *
+     * @return The captured view
+     */
+    [[nodiscard]] std::optional<IndexCapture> capture() const override;
+
+    /**
+     * @brief Row -> ID order of the matrix.
+     */
+    [[nodiscard]] std::vector<std::uint64_t> storage_order() const override;
+
+    /**
+     * @brief Validate the stream header and serve the matrix from a mapped file.
+     *
+     * Only the header of the stream is read; the vectors come from the
+     * mapping, so loading costs O(N) for the ID map and no vector I/O.
+     *
+     * @param in Input stream written by serialize()
+     * @param vectors Mapped rows with their IDs
+     * @return ErrorCode::Ok on success, error code otherwise
+     */
+    ErrorCode deserialize_mapped(std::istream& in, const MappedVectors& vectors) override;
+
     // -------------------------------------------------------------------------
     // Properties
     // -------------------------------------------------------------------------
@@ -164,6 +225,65 @@ private:
      */
     [[nodiscard]] float calculate_distance(std::span<const float> a, std::span<const float> b) const;
 
+    /**
+     * @brief Vector stored in a row of the matrix.
+     * @param r Row index (< ids_.size())
+     * @return View of dimension_ floats
+     */
+    [[nodiscard]] std::span<const float> row(std::size_t r) const {
+        return vectors_.row(r);
+    }
+
+    /**
+     * @brief State of an open capture (guarded by mutex_).
+     */
+    struct Capture {
+        std::vector<std::uint64_t> ids;  ///< Row -> ID at the capture
+        CapturedRows rows;               ///< Captured rows changed since
+    };
+
+    /**
+     * @brief Write the stream header of serialize().
+     * @param out Output stream
+     * @param num_vectors Vector count to record
+     */
+    void write_header(std::ostream& out, std::size_t num_vectors) const;
+
+    /**
+     * @brief Write a capture in the serialize() format, reading its rows
+     *        under short shared locks.
+     * @param out Output stream
+     * @param captured The capture
+     * @return ErrorCode::Ok on success, error code otherwise
+     */
+    ErrorCode write_capture(std::ostream& out, const Capture& captured) const;
+
+    /**
+     * @brief Read and validate the stream header written by serialize().
+     * @param in Input stream
+     * @param num_vectors Receives the stored vector count
+     * @return ErrorCode::Ok on success, error code otherwise
+     */
+    ErrorCode read_header(std::istream& in, std::size_t& num_vectors) const;
+
+    /**
+     * @brief Insert or overwrite a vector (lock must be held).
+     * @param id Vector identifier
+     * @param vector Vector data (dimension_ floats)
+     */
+    void store(std::uint64_t id, std::span<const float> vector);
+
+    /**
+     * @brief Drop all vectors, keeping them for open captures (lock must be held).
+     */
+    void clear_storage();
+
+    /**
+     * @brief Number of threads to scan the current rows with.
+     * @return Thread count (>= 1)
+     */
+    [[nodiscard]] std::size_t scan_thread_count() const;
+
     // -------------------------------------------------------------------------
     // Member Variables
     // -------------------------------------------------------------------------
@@ -171,8 +291,13 @@ private:
     std::size_t dimension_;                                    ///< Vector dimensionality
     DistanceMetric metric_;                                    ///< Distance metric
 
-    // Vector storage
-    std::unordered_map<std::uint64_t, std::vector<float>> vectors_;  ///< ID -> vector mapping
+    std::size_t num_threads_;                                  ///< Max threads per scan (0 = auto)
+
+    // Vector storage: row i of vectors_ holds the vector with ID ids_[i]
+    VectorBlock vectors_;                                      ///< Row-major vectors (heap or mapped)
+    std::vector<std::uint64_t> ids_;                           ///< Row -> ID
+    std::unordered_map<std::uint64_t, std::size_t> id_to_row_; ///< ID -> row
+    mutable std::vector<std::weak_ptr<Capture>> captures_;     ///< Open captures
 
     // Thread safety
     mutable std::shared_mutex mutex_;  ///< Reader-writer lock
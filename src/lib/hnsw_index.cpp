@@ -30,6 +30,8 @@
 #include <algorithm>
 #include <cmath>
 #include <chrono>
+#include <cstddef>
+#include <cstring>
 #include <iostream>
 #include <mutex>
 
@@ -41,6 +43,31 @@ namespace lynx {
 // Static member initialization
 const std::unordered_set<std::uint64_t> HNSWIndex::kEmptyNeighborSet;
 
+namespace {
+
+constexpr std::uint32_t kMagicNumber = 0x484E5357;  // "HNSW"
+constexpr std::uint32_t kVersion = 3;               // Fixed header + CSR sections
+constexpr std::size_t kPageSize = 4096;
+constexpr std::size_t kSectionAlignment = 64;
+
+std::size_t align_up(std::size_t offset, std::size_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+// One visited table per thread: concurrent searches run under a shared
+// lock and must not share mutable state. reset() invalidates all earlier
+// marks, so the table can be reused across index instances.
+VisitedTable& thread_visited_table(std::size_t num_nodes) {
+    thread_local VisitedTable visited_table(1024);  // Initial capacity, will grow as needed
+    if (visited_table.size() < num_nodes) {
+        visited_table.resize(num_nodes);
+    }
+    visited_table.reset();  // O(1) reset
+    return visited_table;
+}
+
+} // namespace
+
 // ============================================================================
 // Constructor
 // ============================================================================
@@ -49,12 +76,12 @@ HNSWIndex::HNSWIndex(std::size_t dimension, DistanceMetric metric, const HNSWPar
     : dimension_(dimension)
     , metric_(metric)
     , params_(params)
+    , vectors_(dimension)
     , entry_point_(kInvalidId)
     , entry_point_layer_(0)
     , rng_(params.random_seed.has_value() ? params.random_seed.value() : std::random_device{}())
     , level_dist_(0.0, 1.0)
-    , ml_(1.0 / std::log(params.m))
-    , visited_table_(1024) {  // Initial capacity, will grow as needed
+    , ml_(1.0 / std::log(params.m)) {
 }
 
 // ============================================================================
@@ -111,7 +138,36 @@ const std::unordered_set<std::uint64_t>& HNSWIndex::get_neighbors(
     return it->second.layers[layer];
 }
 
+void HNSWIndex::thaw() {
+    if (csr_.empty()) {
+        return;
+    }
+
+    const std::size_t num_nodes = index_to_id_.size();
+    graph_.clear();
+    graph_.reserve(num_nodes);
+    for (std::size_t idx = 0; idx < num_nodes; ++idx) {
+        const std::uint64_t id = index_to_id_[idx];
+        Node node(id, csr_.max_layer(idx));
+        for (std::size_t layer = 0; layer <= node.max_layer; ++layer) {
+            const auto neighbors = csr_.neighbors(idx, layer);
+            auto& set = node.layers[layer];
+            set.reserve(neighbors.size());
+            for (std::uint32_t neighbor_idx : neighbors) {
+                if (neighbor_idx < num_nodes) {
+                    set.insert(index_to_id_[neighbor_idx]);
+                }
+            }
+        }
+        graph_.emplace(id, std::move(node));
+    }
+
+    release_csr();
+}
+
 void HNSWIndex::add_connection(std::uint64_t source, std::uint64_t target, std::size_t layer) {
+    keep_links(source);
+    keep_links(target);
     auto& source_node = graph_.at(source);
     auto& target_node = graph_.at(target);
 
@@ -130,6 +186,7 @@ void HNSWIndex::prune_connections(std::uint64_t node_id, std::size_t layer, std:
     if (neighbors.size() <= max_connections) {
         return; // No pruning needed
     }
+    keep_links(node_id);
 
     // Build candidates from current neighbors
     std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
@@ -158,12 +215,7 @@ std::vector<HNSWIndex::Candidate> HNSWIndex::search_layer(
     std::size_t ef,
     std::size_t layer) const {
 
-    // Ensure visited table is large enough
-    const std::size_t num_nodes = id_to_index_.size();
-    if (visited_table_.size() < num_nodes) {
-        visited_table_.resize(num_nodes);
-    }
-    visited_table_.reset();  // O(1) reset
+    VisitedTable& visited_table = thread_visited_table(id_to_index_.size());
 
     // Candidates: min-heap by distance (closest first)
     std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
@@ -180,7 +232,7 @@ std::vector<HNSWIndex::Candidate> HNSWIndex::search_layer(
         const float dist = calculate_distance(query, ep_id);
         candidates.push({ep_id, dist});
         result.push_back({ep_id, dist});
-        visited_table_.mark(ep_idx);
+        visited_table.mark(ep_idx);
     }
 
     // Make result a max-heap for efficient worst-distance tracking
@@ -202,8 +254,8 @@ std::vector<HNSWIndex::Candidate> HNSWIndex::search_layer(
             const std::size_t neighbor_idx = get_index_for_id(neighbor_id);
             if (neighbor_idx == std::numeric_limits<std::size_t>::max()) continue;
 
-            if (!visited_table_.is_visited(neighbor_idx)) {
-                visited_table_.mark(neighbor_idx);
+            if (!visited_table.is_visited(neighbor_idx)) {
+                visited_table.mark(neighbor_idx);
 
                 const float dist = calculate_distance(query, neighbor_id);
 
@@ -230,6 +282,64 @@ std::vector<HNSWIndex::Candidate> HNSWIndex::search_layer(
     return result;
 }
 
+std::vector<HNSWIndex::Candidate> HNSWIndex::search_layer_csr(
+    std::span<const float> query,
+    const std::vector<std::uint64_t>& entry_points,
+    std::size_t ef,
+    std::size_t layer) const {
+
+    // Same algorithm as search_layer(), but nodes are internal indices, so
+    // neither neighbor lists nor vectors need a hash lookup
+    const std::size_t num_nodes = index_to_id_.size();
+    VisitedTable& visited_table = thread_visited_table(num_nodes);
+
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
+    std::vector<Candidate> result;
+    result.reserve(ef + 1);
+
+    for (auto ep_idx : entry_points) {
+        const float dist = utils::calculate_distance(query, get_vector_by_index(ep_idx), metric_);
+        candidates.push({ep_idx, dist});
+        result.push_back({ep_idx, dist});
+        visited_table.mark(ep_idx);
+    }
+    std::make_heap(result.begin(), result.end());
+
+    while (!candidates.empty()) {
+        const Candidate current = candidates.top();
+        candidates.pop();
+
+        if (current.distance > result.front().distance) {
+            break;
+        }
+
+        for (std::uint32_t neighbor_idx : csr_.neighbors(current.id, layer)) {
+            if (neighbor_idx >= num_nodes || visited_table.is_visited(neighbor_idx)) {
+                continue;
+            }
+            visited_table.mark(neighbor_idx);
+
+            const float dist = utils::calculate_distance(
+                query, get_vector_by_index(neighbor_idx), metric_);
+            if (dist < result.front().distance || result.size() < ef) {
+                candidates.push({neighbor_idx, dist});
+                result.push_back({neighbor_idx, dist});
+                std::push_heap(result.begin(), result.end());
+
+                if (result.size() > ef) {
+                    std::pop_heap(result.begin(), result.end());
+                    result.pop_back();
+                }
+            }
+        }
+    }
+
+    std::sort(result.begin(), result.end(),
+              [](const Candidate& a, const Candidate& b) { return a.distance < b.distance; });
+
+    return result;
+}
+
 // ============================================================================
 // Neighbor Selection Algorithms
 // ============================================================================
@@ -362,6 +472,7 @@ std::uint64_t HNSWIndex::greedy_descent(
 
 ErrorCode HNSWIndex::add(std::uint64_t id, std::span<const float> vector) {
     UNIQUE_LOCK(mutex_);
+    thaw();
 
     // Validate dimension
     if (vector.size() != dimension_) {
@@ -372,10 +483,11 @@ ErrorCode HNSWIndex::add(std::uint64_t id, std::span<const float> vector) {
     if (id_to_index_.find(id) != id_to_index_.end()) {
         return ErrorCode::InvalidState;
     }
+    for_each_capture(captures_, [id](Capture& captured) { captured.rows.added.insert(id); });
 
     // Store vector in contiguous storage
     const std::size_t new_index = index_to_id_.size();
-    vector_data_.insert(vector_data_.end(), vector.begin(), vector.end());
+    vectors_.append(vector);
     id_to_index_[id] = new_index;
     index_to_id_.push_back(id);
 
@@ -419,6 +531,12 @@ ErrorCode HNSWIndex::add(std::uint64_t id, std::span<const float> vector) {
         // search_layer returns sorted vector (closest first)
         auto candidates_vec = search_layer(vector, entry_points, params_.ef_construction, lc);
 
+        // Links left behind by a removed node can lead the search to a later
+        // node with the same ID: the new node itself, or one not in this layer
+        std::erase_if(candidates_vec, [this, id, lc](const Candidate& c) {
+            return c.id == id || graph_.at(c.id).max_layer < lc;
+        });
+
         // Build min-heap from sorted vector for neighbor selection
         std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates_min(
             std::greater<Candidate>(),
@@ -480,9 +598,8 @@ ErrorCode HNSWIndex::add(std::uint64_t id, std::span<const float> vector) {
 #endif
 
         // Update entry points for next layer
-        entry_points.clear();
-        for (auto neighbor_id : neighbors) {
-            entry_points.push_back(neighbor_id);
+        if (!neighbors.empty()) {
+            entry_points.assign(neighbors.begin(), neighbors.end());
         }
 
         if (lc == 0) break;
@@ -518,20 +635,37 @@ std::vector<SearchResultItem> HNSWIndex::search(
         return {};
     }
 
-    // Start from entry point
-    std::vector<std::uint64_t> entry_points = {entry_point_};
-
-    // Search from top layer to layer 1
-    for (std::size_t lc = entry_point_layer_; lc > 0; --lc) {
-        auto nearest = search_layer(query, entry_points, 1, lc);
-        if (!nearest.empty()) {
-            entry_points = {nearest.front().id};  // Vector is sorted, front is closest
+    const std::size_t ef_search = params.ef_search > 0 ? params.ef_search : params_.ef_search;
+    std::vector<Candidate> candidates;
+
+    if (!csr_.empty()) {
+        // Loaded graph: the same descent over internal indices
+        std::vector<std::uint64_t> entry_points = {get_index_for_id(entry_point_)};
+        for (std::size_t lc = entry_point_layer_; lc > 0; --lc) {
+            auto nearest = search_layer_csr(query, entry_points, 1, lc);
+            if (!nearest.empty()) {
+                entry_points = {nearest.front().id};
+            }
+        }
+        candidates = search_layer_csr(query, entry_points, std::max(ef_search, k), 0);
+        for (auto& candidate : candidates) {
+            candidate.id = index_to_id_[candidate.id];
+        }
+    } else {
+        // Start from entry point
+        std::vector<std::uint64_t> entry_points = {entry_point_};
+
+        // Search from top layer to layer 1
+        for (std::size_t lc = entry_point_layer_; lc > 0; --lc) {
+            auto nearest = search_layer(query, entry_points, 1, lc);
+            if (!nearest.empty()) {
+                entry_points = {nearest.front().id};  // Vector is sorted, front is closest
+            }
         }
-    }
 
-    // Search at layer 0 with ef_search
-    const std::size_t ef_search = params.ef_search > 0 ? params.ef_search : params_.ef_search;
-    auto candidates = search_layer(query, entry_points, std::max(ef_search, k), 0);
+        // Search at layer 0 with ef_search
+        candidates = search_layer(query, entry_points, std::max(ef_search, k), 0);
+    }
 
     // Extract top k results (candidates already sorted by distance ascending)
     std::vector<SearchResultItem> results;
@@ -563,6 +697,7 @@ std::vector<SearchResultItem> HNSWIndex::search(
 
 ErrorCode HNSWIndex::remove(std::uint64_t id) {
     UNIQUE_LOCK(mutex_);
+    thaw();
 
     // Check if exists
     auto idx_it = id_to_index_.find(id);
@@ -575,53 +710,75 @@ ErrorCode HNSWIndex::remove(std::uint64_t id) {
         return ErrorCode::InvalidState;
     }
 
-    const Node& node = graph_it->second;
+    // Remove from graph
+    keep_links(id);
+    keep_row(id);
+    const Node node = std::move(graph_it->second);
+    graph_.erase(graph_it);
 
-    // Remove all connections to this node
+    // Repair every neighbor that linked back: rerun neighbor selection
+    // over its remaining links plus the removed node's other neighbors, so
+    // paths that went through the removed node survive
     for (std::size_t layer = 0; layer <= node.max_layer; ++layer) {
-        const auto& neighbors = node.layers[layer];
-        for (auto neighbor_id : neighbors) {
+        const std::size_t max_conn = (layer == 0) ? (2 * params_.m) : params_.m;
+        for (auto neighbor_id : node.layers[layer]) {
             auto neighbor_it = graph_.find(neighbor_id);
-            if (neighbor_it != graph_.end() && layer < neighbor_it->second.layers.size()) {
-                neighbor_it->second.layers[layer].erase(id);
+            if (neighbor_it == graph_.end() || layer > neighbor_it->second.max_layer) {
+                continue;
+            }
+            auto& links = neighbor_it->second.layers[layer];
+            if (!links.contains(id)) {
+                continue;
+            }
+            keep_links(neighbor_id);
+            links.erase(id);
+
+            std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
+            auto consider = [&](std::uint64_t candidate_id) {
+                const auto it = graph_.find(candidate_id);
+                if (it != graph_.end() && layer <= it->second.max_layer) {
+                    candidates.push({candidate_id, calculate_distance(neighbor_id, candidate_id)});
+                }
+            };
+            for (auto link_id : links) {
+                consider(link_id);
             }
+            for (auto candidate_id : node.layers[layer]) {
+                if (candidate_id != neighbor_id && !links.contains(candidate_id)) {
+                    consider(candidate_id);
+                }
+            }
+
+            auto selected = select_neighbors_heuristic(candidates, max_conn, layer, false);
+            links.clear();
+            links.insert(selected.begin(), selected.end());
         }
     }
 
-    // Remove from graph
-    graph_.erase(graph_it);
-
     // Remove from contiguous vector storage using swap-with-last strategy
     const std::size_t remove_idx = idx_it->second;
     const std::size_t last_idx = index_to_id_.size() - 1;
 
     if (remove_idx != last_idx) {
-        // Swap vector data with the last element
+        // Update index mappings for the element moved into the freed slot
         const std::uint64_t last_id = index_to_id_[last_idx];
-        std::copy(
-            vector_data_.begin() + last_idx * dimension_,
-            vector_data_.begin() + (last_idx + 1) * dimension_,
-            vector_data_.begin() + remove_idx * dimension_
-        );
-
-        // Update index mappings for the swapped element
         index_to_id_[remove_idx] = last_id;
         id_to_index_[last_id] = remove_idx;
     }
 
-    // Remove the last element
-    vector_data_.resize(vector_data_.size() - dimension_);
+    // Move the last vector into the freed slot and drop the last element
+    vectors_.move_last_to(remove_idx);
     index_to_id_.pop_back();
     id_to_index_.erase(id);
 
     // Update entry point if needed
     if (id == entry_point_) {
-        // Find new entry point (node with highest layer)
+        // Find new entry point (node with highest layer, even if that is 0)
         entry_point_ = kInvalidId;
         entry_point_layer_ = 0;
 
         for (const auto& [node_id, node] : graph_) {
-            if (node.max_layer > entry_point_layer_) {
+            if (entry_point_ == kInvalidId || node.max_layer > entry_point_layer_) {
                 entry_point_ = node_id;
                 entry_point_layer_ = node.max_layer;
             }
@@ -640,13 +797,24 @@ bool HNSWIndex::contains(std::uint64_t id) const {
     return id_to_index_.find(id) != id_to_index_.end();
 }
 
+bool HNSWIndex::get_vector(std::uint64_t id, std::span<float> out) const {
+    SHARED_LOCK(mutex_);
+    auto it = id_to_index_.find(id);
+    if (it == id_to_index_.end() || out.size() != dimension_) {
+        return false;
+    }
+    auto vec = get_vector_by_index(it->second);
+    std::copy(vec.begin(), vec.end(), out.begin());
+    return true;
+}
+
 std::size_t HNSWIndex::memory_usage() const {
     SHARED_LOCK(mutex_);
 
     std::size_t total = 0;
 
     // Contiguous vector storage
-    total += vector_data_.capacity() * sizeof(float);
+    total += vectors_.memory_usage();
 
     // ID-to-index mapping
     total += id_to_index_.size() * (sizeof(std::uint64_t) + sizeof(std::size_t));
@@ -654,6 +822,10 @@ std::size_t HNSWIndex::memory_usage() const {
     // Index-to-ID mapping
     total += index_to_id_.capacity() * sizeof(std::uint64_t);
 
+    // Loaded CSR graph (mapped arrays are page cache, not heap)
+    total += csr_.owned_offsets.capacity() * sizeof(std::uint64_t);
+    total += csr_.owned_links.capacity() * sizeof(std::uint32_t);
+
     // Graph storage: graph_ map
     for (const auto& [id, node] : graph_) {
         total += sizeof(id);                    // Key
@@ -664,9 +836,6 @@ std::size_t HNSWIndex::memory_usage() const {
         }
     }
 
-    // Visited table
-    total += visited_table_.size() * sizeof(uint8_t);
-
     // Don't include fixed object overhead (sizeof(*this))
     // Only count dynamic allocations
 
@@ -684,12 +853,26 @@ ErrorCode HNSWIndex::build(std::span<const VectorRecord> vectors) {
     return ErrorCode::Ok;
 }
 
+ErrorCode HNSWIndex::build(std::span<const std::uint64_t> ids, MatrixView vectors) {
+    if (ids.size() != vectors.rows()) {
+        return ErrorCode::InvalidParameter;
+    }
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        ErrorCode err = add(ids[i], vectors[i]);
+        if (err != ErrorCode::Ok) {
+            return err;
+        }
+    }
+    return ErrorCode::Ok;
+}
+
 // ============================================================================
 // Graph Optimization
 // ============================================================================
 
 ErrorCode HNSWIndex::optimize_graph() {
     UNIQUE_LOCK(mutex_);
+    thaw();
 
     // If index is empty or too small, no optimization needed
     if (graph_.empty() || graph_.size() < 10) {
@@ -761,6 +944,7 @@ ErrorCode HNSWIndex::optimize_graph() {
 
 ErrorCode HNSWIndex::compact_index() {
     UNIQUE_LOCK(mutex_);
+    thaw();
 
     // If index is empty, nothing to compact
     if (graph_.empty() && id_to_index_.empty()) {
@@ -787,6 +971,9 @@ ErrorCode HNSWIndex::compact_index() {
             }
 
             // Remove dangling references
+            if (!to_remove.empty()) {
+                keep_links(node_id);
+            }
             for (auto neighbor_id : to_remove) {
                 neighbors.erase(neighbor_id);
                 dangling_refs_removed++;
@@ -807,20 +994,16 @@ ErrorCode HNSWIndex::compact_index() {
         auto idx_it = id_to_index_.find(vec_id);
         if (idx_it == id_to_index_.end()) continue;
 
+        keep_row(vec_id);
         const std::size_t remove_idx = idx_it->second;
         const std::size_t last_idx = index_to_id_.size() - 1;
 
         if (remove_idx != last_idx) {
             const std::uint64_t last_id = index_to_id_[last_idx];
-            std::copy(
-                vector_data_.begin() + last_idx * dimension_,
-                vector_data_.begin() + (last_idx + 1) * dimension_,
-                vector_data_.begin() + remove_idx * dimension_
-            );
             index_to_id_[remove_idx] = last_id;
             id_to_index_[last_id] = remove_idx;
         }
-        vector_data_.resize(vector_data_.size() - dimension_);
+        vectors_.move_last_to(remove_idx);
         index_to_id_.pop_back();
         id_to_index_.erase(vec_id);
         orphaned_vectors_removed++;
@@ -845,6 +1028,7 @@ ErrorCode HNSWIndex::compact_index() {
             for (auto neighbor_id : neighbors) {
                 auto neighbor_it = graph_.find(neighbor_id);
                 if (neighbor_it != graph_.end() && layer < neighbor_it->second.layers.size()) {
+                    keep_links(neighbor_id);
                     neighbor_it->second.layers[layer].erase(node_id);
                 }
             }
@@ -896,76 +1080,275 @@ ErrorCode HNSWIndex::compact_index() {
 }
 
 // ============================================================================
-// Serialization (Placeholder)
+// Serialization
 // ============================================================================
 
+void HNSWIndex::layout_sections(FileHeader& header) {
+    header.ids_offset = align_up(sizeof(FileHeader), kSectionAlignment);
+    header.vectors_offset = align_up(
+        header.ids_offset + header.num_vectors * sizeof(std::uint64_t), kPageSize);
+    header.level_start_offset = align_up(
+        header.vectors_offset + header.num_vectors * header.dimension * sizeof(float),
+        kSectionAlignment);
+    header.link_start_offset = align_up(
+        header.level_start_offset + (header.num_vectors + 1) * sizeof(std::uint64_t),
+        kSectionAlignment);
+    header.links_offset = align_up(
+        header.link_start_offset + (header.num_slots + 1) * sizeof(std::uint64_t),
+        kSectionAlignment);
+    header.end_offset = header.links_offset + header.num_links * sizeof(std::uint32_t);
+}
+
 ErrorCode HNSWIndex::serialize(std::ostream& out) const {
     SHARED_LOCK(mutex_);
 
     try {
-        // Write magic number and version for file format verification
-        constexpr uint32_t kMagicNumber = 0x484E5357; // "HNSW" in hex
-        constexpr uint32_t kVersion = 2;  // Version 2 for new contiguous storage format
-
-        out.write(reinterpret_cast<const char*>(&kMagicNumber), sizeof(kMagicNumber));
-        out.write(reinterpret_cast<const char*>(&kVersion), sizeof(kVersion));
+        const std::size_t num_vectors = index_to_id_.size();
+        if (num_vectors > std::numeric_limits<std::uint32_t>::max()) {
+            return ErrorCode::InvalidState;  // Links are stored as 32-bit indices
+        }
 
-        // Write configuration
-        out.write(reinterpret_cast<const char*>(&dimension_), sizeof(dimension_));
+        // Adjacency in CSR form: as loaded, or flattened from graph_ in
+        // index order with neighbor IDs replaced by their indices
+        std::vector<std::uint64_t> level_start_buffer;
+        std::vector<std::uint64_t> link_start_buffer;
+        std::vector<std::uint32_t> links_buffer;
+        std::span<const std::uint64_t> level_start = csr_.level_start;
+        std::span<const std::uint64_t> link_start = csr_.link_start;
+        std::span<const std::uint32_t> links = csr_.links;
+        if (csr_.empty()) {
+            level_start_buffer.reserve(num_vectors + 1);
+            link_start_buffer.reserve(num_vectors + 1);
+            level_start_buffer.push_back(0);
+            link_start_buffer.push_back(0);
+            for (std::size_t idx = 0; idx < num_vectors; ++idx) {
+                auto node_it = graph_.find(index_to_id_[idx]);
+                if (node_it == graph_.end()) {
+                    return ErrorCode::InvalidState;
+                }
+                const Node& node = node_it->second;
+                for (std::size_t layer = 0; layer <= node.max_layer; ++layer) {
+                    for (std::uint64_t neighbor_id : node.layers[layer]) {
+                        const std::size_t neighbor_idx = get_index_for_id(neighbor_id);
+                        if (neighbor_idx != std::numeric_limits<std::size_t>::max()) {
+                            links_buffer.push_back(static_cast<std::uint32_t>(neighbor_idx));
+                        }
+                    }
+                    link_start_buffer.push_back(links_buffer.size());
+                }
+                level_start_buffer.push_back(link_start_buffer.size() - 1);
+            }
+            level_start = level_start_buffer;
+            link_start = link_start_buffer;
+            links = links_buffer;
+        }
 
-        uint8_t metric_value = static_cast<uint8_t>(metric_);
-        out.write(reinterpret_cast<const char*>(&metric_value), sizeof(metric_value));
+        FileHeader header = current_header();
+        header.num_slots = link_start.size() - 1;
+        header.num_links = links.size();
+
+        // Vector rows are contiguous within the mapped and the heap part of
+        // vectors_; write each run of adjacent rows at once
+        auto write_vectors = [this, num_vectors](std::ostream& out) {
+            const std::size_t row_bytes = dimension_ * sizeof(float);
+            for (std::size_t begin = 0; begin < num_vectors;) {
+                std::size_t end = begin + 1;
+                while (end < num_vectors &&
+                       vectors_.row_data(end) == vectors_.row_data(end - 1) + dimension_) {
+                    ++end;
+                }
+                out.write(reinterpret_cast<const char*>(vectors_.row_data(begin)),
+                          static_cast<std::streamsize>((end - begin) * row_bytes));
+                begin = end;
+            }
+            return ErrorCode::Ok;
+        };
 
-        out.write(reinterpret_cast<const char*>(&params_.m), sizeof(params_.m));
-        out.write(reinterpret_cast<const char*>(&params_.ef_construction), sizeof(params_.ef_construction));
-        out.write(reinterpret_cast<const char*>(&params_.ef_search), sizeof(params_.ef_search));
-        out.write(reinterpret_cast<const char*>(&params_.max_elements), sizeof(params_.max_elements));
+        return write_file(out, header, index_to_id_, write_vectors, level_start, link_start, links);
 
-        // Write entry point information
-        out.write(reinterpret_cast<const char*>(&entry_point_), sizeof(entry_point_));
-        out.write(reinterpret_cast<const char*>(&entry_point_layer_), sizeof(entry_point_layer_));
+    } catch (const std::exception&) {
+        return ErrorCode::IOError;
+    }
+}
 
-        // Write number of vectors
-        size_t num_vectors = index_to_id_.size();
-        out.write(reinterpret_cast<const char*>(&num_vectors), sizeof(num_vectors));
+HNSWIndex::FileHeader HNSWIndex::current_header() const {
+    FileHeader header{};
+    header.magic = kMagicNumber;
+    header.version = kVersion;
+    header.dimension = dimension_;
+    header.metric = static_cast<std::uint64_t>(metric_);
+    header.m = params_.m;
+    header.ef_construction = params_.ef_construction;
+    header.ef_search = params_.ef_search;
+    header.max_elements = params_.max_elements;
+    header.entry_point = entry_point_;
+    header.entry_point_layer = entry_point_layer_;
+    header.num_vectors = index_to_id_.size();
+    return header;
+}
 
-        // Write each vector and its graph structure (in index order)
-        for (size_t idx = 0; idx < num_vectors; ++idx) {
-            const uint64_t id = index_to_id_[idx];
+ErrorCode HNSWIndex::write_file(std::ostream& out, FileHeader header,
+                                std::span<const std::uint64_t> ids,
+                                const std::function<ErrorCode(std::ostream&)>& write_vectors,
+                                std::span<const std::uint64_t> level_start,
+                                std::span<const std::uint64_t> link_start,
+                                std::span<const std::uint32_t> links) {
+    layout_sections(header);
+
+    // Each section goes out as one write, preceded by zero padding up to
+    // its offset
+    std::size_t position = 0;
+    const std::vector<char> padding(kPageSize, 0);
+    auto write_section = [&](std::uint64_t offset, const void* data, std::size_t bytes) {
+        out.write(padding.data(), static_cast<std::streamsize>(offset - position));
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+        position = offset + bytes;
+    };
+
+    write_section(0, &header, sizeof(header));
+    write_section(header.ids_offset, ids.data(), ids.size() * sizeof(std::uint64_t));
+
+    write_section(header.vectors_offset, nullptr, 0);
+    ErrorCode result = write_vectors(out);
+    if (result != ErrorCode::Ok) {
+        return result;
+    }
+    position += header.num_vectors * header.dimension * sizeof(float);
 
-            // Write vector ID
-            out.write(reinterpret_cast<const char*>(&id), sizeof(id));
+    write_section(header.level_start_offset, level_start.data(),
+                  level_start.size() * sizeof(std::uint64_t));
+    write_section(header.link_start_offset, link_start.data(),
+                  link_start.size() * sizeof(std::uint64_t));
+    write_section(header.links_offset, links.data(), links.size() * sizeof(std::uint32_t));
 
-            // Write vector data
-            out.write(reinterpret_cast<const char*>(vector_data_.data() + idx * dimension_),
-                     dimension_ * sizeof(float));
+    return out.good() ? ErrorCode::Ok : ErrorCode::IOError;
+}
 
-            // Write node information
-            auto node_it = graph_.find(id);
-            if (node_it == graph_.end()) {
-                return ErrorCode::InvalidState;
-            }
+std::optional<IndexCapture> HNSWIndex::capture() const {
+    auto captured = std::make_shared<Capture>();
+    {
+        UNIQUE_LOCK(mutex_);
+        if (index_to_id_.size() > std::numeric_limits<std::uint32_t>::max()) {
+            return std::nullopt;  // serialize() reports the error
+        }
+        captured->header = current_header();
+        captured->ids = index_to_id_;
+        captured->from_csr = !csr_.empty();
+        captures_.push_back(captured);
+    }
 
-            const Node& node = node_it->second;
-            out.write(reinterpret_cast<const char*>(&node.max_layer), sizeof(node.max_layer));
+    IndexCapture result;
+    result.serialize = [this, captured](std::ostream& out) {
+        return write_capture(out, *captured);
+    };
+    result.ids = [captured]() { return captured->ids; };
+    return result;
+}
 
-            // Write neighbors for each layer
-            for (size_t layer = 0; layer <= node.max_layer; ++layer) {
-                const auto& neighbors = node.layers[layer];
-                size_t num_neighbors = neighbors.size();
-                out.write(reinterpret_cast<const char*>(&num_neighbors), sizeof(num_neighbors));
+ErrorCode HNSWIndex::write_capture(std::ostream& out, const Capture& captured) const {
+    try {
+        const std::size_t num_vectors = captured.ids.size();
+        const std::size_t chunk =
+            std::max<std::size_t>(kCaptureReadBytes / (dimension_ * sizeof(float)), 1);
+
+        std::vector<std::uint64_t> level_start_buffer;
+        std::vector<std::uint64_t> link_start_buffer;
+        std::vector<std::uint32_t> links_buffer;
+        std::span<const std::uint64_t> level_start;
+        std::span<const std::uint64_t> link_start;
+        std::span<const std::uint32_t> links;
+        if (captured.from_csr) {
+            // The loaded graph is the captured one; its arrays stay valid
+            // after the lock is released, as release_csr() hands them to
+            // the capture
+            SHARED_LOCK(mutex_);
+            const CsrGraph& csr = captured.csr ? *captured.csr : csr_;
+            level_start = csr.level_start;
+            link_start = csr.link_start;
+            links = csr.links;
+        } else {
+            // Flatten the captured links into CSR form, a chunk of nodes
+            // per lock, with neighbor IDs replaced by their captured indices
+            std::unordered_map<std::uint64_t, std::uint32_t> captured_index;
+            captured_index.reserve(num_vectors);
+            for (std::size_t idx = 0; idx < num_vectors; ++idx) {
+                captured_index.emplace(captured.ids[idx], static_cast<std::uint32_t>(idx));
+            }
 
-                for (uint64_t neighbor_id : neighbors) {
-                    out.write(reinterpret_cast<const char*>(&neighbor_id), sizeof(neighbor_id));
+            level_start_buffer.reserve(num_vectors + 1);
+            link_start_buffer.reserve(num_vectors + 1);
+            level_start_buffer.push_back(0);
+            link_start_buffer.push_back(0);
+            auto append_layer = [&](const auto& neighbors) {
+                for (std::uint64_t neighbor_id : neighbors) {
+                    const auto it = captured_index.find(neighbor_id);
+                    if (it != captured_index.end()) {
+                        links_buffer.push_back(it->second);
+                    }
+                }
+                link_start_buffer.push_back(links_buffer.size());
+            };
+            for (std::size_t begin = 0; begin < num_vectors; begin += chunk) {
+                const std::size_t end = std::min(begin + chunk, num_vectors);
+                SHARED_LOCK(mutex_);
+                for (std::size_t idx = begin; idx < end; ++idx) {
+                    const std::uint64_t id = captured.ids[idx];
+                    if (const auto kept = captured.links.find(id); kept != captured.links.end()) {
+                        for (const auto& neighbors : kept->second) {
+                            append_layer(neighbors);
+                        }
+                    } else {
+                        const auto node_it = graph_.find(id);
+                        if (node_it == graph_.end()) {
+                            return ErrorCode::InvalidState;
+                        }
+                        for (std::size_t layer = 0; layer <= node_it->second.max_layer; ++layer) {
+                            append_layer(node_it->second.layers[layer]);
+                        }
+                    }
+                    level_start_buffer.push_back(link_start_buffer.size() - 1);
                 }
             }
+            level_start = level_start_buffer;
+            link_start = link_start_buffer;
+            links = links_buffer;
         }
 
-        if (!out.good()) {
-            return ErrorCode::IOError;
-        }
+        FileHeader header = captured.header;
+        header.num_slots = link_start.size() - 1;
+        header.num_links = links.size();
+
+        // Rows are copied a chunk at a time under the lock and written
+        // after releasing it, so writers only wait for a copy
+        auto write_vectors = [&](std::ostream& out) {
+            std::vector<float> buffer;
+            for (std::size_t begin = 0; begin < num_vectors; begin += chunk) {
+                const std::size_t end = std::min(begin + chunk, num_vectors);
+                buffer.resize((end - begin) * dimension_);
+                float* row = buffer.data();
+                {
+                    SHARED_LOCK(mutex_);
+                    for (std::size_t idx = begin; idx < end; ++idx, row += dimension_) {
+                        const std::uint64_t id = captured.ids[idx];
+                        std::span<const float> vector;
+                        if (const auto* kept = captured.rows.find(id)) {
+                            vector = *kept;
+                        } else if (const std::size_t current = get_index_for_id(id);
+                                   current != std::numeric_limits<std::size_t>::max()) {
+                            vector = get_vector_by_index(current);
+                        } else {
+                            return ErrorCode::InvalidState;
+                        }
+                        std::copy_n(vector.data(), dimension_, row);
+                    }
+                }
+                out.write(reinterpret_cast<const char*>(buffer.data()),
+                          static_cast<std::streamsize>(buffer.size() * sizeof(float)));
+            }
+            return ErrorCode::Ok;
+        };
 
-        return ErrorCode::Ok;
+        return write_file(out, header, captured.ids, write_vectors, level_start, link_start, links);
 
     } catch (const std::exception&) {
         return ErrorCode::IOError;
@@ -973,20 +1356,91 @@ ErrorCode HNSWIndex::serialize(std::ostream& out) const {
 }
 
 ErrorCode HNSWIndex::deserialize(std::istream& in) {
+    return deserialize_impl(in, nullptr);
+}
+
+std::vector<std::uint64_t> HNSWIndex::storage_order() const {
+    SHARED_LOCK(mutex_);
+    return index_to_id_;
+}
+
+ErrorCode HNSWIndex::deserialize_mapped(std::istream& in, const MappedVectors& vectors) {
+    return deserialize_impl(in, &vectors);
+}
+
+ErrorCode HNSWIndex::open_mapped(std::shared_ptr<MappedFile> file) {
+    UNIQUE_LOCK(mutex_);
+
+    if (!file || file->size() < sizeof(FileHeader)) {
+        return ErrorCode::IOError;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, file->data(), sizeof(header));
+    if (header.magic != kMagicNumber) {
+        return ErrorCode::IOError;
+    }
+    if (header.version != kVersion) {
+        return ErrorCode::NotImplemented;  // Older formats go through deserialize_mapped()
+    }
+
+    ErrorCode result = apply_header(header);
+    if (result != ErrorCode::Ok) {
+        return result;
+    }
+    if (header.end_offset > file->size()) {
+        clear_storage();
+        return ErrorCode::IOError;
+    }
+
+    // Everything but the ID lookup table is used straight from the mapping
+    const char* base = file->data();
+    const std::span<const std::uint64_t> ids(
+        reinterpret_cast<const std::uint64_t*>(base + header.ids_offset), header.num_vectors);
+
+    clear_storage();
+    index_to_id_.assign(ids.begin(), ids.end());
+    vectors_.attach(MappedVectors{file, header.vectors_offset, ids});
+    csr_.level_start = {reinterpret_cast<const std::uint64_t*>(base + header.level_start_offset),
+                        header.num_vectors + 1};
+    csr_.link_start = {reinterpret_cast<const std::uint64_t*>(base + header.link_start_offset),
+                       header.num_slots + 1};
+    csr_.links = {reinterpret_cast<const std::uint32_t*>(base + header.links_offset),
+                  header.num_links};
+    csr_.file = std::move(file);
+
+    result = finish_csr_load();
+    if (result != ErrorCode::Ok) {
+        clear_storage();
+    }
+    return result;
+}
+
+ErrorCode HNSWIndex::deserialize_impl(std::istream& in, const MappedVectors* mapped) {
     UNIQUE_LOCK(mutex_);
 
     try {
         // Read and verify magic number
-        constexpr uint32_t kExpectedMagic = 0x484E5357; // "HNSW"
         uint32_t magic_number;
         in.read(reinterpret_cast<char*>(&magic_number), sizeof(magic_number));
-        if (magic_number != kExpectedMagic) {
+        if (magic_number != kMagicNumber) {
             return ErrorCode::IOError; // Invalid file format
         }
 
         // Read and verify version
         uint32_t version;
         in.read(reinterpret_cast<char*>(&version), sizeof(version));
+        if (version == kVersion) {
+            FileHeader header;
+            header.magic = magic_number;
+            header.version = version;
+            in.read(reinterpret_cast<char*>(&header) + offsetof(FileHeader, dimension),
+                    sizeof(header) - offsetof(FileHeader, dimension));
+            if (!in.good()) {
+                return ErrorCode::IOError;
+            }
+            return deserialize_csr(in, header, mapped);
+        }
         if (version != 1 && version != 2) {
             return ErrorCode::IOError; // Unsupported version
         }
@@ -1018,15 +1472,21 @@ ErrorCode HNSWIndex::deserialize(std::istream& in) {
         size_t num_vectors;
         in.read(reinterpret_cast<char*>(&num_vectors), sizeof(num_vectors));
 
+        if (mapped != nullptr && mapped->ids.size() != num_vectors) {
+            return ErrorCode::IOError;
+        }
+
         // Clear existing data
-        vector_data_.clear();
-        id_to_index_.clear();
-        index_to_id_.clear();
-        graph_.clear();
+        clear_storage();
 
-        // Pre-allocate storage
-        vector_data_.reserve(num_vectors * dimension_);
+        // Pre-allocate storage (or serve vectors from the mapping)
+        if (mapped != nullptr) {
+            vectors_.attach(*mapped);
+        } else {
+            vectors_.reserve(num_vectors);
+        }
         index_to_id_.reserve(num_vectors);
+        std::vector<float> vector(dimension_);
 
         // Read each vector and its graph structure
         for (size_t i = 0; i < num_vectors; ++i) {
@@ -1034,11 +1494,17 @@ ErrorCode HNSWIndex::deserialize(std::istream& in) {
             uint64_t id;
             in.read(reinterpret_cast<char*>(&id), sizeof(id));
 
-            // Read vector data directly into contiguous storage
-            size_t current_size = vector_data_.size();
-            vector_data_.resize(current_size + dimension_);
-            in.read(reinterpret_cast<char*>(vector_data_.data() + current_size),
-                   dimension_ * sizeof(float));
+            // Read vector data, or skip it when the mapped row is used
+            if (mapped != nullptr) {
+                if (mapped->ids[i] != id) {
+                    in.setstate(std::ios::failbit);
+                    break;
+                }
+                in.seekg(static_cast<std::streamoff>(dimension_ * sizeof(float)), std::ios::cur);
+            } else {
+                in.read(reinterpret_cast<char*>(vector.data()), dimension_ * sizeof(float));
+                vectors_.append(vector);
+            }
 
             // Update mappings
             id_to_index_[id] = i;
@@ -1068,10 +1534,7 @@ ErrorCode HNSWIndex::deserialize(std::istream& in) {
 
         if (!in.good()) {
             // Restore to empty state on error
-            vector_data_.clear();
-            id_to_index_.clear();
-            index_to_id_.clear();
-            graph_.clear();
+            clear_storage();
             entry_point_ = kInvalidId;
             entry_point_layer_ = 0;
             return ErrorCode::IOError;
@@ -1081,14 +1544,182 @@ ErrorCode HNSWIndex::deserialize(std::istream& in) {
 
     } catch (const std::exception&) {
         // Restore to empty state on exception
-        vector_data_.clear();
-        id_to_index_.clear();
-        index_to_id_.clear();
-        graph_.clear();
+        clear_storage();
         entry_point_ = kInvalidId;
         entry_point_layer_ = 0;
         return ErrorCode::IOError;
     }
 }
 
+ErrorCode HNSWIndex::deserialize_csr(std::istream& in, const FileHeader& header,
+                                     const MappedVectors* mapped) {
+    ErrorCode result = apply_header(header);
+    if (result != ErrorCode::Ok) {
+        return result;
+    }
+    if (mapped != nullptr && mapped->ids.size() != header.num_vectors) {
+        return ErrorCode::IOError;
+    }
+
+    clear_storage();
+
+    // One read per section, skipping the padding in front of it
+    std::size_t position = sizeof(FileHeader);
+    auto read_section = [&](std::uint64_t offset, void* data, std::size_t bytes) {
+        in.ignore(static_cast<std::streamsize>(offset - position));
+        in.read(static_cast<char*>(data), static_cast<std::streamsize>(bytes));
+        position = offset + bytes;
+    };
+
+    const std::size_t num_vectors = header.num_vectors;
+    index_to_id_.resize(num_vectors);
+    read_section(header.ids_offset, index_to_id_.data(), num_vectors * sizeof(std::uint64_t));
+
+    // Vectors: one bulk read, or skipped when the mapped rows are used
+    const std::size_t vector_bytes = num_vectors * dimension_ * sizeof(float);
+    if (mapped != nullptr) {
+        if (!std::equal(index_to_id_.begin(), index_to_id_.end(), mapped->ids.begin())) {
+            in.setstate(std::ios::failbit);
+        }
+        vectors_.attach(*mapped);
+        read_section(header.vectors_offset + vector_bytes, nullptr, 0);
+    } else {
+        read_section(header.vectors_offset, vectors_.append_rows(num_vectors).data(), vector_bytes);
+    }
+
+    // Adjacency arrays, used as loaded
+    csr_.owned_offsets.resize(num_vectors + 1 + header.num_slots + 1);
+    csr_.owned_links.resize(header.num_links);
+    std::uint64_t* offsets = csr_.owned_offsets.data();
+    read_section(header.level_start_offset, offsets,
+                 (num_vectors + 1) * sizeof(std::uint64_t));
+    read_section(header.link_start_offset, offsets + num_vectors + 1,
+                 (header.num_slots + 1) * sizeof(std::uint64_t));
+    read_section(header.links_offset, csr_.owned_links.data(),
+                 header.num_links * sizeof(std::uint32_t));
+    csr_.level_start = {offsets, num_vectors + 1};
+    csr_.link_start = {offsets + num_vectors + 1, header.num_slots + 1};
+    csr_.links = csr_.owned_links;
+
+    result = in.good() ? finish_csr_load() : ErrorCode::IOError;
+    if (result != ErrorCode::Ok) {
+        clear_storage();
+        entry_point_ = kInvalidId;
+        entry_point_layer_ = 0;
+    }
+    return result;
+}
+
+ErrorCode HNSWIndex::apply_header(const FileHeader& header) {
+    if (header.dimension != dimension_) {
+        return ErrorCode::DimensionMismatch;
+    }
+
+    // Sections must sit where serialize() puts them
+    FileHeader expected = header;
+    layout_sections(expected);
+    if (header.num_vectors > std::numeric_limits<std::uint32_t>::max() ||
+        header.ids_offset != expected.ids_offset ||
+        header.vectors_offset != expected.vectors_offset ||
+        header.level_start_offset != expected.level_start_offset ||
+        header.link_start_offset != expected.link_start_offset ||
+        header.links_offset != expected.links_offset ||
+        header.end_offset != expected.end_offset) {
+        return ErrorCode::IOError;
+    }
+
+    metric_ = static_cast<DistanceMetric>(header.metric);
+    params_.m = header.m;
+    params_.ef_construction = header.ef_construction;
+    params_.ef_search = header.ef_search;
+    params_.max_elements = header.max_elements;
+    ml_ = 1.0 / std::log(params_.m);
+    entry_point_ = header.entry_point;
+    entry_point_layer_ = header.entry_point_layer;
+    return ErrorCode::Ok;
+}
+
+ErrorCode HNSWIndex::finish_csr_load() {
+    const std::size_t num_vectors = index_to_id_.size();
+    if (csr_.level_start.front() != 0 ||
+        csr_.level_start.back() != csr_.link_start.size() - 1 ||
+        csr_.link_start.back() != csr_.links.size()) {
+        return ErrorCode::IOError;
+    }
+
+    id_to_index_.reserve(num_vectors);
+    for (std::size_t idx = 0; idx < num_vectors; ++idx) {
+        if (!id_to_index_.emplace(index_to_id_[idx], idx).second) {
+            return ErrorCode::IOError;  // Duplicate ID
+        }
+    }
+
+    if (entry_point_ == kInvalidId) {
+        return num_vectors == 0 ? ErrorCode::Ok : ErrorCode::IOError;
+    }
+    const std::size_t entry = get_index_for_id(entry_point_);
+    if (entry == std::numeric_limits<std::size_t>::max() ||
+        csr_.max_layer(entry) != entry_point_layer_) {
+        return ErrorCode::IOError;
+    }
+    return ErrorCode::Ok;
+}
+
+void HNSWIndex::clear_storage() {
+    if (!captures_.empty()) {
+        for (std::uint64_t id : index_to_id_) {
+            keep_links(id);
+            keep_row(id);
+        }
+    }
+    release_csr();
+    vectors_.clear();
+    id_to_index_.clear();
+    index_to_id_.clear();
+    graph_.clear();
+}
+
+void HNSWIndex::keep_links(std::uint64_t id) {
+    for_each_capture(captures_, [this, id](Capture& captured) {
+        // A graph captured in CSR form is kept whole by release_csr()
+        if (captured.from_csr || captured.rows.added.contains(id) || captured.links.contains(id)) {
+            return;
+        }
+        const auto it = graph_.find(id);
+        if (it == graph_.end()) {
+            return;
+        }
+        auto& layers = captured.links[id];
+        layers.reserve(it->second.layers.size());
+        for (const auto& neighbors : it->second.layers) {
+            layers.emplace_back(neighbors.begin(), neighbors.end());
+        }
+    });
+}
+
+void HNSWIndex::keep_row(std::uint64_t id) {
+    const std::size_t idx = get_index_for_id(id);
+    if (idx == std::numeric_limits<std::size_t>::max()) {
+        return;
+    }
+    for_each_capture(captures_, [this, id, idx](Capture& captured) {
+        captured.rows.keep(id, get_vector_by_index(idx));
+    });
+}
+
+void HNSWIndex::release_csr() {
+    // Captures taken from the loaded graph keep reading its arrays (moving
+    // the owned buffers does not move their contents)
+    std::shared_ptr<const CsrGraph> released;
+    for_each_capture(captures_, [this, &released](Capture& captured) {
+        if (captured.from_csr && !captured.csr) {
+            if (!released) {
+                released = std::make_shared<const CsrGraph>(std::move(csr_));
+            }
+            captured.csr = released;
+        }
+    });
+    csr_ = CsrGraph{};
+}
+
 } // namespace lynx
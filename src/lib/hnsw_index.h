@@ -14,6 +14,9 @@
 
 #include "../include/lynx/lynx.h"
 #include "lynx_intern.h"
+#include "vector_block.h"
+#include <functional>
+#include <memory>
 #include <random>
 #include <unordered_map>
 #include <unordered_set>
@@ -116,6 +119,7 @@ public:
     ErrorCode add(std::uint64_t id, std::span<const float> vector) override;
     ErrorCode remove(std::uint64_t id) override;
     [[nodiscard]] bool contains(std::uint64_t id) const override;
+    [[nodiscard]] bool get_vector(std::uint64_t id, std::span<float> out) const override;
 
     [[nodiscard]] std::vector<SearchResultItem> search(
         std::span<const float> query,
@@ -123,10 +127,27 @@ public:
         const SearchParams& params) const override;
 
     ErrorCode build(std::span<const VectorRecord> vectors) override;
+    ErrorCode build(std::span<const std::uint64_t> ids, MatrixView vectors) override;
 
     ErrorCode serialize(std::ostream& out) const override;
     ErrorCode deserialize(std::istream& in) override;
 
+    /**
+     * @brief Pin the current graph for writing out later.
+     *
+     * Copies the node order and header; links and vectors changed
+     * afterwards are kept until the capture is released, the others are
+     * read from the index while it is written. A graph still in its loaded
+     * CSR form is handed to the capture whole when it is first modified.
+     *
+     * @return The captured view, or nullopt if the index is too large to save
+     */
+    [[nodiscard]] std::optional<IndexCapture> capture() const override;
+
+    [[nodiscard]] std::vector<std::uint64_t> storage_order() const override;
+    ErrorCode deserialize_mapped(std::istream& in, const MappedVectors& vectors) override;
+    ErrorCode open_mapped(std::shared_ptr<MappedFile> file) override;
+
     // -------------------------------------------------------------------------
     // Statistics and Metadata
     // -------------------------------------------------------------------------
@@ -202,6 +223,89 @@ private:
             : id(id), layers(max_layer + 1), max_layer(max_layer) {}
     };
 
+    /**
+     * @brief Read-only CSR adjacency of a loaded version 3 file.
+     *
+     * Node i (internal index) owns the slots [level_start[i], level_start[i+1]),
+     * one per layer it is in; slot s lists its neighbors as internal indices
+     * links[link_start[s] .. link_start[s+1]). The arrays point into the
+     * mapped file (open_mapped) or into the owned buffers (deserialize).
+     * Lookups are bounds-checked so a corrupt file cannot read out of range.
+     */
+    struct CsrGraph {
+        std::span<const std::uint64_t> level_start;  ///< Node -> first slot (N + 1)
+        std::span<const std::uint64_t> link_start;   ///< Slot -> first link (slots + 1)
+        std::span<const std::uint32_t> links;        ///< Neighbor indices
+        std::vector<std::uint64_t> owned_offsets;    ///< level_start then link_start
+        std::vector<std::uint32_t> owned_links;      ///< Backing for links
+        std::shared_ptr<MappedFile> file;            ///< Keeps mapped arrays alive
+
+        [[nodiscard]] bool empty() const { return level_start.empty(); }
+
+        [[nodiscard]] std::size_t max_layer(std::size_t node) const {
+            const std::uint64_t slots = level_start[node + 1] - level_start[node];
+            return slots > 0 && slots <= level_start.back() ? slots - 1 : 0;
+        }
+
+        [[nodiscard]] std::span<const std::uint32_t> neighbors(
+            std::size_t node, std::size_t layer) const {
+            const std::uint64_t slot = level_start[node] + layer;
+            if (slot >= level_start[node + 1] || slot + 1 >= link_start.size()) {
+                return {};
+            }
+            const std::uint64_t begin = link_start[slot];
+            const std::uint64_t end = link_start[slot + 1];
+            if (begin > end || end > links.size()) {
+                return {};
+            }
+            return links.subspan(begin, end - begin);
+        }
+    };
+
+    /**
+     * @brief Fixed header of a version 3 file.
+     *
+     * Sections follow in this order at the recorded offsets (relative to the
+     * start of the serialized index): IDs (u64 per node), vectors (dimension
+     * floats per node, page aligned), level_start, link_start, links (see
+     * CsrGraph). Every section is at least 64-byte aligned, so a mapped file
+     * can be used in place.
+     */
+    struct FileHeader {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint64_t dimension;
+        std::uint64_t metric;
+        std::uint64_t m;
+        std::uint64_t ef_construction;
+        std::uint64_t ef_search;
+        std::uint64_t max_elements;
+        std::uint64_t entry_point;
+        std::uint64_t entry_point_layer;
+        std::uint64_t num_vectors;
+        std::uint64_t num_slots;
+        std::uint64_t num_links;
+        std::uint64_t ids_offset;
+        std::uint64_t vectors_offset;
+        std::uint64_t level_start_offset;
+        std::uint64_t link_start_offset;
+        std::uint64_t links_offset;
+        std::uint64_t end_offset;
+    };
+
+    /**
+     * @brief State of an open capture (guarded by mutex_).
+     */
+    struct Capture {
+        FileHeader header{};                    ///< Configuration and entry point at the capture
+        std::vector<std::uint64_t> ids;         ///< Node order (index_to_id_) at the capture
+        bool from_csr = false;                  ///< The graph was in csr_ at the capture
+        std::shared_ptr<const CsrGraph> csr;    ///< That graph, once csr_ was released
+        CapturedRows rows;                      ///< Captured vectors removed since
+        /// Captured neighbor IDs per layer of the nodes changed since
+        std::unordered_map<std::uint64_t, std::vector<std::vector<std::uint64_t>>> links;
+    };
+
     /**
      * @brief Priority queue element for search operations.
      */
@@ -317,6 +421,121 @@ private:
      */
     [[nodiscard]] float calculate_distance(std::uint64_t id1, std::uint64_t id2) const;
 
+    /**
+     * @brief Shared body of deserialize() and deserialize_mapped().
+     *
+     * @param in Input stream
+     * @param mapped Mapped vector rows to serve instead of the stream's copy
+     *               (nullptr = read vectors from the stream)
+     */
+    ErrorCode deserialize_impl(std::istream& in, const MappedVectors* mapped);
+
+    /**
+     * @brief Read the sections of a version 3 stream into csr_ and vectors_.
+     *
+     * @param in Input stream positioned after the header
+     * @param header Header already read from the stream
+     * @param mapped Mapped vector rows to serve instead of the stream's copy
+     */
+    ErrorCode deserialize_csr(std::istream& in, const FileHeader& header,
+                              const MappedVectors* mapped);
+
+    /**
+     * @brief Check a version 3 header and adopt its configuration.
+     *
+     * @return ErrorCode::Ok, DimensionMismatch, or IOError if the section
+     *         layout is not the one serialize() writes
+     */
+    ErrorCode apply_header(const FileHeader& header);
+
+    /**
+     * @brief Rebuild id_to_index_ from index_to_id_ and check the entry point
+     *        of a freshly loaded CSR graph.
+     */
+    ErrorCode finish_csr_load();
+
+    /**
+     * @brief Drop all vectors, ID mappings and graph data, keeping them for
+     *        open captures.
+     */
+    void clear_storage();
+
+    /**
+     * @brief Fill in the section offsets of a header from its counts.
+     */
+    static void layout_sections(FileHeader& header);
+
+    /**
+     * @brief Header for the current configuration and entry point.
+     *
+     * Counts other than num_vectors and the offsets are left zero.
+     */
+    [[nodiscard]] FileHeader current_header() const;
+
+    /**
+     * @brief Write a version 3 file.
+     *
+     * @param out Output stream
+     * @param header Header with its counts set; the offsets are filled in here
+     * @param ids Node order
+     * @param write_vectors Writes the vector rows, in node order
+     * @param level_start CSR node -> first slot
+     * @param link_start CSR slot -> first link
+     * @param links CSR neighbor indices
+     * @return ErrorCode::Ok on success, error code otherwise
+     */
+    static ErrorCode write_file(std::ostream& out, FileHeader header,
+                                std::span<const std::uint64_t> ids,
+                                const std::function<ErrorCode(std::ostream&)>& write_vectors,
+                                std::span<const std::uint64_t> level_start,
+                                std::span<const std::uint64_t> link_start,
+                                std::span<const std::uint32_t> links);
+
+    /**
+     * @brief Write a capture as a version 3 file, reading the links and
+     *        vectors still current under short shared locks.
+     *
+     * @param out Output stream
+     * @param captured The capture
+     * @return ErrorCode::Ok on success, error code otherwise
+     */
+    ErrorCode write_capture(std::ostream& out, const Capture& captured) const;
+
+    /**
+     * @brief Keep a node's links for open captures before they change.
+     * @param id Node ID
+     */
+    void keep_links(std::uint64_t id);
+
+    /**
+     * @brief Keep a node's vector for open captures before it goes away.
+     * @param id Node ID
+     */
+    void keep_row(std::uint64_t id);
+
+    /**
+     * @brief Clear csr_, handing it to the captures taken from it.
+     */
+    void release_csr();
+
+    /**
+     * @brief Convert csr_ into graph_ so the graph can be modified.
+     *
+     * Called by every mutating operation; O(nodes + links) once after a
+     * load, a no-op afterwards.
+     */
+    void thaw();
+
+    /**
+     * @brief search_layer() over csr_; IDs in entry points and results are
+     *        internal indices.
+     */
+    [[nodiscard]] std::vector<Candidate> search_layer_csr(
+        std::span<const float> query,
+        const std::vector<std::uint64_t>& entry_points,
+        std::size_t ef,
+        std::size_t layer) const;
+
     /**
      * @brief Get a span to the vector data for a given index.
      *
@@ -324,7 +543,7 @@ private:
      * @return Span to the vector data
      */
     [[nodiscard]] std::span<const float> get_vector_by_index(std::size_t index) const {
-        return std::span<const float>(vector_data_.data() + index * dimension_, dimension_);
+        return vectors_.row(index);
     }
 
     /**
@@ -389,13 +608,17 @@ private:
     DistanceMetric metric_;                                     ///< Distance metric
     HNSWParams params_;                                         ///< HNSW configuration
 
-    // Graph structure
+    // Graph structure: after loading a version 3 file the graph lives in
+    // csr_ (searched in place) until the first write moves it into graph_
     std::unordered_map<std::uint64_t, Node> graph_;            ///< Graph nodes (id -> Node)
+    CsrGraph csr_;                                              ///< Loaded graph, empty once thawed
+    mutable std::vector<std::weak_ptr<Capture>> captures_;      ///< Open captures
 
     // Contiguous vector storage for cache-efficient distance calculations
     // Instead of std::unordered_map<id, vector<float>>, we store all vectors
-    // contiguously and use an ID-to-index mapping for lookups.
-    std::vector<float> vector_data_;                           ///< Contiguous vector data
+    // contiguously and use an ID-to-index mapping for lookups. After
+    // deserialize_mapped() the rows are served from the saved vector file.
+    VectorBlock vectors_;                                      ///< Contiguous vector data
     std::unordered_map<std::uint64_t, std::size_t> id_to_index_; ///< ID to vector index mapping
     std::vector<std::uint64_t> index_to_id_;                   ///< Index to ID mapping (for VisitedTable)
 
@@ -411,9 +634,6 @@ private:
     // Thread safety
     mutable std::shared_mutex mutex_;                           ///< Reader-writer lock
 
-    // Reusable visited table for search operations (mutable for const methods)
-    mutable VisitedTable visited_table_;                        ///< Visited tracking for searches
-
     // Constants
     static constexpr std::uint64_t kInvalidId = std::numeric_limits<std::uint64_t>::max();
     static constexpr std::size_t kDefaultEfConstruction = 200;
@@ -14,6 +14,7 @@
 #include <istream>
 #include <ostream>
 #include <string>
+#include <cmath>
 
 namespace lynx {
 
@@ -27,7 +28,8 @@ IVFIndex::IVFIndex(std::size_t dimension, DistanceMetric metric, const IVFParams
     , params_(params)
     , centroids_()
     , inverted_lists_()
-    , id_to_cluster_()
+    , id_to_location_()
+    , target_clusters_(params.n_clusters)
 {
     if (dimension_ == 0) {
         throw std::invalid_argument("IVFIndex: dimension must be > 0");
@@ -36,6 +38,30 @@ IVFIndex::IVFIndex(std::size_t dimension, DistanceMetric metric, const IVFParams
     if (params_.n_clusters == 0) {
         throw std::invalid_argument("IVFIndex: n_clusters must be > 0");
     }
+
+    // Split halves must not immediately qualify for merging again
+    if (params_.merge_factor < 0.0f || params_.split_factor <= 2.0f * params_.merge_factor) {
+        throw std::invalid_argument("IVFIndex: split_factor must be > 2 * merge_factor");
+    }
+
+    if (params_.balance_factor != 0.0f && !(params_.balance_factor >= 1.0f)) {
+        throw std::invalid_argument("IVFIndex: balance_factor must be 0 or >= 1");
+    }
+
+    if (params_.auto_rebalance) {
+        rebalance_thread_ = std::thread(&IVFIndex::rebalance_worker, this);
+    }
+}
+
+IVFIndex::~IVFIndex() {
+    if (rebalance_thread_.joinable()) {
+        {
+            std::lock_guard guard(rebalance_mutex_);
+            stop_rebalance_ = true;
+        }
+        rebalance_cv_.notify_one();
+        rebalance_thread_.join();
+    }
 }
 
 // ============================================================================
@@ -57,23 +83,23 @@ ErrorCode IVFIndex::add(std::uint64_t id, std::span<const float> vector) {
         centroids_.resize(1);
         centroids_[0] = std::vector<float>(vector.begin(), vector.end());
         inverted_lists_.resize(1);
+        rebuild_quantizer();
     }
 
     // Check if ID already exists
-    if (id_to_cluster_.contains(id)) {
+    if (id_to_location_.contains(id)) {
         return ErrorCode::InvalidState;
     }
 
-    // Find nearest centroid
-    std::size_t cluster_id = find_nearest_centroid(vector);
+    for_each_capture(captures_, [id](Capture& captured) { captured.rows.added.insert(id); });
 
-    // Add to inverted list
-    inverted_lists_[cluster_id].ids.push_back(id);
-    inverted_lists_[cluster_id].vectors.push_back(
-        std::vector<float>(vector.begin(), vector.end()));
+    // Find nearest centroid and append to its inverted list
+    std::size_t cluster_id = find_nearest_centroid(vector);
+    append_to_list(cluster_id, id, vector);
 
-    // Update ID-to-cluster mapping
-    id_to_cluster_[id] = cluster_id;
+    if (params_.auto_rebalance && needs_split(inverted_lists_[cluster_id].size())) {
+        request_rebalance();
+    }
 
     return ErrorCode::Ok;
 }
@@ -81,40 +107,63 @@ ErrorCode IVFIndex::add(std::uint64_t id, std::span<const float> vector) {
 ErrorCode IVFIndex::remove(std::uint64_t id) {
     std::unique_lock lock(mutex_);
 
-    // Find which cluster contains this ID
-    auto it = id_to_cluster_.find(id);
-    if (it == id_to_cluster_.end()) {
+    // Look up the exact location of this ID
+    auto it = id_to_location_.find(id);
+    if (it == id_to_location_.end()) {
         return ErrorCode::VectorNotFound;
     }
 
-    std::size_t cluster_id = it->second;
-    auto& inv_list = inverted_lists_[cluster_id];
+    const std::size_t cluster_id = it->second.cluster;
+    remove_at(it->second);
+    id_to_location_.erase(it);
 
-    // Find position in inverted list
-    auto id_it = std::find(inv_list.ids.begin(), inv_list.ids.end(), id);
-    if (id_it == inv_list.ids.end()) {
-        return ErrorCode::InvalidState;  // Inconsistent state
+    if (params_.auto_rebalance && needs_merge(inverted_lists_[cluster_id].size())) {
+        request_rebalance();
     }
 
-    std::size_t pos = std::distance(inv_list.ids.begin(), id_it);
+    return ErrorCode::Ok;
+}
+
+ErrorCode IVFIndex::remove_batch(std::span<const std::uint64_t> ids) {
+    std::unique_lock lock(mutex_);
 
-    // Remove from inverted list (swap with last for O(1) removal)
-    if (pos != inv_list.ids.size() - 1) {
-        std::swap(inv_list.ids[pos], inv_list.ids.back());
-        std::swap(inv_list.vectors[pos], inv_list.vectors.back());
+    // Validate all IDs first so the batch is all-or-nothing
+    for (std::uint64_t id : ids) {
+        if (!id_to_location_.contains(id)) {
+            return ErrorCode::VectorNotFound;
+        }
     }
-    inv_list.ids.pop_back();
-    inv_list.vectors.pop_back();
 
-    // Remove from mapping
-    id_to_cluster_.erase(it);
+    for (std::uint64_t id : ids) {
+        auto it = id_to_location_.find(id);
+        if (it == id_to_location_.end()) {
+            continue;  // Duplicate ID within the batch
+        }
+        remove_at(it->second);
+        id_to_location_.erase(it);
+    }
+
+    if (params_.auto_rebalance) {
+        request_rebalance();
+    }
 
     return ErrorCode::Ok;
 }
 
 bool IVFIndex::contains(std::uint64_t id) const {
     std::shared_lock lock(mutex_);
-    return id_to_cluster_.contains(id);
+    return id_to_location_.contains(id);
+}
+
+bool IVFIndex::get_vector(std::uint64_t id, std::span<float> out) const {
+    std::shared_lock lock(mutex_);
+    auto it = id_to_location_.find(id);
+    if (it == id_to_location_.end() || out.size() != dimension_) {
+        return false;
+    }
+    const auto& vec = inverted_lists_[it->second.cluster].vectors[it->second.offset];
+    std::copy(vec.begin(), vec.end(), out.begin());
+    return true;
 }
 
 // ============================================================================
@@ -125,6 +174,17 @@ std::vector<SearchResultItem> IVFIndex::search(
     std::span<const float> query,
     std::size_t k,
     const SearchParams& params) const {
+    IndexSearchStats stats;
+    return search_with_stats(query, k, params, stats);
+}
+
+std::vector<SearchResultItem> IVFIndex::search_with_stats(
+    std::span<const float> query,
+    std::size_t k,
+    const SearchParams& params,
+    IndexSearchStats& stats) const {
+
+    stats.clusters_probed = 0;
 
     // Validate dimension
     if (query.size() != dimension_) {
@@ -139,57 +199,86 @@ std::vector<SearchResultItem> IVFIndex::search(
     }
 
     // If index is empty, return empty results
-    if (id_to_cluster_.empty()) {
+    if (id_to_location_.empty()) {
         return {};
     }
 
-    // Get n_probe from params, default to IVFParams.n_probe
-    std::size_t n_probe = params.n_probe;
+    // Get n_probe from params (upper bound in adaptive mode)
+    std::size_t n_probe = params.adaptive_n_probe ? params.max_n_probe : params.n_probe;
 
     // Clamp n_probe to valid range [1, num_clusters]
     n_probe = std::max(std::size_t{1}, std::min(n_probe, centroids_.size()));
 
-    // Step 1: Find n_probe nearest centroids
-    std::vector<std::size_t> probe_clusters = find_nearest_centroids(query, n_probe);
+    // Clusters that are always probed
+    const std::size_t min_probe = params.adaptive_n_probe
+        ? std::max(std::size_t{1}, std::min(params.min_n_probe, n_probe))
+        : n_probe;
 
-    // Step 2: Search within selected clusters and collect candidates
-    std::vector<SearchResultItem> candidates;
+    if (k == 0) {
+        return {};
+    }
 
-    for (std::size_t cluster_id : probe_clusters) {
-        const auto& inv_list = inverted_lists_[cluster_id];
+    // Step 1: Find n_probe nearest centroids (nearest first)
+    std::vector<ProbeCandidate> probe_clusters = find_nearest_centroids(query, n_probe);
 
-        // Skip empty clusters
-        if (inv_list.empty()) {
-            continue;
+    // Step 2: Scan the selected clusters, keeping the k best in a max-heap
+    // (worst candidate on top)
+    auto farther = [](const SearchResultItem& a, const SearchResultItem& b) {
+        return a.distance < b.distance;
+    };
+    std::vector<SearchResultItem> heap;
+    heap.reserve(k + 1);
+
+    // Triangle-inequality pruning needs a true metric
+    const bool prune = (metric_ == DistanceMetric::L2);
+
+    // Adaptive cut-off: stop at centroids farther than ratio * nearest. The gap
+    // form also works for DotProduct, whose distances can be negative.
+    const float nearest_distance = probe_clusters.empty() ? 0.0f : probe_clusters.front().distance;
+    const float max_gap = (params.probe_distance_ratio - 1.0f) * std::abs(nearest_distance);
+    bool improved = true;
+
+    for (std::size_t p = 0; p < probe_clusters.size(); ++p) {
+        const auto& probe = probe_clusters[p];
+
+        if (p >= min_probe && heap.size() == k) {
+            if (probe.distance - nearest_distance > max_gap) {
+                break;  // Remaining clusters are too far away
+            }
+            if (!improved) {
+                break;  // Last probe did not change the top-k
+            }
         }
 
-        // Calculate distance to each vector in this cluster
+        const auto& inv_list = inverted_lists_[probe.cluster];
+        improved = false;
+        ++stats.clusters_probed;
+
         for (std::size_t i = 0; i < inv_list.ids.size(); ++i) {
+            // Skip entries that provably cannot beat the current k-th best
+            if (prune && heap.size() == k &&
+                std::abs(probe.distance - inv_list.centroid_distances[i]) > heap.front().distance) {
+                continue;
+            }
+
             float dist = calculate_distance(query, inv_list.vectors[i]);
-            candidates.push_back({inv_list.ids[i], dist});
+            if (heap.size() < k) {
+                heap.push_back({inv_list.ids[i], dist});
+                std::push_heap(heap.begin(), heap.end(), farther);
+                improved = true;
+            } else if (dist < heap.front().distance) {
+                std::pop_heap(heap.begin(), heap.end(), farther);
+                heap.back() = {inv_list.ids[i], dist};
+                std::push_heap(heap.begin(), heap.end(), farther);
+                improved = true;
+            }
         }
     }
 
-    // Step 3: Select top-k results
-    // Use partial_sort for efficiency (only sort what we need)
-    std::size_t result_size = std::min(k, candidates.size());
-
-    if (result_size == 0) {
-        return {};
-    }
-
-    std::partial_sort(
-        candidates.begin(),
-        candidates.begin() + result_size,
-        candidates.end(),
-        [](const SearchResultItem& a, const SearchResultItem& b) {
-            return a.distance < b.distance;
-        });
-
-    // Resize to k (or less if we don't have enough candidates)
-    candidates.resize(result_size);
+    // Step 3: Sort the survivors nearest first
+    std::sort_heap(heap.begin(), heap.end(), farther);
 
-    return candidates;
+    return heap;
 }
 
 // ============================================================================
@@ -197,51 +286,86 @@ std::vector<SearchResultItem> IVFIndex::search(
 // ============================================================================
 
 ErrorCode IVFIndex::build(std::span<const VectorRecord> vectors) {
+    // Validate all vectors have correct dimension
+    for (const auto& rec : vectors) {
+        if (rec.vector.size() != dimension_) {
+            return ErrorCode::DimensionMismatch;
+        }
+    }
+
+    // Reference the record vectors in place for clustering
+    std::vector<std::uint64_t> ids;
+    ids.reserve(vectors.size());
+    for (const auto& rec : vectors) {
+        ids.push_back(rec.id);
+    }
+    auto rows = collect_row_pointers(vectors, [](const VectorRecord& rec) -> const auto& { return rec.vector; });
+    return build(ids, MatrixView(rows, dimension_));
+}
+
+ErrorCode IVFIndex::build(std::span<const std::uint64_t> ids, MatrixView vectors) {
+    if (ids.size() != vectors.rows()) {
+        return ErrorCode::InvalidParameter;
+    }
     if (vectors.empty()) {
         // Empty build is valid - just clear existing data
         std::unique_lock lock(mutex_);
+        keep_lists_for_captures();
         inverted_lists_.clear();
         centroids_.clear();
-        id_to_cluster_.clear();
+        id_to_location_.clear();
+        quantizer_.reset();
         return ErrorCode::Ok;
     }
+    if (vectors.dim() != dimension_) {
+        return ErrorCode::DimensionMismatch;
+    }
 
-    // Validate all vectors have correct dimension
-    for (const auto& rec : vectors) {
-        if (rec.vector.size() != dimension_) {
-            return ErrorCode::DimensionMismatch;
-        }
+    std::size_t n_clusters = 0;
+    clustering::KMeansParams kmeans_params;
+    {
+        std::shared_lock lock(mutex_);
+        // The configured count, not the one split and merge drifted to
+        n_clusters = target_clusters_;
+        kmeans_params.max_training_samples = n_clusters * params_.training_samples_per_cluster;
+        kmeans_params.init = clustering::InitMethod::Parallel;
+        kmeans_params.balance_factor = params_.balance_factor;
+    }
+
+    // Run k-means clustering without holding the lock; training dominates
+    // build time and only touches local state. Training uses a capped
+    // subsample, while the final assignment below covers every vector.
+    clustering::KMeans kmeans(n_clusters, dimension_, metric_, kmeans_params);
+    kmeans.fit(vectors);
+    // Balanced builds must use the capacity-constrained assignment even
+    // when the centroid graph is enabled
+    const bool balanced = params_.balance_factor != 0.0f;
+    std::vector<std::size_t> assignments;
+    if (balanced) {
+        assignments = kmeans.predict_balanced(vectors);
+    } else if (!params_.use_hnsw_quantizer) {
+        assignments = kmeans.predict(vectors);
     }
 
     std::unique_lock lock(mutex_);
 
-    // Clear existing data
+    // Replace existing data
+    keep_lists_for_captures();
     inverted_lists_.clear();
-    centroids_.clear();
-    id_to_cluster_.clear();
-
-    // Extract vector data for k-means
-    std::vector<std::vector<float>> vec_data;
-    vec_data.reserve(vectors.size());
-    for (const auto& rec : vectors) {
-        vec_data.push_back(rec.vector);
-    }
-
-    // Run k-means clustering
-    clustering::KMeans kmeans(params_.n_clusters, dimension_, metric_, {});
-    kmeans.fit(vec_data);
+    id_to_location_.clear();
     centroids_ = kmeans.centroids();
+    params_.n_clusters = centroids_.size();
+    rebuild_quantizer();
 
     // Initialize inverted lists
     inverted_lists_.resize(centroids_.size());
+    id_to_location_.reserve(ids.size());
 
-    // Assign vectors to clusters
-    auto assignments = kmeans.predict(vec_data);
-    for (std::size_t i = 0; i < vectors.size(); ++i) {
-        std::size_t cluster_id = assignments[i];
-        inverted_lists_[cluster_id].ids.push_back(vectors[i].id);
-        inverted_lists_[cluster_id].vectors.push_back(vectors[i].vector);
-        id_to_cluster_[vectors[i].id] = cluster_id;
+    // Assign vectors to clusters (through the centroid graph if enabled)
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        const std::size_t cluster =
+            (quantizer_ && !balanced) ? find_nearest_centroid(vectors[i]) : assignments[i];
+        append_to_list(cluster, ids[i], vectors[i]);
     }
 
     return ErrorCode::Ok;
@@ -254,9 +378,67 @@ ErrorCode IVFIndex::build(std::span<const VectorRecord> vectors) {
 ErrorCode IVFIndex::serialize(std::ostream& out) const {
     std::shared_lock lock(mutex_);
 
-    // Write header
+    write_header(out, target_clusters_, centroids_);
+
+    // Write inverted lists
+    for (const auto& inv_list : inverted_lists_) {
+        std::uint64_t list_size = inv_list.ids.size();
+        out.write(reinterpret_cast<const char*>(&list_size), sizeof(list_size));
+
+        if (list_size > 0) {
+            out.write(reinterpret_cast<const char*>(inv_list.ids.data()),
+                     list_size * sizeof(std::uint64_t));
+
+            for (const auto& vec : inv_list.vectors) {
+                out.write(reinterpret_cast<const char*>(vec.data()),
+                         dimension_ * sizeof(float));
+            }
+        }
+    }
+
+    // Write ID mapping (offsets are implied by the list order)
+    std::uint64_t map_size = id_to_location_.size();
+    out.write(reinterpret_cast<const char*>(&map_size), sizeof(map_size));
+    for (const auto& [id, pos] : id_to_location_) {
+        out.write(reinterpret_cast<const char*>(&id), sizeof(id));
+        std::uint64_t cluster_u64 = pos.cluster;
+        out.write(reinterpret_cast<const char*>(&cluster_u64), sizeof(cluster_u64));
+    }
+
+    return out.good() ? ErrorCode::Ok : ErrorCode::IOError;
+}
+
+std::optional<IndexCapture> IVFIndex::capture() const {
+    auto captured = std::make_shared<Capture>();
+    {
+        std::unique_lock lock(mutex_);
+        captured->target_clusters = target_clusters_;
+        captured->centroids = centroids_;
+        captured->lists.reserve(inverted_lists_.size());
+        for (const auto& inv_list : inverted_lists_) {
+            captured->lists.push_back(inv_list.ids);
+        }
+        captures_.push_back(captured);
+    }
+
+    IndexCapture result;
+    result.serialize = [this, captured](std::ostream& out) {
+        return write_capture(out, *captured);
+    };
+    result.ids = [captured]() {
+        std::vector<std::uint64_t> ids;
+        for (const auto& list : captured->lists) {
+            ids.insert(ids.end(), list.begin(), list.end());
+        }
+        return ids;
+    };
+    return result;
+}
+
+void IVFIndex::write_header(std::ostream& out, std::uint64_t target_clusters,
+                            const std::vector<std::vector<float>>& centroids) const {
     out.write("IVFX", 4);
-    std::uint32_t version = 1;
+    std::uint32_t version = 2;
     out.write(reinterpret_cast<const char*>(&version), sizeof(version));
 
     std::uint64_t dim = dimension_;
@@ -265,38 +447,69 @@ ErrorCode IVFIndex::serialize(std::ostream& out) const {
     std::uint32_t metric = static_cast<std::uint32_t>(metric_);
     out.write(reinterpret_cast<const char*>(&metric), sizeof(metric));
 
+    // Version 2: the configured cluster count, which rebalancing aims for
+    out.write(reinterpret_cast<const char*>(&target_clusters), sizeof(target_clusters));
+
     // Write centroids
-    std::uint64_t num_clusters = centroids_.size();
+    std::uint64_t num_clusters = centroids.size();
     out.write(reinterpret_cast<const char*>(&num_clusters), sizeof(num_clusters));
 
-    for (const auto& centroid : centroids_) {
+    for (const auto& centroid : centroids) {
         out.write(reinterpret_cast<const char*>(centroid.data()),
                  dimension_ * sizeof(float));
     }
+}
 
-    // Write inverted lists
-    for (const auto& inv_list : inverted_lists_) {
-        std::uint64_t list_size = inv_list.ids.size();
-        out.write(reinterpret_cast<const char*>(&list_size), sizeof(list_size));
-
-        if (list_size > 0) {
-            out.write(reinterpret_cast<const char*>(inv_list.ids.data()),
-                     list_size * sizeof(std::uint64_t));
+ErrorCode IVFIndex::write_capture(std::ostream& out, const Capture& captured) const {
+    write_header(out, captured.target_clusters, captured.centroids);
 
-            for (const auto& vec : inv_list.vectors) {
-                out.write(reinterpret_cast<const char*>(vec.data()),
-                         dimension_ * sizeof(float));
+    // Each list's vectors are copied a chunk at a time under the lock and
+    // written after releasing it, so writers only wait for a copy
+    const std::size_t row_bytes = dimension_ * sizeof(float);
+    const std::size_t chunk = std::max<std::size_t>(kCaptureReadBytes / row_bytes, 1);
+    std::vector<float> buffer;
+    for (const auto& ids : captured.lists) {
+        std::uint64_t list_size = ids.size();
+        out.write(reinterpret_cast<const char*>(&list_size), sizeof(list_size));
+        if (list_size == 0) {
+            continue;
+        }
+        out.write(reinterpret_cast<const char*>(ids.data()), list_size * sizeof(std::uint64_t));
+
+        for (std::size_t begin = 0; begin < ids.size(); begin += chunk) {
+            const std::size_t end = std::min(begin + chunk, ids.size());
+            buffer.resize((end - begin) * dimension_);
+            float* row = buffer.data();
+            {
+                std::shared_lock lock(mutex_);
+                for (std::size_t i = begin; i < end; ++i, row += dimension_) {
+                    const std::vector<float>* vec = captured.rows.find(ids[i]);
+                    if (vec == nullptr) {
+                        auto it = id_to_location_.find(ids[i]);
+                        if (it == id_to_location_.end()) {
+                            return ErrorCode::InvalidState;
+                        }
+                        vec = &inverted_lists_[it->second.cluster].vectors[it->second.offset];
+                    }
+                    std::copy_n(vec->data(), dimension_, row);
+                }
             }
+            out.write(reinterpret_cast<const char*>(buffer.data()),
+                      static_cast<std::streamsize>(buffer.size() * sizeof(float)));
         }
     }
 
     // Write ID mapping
-    std::uint64_t map_size = id_to_cluster_.size();
+    std::uint64_t map_size = 0;
+    for (const auto& ids : captured.lists) {
+        map_size += ids.size();
+    }
     out.write(reinterpret_cast<const char*>(&map_size), sizeof(map_size));
-    for (const auto& [id, cluster] : id_to_cluster_) {
-        out.write(reinterpret_cast<const char*>(&id), sizeof(id));
-        std::uint64_t cluster_u64 = cluster;
-        out.write(reinterpret_cast<const char*>(&cluster_u64), sizeof(cluster_u64));
+    for (std::uint64_t cluster = 0; cluster < captured.lists.size(); ++cluster) {
+        for (std::uint64_t id : captured.lists[cluster]) {
+            out.write(reinterpret_cast<const char*>(&id), sizeof(id));
+            out.write(reinterpret_cast<const char*>(&cluster), sizeof(cluster));
+        }
     }
 
     return out.good() ? ErrorCode::Ok : ErrorCode::IOError;
@@ -314,7 +527,7 @@ ErrorCode IVFIndex::deserialize(std::istream& in) {
 
     std::uint32_t version;
     in.read(reinterpret_cast<char*>(&version), sizeof(version));
-    if (!in.good() || version != 1) {
+    if (!in.good() || (version != 1 && version != 2)) {
         return ErrorCode::IOError;
     }
 
@@ -330,6 +543,15 @@ ErrorCode IVFIndex::deserialize(std::istream& in) {
         return ErrorCode::InvalidParameter;
     }
 
+    // Version 1 files keep the target of this instance's parameters
+    std::uint64_t target_clusters = target_clusters_;
+    if (version >= 2) {
+        in.read(reinterpret_cast<char*>(&target_clusters), sizeof(target_clusters));
+        if (!in.good() || target_clusters == 0) {
+            return ErrorCode::IOError;
+        }
+    }
+
     // Read centroids
     std::uint64_t num_clusters;
     in.read(reinterpret_cast<char*>(&num_clusters), sizeof(num_clusters));
@@ -389,9 +611,35 @@ ErrorCode IVFIndex::deserialize(std::istream& in) {
         return ErrorCode::IOError;
     }
 
-    std::unordered_map<std::uint64_t, std::size_t> new_id_to_cluster;
-    new_id_to_cluster.reserve(map_size);
+    // Validate integrity: check that mapping size matches total vectors
+    std::size_t total_vectors = 0;
+    for (const auto& inv_list : new_inverted_lists) {
+        total_vectors += inv_list.size();
+    }
+
+    // Centroid distances are derived data and not stored on disk
+    for (std::uint64_t c = 0; c < num_clusters; ++c) {
+        auto& inv_list = new_inverted_lists[c];
+        inv_list.centroid_distances.reserve(inv_list.size());
+        for (const auto& vec : inv_list.vectors) {
+            inv_list.centroid_distances.push_back(calculate_distance(vec, new_centroids[c]));
+        }
+    }
+    if (total_vectors != map_size) {
+        return ErrorCode::InvalidState;
+    }
+
+    // Rebuild locations from the list contents
+    std::unordered_map<std::uint64_t, ListPosition> new_id_to_location;
+    new_id_to_location.reserve(map_size);
+    for (std::size_t c = 0; c < new_inverted_lists.size(); ++c) {
+        const auto& ids = new_inverted_lists[c].ids;
+        for (std::size_t j = 0; j < ids.size(); ++j) {
+            new_id_to_location[ids[j]] = ListPosition{c, j};
+        }
+    }
 
+    // The stored mapping must agree with the list contents
     for (std::uint64_t i = 0; i < map_size; ++i) {
         std::uint64_t id;
         std::uint64_t cluster;
@@ -400,23 +648,23 @@ ErrorCode IVFIndex::deserialize(std::istream& in) {
         if (!in.good() || cluster >= num_clusters) {
             return ErrorCode::IOError;
         }
-        new_id_to_cluster[id] = static_cast<std::size_t>(cluster);
-    }
-
-    // Validate integrity: check that mapping size matches total vectors
-    std::size_t total_vectors = 0;
-    for (const auto& inv_list : new_inverted_lists) {
-        total_vectors += inv_list.size();
+        auto it = new_id_to_location.find(id);
+        if (it == new_id_to_location.end() || it->second.cluster != cluster) {
+            return ErrorCode::InvalidState;
+        }
     }
-    if (total_vectors != map_size) {
+    if (new_id_to_location.size() != map_size) {
         return ErrorCode::InvalidState;
     }
 
     // All validation passed, update index state
+    keep_lists_for_captures();
     centroids_ = std::move(new_centroids);
     inverted_lists_ = std::move(new_inverted_lists);
-    id_to_cluster_ = std::move(new_id_to_cluster);
+    id_to_location_ = std::move(new_id_to_location);
     params_.n_clusters = num_clusters;
+    target_clusters_ = target_clusters;
+    rebuild_quantizer();
 
     return ErrorCode::Ok;
 }
@@ -427,7 +675,7 @@ ErrorCode IVFIndex::deserialize(std::istream& in) {
 
 std::size_t IVFIndex::size() const {
     std::shared_lock lock(mutex_);
-    return id_to_cluster_.size();
+    return id_to_location_.size();
 }
 
 std::size_t IVFIndex::dimension() const {
@@ -442,16 +690,23 @@ std::size_t IVFIndex::memory_usage() const {
     // Centroids: k * D * sizeof(float)
     usage += centroids_.size() * dimension_ * sizeof(float);
 
+    // Centroid graph
+    if (quantizer_) {
+        usage += quantizer_->memory_usage();
+    }
+
     // Inverted lists: vectors and IDs
     for (const auto& inv_list : inverted_lists_) {
         // IDs
         usage += inv_list.ids.size() * sizeof(std::uint64_t);
         // Vectors
         usage += inv_list.vectors.size() * dimension_ * sizeof(float);
+        // Centroid distances
+        usage += inv_list.centroid_distances.size() * sizeof(float);
     }
 
-    // ID-to-cluster mapping (approximate)
-    usage += id_to_cluster_.size() * (sizeof(std::uint64_t) + sizeof(std::size_t));
+    // ID-to-location mapping (approximate)
+    usage += id_to_location_.size() * (sizeof(std::uint64_t) + sizeof(ListPosition));
 
     // Add overhead for data structure bookkeeping
     usage += sizeof(IVFIndex);
@@ -463,6 +718,16 @@ std::size_t IVFIndex::memory_usage() const {
 // IVF-Specific Methods
 // ============================================================================
 
+std::size_t IVFIndex::num_clusters() const {
+    std::shared_lock lock(mutex_);
+    return params_.n_clusters;
+}
+
+IVFParams IVFIndex::params() const {
+    std::shared_lock lock(mutex_);
+    return params_;
+}
+
 bool IVFIndex::has_centroids() const {
     std::shared_lock lock(mutex_);
     return !centroids_.empty();
@@ -483,9 +748,10 @@ ErrorCode IVFIndex::set_centroids(const std::vector<std::vector<float>>& centroi
     std::unique_lock lock(mutex_);
 
     // Clear existing data if any
+    keep_lists_for_captures();
     centroids_.clear();
     inverted_lists_.clear();
-    id_to_cluster_.clear();
+    id_to_location_.clear();
 
     // Set new centroids
     centroids_ = centroids;
@@ -495,6 +761,7 @@ ErrorCode IVFIndex::set_centroids(const std::vector<std::vector<float>>& centroi
 
     // Initialize inverted lists (one per cluster)
     inverted_lists_.resize(centroids_.size());
+    rebuild_quantizer();
 
     return ErrorCode::Ok;
 }
@@ -504,10 +771,291 @@ const std::vector<std::vector<float>>& IVFIndex::centroids() const {
     return centroids_;
 }
 
+std::vector<std::size_t> IVFIndex::list_sizes() const {
+    std::shared_lock lock(mutex_);
+
+    std::vector<std::size_t> sizes;
+    sizes.reserve(inverted_lists_.size());
+    for (const auto& inv_list : inverted_lists_) {
+        sizes.push_back(inv_list.size());
+    }
+    return sizes;
+}
+
+std::size_t IVFIndex::nearest_cluster(std::span<const float> vector) const {
+    std::shared_lock lock(mutex_);
+    return find_nearest_centroid(vector);
+}
+
+std::size_t IVFIndex::rebalance(std::size_t max_steps) {
+    std::size_t steps = 0;
+    while (steps < max_steps && rebalance_step()) {
+        ++steps;
+    }
+    return steps;
+}
+
+// ============================================================================
+// Rebalancing
+// ============================================================================
+
+bool IVFIndex::rebalance_step() {
+    std::unique_lock lock(mutex_);
+
+    if (inverted_lists_.empty() || id_to_location_.empty()) {
+        return false;
+    }
+
+    // Locate the largest and smallest lists
+    std::size_t largest = 0;
+    std::size_t smallest = 0;
+    for (std::size_t c = 1; c < inverted_lists_.size(); ++c) {
+        if (inverted_lists_[c].size() > inverted_lists_[largest].size()) {
+            largest = c;
+        }
+        if (inverted_lists_[c].size() < inverted_lists_[smallest].size()) {
+            smallest = c;
+        }
+    }
+
+    // Oversized lists hurt tail latency the most, so split first
+    if (needs_split(inverted_lists_[largest].size())) {
+        split_list(largest);
+        return true;
+    }
+
+    if (inverted_lists_.size() > 1 && needs_merge(inverted_lists_[smallest].size())) {
+        merge_list(smallest);
+        return true;
+    }
+
+    return false;
+}
+
+void IVFIndex::split_list(std::size_t cluster_id) {
+    // Note: This method is called with unique lock already held
+    const auto& vectors = inverted_lists_[cluster_id].vectors;
+    const std::size_t n = vectors.size();
+
+    // Local 2-means over just this list (deterministic per cluster)
+    clustering::KMeansParams kmeans_params;
+    kmeans_params.max_iterations = kSplitIterations;
+    kmeans_params.random_seed = cluster_id;
+    clustering::KMeans kmeans(2, dimension_, metric_, kmeans_params);
+    kmeans.fit(vectors);
+    std::vector<std::size_t> side = kmeans.predict(vectors);
+
+    // If 2-means peels off a handful of outliers, the small half would be
+    // merged straight back. Split at the median projection onto the axis
+    // between the two centroids instead, which always yields equal halves.
+    const std::size_t count_b = static_cast<std::size_t>(std::count(side.begin(), side.end(), 1));
+    if (needs_merge(count_b) || needs_merge(n - count_b) || count_b == 0 || count_b == n) {
+        const auto& two = kmeans.centroids();
+        std::vector<std::pair<float, std::size_t>> projections;
+        projections.reserve(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            float proj = 0.0f;
+            for (std::size_t d = 0; d < dimension_; ++d) {
+                proj += vectors[i][d] * (two[1][d] - two[0][d]);
+            }
+            projections.push_back({proj, i});
+        }
+        std::nth_element(projections.begin(), projections.begin() + n / 2, projections.end());
+        for (std::size_t i = 0; i < n; ++i) {
+            side[projections[i].second] = (i < n / 2) ? 0 : 1;
+        }
+    }
+
+    // Partition the list and compute the mean of each half (for Cosine the
+    // mean direction, matching spherical k-means)
+    InvertedList halves[2];
+    std::vector<float> means[2] = {std::vector<float>(dimension_, 0.0f),
+                                   std::vector<float>(dimension_, 0.0f)};
+    const bool spherical = metric_ == DistanceMetric::Cosine;
+    InvertedList& source = inverted_lists_[cluster_id];
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::size_t s = side[i];
+        const float scale = spherical ? utils::inverse_norm(source.vectors[i]) : 1.0f;
+        for (std::size_t d = 0; d < dimension_; ++d) {
+            means[s][d] += scale * source.vectors[i][d];
+        }
+        halves[s].ids.push_back(source.ids[i]);
+        halves[s].vectors.push_back(std::move(source.vectors[i]));
+    }
+    for (std::size_t s = 0; s < 2; ++s) {
+        const float count = static_cast<float>(halves[s].size());
+        const float scale = spherical ? utils::inverse_norm(means[s]) : 1.0f / count;
+        for (float& value : means[s]) {
+            value *= scale;
+        }
+    }
+
+    // First half stays in place, second half becomes a new cluster
+    const std::size_t new_cluster = centroids_.size();
+    centroids_[cluster_id] = std::move(means[0]);
+    centroids_.push_back(std::move(means[1]));
+    inverted_lists_[cluster_id] = std::move(halves[0]);
+    inverted_lists_.push_back(std::move(halves[1]));
+    params_.n_clusters = centroids_.size();
+    update_quantizer(cluster_id);
+    update_quantizer(new_cluster);
+
+    for (std::size_t c : {cluster_id, new_cluster}) {
+        refresh_centroid_distances(c);
+        const auto& ids = inverted_lists_[c].ids;
+        for (std::size_t j = 0; j < ids.size(); ++j) {
+            id_to_location_[ids[j]] = ListPosition{c, j};
+        }
+    }
+}
+
+void IVFIndex::merge_list(std::size_t cluster_id) {
+    // Note: This method is called with unique lock already held
+    InvertedList orphans = std::move(inverted_lists_[cluster_id]);
+
+    // Drop the centroid by moving the last cluster into its slot
+    const std::size_t last = centroids_.size() - 1;
+    if (cluster_id != last) {
+        centroids_[cluster_id] = std::move(centroids_[last]);
+        inverted_lists_[cluster_id] = std::move(inverted_lists_[last]);
+        for (std::uint64_t id : inverted_lists_[cluster_id].ids) {
+            id_to_location_[id].cluster = cluster_id;
+        }
+    }
+    centroids_.pop_back();
+    inverted_lists_.pop_back();
+    params_.n_clusters = centroids_.size();
+    update_quantizer(last);
+    update_quantizer(cluster_id);
+
+    // Reassign the orphaned vectors to their nearest remaining centroid
+    for (std::size_t i = 0; i < orphans.size(); ++i) {
+        append_to_list(find_nearest_centroid(orphans.vectors[i]), orphans.ids[i], orphans.vectors[i]);
+    }
+}
+
+double IVFIndex::target_list_size() const {
+    return static_cast<double>(id_to_location_.size()) / static_cast<double>(target_clusters_);
+}
+
+bool IVFIndex::needs_split(std::size_t list_size) const {
+    return list_size >= kMinSplitListSize &&
+           static_cast<double>(list_size) > params_.split_factor * target_list_size();
+}
+
+bool IVFIndex::needs_merge(std::size_t list_size) const {
+    return static_cast<double>(list_size) < params_.merge_factor * target_list_size();
+}
+
+void IVFIndex::request_rebalance() {
+    {
+        std::lock_guard guard(rebalance_mutex_);
+        rebalance_requested_ = true;
+    }
+    rebalance_cv_.notify_one();
+}
+
+void IVFIndex::rebalance_worker() {
+    std::unique_lock guard(rebalance_mutex_);
+    while (true) {
+        rebalance_cv_.wait(guard, [this] { return rebalance_requested_ || stop_rebalance_; });
+        if (stop_rebalance_) {
+            return;
+        }
+        rebalance_requested_ = false;
+
+        // Work one step at a time so readers and writers interleave
+        guard.unlock();
+        while (!stop_rebalance_ && rebalance_step()) {
+        }
+        guard.lock();
+    }
+}
+
 // ============================================================================
 // Helper Methods
 // ============================================================================
 
+void IVFIndex::append_to_list(std::size_t cluster_id, std::uint64_t id,
+                              std::span<const float> vector) {
+    // Note: This method is called with unique lock already held
+    auto& inv_list = inverted_lists_[cluster_id];
+    id_to_location_[id] = ListPosition{cluster_id, inv_list.ids.size()};
+    inv_list.ids.push_back(id);
+    inv_list.vectors.emplace_back(vector.begin(), vector.end());
+    inv_list.centroid_distances.push_back(calculate_distance(vector, centroids_[cluster_id]));
+}
+
+void IVFIndex::remove_at(ListPosition pos) {
+    // Note: This method is called with unique lock already held
+    auto& inv_list = inverted_lists_[pos.cluster];
+    const std::size_t last = inv_list.ids.size() - 1;
+    for_each_capture(captures_, [&](Capture& captured) {
+        captured.rows.keep(inv_list.ids[pos.offset], inv_list.vectors[pos.offset]);
+    });
+
+    // Move the last entry into the hole and update its recorded offset
+    if (pos.offset != last) {
+        inv_list.ids[pos.offset] = inv_list.ids[last];
+        inv_list.vectors[pos.offset] = std::move(inv_list.vectors[last]);
+        inv_list.centroid_distances[pos.offset] = inv_list.centroid_distances[last];
+        id_to_location_[inv_list.ids[pos.offset]].offset = pos.offset;
+    }
+    inv_list.ids.pop_back();
+    inv_list.vectors.pop_back();
+    inv_list.centroid_distances.pop_back();
+}
+
+void IVFIndex::keep_lists_for_captures() {
+    // Note: This method is called with unique lock already held
+    for_each_capture(captures_, [this](Capture& captured) {
+        for (const auto& inv_list : inverted_lists_) {
+            for (std::size_t i = 0; i < inv_list.size(); ++i) {
+                captured.rows.keep(inv_list.ids[i], inv_list.vectors[i]);
+            }
+        }
+    });
+}
+
+void IVFIndex::refresh_centroid_distances(std::size_t cluster_id) {
+    // Note: This method is called with unique lock already held
+    auto& inv_list = inverted_lists_[cluster_id];
+    inv_list.centroid_distances.resize(inv_list.size());
+    for (std::size_t i = 0; i < inv_list.size(); ++i) {
+        inv_list.centroid_distances[i] = calculate_distance(inv_list.vectors[i], centroids_[cluster_id]);
+    }
+}
+
+void IVFIndex::rebuild_quantizer() {
+    // Note: This method is called with unique lock already held
+    quantizer_.reset();
+    if (!params_.use_hnsw_quantizer || centroids_.empty()) {
+        return;
+    }
+
+    HNSWParams hnsw_params;
+    hnsw_params.ef_search = params_.quantizer_ef_search;
+    hnsw_params.max_elements = centroids_.size();
+    hnsw_params.random_seed = kQuantizerSeed;
+    quantizer_ = std::make_unique<HNSWIndex>(dimension_, metric_, hnsw_params);
+
+    for (std::size_t c = 0; c < centroids_.size(); ++c) {
+        quantizer_->add(c, centroids_[c]);
+    }
+}
+
+void IVFIndex::update_quantizer(std::size_t cluster_id) {
+    // Note: This method is called with unique lock already held
+    if (!quantizer_) {
+        return;
+    }
+
+    quantizer_->remove(cluster_id);
+    if (cluster_id < centroids_.size()) {
+        quantizer_->add(cluster_id, centroids_[cluster_id]);
+    }
+}
+
 std::size_t IVFIndex::find_nearest_centroid(std::span<const float> vector) const {
     // Note: This method is called with mutex already held
 
@@ -515,6 +1063,15 @@ std::size_t IVFIndex::find_nearest_centroid(std::span<const float> vector) const
         return 0;
     }
 
+    if (quantizer_) {
+        SearchParams search_params;
+        search_params.ef_search = params_.quantizer_ef_search;
+        auto nearest = quantizer_->search(vector, 1, search_params);
+        if (!nearest.empty()) {
+            return static_cast<std::size_t>(nearest.front().id);
+        }
+    }
+
     std::size_t nearest = 0;
     float min_distance = std::numeric_limits<float>::max();
 
@@ -529,7 +1086,7 @@ std::size_t IVFIndex::find_nearest_centroid(std::span<const float> vector) const
     return nearest;
 }
 
-std::vector<std::size_t> IVFIndex::find_nearest_centroids(
+std::vector<IVFIndex::ProbeCandidate> IVFIndex::find_nearest_centroids(
     std::span<const float> vector,
     std::size_t n_probe) const {
     // Note: This method is called with mutex already held
@@ -538,6 +1095,19 @@ std::vector<std::size_t> IVFIndex::find_nearest_centroids(
         return {};
     }
 
+    // Sub-linear path: walk the centroid graph
+    if (quantizer_) {
+        SearchParams search_params;
+        search_params.ef_search = std::max(params_.quantizer_ef_search, n_probe);
+        auto nearest = quantizer_->search(vector, n_probe, search_params);
+        std::vector<ProbeCandidate> result;
+        result.reserve(nearest.size());
+        for (const auto& item : nearest) {
+            result.push_back({static_cast<std::size_t>(item.id), item.distance});
+        }
+        return result;
+    }
+
     // Calculate distances to all centroids
     std::vector<std::pair<float, std::size_t>> centroid_distances;
     centroid_distances.reserve(centroids_.size());
@@ -559,11 +1129,11 @@ std::vector<std::size_t> IVFIndex::find_nearest_centroids(
             return a.first < b.first;
         });
 
-    // Extract cluster IDs
-    std::vector<std::size_t> result;
+    // Extract cluster IDs with their distances
+    std::vector<ProbeCandidate> result;
     result.reserve(n_probe);
     for (std::size_t i = 0; i < n_probe; ++i) {
-        result.push_back(centroid_distances[i].second);
+        result.push_back({centroid_distances[i].second, centroid_distances[i].first});
     }
 
     return result;
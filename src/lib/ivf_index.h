@@ -15,12 +15,19 @@
 #include "../include/lynx/lynx.h"
 #include "lynx_intern.h"
 #include "kmeans.h"
+#include "hnsw_index.h"
 #include <vector>
+#include <memory>
 #include <unordered_map>
 #include <shared_mutex>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
 #include <limits>
 #include <cstdint>
 #include <cstddef>
+#include <span>
 
 namespace lynx {
 
@@ -38,6 +45,20 @@ namespace lynx {
  *
  * Thread-safety: Concurrent reads are safe. Writes must be externally synchronized
  * or use the provided locking (shared_mutex).
+ *
+ * Rebalancing: With IVFParams::auto_rebalance, a background thread splits
+ * oversized inverted lists (local 2-means) and merges tiny ones into their
+ * neighbors as data drifts, so only the affected vectors move and no full
+ * k-means rebuild is needed. Each split or merge holds the lock on its own.
+ *
+ * Coarse quantizer: With IVFParams::use_hnsw_quantizer, an HNSW graph over the
+ * centroids replaces the linear centroid scan for probing, add() and build()
+ * assignment. This keeps cluster selection sub-linear for very large n_clusters.
+ *
+ * List pruning: Every entry stores its distance to its centroid. For L2, the
+ * triangle inequality gives |d(q,c) - d(x,c)| <= d(q,x), so a scan skips
+ * entries whose lower bound already exceeds the current k-th best distance.
+ * Probing clusters nearest-first tightens that bound early.
  */
 class IVFIndex : public IVectorIndex {
 public:
@@ -53,7 +74,10 @@ public:
      */
     IVFIndex(std::size_t dimension, DistanceMetric metric, const IVFParams& params);
 
-    ~IVFIndex() override = default;
+    /**
+     * @brief Destructor. Stops the background rebalancing thread if running.
+     */
+    ~IVFIndex() override;
 
     // -------------------------------------------------------------------------
     // IVectorIndex Interface Implementation
@@ -74,14 +98,25 @@ public:
     /**
      * @brief Remove a vector from the index.
      *
-     * Locates the vector using the ID-to-cluster mapping, removes it from
-     * the inverted list, and updates the mapping.
+     * Locates the vector using the ID-to-location mapping and swap-removes it
+     * from its inverted list in O(1).
      *
      * @param id Vector identifier to remove
      * @return ErrorCode::Ok on success, ErrorCode::VectorNotFound if ID doesn't exist
      */
     ErrorCode remove(std::uint64_t id) override;
 
+    /**
+     * @brief Remove multiple vectors while holding the lock once.
+     *
+     * All IDs are validated before anything is removed, so either every
+     * vector is removed or none is. Duplicate IDs are ignored.
+     *
+     * @param ids Vector identifiers to remove
+     * @return ErrorCode::Ok on success, ErrorCode::VectorNotFound if any ID doesn't exist
+     */
+    ErrorCode remove_batch(std::span<const std::uint64_t> ids) override;
+
     /**
      * @brief Check if a vector exists in the index.
      * @param id Vector identifier to check
@@ -89,6 +124,14 @@ public:
      */
     [[nodiscard]] bool contains(std::uint64_t id) const override;
 
+    /**
+     * @brief Copy a stored vector out of its inverted list.
+     * @param id Vector identifier
+     * @param out Destination (dimension floats)
+     * @return true if the vector exists, false otherwise
+     */
+    [[nodiscard]] bool get_vector(std::uint64_t id, std::span<float> out) const override;
+
     /**
      * @brief Search for k nearest neighbors.
      *
@@ -105,17 +148,50 @@ public:
         std::size_t k,
         const SearchParams& params) const override;
 
+    /**
+     * @brief Search for k nearest neighbors and report the clusters probed.
+     *
+     * With SearchParams::adaptive_n_probe, the number of probed clusters is
+     * chosen per query between min_n_probe and max_n_probe, based on the
+     * query-to-centroid distance gap and on whether the last probed cluster
+     * improved the top-k. Otherwise exactly n_probe clusters are probed.
+     *
+     * @param query Query vector
+     * @param k Number of neighbors to return
+     * @param params Search parameters
+     * @param stats Receives the number of clusters actually scanned
+     * @return Vector of (id, distance) pairs, sorted by distance
+     */
+    [[nodiscard]] std::vector<SearchResultItem> search_with_stats(
+        std::span<const float> query,
+        std::size_t k,
+        const SearchParams& params,
+        IndexSearchStats& stats) const override;
+
     /**
      * @brief Build index from a batch of vectors.
      *
      * Runs k-means clustering to compute centroids, assigns all vectors to
      * clusters, and builds the inverted lists. Clears any existing data.
+     * Clustering reads the records in place; only the inverted lists hold
+     * copies of the vectors. With IVFParams::balance_factor set, k-means
+     * runs in balanced mode and no list starts larger than
+     * balance_factor * N / n_clusters.
      *
      * @param vectors Vector records to index
      * @return ErrorCode::Ok on success, error code otherwise
      */
     ErrorCode build(std::span<const VectorRecord> vectors) override;
 
+    /**
+     * @brief Build index from IDs and a matrix view, reading vectors in place.
+     *
+     * @param ids One ID per row of vectors
+     * @param vectors Vector data (rows must equal ids.size())
+     * @return ErrorCode::Ok on success, error code otherwise
+     */
+    ErrorCode build(std::span<const std::uint64_t> ids, MatrixView vectors) override;
+
     /**
      * @brief Serialize index to output stream.
      *
@@ -127,6 +203,18 @@ public:
      */
     ErrorCode serialize(std::ostream& out) const override;
 
+    /**
+     * @brief Pin the current clustering for writing out later.
+     *
+     * Copies the centroids and the IDs of each inverted list; vectors
+     * removed afterwards are kept until the capture is released, the
+     * others are read from the lists while it is written. Rebalancing may
+     * move vectors meanwhile; the capture keeps the captured lists.
+     *
+     * @return The captured view
+     */
+    [[nodiscard]] std::optional<IndexCapture> capture() const override;
+
     /**
      * @brief Deserialize index from input stream.
      *
@@ -166,9 +254,12 @@ public:
 
     /**
      * @brief Get the number of clusters (k).
+     *
+     * Rebalancing changes it; the value is read under the shared lock.
+     *
      * @return Number of clusters
      */
-    [[nodiscard]] std::size_t num_clusters() const { return params_.n_clusters; }
+    [[nodiscard]] std::size_t num_clusters() const;
 
     /**
      * @brief Check if centroids have been initialized.
@@ -195,9 +286,40 @@ public:
 
     /**
      * @brief Get the IVF parameters.
-     * @return Reference to IVFParams
+     *
+     * Returned by value: rebalancing updates n_clusters under the lock.
+     *
+     * @return Copy of the current IVFParams
+     */
+    [[nodiscard]] IVFParams params() const;
+
+    /**
+     * @brief Get the current size of every inverted list.
+     * @return List sizes indexed by cluster ID
+     */
+    [[nodiscard]] std::vector<std::size_t> list_sizes() const;
+
+    /**
+     * @brief Cluster a vector is assigned to: its nearest centroid, found
+     *        through the centroid graph if enabled.
+     * @param vector Vector of size dimension()
+     * @return Cluster ID (0 if there are no centroids)
+     */
+    [[nodiscard]] std::size_t nearest_cluster(std::span<const float> vector) const;
+
+    /**
+     * @brief Split oversized and merge undersized inverted lists.
+     *
+     * Performs up to max_steps split or merge operations, each under its own
+     * exclusive lock, and stops early once all lists are within
+     * [merge_factor, split_factor] * (N / n_clusters). This is what the
+     * background thread runs when IVFParams::auto_rebalance is set; it can
+     * also be called directly.
+     *
+     * @param max_steps Maximum number of split/merge operations
+     * @return Number of operations performed
      */
-    [[nodiscard]] const IVFParams& params() const { return params_; }
+    std::size_t rebalance(std::size_t max_steps = std::numeric_limits<std::size_t>::max());
 
 private:
     // -------------------------------------------------------------------------
@@ -207,11 +329,14 @@ private:
     /**
      * @brief Inverted list for a single cluster.
      *
-     * Stores all vectors assigned to a cluster along with their IDs.
+     * Stores all vectors assigned to a cluster along with their IDs and
+     * their distance to the cluster centroid. Entries are kept in insertion
+     * order (not sorted) so that removal stays an O(1) swap-remove.
      */
     struct InvertedList {
         std::vector<std::uint64_t> ids;           ///< Vector IDs in this cluster
         std::vector<std::vector<float>> vectors;  ///< Vector data
+        std::vector<float> centroid_distances;    ///< d(x, centroid) per entry
 
         /**
          * @brief Get the number of vectors in this list.
@@ -224,10 +349,155 @@ private:
         [[nodiscard]] bool empty() const { return ids.empty(); }
     };
 
+    /**
+     * @brief A cluster selected for probing with its distance to the query.
+     */
+    struct ProbeCandidate {
+        std::size_t cluster;  ///< Cluster index
+        float distance;       ///< Distance from the query to the centroid
+    };
+
+    /**
+     * @brief Location of a vector inside the inverted lists.
+     */
+    struct ListPosition {
+        std::size_t cluster;  ///< Inverted list (cluster) index
+        std::size_t offset;   ///< Position within the inverted list
+    };
+
+    /**
+     * @brief State of an open capture (guarded by mutex_).
+     */
+    struct Capture {
+        std::uint64_t target_clusters = 0;              ///< target_clusters_ at the capture
+        std::vector<std::vector<float>> centroids;      ///< Centroids at the capture
+        std::vector<std::vector<std::uint64_t>> lists;  ///< IDs per inverted list at the capture
+        CapturedRows rows;                              ///< Captured vectors removed since
+    };
+
     // -------------------------------------------------------------------------
     // Helper Methods
     // -------------------------------------------------------------------------
 
+    /**
+     * @brief Write the stream header of serialize(), up to the centroids.
+     * @param out Output stream
+     * @param target_clusters Configured cluster count to record
+     * @param centroids Centroids to record
+     */
+    void write_header(std::ostream& out, std::uint64_t target_clusters,
+                      const std::vector<std::vector<float>>& centroids) const;
+
+    /**
+     * @brief Write a capture in the serialize() format, reading its vectors
+     *        under short shared locks.
+     * @param out Output stream
+     * @param captured The capture
+     * @return ErrorCode::Ok on success, error code otherwise
+     */
+    ErrorCode write_capture(std::ostream& out, const Capture& captured) const;
+
+    /**
+     * @brief Keep every vector for open captures before the lists are
+     *        replaced (lock must be held).
+     */
+    void keep_lists_for_captures();
+
+    /**
+     * @brief Append a vector to an inverted list and record its location.
+     *
+     * Note: Caller must hold the unique lock.
+     *
+     * @param cluster_id Target inverted list
+     * @param id Vector identifier
+     * @param vector Vector data
+     */
+    void append_to_list(std::size_t cluster_id, std::uint64_t id, std::span<const float> vector);
+
+    /**
+     * @brief Swap-remove the entry at a location and fix up the moved entry.
+     *
+     * Note: Caller must hold the unique lock. The ID-to-location entry of the
+     * removed vector itself is not erased.
+     *
+     * @param pos Location of the vector to remove
+     */
+    void remove_at(ListPosition pos);
+
+    /**
+     * @brief Perform a single split or merge if any list is out of bounds.
+     * @return true if a list was split or merged
+     */
+    bool rebalance_step();
+
+    /**
+     * @brief Split an inverted list in two using local 2-means.
+     *
+     * Note: Caller must hold the unique lock.
+     *
+     * @param cluster_id List to split; its second half becomes a new cluster
+     */
+    void split_list(std::size_t cluster_id);
+
+    /**
+     * @brief Move all vectors of a list to their nearest other centroid and drop it.
+     *
+     * Note: Caller must hold the unique lock. The last cluster is moved
+     * into the freed slot.
+     *
+     * @param cluster_id List to merge away
+     */
+    void merge_list(std::size_t cluster_id);
+
+    /**
+     * @brief Average list size the configured number of clusters would give.
+     *
+     * Note: Caller must hold the lock.
+     */
+    [[nodiscard]] double target_list_size() const;
+
+    /**
+     * @brief Check whether a list has grown past the split threshold.
+     *
+     * Note: Caller must hold the lock.
+     */
+    [[nodiscard]] bool needs_split(std::size_t list_size) const;
+
+    /**
+     * @brief Check whether a list has shrunk below the merge threshold.
+     *
+     * Note: Caller must hold the lock.
+     */
+    [[nodiscard]] bool needs_merge(std::size_t list_size) const;
+
+    /**
+     * @brief Wake the background rebalancing thread.
+     */
+    void request_rebalance();
+
+    /**
+     * @brief Background thread body: rebalance whenever requested.
+     */
+    void rebalance_worker();
+
+    /**
+     * @brief Rebuild the centroid graph from scratch (if enabled).
+     *
+     * Note: Caller must hold the unique lock.
+     */
+    void rebuild_quantizer();
+
+    /**
+     * @brief Re-insert one centroid into the graph after it changed.
+     *
+     * Removes the stale entry and, if cluster_id still exists, adds the
+     * current centroid. No-op without a quantizer.
+     * Note: Caller must hold the unique lock.
+     *
+     * @param cluster_id Cluster whose centroid changed or disappeared
+     */
+    void update_quantizer(std::size_t cluster_id);
+
     /**
      * @brief Find the nearest centroid to a vector.
      * @param vector Vector to find nearest centroid for
@@ -235,13 +505,22 @@ private:
      */
     [[nodiscard]] std::size_t find_nearest_centroid(std::span<const float> vector) const;
 
+    /**
+     * @brief Recompute the stored centroid distances of a whole list.
+     *
+     * Note: Caller must hold the unique lock.
+     *
+     * @param cluster_id List whose centroid changed
+     */
+    void refresh_centroid_distances(std::size_t cluster_id);
+
     /**
      * @brief Find the n_probe nearest centroids to a vector.
      * @param vector Vector to find nearest centroids for
      * @param n_probe Number of nearest centroids to find
-     * @return Vector of cluster IDs sorted by distance (nearest first)
+     * @return Clusters with their distances, sorted by distance (nearest first)
      */
-    [[nodiscard]] std::vector<std::size_t> find_nearest_centroids(
+    [[nodiscard]] std::vector<ProbeCandidate> find_nearest_centroids(
         std::span<const float> vector,
         std::size_t n_probe) const;
 
@@ -264,13 +543,26 @@ private:
     // Cluster structure
     std::vector<std::vector<float>> centroids_;               ///< k cluster centroids
     std::vector<InvertedList> inverted_lists_;                ///< k inverted lists
-    std::unordered_map<std::uint64_t, std::size_t> id_to_cluster_;  ///< ID -> cluster mapping
+    std::unordered_map<std::uint64_t, ListPosition> id_to_location_;  ///< ID -> (cluster, offset) mapping
+    std::unique_ptr<HNSWIndex> quantizer_;                    ///< Centroid graph (if use_hnsw_quantizer)
+    mutable std::vector<std::weak_ptr<Capture>> captures_;    ///< Open captures
 
     // Thread safety
     mutable std::shared_mutex mutex_;                          ///< Reader-writer lock
 
+    // Background rebalancing
+    std::size_t target_clusters_;                              ///< Configured number of clusters
+    std::thread rebalance_thread_;                             ///< Worker (if auto_rebalance)
+    std::mutex rebalance_mutex_;                               ///< Protects the request flags
+    std::condition_variable rebalance_cv_;                     ///< Wakes the worker
+    bool rebalance_requested_ = false;                         ///< Pending rebalance request
+    std::atomic<bool> stop_rebalance_{false};                  ///< Worker shutdown flag
+
     // Constants
     static constexpr std::uint64_t kInvalidId = std::numeric_limits<std::uint64_t>::max();
+    static constexpr std::size_t kMinSplitListSize = 32;       ///< Never split smaller lists
+    static constexpr std::size_t kSplitIterations = 10;        ///< Lloyd iterations for 2-means
+    static constexpr std::uint64_t kQuantizerSeed = 42;        ///< Fixed seed for a reproducible graph
 };
 
 } // namespace lynx
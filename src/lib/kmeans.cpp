@@ -13,10 +13,214 @@
 #include <limits>
 #include <cmath>
 #include <iostream>
+#include <array>
+
+#if defined(__AVX__)
+    #define LYNX_KMEANS_USE_AVX 1
+    #include <immintrin.h>
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #define LYNX_KMEANS_USE_SSE 1
+    #include <xmmintrin.h>
+#endif
 
 namespace lynx {
 namespace clustering {
 
+namespace {
+
+/// Minimum number of scalar distance evaluations per worker thread.
+/// Below this the cost of starting a thread outweighs the work it does.
+constexpr std::size_t kMinWorkPerThread = 1 << 16;
+
+/// Blocked assignment: points per kernel call and centroids per panel.
+/// 4 x 8 float accumulators: 8 SSE or 4 AVX registers.
+constexpr std::size_t kPanelRows = 4;  // inner_product_kernel is unrolled for 4
+constexpr std::size_t kPanelWidth = 8;
+
+/// Points per tile (multiple of kPanelRows) and target bytes of packed
+/// centroids swept per tile.
+constexpr std::size_t kPointTile = 16;
+constexpr std::size_t kCentroidTileBytes = 16 * 1024;
+
+/**
+ * @brief acc[r][j] = rows[r] . panel column j, for a kPanelRows x kPanelWidth tile.
+ *
+ * The panel is stored transposed (dimension x kPanelWidth), so the inner
+ * loop runs across centroids and vectorizes without reassociating sums.
+ */
+[[maybe_unused]] void inner_product_kernel(const float* const* rows, const float* panel, std::size_t dim,
+                                           float (&acc)[kPanelRows][kPanelWidth]) {
+    const float* row0 = rows[0];
+    const float* row1 = rows[1];
+    const float* row2 = rows[2];
+    const float* row3 = rows[3];
+#if defined(LYNX_KMEANS_USE_AVX)
+    // One panel column is one AVX register; 4 row accumulators
+    __m256 s0 = _mm256_setzero_ps();
+    __m256 s1 = _mm256_setzero_ps();
+    __m256 s2 = _mm256_setzero_ps();
+    __m256 s3 = _mm256_setzero_ps();
+    for (std::size_t t = 0; t < dim; ++t) {
+        const __m256 c = _mm256_loadu_ps(panel + t * kPanelWidth);
+#if defined(__FMA__)
+        s0 = _mm256_fmadd_ps(_mm256_broadcast_ss(row0 + t), c, s0);
+        s1 = _mm256_fmadd_ps(_mm256_broadcast_ss(row1 + t), c, s1);
+        s2 = _mm256_fmadd_ps(_mm256_broadcast_ss(row2 + t), c, s2);
+        s3 = _mm256_fmadd_ps(_mm256_broadcast_ss(row3 + t), c, s3);
+#else
+        s0 = _mm256_add_ps(s0, _mm256_mul_ps(_mm256_broadcast_ss(row0 + t), c));
+        s1 = _mm256_add_ps(s1, _mm256_mul_ps(_mm256_broadcast_ss(row1 + t), c));
+        s2 = _mm256_add_ps(s2, _mm256_mul_ps(_mm256_broadcast_ss(row2 + t), c));
+        s3 = _mm256_add_ps(s3, _mm256_mul_ps(_mm256_broadcast_ss(row3 + t), c));
+#endif
+    }
+    _mm256_storeu_ps(acc[0], s0);
+    _mm256_storeu_ps(acc[1], s1);
+    _mm256_storeu_ps(acc[2], s2);
+    _mm256_storeu_ps(acc[3], s3);
+#elif defined(LYNX_KMEANS_USE_SSE)
+    // 4 rows x 2 SSE registers: 8 accumulators stay in registers
+    __m128 s0a = _mm_setzero_ps(), s0b = _mm_setzero_ps();
+    __m128 s1a = _mm_setzero_ps(), s1b = _mm_setzero_ps();
+    __m128 s2a = _mm_setzero_ps(), s2b = _mm_setzero_ps();
+    __m128 s3a = _mm_setzero_ps(), s3b = _mm_setzero_ps();
+    for (std::size_t t = 0; t < dim; ++t) {
+        const float* column = panel + t * kPanelWidth;
+        const __m128 ca = _mm_loadu_ps(column);
+        const __m128 cb = _mm_loadu_ps(column + 4);
+        __m128 x = _mm_set1_ps(row0[t]);
+        s0a = _mm_add_ps(s0a, _mm_mul_ps(x, ca));
+        s0b = _mm_add_ps(s0b, _mm_mul_ps(x, cb));
+        x = _mm_set1_ps(row1[t]);
+        s1a = _mm_add_ps(s1a, _mm_mul_ps(x, ca));
+        s1b = _mm_add_ps(s1b, _mm_mul_ps(x, cb));
+        x = _mm_set1_ps(row2[t]);
+        s2a = _mm_add_ps(s2a, _mm_mul_ps(x, ca));
+        s2b = _mm_add_ps(s2b, _mm_mul_ps(x, cb));
+        x = _mm_set1_ps(row3[t]);
+        s3a = _mm_add_ps(s3a, _mm_mul_ps(x, ca));
+        s3b = _mm_add_ps(s3b, _mm_mul_ps(x, cb));
+    }
+    _mm_storeu_ps(&acc[0][0], s0a);
+    _mm_storeu_ps(&acc[0][4], s0b);
+    _mm_storeu_ps(&acc[1][0], s1a);
+    _mm_storeu_ps(&acc[1][4], s1b);
+    _mm_storeu_ps(&acc[2][0], s2a);
+    _mm_storeu_ps(&acc[2][4], s2b);
+    _mm_storeu_ps(&acc[3][0], s3a);
+    _mm_storeu_ps(&acc[3][4], s3b);
+#else
+    float sum[kPanelRows][kPanelWidth] = {};
+    for (std::size_t t = 0; t < dim; ++t) {
+        const float* column = panel + t * kPanelWidth;
+        const float x0 = row0[t];
+        const float x1 = row1[t];
+        const float x2 = row2[t];
+        const float x3 = row3[t];
+        for (std::size_t j = 0; j < kPanelWidth; ++j) {
+            const float c = column[j];
+            sum[0][j] += x0 * c;
+            sum[1][j] += x1 * c;
+            sum[2][j] += x2 * c;
+            sum[3][j] += x3 * c;
+        }
+    }
+    std::copy(&sum[0][0], &sum[0][0] + kPanelRows * kPanelWidth, &acc[0][0]);
+#endif
+}
+
+/**
+ * @brief Centroids packed into transposed panels for blocked assignment.
+ *
+ * Also holds the per-centroid terms that turn an inner product into a
+ * score with the same ordering as the metric (lower is closer).
+ */
+class PackedCentroids {
+public:
+    PackedCentroids(const std::vector<std::vector<float>>& centroids,
+                    std::size_t dim, DistanceMetric metric)
+        : dim_(dim)
+        , count_(centroids.size())
+        , num_panels_((centroids.size() + kPanelWidth - 1) / kPanelWidth)
+        , panels_(num_panels_ * dim * kPanelWidth, 0.0f)
+        , bias_(num_panels_ * kPanelWidth, 0.0f)
+        , scale_(num_panels_ * kPanelWidth, -1.0f) {
+        for (std::size_t c = 0; c < count_; ++c) {
+            float* panel = panels_.data() + (c / kPanelWidth) * dim * kPanelWidth;
+            float norm_sq = 0.0f;
+            for (std::size_t t = 0; t < dim; ++t) {
+                panel[t * kPanelWidth + c % kPanelWidth] = centroids[c][t];
+                norm_sq += centroids[c][t] * centroids[c][t];
+            }
+            switch (metric) {
+                case DistanceMetric::L2:
+                    bias_[c] = norm_sq;
+                    scale_[c] = -2.0f;
+                    break;
+                case DistanceMetric::Cosine: {
+                    // Zero centroids are at distance 1 from everything,
+                    // which orders like a cosine similarity of 0
+                    const float norm = std::sqrt(norm_sq);
+                    scale_[c] = norm < 1e-10f ? 0.0f : -1.0f / norm;
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+    }
+
+    [[nodiscard]] std::size_t num_panels() const { return num_panels_; }
+
+    [[nodiscard]] const float* panel(std::size_t p) const {
+        return panels_.data() + p * dim_ * kPanelWidth;
+    }
+
+    /**
+     * @brief Fold a kernel tile into the running best score per point.
+     */
+    void update_best(std::size_t p, const float (&acc)[kPanelRows][kPanelWidth],
+                     float* best_score, std::size_t* best_cluster) const {
+        const std::size_t first = p * kPanelWidth;
+        const std::size_t width = std::min(kPanelWidth, count_ - first);
+        for (std::size_t r = 0; r < kPanelRows; ++r) {
+            for (std::size_t j = 0; j < width; ++j) {
+                const float score = bias_[first + j] + scale_[first + j] * acc[r][j];
+                if (score < best_score[r]) {
+                    best_score[r] = score;
+                    best_cluster[r] = first + j;
+                }
+            }
+        }
+    }
+
+private:
+    std::size_t dim_;
+    std::size_t count_;
+    std::size_t num_panels_;
+    std::vector<float> panels_;   ///< num_panels x dim x kPanelWidth
+    std::vector<float> bias_;     ///< Additive per-centroid term
+    std::vector<float> scale_;    ///< Multiplier on the inner product
+};
+
+/// Weighted Lloyd iterations used to recluster k-means|| candidates.
+constexpr std::size_t kReclusterIterations = 10;
+
+/**
+ * @brief Counter-based uniform draw in [0, 1) for point `index`.
+ *
+ * SplitMix64 finalizer over (seed, index); independent of evaluation order.
+ */
+double hashed_uniform(std::uint64_t seed, std::uint64_t index) {
+    std::uint64_t z = seed + (index + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return static_cast<double>(z >> 11) * 0x1.0p-53;
+}
+
+} // namespace
+
 // ============================================================================
 // Constructor
 // ============================================================================
@@ -35,6 +239,9 @@ KMeans::KMeans(std::size_t k, std::size_t dimension,
     if (dimension_ == 0) {
         throw std::invalid_argument("dimension must be greater than 0");
     }
+    if (params_.balance_factor != 0.0f && !(params_.balance_factor >= 1.0f)) {
+        throw std::invalid_argument("balance_factor must be 0 or >= 1");
+    }
 
     // Initialize random number generator
     if (params_.random_seed.has_value()) {
@@ -50,10 +257,6 @@ KMeans::KMeans(std::size_t k, std::size_t dimension,
 // ============================================================================
 
 void KMeans::fit(std::span<const std::vector<float>> vectors) {
-    if (vectors.empty()) {
-        throw std::invalid_argument("Cannot fit on empty vector set");
-    }
-
     // Validate dimensions
     for (const auto& vec : vectors) {
         if (vec.size() != dimension_) {
@@ -61,25 +264,91 @@ void KMeans::fit(std::span<const std::vector<float>> vectors) {
         }
     }
 
+    auto rows = collect_row_pointers(vectors, [](const auto& vec) -> const auto& { return vec; });
+    fit(MatrixView(rows, dimension_));
+}
+
+void KMeans::fit(MatrixView vectors) {
+    if (vectors.empty()) {
+        throw std::invalid_argument("Cannot fit on empty vector set");
+    }
+    if (vectors.dim() != dimension_) {
+        throw std::invalid_argument("Vector dimension mismatch");
+    }
+
+    // Subsample large inputs; centroid quality saturates well before N
+    std::vector<const float*> sample;
+    MatrixView training = vectors;
+    if (params_.max_training_samples > 0) {
+        std::size_t sample_size = std::max(params_.max_training_samples, k_);
+        if (sample_size < vectors.rows()) {
+            sample = draw_training_sample(vectors, sample_size);
+            training = MatrixView(sample, dimension_);
+        }
+    }
+
     // Adjust k if necessary (k cannot exceed number of vectors)
-    std::size_t effective_k = std::min(k_, vectors.size());
+    std::size_t effective_k = std::min(k_, training.rows());
     if (effective_k < k_) {
         std::cerr << "Warning: k (" << k_ << ") is greater than number of vectors ("
-                  << vectors.size() << "). Reducing k to " << effective_k << std::endl;
+                  << training.rows() << "). Reducing k to " << effective_k << std::endl;
         k_ = effective_k;
     }
 
-    // Initialize centroids using k-means++
-    initialize_centroids_plusplus(vectors);
+    // Initialize centroids
+    if (params_.init == InitMethod::Parallel) {
+        initialize_centroids_parallel(training);
+    } else {
+        initialize_centroids_plusplus(training);
+    }
+    normalize_centroids();
+
+    if (params_.mini_batch_size > 0 && params_.mini_batch_size < training.rows()) {
+        run_mini_batch(training);
+    } else {
+        run_lloyd(training);
+    }
+
+    is_fitted_ = true;
+}
+
+// ============================================================================
+// Iteration
+// ============================================================================
+
+std::vector<const float*> KMeans::draw_training_sample(
+    MatrixView vectors, std::size_t count) {
+    // Selection sampling (Knuth's Algorithm S): one pass, output in input
+    // order, no index array proportional to N, no vector data copied
+    std::vector<const float*> sample;
+    sample.reserve(count);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::size_t needed = count;
+    for (std::size_t i = 0; i < vectors.rows() && needed > 0; ++i) {
+        const double remaining = static_cast<double>(vectors.rows() - i);
+        if (unit(rng_) * remaining < static_cast<double>(needed)) {
+            sample.push_back(vectors.row_data(i));
+            --needed;
+        }
+    }
+    return sample;
+}
+
+void KMeans::run_lloyd(MatrixView vectors) {
+    // Balancing moves points off their nearest centroid, which would
+    // invalidate Hamerly's bounds
+    if (metric_ == DistanceMetric::L2 && params_.use_bounds && params_.balance_factor == 0.0f) {
+        run_lloyd_bounded(vectors);
+        return;
+    }
 
     // Lloyd's algorithm: iterate until convergence or max iterations
-    std::vector<std::size_t> assignments(vectors.size());
+    std::vector<std::size_t> assignments(vectors.rows());
 
     for (std::size_t iter = 0; iter < params_.max_iterations; ++iter) {
         // Assignment step: assign each vector to nearest centroid
-        for (std::size_t i = 0; i < vectors.size(); ++i) {
-            assignments[i] = assign_to_nearest_centroid(vectors[i]);
-        }
+        assign_all(vectors, assignments);
+        enforce_capacity(vectors, assignments);
 
         // Save old centroids for convergence check
         auto old_centroids = centroids_;
@@ -93,8 +362,137 @@ void KMeans::fit(std::span<const std::vector<float>> vectors) {
             break;  // Converged
         }
     }
+}
 
-    is_fitted_ = true;
+void KMeans::run_lloyd_bounded(MatrixView vectors) {
+    const std::size_t n = vectors.rows();
+    std::vector<std::size_t> assignments(n, 0);
+    std::vector<float> upper(n);    // >= distance to assigned centroid
+    std::vector<float> lower(n);    // <= distance to any other centroid
+    std::vector<float> half_gap(k_);  // half distance to nearest other centroid
+    std::vector<float> shift(k_);
+
+    auto scan = [&](std::size_t i) {
+        float best = std::numeric_limits<float>::max();
+        float second = std::numeric_limits<float>::max();
+        std::size_t best_c = 0;
+        for (std::size_t c = 0; c < centroids_.size(); ++c) {
+            float dist = calculate_distance(vectors[i], centroids_[c]);
+            if (dist < best) {
+                second = best;
+                best = dist;
+                best_c = c;
+            } else if (dist < second) {
+                second = dist;
+            }
+        }
+        assignments[i] = best_c;
+        upper[i] = best;
+        lower[i] = second;
+    };
+
+    // Initial assignment is a full scan that also seeds the bounds
+    utils::parallel_for(n, worker_count(n, k_),
+        [&](std::size_t, std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                scan(i);
+            }
+        });
+
+    for (std::size_t iter = 0; iter < params_.max_iterations; ++iter) {
+        auto old_centroids = centroids_;
+        update_centroids(vectors, assignments);
+
+        float movement = calculate_centroid_movement(old_centroids, centroids_);
+        if (movement < params_.convergence_threshold || iter + 1 == params_.max_iterations) {
+            break;
+        }
+
+        // Per-centroid movement and the two largest movements
+        float max_shift = 0.0f;
+        float second_shift = 0.0f;
+        std::size_t max_shift_c = 0;
+        for (std::size_t c = 0; c < k_; ++c) {
+            shift[c] = calculate_distance(old_centroids[c], centroids_[c]);
+            if (shift[c] > max_shift) {
+                second_shift = max_shift;
+                max_shift = shift[c];
+                max_shift_c = c;
+            } else if (shift[c] > second_shift) {
+                second_shift = shift[c];
+            }
+        }
+
+        utils::parallel_for(k_, worker_count(k_, k_),
+            [&](std::size_t, std::size_t begin, std::size_t end) {
+                for (std::size_t c = begin; c < end; ++c) {
+                    float nearest = std::numeric_limits<float>::max();
+                    for (std::size_t other = 0; other < k_; ++other) {
+                        if (other != c) {
+                            nearest = std::min(nearest, calculate_distance(centroids_[c], centroids_[other]));
+                        }
+                    }
+                    half_gap[c] = 0.5f * nearest;
+                }
+            });
+
+        // Loosen bounds by centroid movement, then rescan only points whose
+        // assignment could have changed
+        utils::parallel_for(n, worker_count(n, k_),
+            [&](std::size_t, std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i) {
+                    const std::size_t a = assignments[i];
+                    upper[i] += shift[a];
+                    lower[i] -= (a == max_shift_c) ? second_shift : max_shift;
+
+                    const float bound = std::max(half_gap[a], lower[i]);
+                    if (upper[i] <= bound) {
+                        continue;
+                    }
+                    upper[i] = calculate_distance(vectors[i], centroids_[a]);
+                    if (upper[i] <= bound) {
+                        continue;
+                    }
+                    scan(i);
+                }
+            });
+    }
+}
+
+void KMeans::run_mini_batch(MatrixView vectors) {
+    const std::size_t batch_size = params_.mini_batch_size;
+    std::vector<std::size_t> seen(k_, 0);
+    std::vector<const float*> batch(batch_size);
+    std::vector<std::size_t> assignments(batch_size);
+    std::uniform_int_distribution<std::size_t> pick(0, vectors.rows() - 1);
+
+    for (std::size_t iter = 0; iter < params_.max_iterations; ++iter) {
+        for (auto& row : batch) {
+            row = vectors.row_data(pick(rng_));
+        }
+
+        // Assign against the centroids as they were at the start of the batch
+        assign_all(MatrixView(batch, dimension_), assignments);
+
+        auto old_centroids = centroids_;
+
+        // Gradient step in batch order so results do not depend on threads
+        for (std::size_t i = 0; i < batch_size; ++i) {
+            auto& centroid = centroids_[assignments[i]];
+            const float eta = 1.0f / static_cast<float>(++seen[assignments[i]]);
+            const float scale = is_spherical()
+                ? utils::inverse_norm({batch[i], dimension_}) : 1.0f;
+            for (std::size_t d = 0; d < dimension_; ++d) {
+                centroid[d] += eta * (scale * batch[i][d] - centroid[d]);
+            }
+        }
+        normalize_centroids();
+
+        float movement = calculate_centroid_movement(old_centroids, centroids_);
+        if (movement < params_.convergence_threshold) {
+            break;
+        }
+    }
 }
 
 // ============================================================================
@@ -106,16 +504,32 @@ std::vector<std::size_t> KMeans::predict(std::span<const std::vector<float>> vec
         throw std::logic_error("KMeans::predict() called before fit()");
     }
 
-    std::vector<std::size_t> assignments;
-    assignments.reserve(vectors.size());
-
     for (const auto& vec : vectors) {
         if (vec.size() != dimension_) {
             throw std::invalid_argument("Vector dimension mismatch in predict()");
         }
-        assignments.push_back(assign_to_nearest_centroid(vec));
     }
 
+    auto rows = collect_row_pointers(vectors, [](const auto& vec) -> const auto& { return vec; });
+    return predict(MatrixView(rows, dimension_));
+}
+
+std::vector<std::size_t> KMeans::predict(MatrixView vectors) const {
+    if (!is_fitted_) {
+        throw std::logic_error("KMeans::predict() called before fit()");
+    }
+    if (!vectors.empty() && vectors.dim() != dimension_) {
+        throw std::invalid_argument("Vector dimension mismatch in predict()");
+    }
+
+    std::vector<std::size_t> assignments;
+    assign_all(vectors, assignments);
+    return assignments;
+}
+
+std::vector<std::size_t> KMeans::predict_balanced(MatrixView vectors) const {
+    auto assignments = predict(vectors);
+    enforce_capacity(vectors, assignments);
     return assignments;
 }
 
@@ -134,37 +548,189 @@ const std::vector<std::vector<float>>& KMeans::centroids() const {
 // Initialization (K-means++)
 // ============================================================================
 
-void KMeans::initialize_centroids_plusplus(std::span<const std::vector<float>> vectors) {
+void KMeans::initialize_centroids_plusplus(MatrixView vectors,
+                                           std::span<const float> weights) {
     centroids_.clear();
     centroids_.reserve(k_);
 
-    // Step 1: Choose first centroid uniformly at random
-    std::uniform_int_distribution<std::size_t> uniform_dist(0, vectors.size() - 1);
-    std::size_t first_idx = uniform_dist(rng_);
-    centroids_.push_back(vectors[first_idx]);
+    // Step 1: Choose first centroid uniformly at random (or by weight)
+    std::size_t first_idx = 0;
+    if (weights.empty()) {
+        std::uniform_int_distribution<std::size_t> uniform_dist(0, vectors.rows() - 1);
+        first_idx = uniform_dist(rng_);
+    } else {
+        std::discrete_distribution<std::size_t> weight_dist(weights.begin(), weights.end());
+        first_idx = weight_dist(rng_);
+    }
+    centroids_.emplace_back(vectors[first_idx].begin(), vectors[first_idx].end());
 
     // Step 2: Choose remaining k-1 centroids with probability proportional to D(x)^2
-    std::vector<float> min_distances(vectors.size(), std::numeric_limits<float>::max());
+    std::vector<float> min_distances(vectors.rows(), std::numeric_limits<float>::max());
 
     for (std::size_t c = 1; c < k_; ++c) {
         // Update minimum distances to nearest centroid
-        for (std::size_t i = 0; i < vectors.size(); ++i) {
-            float dist = calculate_distance(vectors[i], centroids_.back());
-            min_distances[i] = std::min(min_distances[i], dist);
-        }
+        const auto& newest = centroids_.back();
+        utils::parallel_for(vectors.rows(), worker_count(vectors.rows(), 1),
+            [&](std::size_t, std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i) {
+                    float dist = calculate_distance(vectors[i], newest);
+                    min_distances[i] = std::min(min_distances[i], dist);
+                }
+            });
 
         // Calculate D(x)^2 for probability distribution
         std::vector<float> squared_distances;
-        squared_distances.reserve(vectors.size());
-        for (float dist : min_distances) {
-            squared_distances.push_back(dist * dist);
+        squared_distances.reserve(vectors.rows());
+        for (std::size_t i = 0; i < vectors.rows(); ++i) {
+            float dist = min_distances[i];
+            squared_distances.push_back(weights.empty() ? dist * dist : weights[i] * dist * dist);
         }
 
         // Choose next centroid with probability proportional to D(x)^2
         std::discrete_distribution<std::size_t> weighted_dist(
             squared_distances.begin(), squared_distances.end());
         std::size_t next_idx = weighted_dist(rng_);
-        centroids_.push_back(vectors[next_idx]);
+        centroids_.emplace_back(vectors[next_idx].begin(), vectors[next_idx].end());
+    }
+}
+
+void KMeans::initialize_centroids_parallel(MatrixView vectors) {
+    const std::size_t n = vectors.rows();
+
+    // Candidate centres (indices into vectors) with, per point, the distance
+    // to and index of the nearest candidate seen so far
+    std::vector<std::size_t> candidates;
+    std::vector<float> min_distances(n, std::numeric_limits<float>::max());
+    std::vector<std::size_t> nearest(n, 0);
+
+    auto refresh = [&](std::size_t first_new) {
+        const std::size_t added = candidates.size() - first_new;
+        utils::parallel_for(n, worker_count(n, added),
+            [&](std::size_t, std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i) {
+                    for (std::size_t c = first_new; c < candidates.size(); ++c) {
+                        float dist = calculate_distance(vectors[i], vectors[candidates[c]]);
+                        if (dist < min_distances[i]) {
+                            min_distances[i] = dist;
+                            nearest[i] = c;
+                        }
+                    }
+                }
+            });
+    };
+
+    // Step 1: one uniformly random centre
+    std::uniform_int_distribution<std::size_t> uniform_dist(0, n - 1);
+    candidates.push_back(uniform_dist(rng_));
+    refresh(0);
+
+    // Step 2: oversampling rounds
+    const double oversample = std::max(1.0, static_cast<double>(params_.oversampling_factor) *
+                                                static_cast<double>(k_));
+    const std::size_t threads = worker_count(n, 1);
+    for (std::size_t round = 0; round < params_.init_rounds; ++round) {
+        double cost = 0.0;
+        for (float dist : min_distances) {
+            cost += static_cast<double>(dist) * static_cast<double>(dist);
+        }
+        if (cost <= 0.0) {
+            break;  // Every point coincides with a candidate
+        }
+
+        const std::uint64_t round_seed = rng_();
+        std::vector<std::vector<std::size_t>> picked(threads);
+        const std::size_t chunks = utils::parallel_for(n, threads,
+            [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i) {
+                    const double d = min_distances[i];
+                    const double p = oversample * d * d / cost;
+                    if (p > 0.0 && (p >= 1.0 || hashed_uniform(round_seed, i) < p)) {
+                        picked[chunk].push_back(i);
+                    }
+                }
+            });
+
+        // Chunks cover consecutive ranges, so concatenation is in index order
+        const std::size_t first_new = candidates.size();
+        for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+            candidates.insert(candidates.end(), picked[chunk].begin(), picked[chunk].end());
+        }
+        if (candidates.size() > first_new) {
+            refresh(first_new);
+        }
+    }
+
+    // Too few candidates (tiny or highly duplicated input): top up by D^2
+    while (candidates.size() < k_) {
+        std::vector<double> squared_distances(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            squared_distances[i] = static_cast<double>(min_distances[i]) * min_distances[i];
+        }
+        std::size_t next_idx = 0;
+        if (std::all_of(squared_distances.begin(), squared_distances.end(),
+                        [](double d) { return d <= 0.0; })) {
+            next_idx = uniform_dist(rng_);
+        } else {
+            std::discrete_distribution<std::size_t> weighted_dist(
+                squared_distances.begin(), squared_distances.end());
+            next_idx = weighted_dist(rng_);
+        }
+        candidates.push_back(next_idx);
+        refresh(candidates.size() - 1);
+    }
+
+    // Step 3: weight candidates by the points they attract
+    std::vector<float> weights(candidates.size(), 0.0f);
+    for (std::size_t i = 0; i < n; ++i) {
+        weights[nearest[i]] += 1.0f;
+    }
+
+    std::vector<const float*> candidate_rows;
+    candidate_rows.reserve(candidates.size());
+    for (std::size_t idx : candidates) {
+        candidate_rows.push_back(vectors.row_data(idx));
+    }
+    const MatrixView candidate_vectors(candidate_rows, dimension_);
+
+    if (candidate_vectors.rows() == k_) {
+        centroids_.clear();
+        for (std::size_t c = 0; c < k_; ++c) {
+            centroids_.emplace_back(candidate_vectors[c].begin(), candidate_vectors[c].end());
+        }
+        return;
+    }
+
+    // Step 4: recluster the weighted candidates down to k centres
+    initialize_centroids_plusplus(candidate_vectors, weights);
+
+    std::vector<std::size_t> assignments;
+    for (std::size_t iter = 0; iter < kReclusterIterations; ++iter) {
+        assign_all(candidate_vectors, assignments);
+
+        std::vector<std::vector<float>> sums(k_, std::vector<float>(dimension_, 0.0f));
+        std::vector<float> totals(k_, 0.0f);
+        for (std::size_t c = 0; c < candidate_vectors.rows(); ++c) {
+            const float w = weights[c];
+            const float scale = is_spherical() ? utils::inverse_norm(candidate_vectors[c]) : 1.0f;
+            auto& sum = sums[assignments[c]];
+            for (std::size_t d = 0; d < dimension_; ++d) {
+                sum[d] += w * scale * candidate_vectors[c][d];
+            }
+            totals[assignments[c]] += w;
+        }
+
+        auto old_centroids = centroids_;
+        for (std::size_t c = 0; c < k_; ++c) {
+            if (totals[c] > 0.0f) {
+                for (std::size_t d = 0; d < dimension_; ++d) {
+                    centroids_[c][d] = sums[c][d] / totals[c];
+                }
+            }
+        }
+        normalize_centroids();
+        if (calculate_centroid_movement(old_centroids, centroids_) < params_.convergence_threshold) {
+            break;
+        }
     }
 }
 
@@ -172,61 +738,220 @@ void KMeans::initialize_centroids_plusplus(std::span<const std::vector<float>> v
 // Assignment
 // ============================================================================
 
-std::size_t KMeans::assign_to_nearest_centroid(std::span<const float> vector) const {
+void KMeans::assign_all(MatrixView vectors,
+                        std::vector<std::size_t>& assignments) const {
     if (centroids_.empty()) {
         throw std::logic_error("Cannot assign to nearest centroid: no centroids");
     }
+    assignments.resize(vectors.rows());
+    if (vectors.empty()) {
+        return;
+    }
+
+#if !defined(LYNX_KMEANS_USE_AVX) && !defined(LYNX_KMEANS_USE_SSE)
+    // Scalar build: nothing for the packed panels to pay off against
+    utils::parallel_for(vectors.rows(), worker_count(vectors.rows(), centroids_.size()),
+        [&](std::size_t, std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                std::size_t best = 0;
+                float best_distance = std::numeric_limits<float>::max();
+                for (std::size_t c = 0; c < centroids_.size(); ++c) {
+                    const float dist = calculate_distance(vectors[i], centroids_[c]);
+                    if (dist < best_distance) {
+                        best_distance = dist;
+                        best = c;
+                    }
+                }
+                assignments[i] = best;
+            }
+        });
+#else
+    const PackedCentroids packed(centroids_, dimension_, metric_);
+
+    // Centroid panels per tile: keep one tile of centroids in L1/L2 while
+    // a tile of points is swept over it
+    const std::size_t panel_bytes = dimension_ * kPanelWidth * sizeof(float);
+    const std::size_t panels_per_tile = std::max<std::size_t>(kCentroidTileBytes / panel_bytes, 1);
+
+    utils::parallel_for(vectors.rows(), worker_count(vectors.rows(), centroids_.size()),
+        [&](std::size_t, std::size_t begin, std::size_t end) {
+            std::array<float, kPointTile> best_score;
+            std::array<std::size_t, kPointTile> best_cluster;
+            std::array<const float*, kPointTile> rows;
+
+            for (std::size_t tile = begin; tile < end; tile += kPointTile) {
+                const std::size_t tile_rows = std::min(kPointTile, end - tile);
+                // Pad to whole kernel rows by repeating the last point
+                const std::size_t padded = (tile_rows + kPanelRows - 1) / kPanelRows * kPanelRows;
+                for (std::size_t r = 0; r < padded; ++r) {
+                    rows[r] = vectors.row_data(tile + std::min(r, tile_rows - 1));
+                }
+                best_score.fill(std::numeric_limits<float>::max());
+                best_cluster.fill(0);
+
+                for (std::size_t p0 = 0; p0 < packed.num_panels(); p0 += panels_per_tile) {
+                    const std::size_t p1 = std::min(p0 + panels_per_tile, packed.num_panels());
+                    for (std::size_t r = 0; r < padded; r += kPanelRows) {
+                        for (std::size_t p = p0; p < p1; ++p) {
+                            float acc[kPanelRows][kPanelWidth];
+                            inner_product_kernel(&rows[r], packed.panel(p), dimension_, acc);
+                            packed.update_best(p, acc, &best_score[r], &best_cluster[r]);
+                        }
+                    }
+                }
+
+                for (std::size_t r = 0; r < tile_rows; ++r) {
+                    assignments[tile + r] = best_cluster[r];
+                }
+            }
+        });
+#endif
+}
 
-    std::size_t nearest_cluster = 0;
-    float min_distance = std::numeric_limits<float>::max();
+void KMeans::enforce_capacity(MatrixView vectors, std::vector<std::size_t>& assignments) const {
+    if (params_.balance_factor == 0.0f || vectors.empty()) {
+        return;
+    }
+
+    const std::size_t n = vectors.rows();
+    const std::size_t k = centroids_.size();
+    const std::size_t even = (n + k - 1) / k;
+    const std::size_t capacity = std::max(
+        even, static_cast<std::size_t>(std::ceil(params_.balance_factor * static_cast<double>(n) /
+                                                 static_cast<double>(k))));
+
+    std::vector<std::vector<std::size_t>> members(k);
+    for (std::size_t i = 0; i < n; ++i) {
+        members[assignments[i]].push_back(i);
+    }
 
-    for (std::size_t c = 0; c < centroids_.size(); ++c) {
-        float dist = calculate_distance(vector, centroids_[c]);
-        if (dist < min_distance) {
-            min_distance = dist;
-            nearest_cluster = c;
+    // Overfull clusters keep their closest members
+    std::vector<std::size_t> counts(k);
+    std::vector<std::size_t> evicted;
+    for (std::size_t c = 0; c < k; ++c) {
+        auto& list = members[c];
+        if (list.size() > capacity) {
+            std::vector<std::pair<float, std::size_t>> by_distance;
+            by_distance.reserve(list.size());
+            for (std::size_t i : list) {
+                by_distance.emplace_back(calculate_distance(vectors[i], centroids_[c]), i);
+            }
+            std::nth_element(by_distance.begin(), by_distance.begin() + capacity, by_distance.end());
+            for (std::size_t j = capacity; j < by_distance.size(); ++j) {
+                evicted.push_back(by_distance[j].second);
+            }
         }
+        counts[c] = std::min(list.size(), capacity);
     }
+    std::sort(evicted.begin(), evicted.end());
+
+    // Evicted points go to their nearest centroid with room; total
+    // capacity k * capacity >= n guarantees one exists
+    for (std::size_t i : evicted) {
+        std::size_t best = k;
+        float best_distance = std::numeric_limits<float>::max();
+        for (std::size_t c = 0; c < k; ++c) {
+            if (counts[c] >= capacity) {
+                continue;
+            }
+            float dist = calculate_distance(vectors[i], centroids_[c]);
+            if (best == k || dist < best_distance) {
+                best = c;
+                best_distance = dist;
+            }
+        }
+        assignments[i] = best;
+        counts[best]++;
+    }
+}
 
-    return nearest_cluster;
+std::size_t KMeans::worker_count(std::size_t count, std::size_t cost_per_item) const {
+    const std::size_t work = count * std::max<std::size_t>(cost_per_item, 1) * dimension_;
+    const std::size_t by_work = std::max<std::size_t>(work / kMinWorkPerThread, 1);
+    return std::min(utils::resolve_thread_count(params_.num_threads), by_work);
 }
 
 // ============================================================================
 // Update
 // ============================================================================
 
-void KMeans::update_centroids(std::span<const std::vector<float>> vectors,
+void KMeans::update_centroids(MatrixView vectors,
                               const std::vector<std::size_t>& assignments) {
-    // Initialize new centroids and counts
-    std::vector<std::vector<float>> new_centroids(k_, std::vector<float>(dimension_, 0.0f));
-    std::vector<std::size_t> cluster_counts(k_, 0);
-
-    // Accumulate vectors for each cluster
-    for (std::size_t i = 0; i < vectors.size(); ++i) {
-        std::size_t cluster = assignments[i];
-        cluster_counts[cluster]++;
-
-        for (std::size_t d = 0; d < dimension_; ++d) {
-            new_centroids[cluster][d] += vectors[i][d];
+    // Group member indices by cluster (counting sort keeps input order)
+    std::vector<std::size_t> cluster_offsets(k_ + 1, 0);
+    for (std::size_t cluster : assignments) {
+        cluster_offsets[cluster + 1]++;
+    }
+    for (std::size_t c = 0; c < k_; ++c) {
+        cluster_offsets[c + 1] += cluster_offsets[c];
+    }
+    std::vector<std::size_t> members(vectors.rows());
+    {
+        std::vector<std::size_t> cursor(cluster_offsets.begin(), cluster_offsets.end() - 1);
+        for (std::size_t i = 0; i < vectors.rows(); ++i) {
+            members[cursor[assignments[i]]++] = i;
         }
     }
 
-    // Compute means and handle empty clusters
-    for (std::size_t c = 0; c < k_; ++c) {
-        if (cluster_counts[c] > 0) {
-            // Normal case: compute mean
-            for (std::size_t d = 0; d < dimension_; ++d) {
-                new_centroids[c][d] /= static_cast<float>(cluster_counts[c]);
+    // Accumulate each cluster's members in input order; clusters are
+    // partitioned across threads so every sum is computed by one thread
+    std::vector<std::vector<float>> new_centroids(k_, std::vector<float>(dimension_, 0.0f));
+    const bool spherical = is_spherical();
+    const std::size_t avg_members = vectors.rows() / k_ + 1;
+    utils::parallel_for(k_, worker_count(k_, avg_members),
+        [&](std::size_t, std::size_t begin, std::size_t end) {
+            for (std::size_t c = begin; c < end; ++c) {
+                const std::size_t count = cluster_offsets[c + 1] - cluster_offsets[c];
+                if (count == 0) {
+                    continue;
+                }
+                auto& centroid = new_centroids[c];
+                for (std::size_t m = cluster_offsets[c]; m < cluster_offsets[c + 1]; ++m) {
+                    const auto& vec = vectors[members[m]];
+                    const float scale = spherical ? utils::inverse_norm(vec) : 1.0f;
+                    for (std::size_t d = 0; d < dimension_; ++d) {
+                        centroid[d] += scale * vec[d];
+                    }
+                }
+                if (spherical) {
+                    const float scale = utils::inverse_norm(centroid);
+                    for (std::size_t d = 0; d < dimension_; ++d) {
+                        centroid[d] *= scale;
+                    }
+                } else {
+                    for (std::size_t d = 0; d < dimension_; ++d) {
+                        centroid[d] /= static_cast<float>(count);
+                    }
+                }
             }
-        } else {
-            // Empty cluster: reinitialize to random vector
-            std::uniform_int_distribution<std::size_t> dist(0, vectors.size() - 1);
+        });
+
+    // Empty clusters: reinitialize to random vector (sequential, so the
+    // RNG stream does not depend on the thread count)
+    for (std::size_t c = 0; c < k_; ++c) {
+        if (cluster_offsets[c + 1] == cluster_offsets[c]) {
+            std::uniform_int_distribution<std::size_t> dist(0, vectors.rows() - 1);
             std::size_t random_idx = dist(rng_);
-            new_centroids[c] = vectors[random_idx];
+            new_centroids[c].assign(vectors[random_idx].begin(), vectors[random_idx].end());
         }
     }
 
     centroids_ = std::move(new_centroids);
+    normalize_centroids();
+}
+
+void KMeans::normalize_centroids() {
+    if (!is_spherical()) {
+        return;
+    }
+    for (auto& centroid : centroids_) {
+        const float scale = utils::inverse_norm(centroid);
+        if (scale > 0.0f) {
+            for (float& x : centroid) {
+                x *= scale;
+            }
+        }
+    }
 }
 
 // ============================================================================
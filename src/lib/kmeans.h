@@ -12,6 +12,7 @@
 #define LYNX_KMEANS_H
 
 #include "../include/lynx/lynx.h"
+#include "matrix_view.h"
 #include <vector>
 #include <span>
 #include <random>
@@ -26,6 +27,14 @@ namespace clustering {
 // Configuration
 // ============================================================================
 
+/**
+ * @brief Centroid initialization strategy.
+ */
+enum class InitMethod {
+    PlusPlus,   ///< Sequential k-means++ (k passes over the data)
+    Parallel    ///< k-means|| oversampling + reclustering (a few parallel passes)
+};
+
 /**
  * @brief Configuration parameters for k-means clustering.
  */
@@ -33,6 +42,14 @@ struct KMeansParams {
     std::size_t max_iterations = 100;           ///< Maximum iterations for Lloyd's algorithm
     float convergence_threshold = 1e-4f;        ///< Convergence threshold for centroid movement
     std::optional<std::uint64_t> random_seed = std::nullopt;  ///< Random seed (nullopt = non-deterministic)
+    std::size_t num_threads = 0;                ///< Worker threads for assignment/update (0 = hardware concurrency)
+    std::size_t max_training_samples = 0;       ///< Train on a random subsample of at most this many vectors (0 = all)
+    std::size_t mini_batch_size = 0;            ///< Points per mini-batch iteration (0 = full-batch Lloyd)
+    InitMethod init = InitMethod::PlusPlus;     ///< Centroid initialization strategy
+    float oversampling_factor = 2.0f;           ///< k-means||: expected candidates per round = factor * k
+    std::size_t init_rounds = 5;                ///< k-means||: number of sampling rounds
+    bool use_bounds = true;                     ///< Skip distance evaluations with Hamerly bounds (L2 only)
+    float balance_factor = 0.0f;                ///< Cap cluster sizes at balance_factor * N / k in Lloyd and predict_balanced() (0 = off, else >= 1)
 };
 
 // ============================================================================
@@ -48,10 +65,26 @@ struct KMeansParams {
  * 3. Repeating until convergence or max iterations reached
  *
  * Key features:
- * - K-means++ initialization for better initial centroids
+ * - K-means++ or k-means|| initialization for better initial centroids
  * - Support for L2, Cosine, and DotProduct distance metrics
  * - Handles edge cases (k > N, empty clusters, etc.)
  * - Configurable convergence criteria
+ * - Multi-threaded assignment and update steps (KMeansParams::num_threads)
+ * - Optional training subsample and mini-batch updates for large inputs
+ * - Hamerly's bounds for L2, skipping most distance evaluations once
+ *   centroids settle. A skip never changes which centroid is nearest, but
+ *   the distances it does evaluate are direct rather than in the X * C^T
+ *   form of assign_all(), so near-ties can round to a different centroid
+ *   than the unbounded path picks
+ * - Optional balanced mode that caps every cluster at
+ *   balance_factor * N / k points (see predict_balanced())
+ * - Spherical k-means for Cosine: members contribute their unit direction
+ *   and centroids are kept on the unit sphere, so a cluster's centre is its
+ *   mean direction rather than being pulled towards long vectors
+ *
+ * The assignment and update steps are split across worker threads. Each
+ * centroid is summed by exactly one thread, in input order, so results for
+ * a fixed random_seed are identical for any thread count.
  *
  * Thread-safety: Not thread-safe. External synchronization required.
  */
@@ -67,6 +100,8 @@ public:
      * @param dimension Vector dimensionality
      * @param metric Distance metric to use
      * @param params K-means parameters (iterations, convergence, seed)
+     * @throws std::invalid_argument if k or dimension is 0, or balance_factor
+     *         is in (0, 1)
      */
     KMeans(std::size_t k, std::size_t dimension,
            DistanceMetric metric, const KMeansParams& params = {});
@@ -82,11 +117,29 @@ public:
      * k cluster centroids. After calling fit(), centroids are available
      * via centroids() method.
      *
+     * If max_training_samples is set and smaller than the input, training
+     * runs on a uniform random subsample (never fewer than k points). If
+     * mini_batch_size is set, each iteration updates centroids from a
+     * random batch with per-centroid learning rates instead of a full pass.
+     *
      * @param vectors Training vectors (must all have dimension_ size)
      * @throws std::invalid_argument if vectors is empty or has wrong dimension
      */
     void fit(std::span<const std::vector<float>> vectors);
 
+    /**
+     * @brief Fit k-means on vectors read in place through a matrix view.
+     *
+     * Same as fit() above, but without requiring a vector-of-vectors: the
+     * rows may live in one strided buffer (e.g. a memory-mapped file) or be
+     * referenced through a row-pointer table. Only sampled or batched row
+     * pointers are materialized; vector data is never copied.
+     *
+     * @param vectors Training vectors (vectors.dim() must equal dimension())
+     * @throws std::invalid_argument if vectors is empty or has wrong dimension
+     */
+    void fit(MatrixView vectors);
+
     // -------------------------------------------------------------------------
     // Prediction
     // -------------------------------------------------------------------------
@@ -103,6 +156,31 @@ public:
      */
     [[nodiscard]] std::vector<std::size_t> predict(std::span<const std::vector<float>> vectors) const;
 
+    /**
+     * @brief Predict cluster assignments for vectors read through a view.
+     *
+     * @param vectors Vectors to assign (vectors.dim() must equal dimension())
+     * @return Vector of cluster IDs [0, k-1] for each row
+     * @throws std::logic_error if fit() hasn't been called yet
+     * @throws std::invalid_argument if vectors have wrong dimension
+     */
+    [[nodiscard]] std::vector<std::size_t> predict(MatrixView vectors) const;
+
+    /**
+     * @brief Assign vectors to clusters under the balance_factor size cap.
+     *
+     * Starts from nearest-centroid assignment; every cluster holding more
+     * than ceil(balance_factor * rows / k) points keeps the ones closest to
+     * its centroid and the rest move to their nearest centroid that still
+     * has room. With balance_factor == 0 this is the same as predict().
+     *
+     * @param vectors Vectors to assign (vectors.dim() must equal dimension())
+     * @return Vector of cluster IDs [0, k-1] for each row
+     * @throws std::logic_error if fit() hasn't been called yet
+     * @throws std::invalid_argument if vectors have wrong dimension
+     */
+    [[nodiscard]] std::vector<std::size_t> predict_balanced(MatrixView vectors) const;
+
     // -------------------------------------------------------------------------
     // Accessors
     // -------------------------------------------------------------------------
@@ -149,36 +227,157 @@ private:
      * This initialization provides better starting points than random,
      * leading to faster convergence and better final clusters.
      *
+     * If weights are given, selection probabilities are additionally
+     * scaled by each point's weight (used to recluster k-means|| candidates).
+     *
+     * @param vectors Training vectors
+     * @param weights Optional per-vector weights (empty = uniform)
+     */
+    void initialize_centroids_plusplus(MatrixView vectors,
+                                       std::span<const float> weights = {});
+
+    /**
+     * @brief Initialize centroids using k-means|| (Bahmani et al., 2012).
+     *
+     * 1. Choose one centroid uniformly at random
+     * 2. For init_rounds rounds, sample every point independently with
+     *    probability oversampling_factor * k * D(x)^2 / sum(D^2)
+     * 3. Weight each candidate by the number of points nearest to it and
+     *    recluster the weighted candidates down to k with k-means++ and a
+     *    few weighted Lloyd iterations
+     *
+     * Each round is a single parallel pass. Per-point sampling decisions
+     * come from a counter-based hash of (round seed, point index), so the
+     * result does not depend on the thread count.
+     *
+     * @param vectors Training vectors
+     */
+    void initialize_centroids_parallel(MatrixView vectors);
+
+    // -------------------------------------------------------------------------
+    // Iteration
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Draw a uniform random training subsample without replacement.
+     *
+     * @param vectors Full input
+     * @param count Number of vectors to draw (< vectors.rows())
+     * @return Row pointers of the sampled vectors, in input order
+     */
+    [[nodiscard]] std::vector<const float*> draw_training_sample(
+        MatrixView vectors, std::size_t count);
+
+    /**
+     * @brief Run full-batch Lloyd iterations until convergence.
+     * @param vectors Training vectors
+     */
+    void run_lloyd(MatrixView vectors);
+
+    /**
+     * @brief Run Lloyd iterations with Hamerly's triangle-inequality bounds.
+     *
+     * Keeps, per point, an upper bound on the distance to its assigned
+     * centroid and a lower bound on the distance to any other centroid.
+     * After each update the bounds are loosened by how far centroids moved;
+     * a point is only rescanned when its upper bound exceeds both its lower
+     * bound and half the distance from its centroid to the nearest other
+     * centroid. Requires a true metric, so it is used for L2 only.
+     *
+     * @param vectors Training vectors
+     */
+    void run_lloyd_bounded(MatrixView vectors);
+
+    /**
+     * @brief Run mini-batch k-means iterations.
+     *
+     * Each iteration assigns a random batch to the nearest centroids and
+     * moves each centroid towards its points with learning rate
+     * 1 / (points seen by that centroid so far).
+     *
      * @param vectors Training vectors
      */
-    void initialize_centroids_plusplus(std::span<const std::vector<float>> vectors);
+    void run_mini_batch(MatrixView vectors);
 
     // -------------------------------------------------------------------------
     // Assignment
     // -------------------------------------------------------------------------
 
     /**
-     * @brief Assign a vector to its nearest centroid.
+     * @brief Assign every vector to its nearest centroid in parallel.
      *
-     * @param vector Vector to assign
-     * @return Cluster ID [0, k-1] of nearest centroid
+     * Distances are evaluated as a blocked matrix product X * C^T: centroids
+     * are packed into transposed panels of kPanelWidth columns and each
+     * kernel call computes a tile of kPanelRows points by one panel, so
+     * every centroid value loaded is reused across several points. The
+     * metric is then applied from the inner products and precomputed
+     * centroid norms:
+     * - L2:         |c|^2 - 2 x.c   (|x|^2 is constant per point)
+     * - Cosine:     -x.c / |c|      (|x| is constant per point)
+     * - DotProduct: -x.c
+     *
+     * The blocking pays for its packing only when the kernel's accumulators
+     * live in SIMD registers; builds without SSE or AVX compare each point
+     * with each centroid directly instead. Ties resolve to the lowest
+     * centroid index.
+     *
+     * @param vectors Vectors to assign
+     * @param assignments Output cluster IDs (resized to vectors.rows())
      */
-    [[nodiscard]] std::size_t assign_to_nearest_centroid(std::span<const float> vector) const;
+    void assign_all(MatrixView vectors,
+                    std::vector<std::size_t>& assignments) const;
+
+    /**
+     * @brief Move points out of clusters above the balance_factor cap.
+     *
+     * Overfull clusters (processed in index order) keep their closest
+     * members; evicted points (in index order) go to the nearest centroid
+     * with spare capacity. No-op when balance_factor is 0.
+     *
+     * @param vectors Vectors that assignments refers to
+     * @param assignments Cluster IDs, updated in place
+     */
+    void enforce_capacity(MatrixView vectors, std::vector<std::size_t>& assignments) const;
 
     // -------------------------------------------------------------------------
     // Update
     // -------------------------------------------------------------------------
 
+    /**
+     * @brief Number of worker threads for a pass over count items.
+     *
+     * Caps params_.num_threads so that each thread gets enough distance
+     * computations to amortize thread start-up.
+     *
+     * @param count Number of items in the pass
+     * @param cost_per_item Distance computations per item
+     * @return Number of threads to use (>= 1)
+     */
+    [[nodiscard]] std::size_t worker_count(std::size_t count, std::size_t cost_per_item) const;
+
+    /**
+     * @brief Whether centroids are mean directions (Cosine metric).
+     */
+    [[nodiscard]] bool is_spherical() const { return metric_ == DistanceMetric::Cosine; }
+
+    /**
+     * @brief Scale each centroid to unit length (spherical mode only).
+     */
+    void normalize_centroids();
+
     /**
      * @brief Update centroids as the mean of assigned vectors.
      *
-     * Recomputes each centroid as the mean of all vectors assigned to it.
+     * Recomputes each centroid as the mean of all vectors assigned to it
+     * (in spherical mode: the normalized sum of their unit directions).
+     * Clusters are partitioned across worker threads; each thread sums the
+     * members of its clusters in input order.
      * Handles empty clusters by reinitializing them to random vectors.
      *
      * @param vectors Training vectors
      * @param assignments Cluster assignments for each vector
      */
-    void update_centroids(std::span<const std::vector<float>> vectors,
+    void update_centroids(MatrixView vectors,
                          const std::vector<std::size_t>& assignments);
 
     // -------------------------------------------------------------------------
@@ -58,6 +58,40 @@ const char* distance_metric_string(DistanceMetric metric) {
 IVectorDatabase::~IVectorDatabase() {}
 IVectorIndex::~IVectorIndex() {}
 
+std::vector<SearchResultItem> IVectorIndex::search_with_stats(
+    std::span<const float> query,
+    std::size_t k,
+    const SearchParams& params,
+    IndexSearchStats& /*stats*/) const {
+    return search(query, k, params);
+}
+
+ErrorCode IVectorIndex::remove_batch(std::span<const std::uint64_t> ids) {
+    for (std::uint64_t id : ids) {
+        if (!contains(id)) {
+            return ErrorCode::VectorNotFound;
+        }
+    }
+    for (std::uint64_t id : ids) {
+        ErrorCode result = remove(id);
+        if (result != ErrorCode::Ok && result != ErrorCode::VectorNotFound) {
+            return result;
+        }
+    }
+    return ErrorCode::Ok;
+}
+
+ErrorCode IVectorIndex::build(std::span<const std::uint64_t> ids, MatrixView vectors) {
+    if (ids.size() != vectors.rows()) {
+        return ErrorCode::InvalidParameter;
+    }
+    std::vector<VectorRecord> records;
+    records.reserve(ids.size());
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        records.push_back({ids[i], std::vector<float>(vectors[i].begin(), vectors[i].end()), std::nullopt});
+    }
+    return build(records);
+}
 
 const char* IVectorDatabase::version() {
     return "0.1.0";
@@ -14,9 +14,87 @@
 
 #include "../include/lynx/lynx.h"
 #include "utils.h"
+#include "matrix_view.h"
+#include "mapped_file.h"
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace lynx {
 
+// ============================================================================
+// Internal Data Structures
+// ============================================================================
+
+/**
+ * @brief Per-query statistics reported by an index search.
+ */
+struct IndexSearchStats {
+    std::size_t clusters_probed = 0;  ///< IVF: clusters actually scanned
+};
+
+/**
+ * @brief Point-in-time view of an index, taken by IVectorIndex::capture().
+ *
+ * Both functions may run after the index has changed and still describe
+ * it as captured. An index updated in place reads its current rows while
+ * writing, so it must outlive the capture.
+ */
+struct IndexCapture {
+    std::function<ErrorCode(std::ostream&)> serialize;  ///< Writes what serialize() would have
+    std::function<std::vector<std::uint64_t>()> ids;    ///< IDs held, in storage_order() if the index has one
+};
+
+/**
+ * @brief Captured rows that an index updated in place has since changed.
+ *
+ * Such an index copies its IDs when captured and reads their rows while
+ * the capture is written. A row overwritten or removed in between is kept
+ * here first (only its captured value); changes to IDs added after the
+ * capture are not kept. Guarded by the owning index's lock.
+ */
+struct CapturedRows {
+    std::unordered_set<std::uint64_t> added;                     ///< Added since the capture
+    std::unordered_map<std::uint64_t, std::vector<float>> kept;  ///< Captured rows changed since
+
+    /// Keep the captured value of a row about to change or go away
+    void keep(std::uint64_t id, std::span<const float> row) {
+        if (!added.contains(id)) {
+            kept.try_emplace(id, row.begin(), row.end());
+        }
+    }
+
+    /// The kept row of `id`, or nullptr if it still is the current one
+    [[nodiscard]] const std::vector<float>* find(std::uint64_t id) const {
+        const auto it = kept.find(id);
+        return it != kept.end() ? &it->second : nullptr;
+    }
+};
+
+/// Bytes of rows a capture copies under one shared lock of its index
+inline constexpr std::size_t kCaptureReadBytes = std::size_t{1} << 20;
+
+/**
+ * @brief Call `f` on each capture still being written; forget the others.
+ * @param captures Open captures of an index (guarded by its lock)
+ * @param f Called with each live capture
+ */
+template <typename Capture, typename F>
+void for_each_capture(std::vector<std::weak_ptr<Capture>>& captures, F&& f) {
+    std::erase_if(captures, [&f](const std::weak_ptr<Capture>& weak) {
+        const std::shared_ptr<Capture> capture = weak.lock();
+        if (!capture) {
+            return true;
+        }
+        f(*capture);
+        return false;
+    });
+}
+
 // ============================================================================
 // Internal Interfaces
 // ============================================================================
@@ -53,6 +131,18 @@ public:
      */
     virtual ErrorCode remove(std::uint64_t id) = 0;
 
+    /**
+     * @brief Remove multiple vectors from the index.
+     *
+     * The default implementation removes the IDs one by one. Indexes that can
+     * take their lock once for the whole batch override this.
+     *
+     * @param ids Vector identifiers to remove
+     * @return ErrorCode::Ok on success, ErrorCode::VectorNotFound if any ID
+     *         doesn't exist (in which case nothing is removed)
+     */
+    virtual ErrorCode remove_batch(std::span<const std::uint64_t> ids);
+
     /**
      * @brief Check if a vector exists in the index.
      * @param id Vector identifier to check
@@ -60,6 +150,18 @@ public:
      */
     [[nodiscard]] virtual bool contains(std::uint64_t id) const = 0;
 
+    /**
+     * @brief Copy a stored vector out of the index.
+     *
+     * The index owns the only copy of each vector; VectorDatabase reads
+     * vectors back through this (get(), iteration, persistence).
+     *
+     * @param id Vector identifier
+     * @param out Destination (must hold dimension() floats)
+     * @return true if the vector exists, false otherwise
+     */
+    [[nodiscard]] virtual bool get_vector(std::uint64_t id, std::span<float> out) const = 0;
+
     // -------------------------------------------------------------------------
     // Search Operations
     // -------------------------------------------------------------------------
@@ -76,6 +178,23 @@ public:
         std::size_t k,
         const SearchParams& params) const = 0;
 
+    /**
+     * @brief Search for k nearest neighbors and report per-query statistics.
+     *
+     * The default implementation calls search() and leaves stats untouched.
+     *
+     * @param query Query vector
+     * @param k Number of neighbors to return
+     * @param params Search parameters
+     * @param stats Receives statistics about this query
+     * @return Vector of (id, distance) pairs, sorted by distance
+     */
+    [[nodiscard]] virtual std::vector<SearchResultItem> search_with_stats(
+        std::span<const float> query,
+        std::size_t k,
+        const SearchParams& params,
+        IndexSearchStats& stats) const;
+
     // -------------------------------------------------------------------------
     // Batch Operations
     // -------------------------------------------------------------------------
@@ -87,6 +206,20 @@ public:
      */
     virtual ErrorCode build(std::span<const VectorRecord> vectors) = 0;
 
+    /**
+     * @brief Build index from IDs and a matrix view of their vectors.
+     *
+     * Lets callers build from vectors that already sit in memory (a strided
+     * buffer, a memory-mapped file, or rows referenced by pointer) without
+     * materializing VectorRecords. The default implementation copies into
+     * records and calls build(); indexes override it to read in place.
+     *
+     * @param ids One ID per row of vectors
+     * @param vectors Vector data (rows must equal ids.size())
+     * @return ErrorCode indicating success or failure
+     */
+    virtual ErrorCode build(std::span<const std::uint64_t> ids, MatrixView vectors);
+
     // -------------------------------------------------------------------------
     // Serialization
     // -------------------------------------------------------------------------
@@ -105,6 +238,58 @@ public:
      */
     virtual ErrorCode deserialize(std::istream& in) = 0;
 
+    /**
+     * @brief Pin the current contents for writing out later.
+     *
+     * So that a snapshot needs no copy of the whole index: an immutable
+     * representation is shared, an index updated in place copies its IDs
+     * and keeps the rows and links changed afterwards (see CapturedRows).
+     * The default returns nullopt: the index must be serialized while
+     * writers are held off.
+     *
+     * @return The captured view, or nullopt if the index cannot pin itself
+     */
+    [[nodiscard]] virtual std::optional<IndexCapture> capture() const { return std::nullopt; }
+
+    /**
+     * @brief IDs in the order the index stores their vectors.
+     *
+     * Lets save() lay out the vector file so that the index can later serve
+     * its rows in place (see deserialize_mapped()).
+     *
+     * @return Row -> ID, or empty if the index cannot serve mapped vectors
+     */
+    [[nodiscard]] virtual std::vector<std::uint64_t> storage_order() const { return {}; }
+
+    /**
+     * @brief Deserialize index structure and serve vectors from a mapped file.
+     *
+     * The default implementation ignores the mapping and calls deserialize().
+     *
+     * @param in Input stream written by serialize()
+     * @param vectors Mapped rows in storage_order() as of serialize()
+     * @return ErrorCode indicating success or failure
+     */
+    virtual ErrorCode deserialize_mapped(std::istream& in, const MappedVectors& vectors) {
+        (void)vectors;
+        return deserialize(in);
+    }
+
+    /**
+     * @brief Serve the whole index in place from a mapped serialize() file.
+     *
+     * Nothing is deserialized: the index reads its vectors and structure
+     * straight from the mapping, which it keeps alive.
+     *
+     * @param file Mapping of a file holding exactly one serialize() output
+     * @return ErrorCode::NotImplemented if the index or the file's format
+     *         version cannot be served in place (use deserialize_mapped())
+     */
+    virtual ErrorCode open_mapped(std::shared_ptr<MappedFile> file) {
+        (void)file;
+        return ErrorCode::NotImplemented;
+    }
+
     // -------------------------------------------------------------------------
     // Properties
     // -------------------------------------------------------------------------
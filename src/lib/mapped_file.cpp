@@ -0,0 +1,44 @@
+/**
+ * @file mapped_file.cpp
+ * @brief Implementation of MappedFile class
+ *
+ * @copyright MIT License
+ */
+
+#include "mapped_file.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace lynx {
+
+std::shared_ptr<MappedFile> MappedFile::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    // Read-only and shared: backed by the page cache alone, nothing is
+    // charged against the commit limit
+    const auto size = static_cast<std::size_t>(st.st_size);
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);  // The mapping keeps its own reference to the file
+    if (data == MAP_FAILED) {
+        return nullptr;
+    }
+
+    return std::shared_ptr<MappedFile>(new MappedFile(static_cast<char*>(data), size));
+}
+
+MappedFile::~MappedFile() {
+    ::munmap(data_, size_);
+}
+
+} // namespace lynx
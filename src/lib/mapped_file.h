@@ -0,0 +1,71 @@
+/**
+ * @file mapped_file.h
+ * @brief Memory-mapped snapshot files
+ *
+ * Lets indexes serve vectors straight from a saved file: pages are faulted
+ * in on first access and shared with every other process mapping the same
+ * file, so startup does not read the vectors and datasets larger than RAM
+ * can be searched.
+ *
+ * @copyright MIT License
+ */
+
+#ifndef LYNX_MAPPED_FILE_H
+#define LYNX_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+
+namespace lynx {
+
+/**
+ * @brief Read-only shared mapping of a whole file.
+ *
+ * Pages are the page cache's own, so a mapping costs no committed memory
+ * however large the file is. Indexes never write through it; VectorBlock
+ * keeps overwritten rows on the heap instead. The file must not be
+ * truncated or rewritten in place while mapped; replace it by renaming a
+ * new file over it instead.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Map a file.
+     * @param path File to map
+     * @return The mapping, or nullptr if the file cannot be opened or mapped
+     */
+    [[nodiscard]] static std::shared_ptr<MappedFile> open(const std::string& path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    [[nodiscard]] const char* data() const { return data_; }
+    [[nodiscard]] std::size_t size() const { return size_; }
+
+private:
+    MappedFile(char* data, std::size_t size) : data_(data), size_(size) {}
+
+    char* data_;
+    std::size_t size_;
+};
+
+/**
+ * @brief Location of a saved vector block inside a mapped file.
+ *
+ * Row i (dimension floats, starting at data() + offset) holds the vector
+ * with ID ids[i]. Handed to IVectorIndex::deserialize_mapped().
+ */
+struct MappedVectors {
+    std::shared_ptr<MappedFile> file;    ///< Keeps the mapping alive
+    std::size_t offset = 0;              ///< Byte offset of row 0 (page aligned)
+    std::span<const std::uint64_t> ids;  ///< Row -> ID (points into the mapping)
+};
+
+} // namespace lynx
+
+#endif // LYNX_MAPPED_FILE_H
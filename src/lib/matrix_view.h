@@ -0,0 +1,98 @@
+/**
+ * @file matrix_view.h
+ * @brief Non-owning view over a set of equally sized float rows
+ *
+ * Lets clustering and index builds read vectors in place, whether they sit
+ * in one strided row-major buffer (e.g. a memory-mapped file) or in
+ * separately allocated rows (e.g. VectorRecord::vector), without copying
+ * them into a temporary vector-of-vectors.
+ *
+ * @copyright MIT License
+ */
+
+#ifndef LYNX_MATRIX_VIEW_H
+#define LYNX_MATRIX_VIEW_H
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace lynx {
+
+/**
+ * @brief Read-only view of `rows` vectors of `dim` floats.
+ *
+ * Two layouts are supported:
+ * - Strided: row i starts at data + i * stride (stride >= dim, in floats)
+ * - Row table: row i starts at row_pointers[i]
+ *
+ * The view does not own the data or the row table; both must outlive it.
+ */
+class MatrixView {
+public:
+    MatrixView() = default;
+
+    /**
+     * @brief View a row-major buffer.
+     * @param data First element of row 0
+     * @param rows Number of rows
+     * @param dim Floats per row
+     * @param stride Floats between row starts (0 = dim, i.e. densely packed)
+     */
+    MatrixView(const float* data, std::size_t rows, std::size_t dim, std::size_t stride = 0)
+        : data_(data), rows_(rows), dim_(dim), stride_(stride == 0 ? dim : stride) {}
+
+    /**
+     * @brief View rows given by a table of row pointers.
+     * @param row_pointers One pointer per row
+     * @param dim Floats per row
+     */
+    MatrixView(std::span<const float* const> row_pointers, std::size_t dim)
+        : row_table_(row_pointers.data()), rows_(row_pointers.size()), dim_(dim) {}
+
+    [[nodiscard]] std::size_t rows() const { return rows_; }
+    [[nodiscard]] std::size_t dim() const { return dim_; }
+    [[nodiscard]] bool empty() const { return rows_ == 0; }
+
+    /**
+     * @brief Pointer to the first element of row i.
+     */
+    [[nodiscard]] const float* row_data(std::size_t i) const {
+        return row_table_ != nullptr ? row_table_[i] : data_ + i * stride_;
+    }
+
+    /**
+     * @brief Row i as a span of dim() floats.
+     */
+    [[nodiscard]] std::span<const float> operator[](std::size_t i) const {
+        return {row_data(i), dim_};
+    }
+
+private:
+    const float* data_ = nullptr;
+    const float* const* row_table_ = nullptr;
+    std::size_t rows_ = 0;
+    std::size_t dim_ = 0;
+    std::size_t stride_ = 0;
+};
+
+/**
+ * @brief Collect row pointers for a set of vectors (no data is copied).
+ *
+ * @param rows Range of elements to reference
+ * @param project Maps an element to its vector (anything with data())
+ * @return One pointer per element, suitable for MatrixView's row-table form
+ */
+template <typename Rows, typename Project>
+[[nodiscard]] std::vector<const float*> collect_row_pointers(const Rows& rows, Project project) {
+    std::vector<const float*> pointers;
+    pointers.reserve(std::size(rows));
+    for (const auto& row : rows) {
+        pointers.push_back(project(row).data());
+    }
+    return pointers;
+}
+
+} // namespace lynx
+
+#endif // LYNX_MATRIX_VIEW_H
@@ -0,0 +1,86 @@
+/**
+ * @file metadata_store.cpp
+ * @brief Implementation of MetadataStore class
+ */
+
+#include "metadata_store.h"
+
+namespace lynx {
+
+MetadataStore::Slot MetadataStore::add(std::optional<std::string_view> value) {
+    Entry entry;
+    if (value.has_value()) {
+        entry.offset = bytes_.size();
+        entry.length = static_cast<std::uint32_t>(value->size());
+        bytes_.insert(bytes_.end(), value->begin(), value->end());
+    }
+
+    if (!free_slots_.empty()) {
+        const Slot slot = free_slots_.back();
+        free_slots_.pop_back();
+        entries_[slot] = entry;
+        return slot;
+    }
+    entries_.push_back(entry);
+    return static_cast<Slot>(entries_.size() - 1);
+}
+
+void MetadataStore::remove(Slot slot) {
+    Entry& entry = entries_[slot];
+    if (entry.length != kAbsent) {
+        dead_bytes_ += entry.length;
+    }
+    entry = Entry{};
+    free_slots_.push_back(slot);
+
+    if (dead_bytes_ > 0 && dead_bytes_ * 2 >= bytes_.size()) {
+        compact();
+    }
+}
+
+std::optional<std::string> MetadataStore::get(Slot slot) const {
+    auto value = view(slot);
+    if (!value.has_value()) {
+        return std::nullopt;
+    }
+    return std::string(*value);
+}
+
+std::optional<std::string_view> MetadataStore::view(Slot slot) const {
+    const Entry& entry = entries_[slot];
+    if (entry.length == kAbsent) {
+        return std::nullopt;
+    }
+    return std::string_view(bytes_.data() + entry.offset, entry.length);
+}
+
+void MetadataStore::clear() {
+    bytes_.clear();
+    entries_.clear();
+    free_slots_.clear();
+    dead_bytes_ = 0;
+}
+
+std::size_t MetadataStore::memory_usage() const {
+    return bytes_.capacity() +
+           entries_.capacity() * sizeof(Entry) +
+           free_slots_.capacity() * sizeof(Slot);
+}
+
+void MetadataStore::compact() {
+    std::vector<char> live;
+    live.reserve(bytes_.size() - dead_bytes_);
+    for (Entry& entry : entries_) {
+        if (entry.length == kAbsent) {
+            continue;
+        }
+        const std::uint64_t offset = live.size();
+        live.insert(live.end(), bytes_.begin() + static_cast<std::ptrdiff_t>(entry.offset),
+                    bytes_.begin() + static_cast<std::ptrdiff_t>(entry.offset + entry.length));
+        entry.offset = offset;
+    }
+    bytes_ = std::move(live);
+    dead_bytes_ = 0;
+}
+
+} // namespace lynx
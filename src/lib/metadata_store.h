@@ -0,0 +1,100 @@
+/**
+ * @file metadata_store.h
+ * @brief Arena-backed side store for per-record metadata
+ *
+ * Keeps record metadata out of the ID map: all values are packed into one
+ * byte buffer and addressed through small fixed-size slots, so lookups and
+ * searches that never read metadata do not carry it in their cache lines.
+ *
+ * @copyright MIT License
+ */
+
+#ifndef LYNX_METADATA_STORE_H
+#define LYNX_METADATA_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lynx {
+
+/**
+ * @brief Slot-addressed metadata strings packed into one byte buffer.
+ *
+ * Each slot is an (offset, length) pair into the arena; a record without
+ * metadata costs one slot and no bytes. Freed slots are reused. Bytes of
+ * removed values stay in the arena as holes until they make up half of it,
+ * at which point live values are compacted into a fresh buffer.
+ *
+ * Thread-safety: Not thread-safe. External synchronization required.
+ */
+class MetadataStore {
+public:
+    using Slot = std::uint32_t;
+
+    /**
+     * @brief Store a value.
+     * @param value Metadata (nullopt = record has no metadata)
+     * @return Slot addressing the value
+     */
+    Slot add(std::optional<std::string_view> value);
+
+    /**
+     * @brief Release a slot and its bytes.
+     * @param slot Slot returned by add()
+     */
+    void remove(Slot slot);
+
+    /**
+     * @brief Copy a value out of the store.
+     * @param slot Slot returned by add()
+     * @return The metadata, or nullopt if the record has none
+     */
+    [[nodiscard]] std::optional<std::string> get(Slot slot) const;
+
+    /**
+     * @brief View a value in place.
+     * @param slot Slot returned by add()
+     * @return View into the arena (valid until the next add/remove/clear),
+     *         or nullopt if the record has none
+     */
+    [[nodiscard]] std::optional<std::string_view> view(Slot slot) const;
+
+    /**
+     * @brief Drop all values and slots.
+     */
+    void clear();
+
+    /**
+     * @brief Approximate memory usage in bytes (arena plus slot table).
+     */
+    [[nodiscard]] std::size_t memory_usage() const;
+
+private:
+    /**
+     * @brief Location of one value in the arena.
+     */
+    struct Entry {
+        std::uint64_t offset = 0;       ///< First byte in bytes_
+        std::uint32_t length = kAbsent; ///< Byte count (kAbsent = no metadata)
+    };
+
+    static constexpr std::uint32_t kAbsent = UINT32_MAX;
+
+    /**
+     * @brief Rewrite the arena with live values only.
+     */
+    void compact();
+
+    std::vector<char> bytes_;        ///< Arena holding all values back to back
+    std::vector<Entry> entries_;     ///< Slot -> location
+    std::vector<Slot> free_slots_;   ///< Released slots available for reuse
+    std::size_t dead_bytes_ = 0;     ///< Arena bytes no longer referenced
+};
+
+} // namespace lynx
+
+#endif // LYNX_METADATA_STORE_H
@@ -12,7 +12,10 @@
 #define LYNX_RECORD_ITERATOR_IMPL_H
 
 #include "../include/lynx/lynx.h"
+#include "lynx_intern.h"
+#include "metadata_store.h"
 #include <memory>
+#include <optional>
 #include <unordered_map>
 #include <shared_mutex>
 
@@ -135,6 +138,67 @@ private:
     std::shared_ptr<LockType> lock_;  ///< Shared lock kept alive across copies
 };
 
+/**
+ * @brief Thread-safe iterator that reads vectors from the owning index
+ *
+ * Walks an ID -> metadata slot map while holding a shared lock (like
+ * LockedIteratorImpl) and materializes the current VectorRecord on first
+ * dereference, copying its vector out of the index and its metadata out of
+ * the metadata store. Only the current record is held, so iterating does
+ * not duplicate the stored data.
+ */
+template<typename MapType, typename MutexType>
+class IndexRecordIteratorImpl : public RecordIteratorImpl {
+public:
+    using Iterator = typename MapType::const_iterator;
+    using LockType = std::shared_lock<MutexType>;
+
+    /**
+     * @brief Construct index-backed iterator
+     * @param it Underlying ID -> metadata slot map iterator
+     * @param index Index holding the vectors
+     * @param metadata Store holding the metadata
+     * @param lock Shared lock (will be shared among copies)
+     */
+    IndexRecordIteratorImpl(Iterator it, std::shared_ptr<const IVectorIndex> index,
+                            const MetadataStore& metadata, std::shared_ptr<LockType> lock)
+        : it_(it), index_(std::move(index)), metadata_(&metadata), lock_(std::move(lock)) {}
+
+    const std::pair<const std::uint64_t, VectorRecord>& dereference() const override {
+        if (!current_) {
+            VectorRecord record{it_->first, std::vector<float>(index_->dimension()),
+                                metadata_->get(it_->second)};
+            if (!index_->get_vector(record.id, record.vector)) {
+                record.vector.clear();
+            }
+            current_.emplace(record.id, std::move(record));
+        }
+        return *current_;
+    }
+
+    void increment() override {
+        ++it_;
+        current_.reset();
+    }
+
+    bool equals(const RecordIteratorImpl& other) const override {
+        auto* other_ptr = dynamic_cast<const IndexRecordIteratorImpl*>(&other);
+        if (!other_ptr) return false;
+        return it_ == other_ptr->it_;
+    }
+
+    std::shared_ptr<RecordIteratorImpl> clone() const override {
+        return std::make_shared<IndexRecordIteratorImpl>(it_, index_, *metadata_, lock_);
+    }
+
+private:
+    Iterator it_;
+    std::shared_ptr<const IVectorIndex> index_;
+    const MetadataStore* metadata_;
+    std::shared_ptr<LockType> lock_;  ///< Shared lock kept alive across copies
+    mutable std::optional<std::pair<const std::uint64_t, VectorRecord>> current_;  ///< Materialized record
+};
+
 } // namespace lynx
 
 #endif // LYNX_RECORD_ITERATOR_IMPL_H
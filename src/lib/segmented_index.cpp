@@ -0,0 +1,686 @@
+/**
+ * @file segmented_index.cpp
+ * @brief Implementation of the memtable + immutable segments index
+ *
+ * @copyright MIT License
+ */
+
+#include "segmented_index.h"
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <sstream>
+
+namespace lynx {
+
+namespace {
+
+constexpr char kSegmentMagic[4] = {'L', 'S', 'E', 'G'};
+constexpr std::uint32_t kSegmentVersion = 1;
+
+// Recent tombstones are copied by every remove; beyond this many they are
+// folded into the shared set
+constexpr std::size_t kFoldTombstones = 256;
+
+// A sealed segment is rewritten once tombstones exceed 1/kTombstoneDivisor
+// of its IDs
+constexpr std::size_t kTombstoneDivisor = 4;
+
+template <typename T>
+void write_value(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool read_value(std::istream& in, T& value) {
+    in.read(reinterpret_cast<char*>(&value), sizeof(value));
+    return in.good();
+}
+
+void write_ids(std::ostream& out, std::span<const std::uint64_t> ids) {
+    write_value(out, static_cast<std::uint64_t>(ids.size()));
+    out.write(reinterpret_cast<const char*>(ids.data()),
+              static_cast<std::streamsize>(ids.size_bytes()));
+}
+
+bool read_ids(std::istream& in, std::vector<std::uint64_t>& ids) {
+    std::uint64_t count = 0;
+    if (!read_value(in, count)) {
+        return false;
+    }
+    ids.resize(count);
+    in.read(reinterpret_cast<char*>(ids.data()),
+            static_cast<std::streamsize>(count * sizeof(std::uint64_t)));
+    return in.good();
+}
+
+} // namespace
+
+// ============================================================================
+// Tombstones
+// ============================================================================
+
+bool SegmentedIndex::Tombstones::contains(std::uint64_t id) const {
+    return recent.contains(id) || (folded && folded->contains(id));
+}
+
+std::size_t SegmentedIndex::Tombstones::size() const {
+    return recent.size() + (folded ? folded->size() : 0);
+}
+
+std::shared_ptr<const SegmentedIndex::Tombstones> SegmentedIndex::Tombstones::with(
+    const std::shared_ptr<const Tombstones>& set, std::uint64_t id) {
+    auto next = set ? std::make_shared<Tombstones>(*set) : std::make_shared<Tombstones>();
+    next->recent.insert(id);
+    if (next->recent.size() > kFoldTombstones) {
+        auto folded = next->folded
+                          ? std::make_shared<std::unordered_set<std::uint64_t>>(*next->folded)
+                          : std::make_shared<std::unordered_set<std::uint64_t>>();
+        folded->insert(next->recent.begin(), next->recent.end());
+        next->folded = std::move(folded);
+        next->recent.clear();
+    }
+    return next;
+}
+
+std::shared_ptr<const SegmentedIndex::Tombstones> SegmentedIndex::Tombstones::from(
+    std::unordered_set<std::uint64_t> ids) {
+    if (ids.empty()) {
+        return nullptr;
+    }
+    auto set = std::make_shared<Tombstones>();
+    set->folded = std::make_shared<const std::unordered_set<std::uint64_t>>(std::move(ids));
+    return set;
+}
+
+// ============================================================================
+// Constructor and Destructor
+// ============================================================================
+
+SegmentedIndex::SegmentedIndex(std::size_t dimension, DistanceMetric metric,
+                               std::size_t memtable_capacity, std::size_t max_sealed_segments,
+                               SegmentFactory make_segment)
+    : dimension_(dimension),
+      metric_(metric),
+      memtable_capacity_(std::max<std::size_t>(1, memtable_capacity)),
+      max_sealed_segments_(std::max<std::size_t>(1, max_sealed_segments)),
+      make_segment_(std::move(make_segment)),
+      current_(std::make_shared<const SegmentList>(SegmentList{make_memtable(), {}})) {
+    worker_ = std::thread(&SegmentedIndex::background_worker, this);
+}
+
+SegmentedIndex::~SegmentedIndex() {
+    {
+        std::lock_guard guard(work_mutex_);
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+    worker_.join();
+}
+
+std::shared_ptr<FlatIndex> SegmentedIndex::make_memtable() const {
+    // Small enough that one scan thread is fastest
+    return std::make_shared<FlatIndex>(dimension_, metric_, 1);
+}
+
+void SegmentedIndex::publish_locked(SegmentList list) {
+    current_.store(std::make_shared<const SegmentList>(std::move(list)), std::memory_order_release);
+}
+
+// ============================================================================
+// IVectorIndex Interface - Vector Operations
+// ============================================================================
+
+ErrorCode SegmentedIndex::add(std::uint64_t id, std::span<const float> vector) {
+    if (vector.size() != dimension_) {
+        return ErrorCode::DimensionMismatch;
+    }
+
+    std::lock_guard lock(write_mutex_);
+    const std::shared_ptr<const SegmentList> current = snapshot();
+
+    // The new vector is stored first: if that fails, the old one stays
+    ErrorCode result = current->memtable->add(id, vector);
+    if (result != ErrorCode::Ok) {
+        return result;
+    }
+
+    // Adding an ID that lives in a segment replaces it (as FlatIndex does).
+    // The tombstone and a freeze go out in one list
+    std::optional<SegmentList> list;
+    for (std::size_t s = 0; s < current->segments.size(); ++s) {
+        const Segment& segment = current->segments[s];
+        if (!segment.is_deleted(id) && segment.index->contains(id)) {
+            list = *current;
+            list->segments[s].deleted = Tombstones::with(segment.deleted, id);
+            break;
+        }
+    }
+    const bool full = current->memtable->size() >= memtable_capacity_;
+    if (full) {
+        if (!list) {
+            list = *current;
+        }
+        freeze_memtable(*list);
+    }
+    if (list) {
+        publish_locked(std::move(*list));
+    }
+    if (full) {
+        request_work();
+    }
+    return ErrorCode::Ok;
+}
+
+ErrorCode SegmentedIndex::remove(std::uint64_t id) {
+    std::lock_guard lock(write_mutex_);
+    const std::shared_ptr<const SegmentList> current = snapshot();
+
+    if (current->memtable->contains(id)) {
+        return current->memtable->remove(id);
+    }
+
+    // Segments are immutable: publish a tombstone instead
+    for (std::size_t s = current->segments.size(); s-- > 0;) {
+        const Segment& segment = current->segments[s];
+        if (!segment.is_deleted(id) && segment.index->contains(id)) {
+            SegmentList list = *current;
+            list.segments[s].deleted = Tombstones::with(segment.deleted, id);
+            const bool compact = !compaction_sources(list).empty();
+            publish_locked(std::move(list));
+            if (compact) {
+                request_work();
+            }
+            return ErrorCode::Ok;
+        }
+    }
+    return ErrorCode::VectorNotFound;
+}
+
+bool SegmentedIndex::contains(std::uint64_t id) const {
+    const std::shared_ptr<const SegmentList> current = snapshot();
+    if (current->memtable->contains(id)) {
+        return true;
+    }
+    return std::any_of(current->segments.begin(), current->segments.end(),
+                       [id](const Segment& segment) {
+                           return !segment.is_deleted(id) && segment.index->contains(id);
+                       });
+}
+
+bool SegmentedIndex::get_vector(std::uint64_t id, std::span<float> out) const {
+    const std::shared_ptr<const SegmentList> current = snapshot();
+    if (current->memtable->get_vector(id, out)) {
+        return true;
+    }
+    for (auto it = current->segments.rbegin(); it != current->segments.rend(); ++it) {
+        if (!it->is_deleted(id) && it->index->get_vector(id, out)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============================================================================
+// IVectorIndex Interface - Search Operations
+// ============================================================================
+
+std::vector<SearchResultItem> SegmentedIndex::search(std::span<const float> query,
+                                                     std::size_t k,
+                                                     const SearchParams& params) const {
+    IndexSearchStats stats;
+    return search_with_stats(query, k, params, stats);
+}
+
+std::vector<SearchResultItem> SegmentedIndex::search_with_stats(std::span<const float> query,
+                                                                std::size_t k,
+                                                                const SearchParams& params,
+                                                                IndexSearchStats& stats) const {
+    if (query.size() != dimension_ || k == 0) {
+        return {};
+    }
+
+    const std::shared_ptr<const SegmentList> current = snapshot();
+    std::vector<SearchResultItem> merged = current->memtable->search(query, k, params);
+
+    for (const auto& segment : current->segments) {
+        IndexSearchStats segment_stats;
+        std::vector<SearchResultItem> items =
+            search_segment(segment, query, k, params, segment_stats);
+
+        // An ID being replaced is briefly in the memtable and, not yet
+        // tombstoned, in its old segment: the memtable copy is the current one
+        std::erase_if(items, [&current](const SearchResultItem& item) {
+            return current->memtable->contains(item.id);
+        });
+        stats.clusters_probed += segment_stats.clusters_probed;
+        merged.insert(merged.end(), items.begin(), items.end());
+    }
+
+    auto closer = [](const SearchResultItem& a, const SearchResultItem& b) {
+        return a.distance < b.distance || (a.distance == b.distance && a.id < b.id);
+    };
+    if (merged.size() > k) {
+        std::partial_sort(merged.begin(), merged.begin() + static_cast<std::ptrdiff_t>(k),
+                          merged.end(), closer);
+        merged.resize(k);
+    } else {
+        std::sort(merged.begin(), merged.end(), closer);
+    }
+    return merged;
+}
+
+std::vector<SearchResultItem> SegmentedIndex::search_segment(const Segment& segment,
+                                                             std::span<const float> query,
+                                                             std::size_t k,
+                                                             const SearchParams& params,
+                                                             IndexSearchStats& stats) {
+    if (!segment.deleted) {
+        return segment.index->search_with_stats(query, k, params, stats);
+    }
+
+    // Some indexes filter after selecting candidates and IVF does not
+    // filter at all, so tombstones are dropped here as well
+    SearchParams live = params;
+    live.filter = [&segment, &params](std::uint64_t id) {
+        return !segment.deleted->contains(id) && (!params.filter || (*params.filter)(id));
+    };
+    const std::size_t most = k + segment.deleted->size();
+    std::size_t fetch = k + std::min(k, segment.deleted->size());
+    while (true) {
+        stats = IndexSearchStats{};
+        std::vector<SearchResultItem> items =
+            segment.index->search_with_stats(query, fetch, live, stats);
+        const bool exhausted = items.size() < fetch;
+        std::erase_if(items, [&live](const SearchResultItem& item) {
+            return !(*live.filter)(item.id);
+        });
+        if (items.size() >= k || exhausted || fetch >= most) {
+            return items;
+        }
+        fetch = std::min(most, fetch * 2);
+    }
+}
+
+// ============================================================================
+// IVectorIndex Interface - Batch Operations
+// ============================================================================
+
+ErrorCode SegmentedIndex::build(std::span<const VectorRecord> vectors) {
+    std::vector<std::uint64_t> ids;
+    ids.reserve(vectors.size());
+    for (const auto& record : vectors) {
+        if (record.vector.size() != dimension_) {
+            return ErrorCode::DimensionMismatch;
+        }
+        ids.push_back(record.id);
+    }
+    const std::vector<const float*> rows =
+        collect_row_pointers(vectors, [](const VectorRecord& record) -> const auto& {
+            return record.vector;
+        });
+    return build(ids, MatrixView(rows, dimension_));
+}
+
+ErrorCode SegmentedIndex::build(std::span<const std::uint64_t> ids, MatrixView vectors) {
+    if (ids.size() != vectors.rows()) {
+        return ErrorCode::InvalidParameter;
+    }
+
+    // Built without holding the lock; nothing else can see it yet
+    Segment segment;
+    segment.index = make_segment_();
+    segment.ids = std::make_shared<const std::vector<std::uint64_t>>(ids.begin(), ids.end());
+    segment.sealed = true;
+    ErrorCode result = segment.index->build(ids, vectors);
+    if (result != ErrorCode::Ok) {
+        return result;
+    }
+
+    SegmentList list{make_memtable(), {}};
+    if (!segment.ids->empty()) {
+        list.segments.push_back(std::move(segment));
+    }
+    std::lock_guard lock(write_mutex_);
+    publish_locked(std::move(list));
+    return ErrorCode::Ok;
+}
+
+// ============================================================================
+// IVectorIndex Interface - Serialization
+// ============================================================================
+
+ErrorCode SegmentedIndex::serialize(std::ostream& out) const {
+    const std::optional<IndexCapture> captured = capture();
+    return captured ? captured->serialize(out) : ErrorCode::IOError;
+}
+
+std::optional<IndexCapture> SegmentedIndex::capture() const {
+    // Writers wait while the memtable is copied, so it matches the
+    // segments' tombstones; the segments themselves are only pinned
+    std::shared_ptr<const SegmentList> list;
+    std::ostringstream image;
+    std::vector<std::uint64_t> memtable_ids;
+    {
+        std::lock_guard lock(write_mutex_);
+        list = snapshot();
+        if (list->memtable->serialize(image) != ErrorCode::Ok) {
+            return std::nullopt;
+        }
+        memtable_ids = list->memtable->storage_order();
+    }
+
+    auto memtable_image = std::make_shared<const std::string>(std::move(image).str());
+    IndexCapture captured;
+    captured.serialize = [dimension = dimension_, list, memtable_image](std::ostream& out) {
+        return write_list(out, dimension, *list, *memtable_image);
+    };
+    captured.ids = [list, memtable_ids = std::move(memtable_ids)]() {
+        std::vector<std::uint64_t> ids = memtable_ids;
+        for (const auto& segment : list->segments) {
+            for (std::uint64_t id : *segment.ids) {
+                if (!segment.is_deleted(id)) {
+                    ids.push_back(id);
+                }
+            }
+        }
+        return ids;
+    };
+    return captured;
+}
+
+ErrorCode SegmentedIndex::write_list(std::ostream& out, std::size_t dimension,
+                                     const SegmentList& list, const std::string& memtable_image) {
+    out.write(kSegmentMagic, sizeof(kSegmentMagic));
+    write_value(out, kSegmentVersion);
+    write_value(out, static_cast<std::uint64_t>(dimension));
+    write_value(out, static_cast<std::uint64_t>(list.segments.size()));
+    out.write(memtable_image.data(), static_cast<std::streamsize>(memtable_image.size()));
+
+    // Per segment: sealed flag, IDs, tombstones, then the index itself
+    for (const auto& segment : list.segments) {
+        write_value(out, static_cast<std::uint8_t>(segment.sealed ? 1 : 0));
+        write_ids(out, *segment.ids);
+        std::vector<std::uint64_t> deleted;
+        deleted.reserve(segment.deleted_count());
+        if (segment.deleted) {
+            segment.deleted->for_each([&deleted](std::uint64_t id) { deleted.push_back(id); });
+        }
+        write_ids(out, deleted);
+        ErrorCode result = segment.index->serialize(out);
+        if (result != ErrorCode::Ok) {
+            return result;
+        }
+    }
+    return out.good() ? ErrorCode::Ok : ErrorCode::IOError;
+}
+
+ErrorCode SegmentedIndex::deserialize(std::istream& in) {
+    try {
+        char magic[sizeof(kSegmentMagic)];
+        in.read(magic, sizeof(magic));
+        std::uint32_t version = 0;
+        std::uint64_t dimension = 0;
+        std::uint64_t segment_count = 0;
+        if (!in.good() || std::memcmp(magic, kSegmentMagic, sizeof(magic)) != 0 ||
+            !read_value(in, version) || version != kSegmentVersion ||
+            !read_value(in, dimension) || !read_value(in, segment_count)) {
+            return ErrorCode::IOError;
+        }
+        if (dimension != dimension_) {
+            return ErrorCode::DimensionMismatch;
+        }
+
+        // Everything is read into a new list and published at the end
+        SegmentList list{make_memtable(), {}};
+        ErrorCode result = list.memtable->deserialize(in);
+        if (result != ErrorCode::Ok) {
+            return result;
+        }
+
+        for (std::uint64_t s = 0; s < segment_count; ++s) {
+            Segment segment;
+            std::uint8_t sealed = 0;
+            std::vector<std::uint64_t> ids;
+            std::vector<std::uint64_t> deleted;
+            if (!read_value(in, sealed) || !read_ids(in, ids) || !read_ids(in, deleted)) {
+                return ErrorCode::IOError;
+            }
+            segment.sealed = sealed != 0;
+            segment.ids = std::make_shared<const std::vector<std::uint64_t>>(std::move(ids));
+            segment.deleted = Tombstones::from({deleted.begin(), deleted.end()});
+            segment.index = segment.sealed ? make_segment_() : make_memtable();
+            result = segment.index->deserialize(in);
+            if (result != ErrorCode::Ok) {
+                return result;
+            }
+            list.segments.push_back(std::move(segment));
+        }
+
+        const bool work = has_work(list);
+        {
+            std::lock_guard lock(write_mutex_);
+            publish_locked(std::move(list));
+        }
+        if (work) {
+            request_work();
+        }
+        return ErrorCode::Ok;
+
+    } catch (const std::exception&) {
+        return ErrorCode::IOError;
+    }
+}
+
+// ============================================================================
+// IVectorIndex Interface - Properties
+// ============================================================================
+
+std::size_t SegmentedIndex::size() const {
+    const std::shared_ptr<const SegmentList> current = snapshot();
+    std::size_t total = current->memtable->size();
+    for (const auto& segment : current->segments) {
+        total += segment.live_count();
+    }
+    return total;
+}
+
+std::size_t SegmentedIndex::memory_usage() const {
+    const std::shared_ptr<const SegmentList> current = snapshot();
+    std::size_t total = sizeof(*this) + current->memtable->memory_usage();
+    for (const auto& segment : current->segments) {
+        total += segment.index->memory_usage() +
+                 segment.ids->capacity() * sizeof(std::uint64_t) +
+                 segment.deleted_count() * (sizeof(std::uint64_t) + sizeof(void*));
+    }
+    return total;
+}
+
+// ============================================================================
+// Segment Management
+// ============================================================================
+
+std::size_t SegmentedIndex::segment_count() const {
+    return snapshot()->segments.size();
+}
+
+void SegmentedIndex::wait_idle() const {
+    std::unique_lock guard(work_mutex_);
+    work_cv_.wait(guard, [this] { return stop_ || (!work_requested_ && !working_); });
+}
+
+void SegmentedIndex::freeze_memtable(SegmentList& list) const {
+    Segment frozen;
+    frozen.ids = std::make_shared<const std::vector<std::uint64_t>>(list.memtable->storage_order());
+    frozen.index = std::move(list.memtable);
+    list.segments.push_back(std::move(frozen));
+    list.memtable = make_memtable();
+}
+
+std::size_t SegmentedIndex::tier_of(std::size_t live) const {
+    const std::size_t fanout = max_sealed_segments_ + 1;
+    std::size_t tier = 0;
+    for (std::size_t bound = memtable_capacity_; live > bound; ++tier) {
+        if (bound > std::numeric_limits<std::size_t>::max() / fanout) {
+            return tier + 1;
+        }
+        bound *= fanout;
+    }
+    return tier;
+}
+
+std::vector<std::size_t> SegmentedIndex::compaction_sources(const SegmentList& list) const {
+    std::map<std::size_t, std::vector<std::size_t>> tiers;
+    for (std::size_t s = 0; s < list.segments.size(); ++s) {
+        const Segment& segment = list.segments[s];
+        if (!segment.sealed) {
+            continue;
+        }
+        if (segment.deleted_count() * kTombstoneDivisor > segment.ids->size()) {
+            return {s};
+        }
+        tiers[tier_of(segment.live_count())].push_back(s);
+    }
+    for (auto& [tier, positions] : tiers) {
+        if (positions.size() > max_sealed_segments_) {
+            return std::move(positions);
+        }
+    }
+    return {};
+}
+
+bool SegmentedIndex::has_work(const SegmentList& list) const {
+    return std::any_of(list.segments.begin(), list.segments.end(),
+                       [](const Segment& segment) { return !segment.sealed; }) ||
+           !compaction_sources(list).empty();
+}
+
+bool SegmentedIndex::run_background_step() {
+    // 1. Pick the sources: the oldest frozen segment, else a compaction.
+    // Only this thread replaces segments, so they stay in this order
+    std::vector<Segment> sources;
+    bool compaction = false;
+    {
+        const std::shared_ptr<const SegmentList> current = snapshot();
+        auto frozen = std::find_if(current->segments.begin(), current->segments.end(),
+                                   [](const Segment& segment) { return !segment.sealed; });
+        compaction = frozen == current->segments.end();
+        if (compaction) {
+            for (std::size_t s : compaction_sources(*current)) {
+                sources.push_back(current->segments[s]);
+            }
+        } else {
+            sources.push_back(*frozen);
+        }
+    }
+    if (sources.empty()) {
+        return false;
+    }
+
+    // 2. Gather their live vectors and build the new segment, unlocked:
+    // the sources are never modified, only tombstoned
+    Segment built;
+    built.index = make_segment_();
+    built.sealed = true;
+    std::vector<std::uint64_t> ids;
+    std::vector<float> vectors;
+    for (const auto& source : sources) {
+        for (std::uint64_t id : *source.ids) {
+            if (source.is_deleted(id)) {
+                continue;
+            }
+            const std::size_t row = ids.size();
+            vectors.resize((row + 1) * dimension_);
+            if (source.index->get_vector(id, std::span<float>(vectors).subspan(row * dimension_,
+                                                                              dimension_))) {
+                ids.push_back(id);
+            }
+        }
+    }
+    vectors.resize(ids.size() * dimension_);
+    const bool ok = ids.empty() ||
+                    built.index->build(ids, MatrixView(vectors.data(), ids.size(), dimension_)) ==
+                        ErrorCode::Ok;
+    built.ids = std::make_shared<const std::vector<std::uint64_t>>(std::move(ids));
+
+    // 3. Swap it in, carrying over tombstones recorded during the build
+    std::lock_guard lock(write_mutex_);
+    SegmentList list = *snapshot();
+    std::vector<std::size_t> positions;
+    for (const auto& source : sources) {
+        auto it = std::find_if(list.segments.begin(), list.segments.end(),
+                               [&source](const Segment& segment) {
+                                   return segment.index == source.index;
+                               });
+        if (it == list.segments.end()) {
+            return true;  // Replaced meanwhile by build() or deserialize()
+        }
+        positions.push_back(static_cast<std::size_t>(it - list.segments.begin()));
+    }
+    if (!ok) {
+        // A frozen segment that cannot be built stays a searchable Flat
+        // segment; a failed compaction keeps its inputs
+        if (!compaction) {
+            list.segments[positions.front()].sealed = true;
+            publish_locked(std::move(list));
+            return true;
+        }
+        return false;
+    }
+    std::unordered_set<std::uint64_t> carried;
+    for (std::size_t s = 0; s < positions.size(); ++s) {
+        const Segment& now = list.segments[positions[s]];
+        if (now.deleted && now.deleted != sources[s].deleted) {
+            now.deleted->for_each([&carried, &source = sources[s]](std::uint64_t id) {
+                if (!source.is_deleted(id)) {
+                    carried.insert(id);
+                }
+            });
+        }
+    }
+    built.deleted = Tombstones::from(std::move(carried));
+    const std::size_t insert_at = positions.front();
+    for (auto it = positions.rbegin(); it != positions.rend(); ++it) {
+        list.segments.erase(list.segments.begin() + static_cast<std::ptrdiff_t>(*it));
+    }
+    if (!built.ids->empty()) {
+        list.segments.insert(list.segments.begin() + static_cast<std::ptrdiff_t>(insert_at),
+                             std::move(built));
+    }
+    publish_locked(std::move(list));
+    return true;
+}
+
+void SegmentedIndex::request_work() {
+    {
+        std::lock_guard guard(work_mutex_);
+        work_requested_ = true;
+    }
+    work_cv_.notify_all();
+}
+
+void SegmentedIndex::background_worker() {
+    std::unique_lock guard(work_mutex_);
+    while (true) {
+        work_cv_.wait(guard, [this] { return work_requested_ || stop_; });
+        if (stop_) {
+            return;
+        }
+        work_requested_ = false;
+        working_ = true;
+
+        // One build or compaction per step, until nothing is left
+        guard.unlock();
+        while (!stop_ && run_background_step()) {
+        }
+        guard.lock();
+        working_ = false;
+        work_cv_.notify_all();
+    }
+}
+
+} // namespace lynx
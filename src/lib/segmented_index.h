@@ -0,0 +1,329 @@
+/**
+ * @file segmented_index.h
+ * @brief LSM-style index: mutable memtable plus immutable segments
+ *
+ * Writes go to a small FlatIndex (the memtable). When it is full it is
+ * frozen, and a background thread builds an immutable segment of the
+ * configured index type from it. Searches fan out over the memtable and
+ * every segment and merge the results. Compaction merges sealed segments
+ * of similar size and drops removed vectors.
+ *
+ * @copyright MIT License
+ */
+
+#ifndef LYNX_SEGMENTED_INDEX_H
+#define LYNX_SEGMENTED_INDEX_H
+
+#include "../include/lynx/lynx.h"
+#include "lynx_intern.h"
+#include "flat_index.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace lynx {
+
+/**
+ * @brief Index made of a mutable memtable and immutable segments.
+ *
+ * Inserts only touch the memtable, so they never wait for an HNSW graph
+ * insert or an IVF assignment, and the segments are never written after
+ * they are built: a segment searched by readers has no writer to contend
+ * with. Removing a vector that lives in a segment records a tombstone for
+ * that segment; tombstoned IDs are filtered out of its search results and
+ * dropped when the segment is compacted.
+ *
+ * Segment lifecycle:
+ * - Frozen: a full memtable, still a FlatIndex, waiting for its build
+ * - Sealed: built by the background thread with the segment factory
+ * A bulk build() creates one sealed segment directly, on the caller's thread.
+ *
+ * Compaction is size-tiered. A sealed segment's tier is the number of times
+ * the memtable capacity must be multiplied by (max_sealed_segments + 1) to
+ * hold its live vectors; when a tier holds more than max_sealed_segments
+ * segments, those segments (and only those) are merged, which lands the
+ * result one tier up. Every vector is therefore rewritten once per tier,
+ * O(log N) times, rather than on every compaction. A segment whose
+ * tombstones exceed a quarter of its IDs is rewritten on its own.
+ *
+ * Thread-safety: This class is thread-safe. The memtable pointer and the
+ * segment list are published together as an immutable SegmentList through
+ * an atomic shared_ptr: readers load it and never lock, so a search never
+ * waits for a writer. Writers are serialized by a mutex and publish a new
+ * list (removes included: tombstone sets are copy-on-write); segment builds
+ * run without holding it. A vector that replaces one in a segment is
+ * added to the memtable before the old copy is tombstoned; searches drop
+ * segment results whose ID is in the memtable.
+ */
+class SegmentedIndex : public IVectorIndex {
+public:
+    /// Creates an empty index for a sealed segment
+    using SegmentFactory = std::function<std::shared_ptr<IVectorIndex>()>;
+
+    /**
+     * @brief Construct an empty segmented index.
+     * @param dimension Vector dimensionality
+     * @param metric Distance metric (used by the memtable)
+     * @param memtable_capacity Vectors per memtable before it is frozen (> 0)
+     * @param max_sealed_segments Sealed segments per size tier before they are
+     *        merged (> 0)
+     * @param make_segment Factory for sealed segment indexes
+     */
+    SegmentedIndex(std::size_t dimension, DistanceMetric metric,
+                   std::size_t memtable_capacity, std::size_t max_sealed_segments,
+                   SegmentFactory make_segment);
+
+    /**
+     * @brief Destructor. Stops the background thread; pending builds are
+     *        abandoned (their vectors are still in memory).
+     */
+    ~SegmentedIndex() override;
+
+    SegmentedIndex(const SegmentedIndex&) = delete;
+    SegmentedIndex& operator=(const SegmentedIndex&) = delete;
+
+    // -------------------------------------------------------------------------
+    // IVectorIndex Interface Implementation
+    // -------------------------------------------------------------------------
+
+    ErrorCode add(std::uint64_t id, std::span<const float> vector) override;
+    ErrorCode remove(std::uint64_t id) override;
+    [[nodiscard]] bool contains(std::uint64_t id) const override;
+    [[nodiscard]] bool get_vector(std::uint64_t id, std::span<float> out) const override;
+
+    /**
+     * @brief Search every segment and merge the k nearest.
+     *
+     * Approximate segments answer with their own recall; the merged list
+     * is sorted by distance, ties by ascending ID.
+     */
+    [[nodiscard]] std::vector<SearchResultItem> search(
+        std::span<const float> query,
+        std::size_t k,
+        const SearchParams& params) const override;
+
+    /**
+     * @brief Search and sum clusters_probed over the segments.
+     */
+    [[nodiscard]] std::vector<SearchResultItem> search_with_stats(
+        std::span<const float> query,
+        std::size_t k,
+        const SearchParams& params,
+        IndexSearchStats& stats) const override;
+
+    /**
+     * @brief Replace the contents with one sealed segment built from `vectors`.
+     */
+    ErrorCode build(std::span<const VectorRecord> vectors) override;
+
+    /**
+     * @brief Replace the contents with one sealed segment, reading in place.
+     */
+    ErrorCode build(std::span<const std::uint64_t> ids, MatrixView vectors) override;
+
+    /**
+     * @brief Write the memtable and every segment with its tombstones.
+     *
+     * Frozen segments are written as Flat and queued for building again
+     * after deserialize().
+     */
+    ErrorCode serialize(std::ostream& out) const override;
+    ErrorCode deserialize(std::istream& in) override;
+
+    /**
+     * @brief Pin the segment list and copy the memtable.
+     *
+     * Segments are immutable, so the capture costs one memtable (at most
+     * memtable_capacity vectors) whatever the index size. Segments replaced
+     * by compaction stay in memory until the capture is released.
+     */
+    [[nodiscard]] std::optional<IndexCapture> capture() const override;
+
+    [[nodiscard]] std::size_t size() const override;
+    [[nodiscard]] std::size_t dimension() const override { return dimension_; }
+    [[nodiscard]] std::size_t memory_usage() const override;
+
+    // -------------------------------------------------------------------------
+    // Segment Management
+    // -------------------------------------------------------------------------
+
+    /**
+     * @brief Number of frozen and sealed segments (the memtable excluded).
+     */
+    [[nodiscard]] std::size_t segment_count() const;
+
+    /**
+     * @brief Block until no segment is waiting to be built or compacted.
+     */
+    void wait_idle() const;
+
+private:
+    /**
+     * @brief Immutable set of removed IDs.
+     *
+     * A remove publishes a new set: the recent IDs are copied, the folded
+     * older ones are shared until recent grows past kFoldTombstones.
+     */
+    struct Tombstones {
+        std::shared_ptr<const std::unordered_set<std::uint64_t>> folded; ///< May be nullptr
+        std::unordered_set<std::uint64_t> recent;                        ///< Copied on every remove
+
+        [[nodiscard]] bool contains(std::uint64_t id) const;
+        [[nodiscard]] std::size_t size() const;
+
+        /**
+         * @brief Copy of `set` (nullptr = empty) with `id` added.
+         */
+        [[nodiscard]] static std::shared_ptr<const Tombstones> with(
+            const std::shared_ptr<const Tombstones>& set, std::uint64_t id);
+
+        /**
+         * @brief Set holding `ids` (nullptr if empty).
+         */
+        [[nodiscard]] static std::shared_ptr<const Tombstones> from(
+            std::unordered_set<std::uint64_t> ids);
+
+        template <typename Fn>
+        void for_each(Fn&& fn) const {
+            if (folded) {
+                for (std::uint64_t id : *folded) {
+                    fn(id);
+                }
+            }
+            for (std::uint64_t id : recent) {
+                fn(id);
+            }
+        }
+    };
+
+    /**
+     * @brief One immutable segment. Copies share everything but the flag.
+     */
+    struct Segment {
+        std::shared_ptr<IVectorIndex> index;                     ///< FlatIndex while frozen
+        std::shared_ptr<const std::vector<std::uint64_t>> ids;   ///< Every ID in index
+        std::shared_ptr<const Tombstones> deleted;               ///< Subset of ids; nullptr = none
+        bool sealed = false;                                     ///< Built with the segment factory
+
+        [[nodiscard]] bool is_deleted(std::uint64_t id) const {
+            return deleted && deleted->contains(id);
+        }
+        [[nodiscard]] std::size_t deleted_count() const { return deleted ? deleted->size() : 0; }
+        [[nodiscard]] std::size_t live_count() const { return ids->size() - deleted_count(); }
+    };
+
+    /**
+     * @brief What readers see: the memtable and the segments, oldest first.
+     *
+     * Never modified once published. The memtable is the one mutable part;
+     * FlatIndex locks internally.
+     */
+    struct SegmentList {
+        std::shared_ptr<FlatIndex> memtable;
+        std::vector<Segment> segments;
+    };
+
+    /**
+     * @brief Create an empty memtable.
+     */
+    [[nodiscard]] std::shared_ptr<FlatIndex> make_memtable() const;
+
+    /**
+     * @brief The current segment list.
+     */
+    [[nodiscard]] std::shared_ptr<const SegmentList> snapshot() const {
+        return current_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Make `list` the current segment list. Caller holds write_mutex_.
+     */
+    void publish_locked(SegmentList list);
+
+    /**
+     * @brief Write `list` in the serialize() format.
+     * @param memtable_image The list's memtable, serialized
+     */
+    static ErrorCode write_list(std::ostream& out, std::size_t dimension,
+                                const SegmentList& list, const std::string& memtable_image);
+
+    /**
+     * @brief Search one segment, dropping its tombstones.
+     *
+     * Tombstones may take up results the index had selected, so the first
+     * attempt asks for at most k extra; it is repeated with twice as many
+     * only while fewer than k results survive and the segment has more.
+     */
+    [[nodiscard]] static std::vector<SearchResultItem> search_segment(
+        const Segment& segment,
+        std::span<const float> query,
+        std::size_t k,
+        const SearchParams& params,
+        IndexSearchStats& stats);
+
+    /**
+     * @brief Size tier of a sealed segment holding `live` vectors.
+     */
+    [[nodiscard]] std::size_t tier_of(std::size_t live) const;
+
+    /**
+     * @brief Positions of the segments the next compaction should merge:
+     *        one segment hollowed out by tombstones, else the lowest tier
+     *        with more than max_sealed_segments segments.
+     * @return Ascending positions; empty if nothing needs compacting
+     */
+    [[nodiscard]] std::vector<std::size_t> compaction_sources(const SegmentList& list) const;
+
+    /**
+     * @brief Freeze a full memtable into `list` and start a new one.
+     */
+    void freeze_memtable(SegmentList& list) const;
+
+    /**
+     * @brief Whether the background thread has work in `list`.
+     */
+    [[nodiscard]] bool has_work(const SegmentList& list) const;
+
+    /**
+     * @brief Build one segment from the live vectors of `sources` (the
+     *        oldest frozen segment, or the compaction sources) and swap it in.
+     * @return false if there was nothing to do
+     */
+    bool run_background_step();
+
+    /**
+     * @brief Background thread body.
+     */
+    void background_worker();
+
+    /**
+     * @brief Wake the background thread.
+     */
+    void request_work();
+
+    std::size_t dimension_;
+    DistanceMetric metric_;
+    std::size_t memtable_capacity_;
+    std::size_t max_sealed_segments_;
+    SegmentFactory make_segment_;
+
+    mutable std::mutex write_mutex_;                        ///< Serializes writers and swaps
+    std::atomic<std::shared_ptr<const SegmentList>> current_; ///< Published segment list
+
+    std::thread worker_;                           ///< Builds and compacts segments
+    mutable std::mutex work_mutex_;                ///< Protects the flags below
+    mutable std::condition_variable work_cv_;      ///< Wakes the worker / idle waiters
+    bool work_requested_ = false;                  ///< Pending wake-up
+    bool working_ = false;                         ///< Worker is building
+    std::atomic<bool> stop_{false};                ///< Worker shutdown request
+};
+
+} // namespace lynx
+
+#endif // LYNX_SEGMENTED_INDEX_H
@@ -0,0 +1,145 @@
+/**
+ * @file snapshot_delta.cpp
+ * @brief Implementation of delta file encoding
+ *
+ * @copyright MIT License
+ */
+
+#include "snapshot_delta.h"
+#include "utils.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace lynx {
+
+namespace {
+
+constexpr std::uint32_t kDeltaMagic = 0x4C444C54;   ///< "LDLT" in hex
+constexpr std::uint32_t kDeltaVersion = 1;
+
+struct DeltaFileHeader {
+    std::uint32_t magic = 0;
+    std::uint32_t version = 0;
+    std::uint64_t dimension = 0;
+    std::uint64_t sequence = 0;
+    std::uint64_t removed_count = 0;
+    std::uint64_t record_count = 0;
+    std::uint32_t body_crc = 0;
+    std::uint32_t reserved = 0;
+};
+static_assert(sizeof(DeltaFileHeader) == 48);
+
+/// Append raw bytes of a block to the body
+template <typename T>
+void append_block(std::string& body, const T* data, std::size_t count) {
+    body.append(reinterpret_cast<const char*>(data), count * sizeof(T));
+}
+
+/// Copy a block out of the body; false if it runs past the end
+template <typename T>
+bool take_block(const std::string& body, std::size_t& position, T* data, std::size_t count) {
+    const std::size_t bytes = count * sizeof(T);
+    if (bytes > body.size() - position) {
+        return false;
+    }
+    std::memcpy(data, body.data() + position, bytes);
+    position += bytes;
+    return true;
+}
+
+} // namespace
+
+ErrorCode write_snapshot_delta(const std::string& path, std::size_t dimension,
+                               const SnapshotDelta& delta) {
+    if (delta.vectors.size() != delta.ids.size() * dimension ||
+        delta.metadata.size() != delta.ids.size()) {
+        return ErrorCode::InvalidParameter;
+    }
+
+    // The whole body is encoded first so the header can carry its checksum;
+    // deltas are small by design
+    std::string body;
+    append_block(body, delta.removed_ids.data(), delta.removed_ids.size());
+    append_block(body, delta.ids.data(), delta.ids.size());
+    append_block(body, delta.vectors.data(), delta.vectors.size());
+    for (const auto& metadata : delta.metadata) {
+        const std::uint32_t length = metadata ? static_cast<std::uint32_t>(metadata->size()) : 0;
+        append_block(body, &length, 1);
+        if (length > 0) {
+            body.append(*metadata);
+        }
+    }
+
+    DeltaFileHeader header;
+    header.magic = kDeltaMagic;
+    header.version = kDeltaVersion;
+    header.dimension = dimension;
+    header.sequence = delta.sequence;
+    header.removed_count = delta.removed_ids.size();
+    header.record_count = delta.ids.size();
+    header.body_crc = utils::crc32c(body.data(), body.size());
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(body.data(), static_cast<std::streamsize>(body.size()));
+    out.close();
+    return out ? ErrorCode::Ok : ErrorCode::IOError;
+}
+
+ErrorCode read_snapshot_delta(const std::string& path, std::size_t dimension,
+                              SnapshotDelta& delta) {
+    try {
+        std::ifstream in(path, std::ios::binary);
+        DeltaFileHeader header;
+        in.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!in || header.magic != kDeltaMagic || header.version != kDeltaVersion) {
+            return ErrorCode::IOError;
+        }
+        if (header.dimension != dimension) {
+            return ErrorCode::DimensionMismatch;
+        }
+
+        std::string body(std::filesystem::file_size(path) - sizeof(header), '\0');
+        in.read(body.data(), static_cast<std::streamsize>(body.size()));
+        if (!in || utils::crc32c(body.data(), body.size()) != header.body_crc) {
+            return ErrorCode::IOError;
+        }
+
+        // Counts are covered by the checksum, but still bounded by the body
+        const std::size_t id_bytes = sizeof(std::uint64_t);
+        if (header.removed_count > body.size() / id_bytes ||
+            header.record_count > body.size() / (id_bytes + dimension * sizeof(float))) {
+            return ErrorCode::IOError;
+        }
+
+        delta.sequence = header.sequence;
+        delta.removed_ids.resize(header.removed_count);
+        delta.ids.resize(header.record_count);
+        delta.vectors.resize(header.record_count * dimension);
+        delta.metadata.assign(header.record_count, std::nullopt);
+
+        std::size_t position = 0;
+        if (!take_block(body, position, delta.removed_ids.data(), delta.removed_ids.size()) ||
+            !take_block(body, position, delta.ids.data(), delta.ids.size()) ||
+            !take_block(body, position, delta.vectors.data(), delta.vectors.size())) {
+            return ErrorCode::IOError;
+        }
+        for (auto& metadata : delta.metadata) {
+            std::uint32_t length = 0;
+            if (!take_block(body, position, &length, 1) || length > body.size() - position) {
+                return ErrorCode::IOError;
+            }
+            if (length > 0) {
+                metadata.emplace(body.data() + position, length);
+                position += length;
+            }
+        }
+        return position == body.size() ? ErrorCode::Ok : ErrorCode::IOError;
+
+    } catch (const std::exception&) {
+        return ErrorCode::IOError;
+    }
+}
+
+} // namespace lynx
@@ -0,0 +1,71 @@
+/**
+ * @file snapshot_delta.h
+ * @brief Delta files written by save() on top of a full snapshot
+ *
+ * A delta holds the records inserted or replaced and the IDs removed since
+ * the previous save(), so a checkpoint writes only what changed. On load
+ * the deltas are applied to the snapshot in sequence order.
+ *
+ * File layout:
+ * - Header: magic (u32), version (u32), dimension (u64), sequence (u64),
+ *   removed count (u64), record count (u64), CRC-32C of the body (u32),
+ *   reserved (u32)
+ * - Body: removed IDs (u64 each), record IDs (u64 each), vectors (record
+ *   count x dimension floats), then per record the metadata length (u32)
+ *   and bytes (length 0 = no metadata, as in vectors.bin)
+ *
+ * @copyright MIT License
+ */
+
+#ifndef LYNX_SNAPSHOT_DELTA_H
+#define LYNX_SNAPSHOT_DELTA_H
+
+#include "../include/lynx/lynx.h"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace lynx {
+
+/**
+ * @brief Changes recorded by one delta file.
+ *
+ * Removals are applied before the records, so an ID that was removed and
+ * then inserted again may appear in both.
+ */
+struct SnapshotDelta {
+    std::uint64_t sequence = 0;                          ///< Position after the snapshot (1, 2, ...)
+    std::vector<std::uint64_t> removed_ids;              ///< Tombstones
+    std::vector<std::uint64_t> ids;                      ///< Inserted or replaced IDs
+    std::vector<float> vectors;                          ///< ids.size() x dimension, row-major
+    std::vector<std::optional<std::string>> metadata;    ///< One entry per ID
+};
+
+/**
+ * @brief Write a delta file.
+ *
+ * @param path Destination (overwritten)
+ * @param dimension Vector dimensionality
+ * @param delta Changes to write; vectors must hold ids.size() x dimension floats
+ * @return ErrorCode::Ok, ErrorCode::InvalidParameter for inconsistent
+ *         sizes, or ErrorCode::IOError
+ */
+ErrorCode write_snapshot_delta(const std::string& path, std::size_t dimension,
+                               const SnapshotDelta& delta);
+
+/**
+ * @brief Read and verify a delta file.
+ *
+ * @param path Delta file
+ * @param dimension Expected vector dimensionality
+ * @param delta Receives the changes
+ * @return ErrorCode::Ok, ErrorCode::DimensionMismatch, or
+ *         ErrorCode::IOError for a missing, truncated or corrupt file
+ */
+ErrorCode read_snapshot_delta(const std::string& path, std::size_t dimension,
+                              SnapshotDelta& delta);
+
+} // namespace lynx
+
+#endif // LYNX_SNAPSHOT_DELTA_H
@@ -11,6 +11,14 @@
 #include "utils.h"
 #include <cmath>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
 
 // ============================================================================
 // SIMD Support Detection
@@ -231,5 +239,236 @@ float calculate_distance(
     }
 }
 
+float inverse_norm(std::span<const float> v) {
+    float norm_sq = 0.0f;
+    for (float x : v) {
+        norm_sq += x * x;
+    }
+    return norm_sq > 1e-20f ? 1.0f / std::sqrt(norm_sq) : 0.0f;
+}
+
+// ============================================================================
+// Worker Pool
+// ============================================================================
+
+namespace {
+
+// One run_chunks call. Chunks are claimed by index, so the caller and any
+// number of pool threads can share the work without further coordination.
+struct ChunkJob {
+    const std::function<void(std::size_t)>* chunk;
+    std::size_t chunks;
+    std::atomic<std::size_t> next{0};
+    std::size_t finished = 0;        // Guarded by mutex
+    std::exception_ptr error;        // First failure, guarded by mutex
+    std::mutex mutex;
+    std::condition_variable all_finished;
+
+    // Claim and run chunks until none are left
+    void work() {
+        for (std::size_t c = next++; c < chunks; c = next++) {
+            std::exception_ptr failure;
+            try {
+                (*chunk)(c);
+            } catch (...) {
+                failure = std::current_exception();
+            }
+
+            std::lock_guard lock(mutex);
+            if (failure && !error) {
+                error = failure;
+            }
+            if (++finished == chunks) {
+                all_finished.notify_all();
+            }
+        }
+    }
+};
+
+// Threads started on first use and kept for the life of the process.
+// Queue entries are shared with the caller, which may finish the job (and
+// return) before a pool thread gets to an entry.
+class WorkerPool {
+public:
+    WorkerPool() {
+        const std::size_t count = std::max<std::size_t>(resolve_thread_count(0), 2) - 1;
+        threads_.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            threads_.emplace_back([this] { run(); });
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    static WorkerPool& instance() {
+        static WorkerPool pool;
+        return pool;
+    }
+
+    // Offer a job to up to `helpers` pool threads
+    void post(const std::shared_ptr<ChunkJob>& job, std::size_t helpers) {
+        {
+            std::lock_guard lock(mutex_);
+            helpers = std::min(helpers, threads_.size());
+            for (std::size_t i = 0; i < helpers; ++i) {
+                queue_.push_back(job);
+            }
+        }
+        if (helpers == 1) {
+            wake_.notify_one();
+        } else {
+            wake_.notify_all();
+        }
+    }
+
+private:
+    void run() {
+        while (true) {
+            std::shared_ptr<ChunkJob> job;
+            {
+                std::unique_lock lock(mutex_);
+                wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+                if (queue_.empty()) {
+                    return;
+                }
+                job = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            job->work();
+        }
+    }
+
+    std::vector<std::thread> threads_;
+    std::deque<std::shared_ptr<ChunkJob>> queue_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+};
+
+} // namespace
+
+void run_chunks(std::size_t chunks, const std::function<void(std::size_t)>& chunk) {
+    auto job = std::make_shared<ChunkJob>();
+    job->chunk = &chunk;
+    job->chunks = chunks;
+
+    WorkerPool::instance().post(job, chunks - 1);
+    job->work();
+
+    std::unique_lock lock(job->mutex);
+    job->all_finished.wait(lock, [&] { return job->finished == chunks; });
+    if (job->error) {
+        std::rethrow_exception(job->error);
+    }
+}
+
+// ============================================================================
+// Checksums
+// ============================================================================
+
+namespace {
+
+/// Slicing-by-8 tables for a reflected CRC-32 polynomial: table[0] is the
+/// classic byte-at-a-time table, table[k] advances a byte through k more
+/// zero bytes, so eight input bytes are folded in per step
+using Crc32Tables = std::array<std::array<std::uint32_t, 256>, 8>;
+
+Crc32Tables make_crc32_tables(std::uint32_t polynomial) {
+    Crc32Tables tables{};
+    for (std::uint32_t i = 0; i < 256; ++i) {
+        std::uint32_t c = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            c = (c & 1u) ? (polynomial ^ (c >> 1)) : (c >> 1);
+        }
+        tables[0][i] = c;
+    }
+    for (std::uint32_t i = 0; i < 256; ++i) {
+        for (std::size_t k = 1; k < 8; ++k) {
+            const std::uint32_t prev = tables[k - 1][i];
+            tables[k][i] = tables[0][prev & 0xFFu] ^ (prev >> 8);
+        }
+    }
+    return tables;
+}
+
+std::uint32_t crc32_sliced(const Crc32Tables& tables, const void* data, std::size_t size,
+                           std::uint32_t crc) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+
+    // Eight bytes per step (little-endian load order)
+    while (size >= 8) {
+        std::uint32_t lo;
+        std::uint32_t hi;
+        std::memcpy(&lo, bytes, sizeof(lo));
+        std::memcpy(&hi, bytes + 4, sizeof(hi));
+        lo ^= crc;
+        crc = tables[7][lo & 0xFFu] ^ tables[6][(lo >> 8) & 0xFFu] ^
+              tables[5][(lo >> 16) & 0xFFu] ^ tables[4][lo >> 24] ^
+              tables[3][hi & 0xFFu] ^ tables[2][(hi >> 8) & 0xFFu] ^
+              tables[1][(hi >> 16) & 0xFFu] ^ tables[0][hi >> 24];
+        bytes += 8;
+        size -= 8;
+    }
+    while (size-- > 0) {
+        crc = tables[0][(crc ^ *bytes++) & 0xFFu] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define LYNX_HAS_CRC32C_INSTRUCTION 1
+
+// SSE4.2 crc32 instruction, eight bytes at a time. Compiled for SSE4.2
+// regardless of the build flags and only called after a runtime check.
+__attribute__((target("sse4.2")))
+std::uint32_t crc32c_hardware(const void* data, std::size_t size, std::uint32_t crc) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    std::uint64_t c = ~crc;
+    while (size >= 8) {
+        std::uint64_t word;
+        std::memcpy(&word, bytes, sizeof(word));
+        c = __builtin_ia32_crc32di(c, word);
+        bytes += 8;
+        size -= 8;
+    }
+    auto c32 = static_cast<std::uint32_t>(c);
+    while (size-- > 0) {
+        c32 = __builtin_ia32_crc32qi(c32, *bytes++);
+    }
+    return ~c32;
+}
+#endif
+
+} // namespace
+
+std::uint32_t crc32(const void* data, std::size_t size, std::uint32_t crc) {
+    static const Crc32Tables tables = make_crc32_tables(0xEDB88320u);
+    return crc32_sliced(tables, data, size, crc);
+}
+
+std::uint32_t crc32c(const void* data, std::size_t size, std::uint32_t crc) {
+#ifdef LYNX_HAS_CRC32C_INSTRUCTION
+    static const bool hardware = __builtin_cpu_supports("sse4.2");
+    if (hardware) {
+        return crc32c_hardware(data, size, crc);
+    }
+#endif
+    static const Crc32Tables tables = make_crc32_tables(0x82F63B78u);
+    return crc32_sliced(tables, data, size, crc);
+}
+
 } // namespace utils
 } // namespace lynx
@@ -13,7 +13,13 @@
 
 #include "lynx/lynx.h"
 #include <span>
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <thread>
+#include <vector>
 
 namespace lynx {
 namespace utils {
@@ -85,6 +91,141 @@ namespace utils {
     std::span<const float> b,
     DistanceMetric metric);
 
+/**
+ * @brief Factor that scales a vector to unit length.
+ *
+ * @param v Vector
+ * @return 1 / |v|, or 0 for a (near-)zero vector
+ */
+[[nodiscard]] float inverse_norm(std::span<const float> v);
+
+// ============================================================================
+// Parallel Execution
+// ============================================================================
+
+/**
+ * @brief Resolve a requested worker count.
+ *
+ * @param requested Requested number of threads (0 = hardware concurrency)
+ * @return Number of threads to use (always >= 1)
+ */
+[[nodiscard]] inline std::size_t resolve_thread_count(std::size_t requested) {
+    if (requested == 0) {
+        requested = std::thread::hardware_concurrency();
+    }
+    return requested == 0 ? 1 : requested;
+}
+
+/**
+ * @brief Run chunk(0) .. chunk(chunks - 1) on the shared worker pool.
+ *
+ * The calling thread claims chunks too, so the call completes even when
+ * every pool thread is busy (including with an enclosing parallel_for).
+ * Returns once every chunk has finished; if any chunk threw, the first
+ * exception is rethrown on the calling thread.
+ *
+ * @param chunks Number of chunks
+ * @param chunk Callable run once per chunk index
+ */
+void run_chunks(std::size_t chunks, const std::function<void(std::size_t)>& chunk);
+
+/**
+ * @brief Run a function over [0, count) split into contiguous chunks.
+ *
+ * The range is divided into at most num_threads chunks of near-equal size
+ * and fn(chunk, begin, end) is invoked once per chunk, on the calling
+ * thread and the threads of a process-wide pool (see run_chunks). Chunk
+ * boundaries depend only on count and the chunk count, so callers that
+ * write per-index or per-chunk results get identical output regardless of
+ * scheduling. An exception thrown by fn reaches the caller after all
+ * chunks have stopped.
+ *
+ * @param count Number of items
+ * @param num_threads Maximum number of chunks (0 = hardware concurrency)
+ * @param fn Callable taking (chunk_index, begin, end)
+ * @return Number of chunks used
+ */
+template <typename Fn>
+std::size_t parallel_for(std::size_t count, std::size_t num_threads, Fn&& fn) {
+    if (count == 0) {
+        return 0;
+    }
+    const std::size_t chunks = std::min(resolve_thread_count(num_threads), count);
+    if (chunks == 1) {
+        fn(std::size_t{0}, std::size_t{0}, count);
+        return 1;
+    }
+
+    const std::size_t base = count / chunks;
+    const std::size_t extra = count % chunks;
+    auto chunk_begin = [&](std::size_t c) {
+        return c * base + std::min(c, extra);
+    };
+
+    run_chunks(chunks, [&](std::size_t c) { fn(c, chunk_begin(c), chunk_begin(c + 1)); });
+    return chunks;
+}
+
+// ============================================================================
+// Checksums
+// ============================================================================
+
+/**
+ * @brief CRC-32 (IEEE 802.3 polynomial) of a byte range.
+ *
+ * @param data First byte
+ * @param size Number of bytes
+ * @param crc Running value from a previous call (0 to start)
+ * @return Updated checksum; chaining calls equals one call over the
+ *         concatenated ranges
+ */
+[[nodiscard]] std::uint32_t crc32(const void* data, std::size_t size, std::uint32_t crc = 0);
+
+/**
+ * @brief CRC-32C (Castagnoli polynomial) of a byte range.
+ *
+ * Same contract as crc32(). Uses the SSE4.2 crc32 instruction when the CPU
+ * has it, which makes it fast enough to checksum snapshot files at memory
+ * speed; the table fallback runs at crc32() speed.
+ */
+[[nodiscard]] std::uint32_t crc32c(const void* data, std::size_t size, std::uint32_t crc = 0);
+
+// ============================================================================
+// Memory
+// ============================================================================
+
+/**
+ * @brief Allocator returning storage aligned to `Alignment` bytes.
+ *
+ * Used for dense vector arrays so that every scan starts on a cache line
+ * (and on a full SIMD register boundary).
+ */
+template <typename T, std::size_t Alignment = 64>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    [[nodiscard]] T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{Alignment}));
+    }
+
+    void deallocate(T* p, std::size_t) noexcept {
+        ::operator delete(p, std::align_val_t{Alignment});
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+};
+
 } // namespace utils
 } // namespace lynx
 
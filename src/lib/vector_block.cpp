@@ -0,0 +1,79 @@
+/**
+ * @file vector_block.cpp
+ * @brief Implementation of VectorBlock class
+ *
+ * @copyright MIT License
+ */
+
+#include "vector_block.h"
+#include <algorithm>
+
+namespace lynx {
+
+void VectorBlock::append(std::span<const float> vector) {
+    heap_.insert(heap_.end(), vector.begin(), vector.end());
+}
+
+std::span<float> VectorBlock::append_rows(std::size_t count) {
+    const std::size_t start = heap_.size();
+    heap_.resize(start + count * dim_);
+    return {heap_.data() + start, count * dim_};
+}
+
+void VectorBlock::assign(std::size_t r, std::span<const float> vector) {
+    if (r >= mapped_rows_) {
+        std::copy(vector.begin(), vector.end(), heap_.begin() + (r - mapped_rows_) * dim_);
+        return;
+    }
+
+    // The mapping is read-only: the row moves to the heap
+    if (patched_.empty()) {
+        patched_.resize((mapped_rows_ + 63) / 64, 0);
+    }
+    patched_[r / 64] |= std::uint64_t{1} << (r % 64);
+    patches_[r].assign(vector.begin(), vector.end());
+}
+
+void VectorBlock::move_last_to(std::size_t r) {
+    const std::size_t last = rows() - 1;
+    if (r != last) {
+        assign(r, row(last));
+    }
+    pop_back();
+}
+
+void VectorBlock::pop_back() {
+    if (!heap_.empty()) {
+        heap_.resize(heap_.size() - dim_);
+    } else if (mapped_rows_ > 0) {
+        --mapped_rows_;
+        if (is_patched(mapped_rows_)) {
+            patched_[mapped_rows_ / 64] &= ~(std::uint64_t{1} << (mapped_rows_ % 64));
+            patches_.erase(mapped_rows_);
+        }
+    }
+}
+
+void VectorBlock::reserve(std::size_t rows) {
+    if (rows > mapped_rows_) {
+        heap_.reserve((rows - mapped_rows_) * dim_);
+    }
+}
+
+void VectorBlock::clear() {
+    heap_.clear();
+    patches_.clear();
+    patched_ = {};
+    file_.reset();
+    mapped_ = nullptr;
+    mapped_rows_ = 0;
+}
+
+void VectorBlock::attach(const MappedVectors& vectors) {
+    clear();
+    file_ = vectors.file;
+    mapped_ = reinterpret_cast<const float*>(file_->data() + vectors.offset);
+    mapped_rows_ = vectors.ids.size();
+}
+
+} // namespace lynx
@@ -0,0 +1,133 @@
+/**
+ * @file vector_block.h
+ * @brief Dense row-major vector storage, optionally backed by a mapped file
+ *
+ * @copyright MIT License
+ */
+
+#ifndef LYNX_VECTOR_BLOCK_H
+#define LYNX_VECTOR_BLOCK_H
+
+#include "mapped_file.h"
+#include "utils.h"
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace lynx {
+
+/**
+ * @brief Rows of `dim` floats addressed by a dense row index.
+ *
+ * Rows [0, mapped_rows) may live in a memory-mapped file (see attach());
+ * the remaining rows live in a 64-byte aligned heap buffer. Appends always
+ * go to the heap. The mapping is read-only, so overwriting a mapped row
+ * moves that one row to a heap patch; a bitmap over the mapped rows keeps
+ * reads of unpatched rows to one extra bit test. A mapped block thus stays
+ * usable for every index operation without first being read into memory.
+ *
+ * Thread-safety: Not thread-safe. External synchronization required.
+ */
+class VectorBlock {
+public:
+    /**
+     * @brief Construct an empty block.
+     * @param dim Floats per row
+     */
+    explicit VectorBlock(std::size_t dim) : dim_(dim) {}
+
+    [[nodiscard]] std::size_t dim() const { return dim_; }
+    [[nodiscard]] std::size_t rows() const { return mapped_rows_ + heap_.size() / dim_; }
+    [[nodiscard]] bool empty() const { return rows() == 0; }
+    [[nodiscard]] bool is_mapped() const { return file_ != nullptr; }
+
+    /**
+     * @brief Pointer to the first float of row r.
+     */
+    [[nodiscard]] const float* row_data(std::size_t r) const {
+        if (r >= mapped_rows_) {
+            return heap_.data() + (r - mapped_rows_) * dim_;
+        }
+        if (is_patched(r)) {
+            return patches_.find(r)->second.data();
+        }
+        return mapped_ + r * dim_;
+    }
+
+    /**
+     * @brief Row r as a span of dim() floats.
+     */
+    [[nodiscard]] std::span<const float> row(std::size_t r) const {
+        return {row_data(r), dim_};
+    }
+
+    /**
+     * @brief Append a row.
+     */
+    void append(std::span<const float> vector);
+
+    /**
+     * @brief Append `count` zero-filled rows and return them for filling.
+     */
+    std::span<float> append_rows(std::size_t count);
+
+    /**
+     * @brief Overwrite row r.
+     */
+    void assign(std::size_t r, std::span<const float> vector);
+
+    /**
+     * @brief Move the last row into row r and drop the last row.
+     */
+    void move_last_to(std::size_t r);
+
+    /**
+     * @brief Drop the last row.
+     */
+    void pop_back();
+
+    /**
+     * @brief Reserve heap space for a total of `rows` rows.
+     */
+    void reserve(std::size_t rows);
+
+    /**
+     * @brief Drop all rows and release any mapping.
+     */
+    void clear();
+
+    /**
+     * @brief Serve rows from a mapped file, replacing the current contents.
+     * @param vectors Mapped block (row count = vectors.ids.size())
+     */
+    void attach(const MappedVectors& vectors);
+
+    /**
+     * @brief Heap bytes held (mapped rows are not counted; they are page cache).
+     */
+    [[nodiscard]] std::size_t memory_usage() const {
+        return (heap_.capacity() + patches_.size() * dim_) * sizeof(float) +
+               patched_.capacity() * sizeof(std::uint64_t);
+    }
+
+private:
+    using Row = std::vector<float, utils::AlignedAllocator<float>>;
+
+    [[nodiscard]] bool is_patched(std::size_t r) const {
+        return !patched_.empty() && ((patched_[r / 64] >> (r % 64)) & 1u) != 0;
+    }
+
+    std::size_t dim_;
+    std::shared_ptr<MappedFile> file_;                          ///< Keeps mapped_ alive
+    const float* mapped_ = nullptr;                             ///< Row 0 inside the mapping
+    std::size_t mapped_rows_ = 0;                               ///< Rows served from the mapping
+    Row heap_;                                                  ///< Rows after the mapped ones
+    std::unordered_map<std::size_t, Row> patches_;              ///< Overwritten mapped rows
+    std::vector<std::uint64_t> patched_;                        ///< Bit per mapped row: has a patch (empty if none)
+};
+
+} // namespace lynx
+
+#endif // LYNX_VECTOR_BLOCK_H
@@ -10,15 +10,122 @@
 #include "hnsw_index.h"
 #include "ivf_index.h"
 #include "utils.h"
+#include "checksum_stream.h"
+#include "segmented_index.h"
+#include <cstring>
 #include <fstream>
+#include <sstream>
+#include <future>
+#include <limits>
+#include <optional>
 #include <stdexcept>
 #include <filesystem>
 #include <algorithm>
 #include <unordered_set>
 #include <mutex>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace lynx {
 
+namespace {
+
+/// fsync a file by path (ofstream cannot), so a snapshot is on disk
+/// before the log it supersedes is truncated
+bool sync_file(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+}
+
+/// fsync a directory, so renames into it survive a crash
+bool sync_directory(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+}
+
+/// Outcome of writing or reading index.bin on a helper thread
+struct IndexFileResult {
+    ErrorCode result = ErrorCode::Ok;
+    std::uint64_t size = 0;   ///< Bytes written or read
+    std::uint32_t crc = 0;    ///< CRC-32C of those bytes
+};
+
+/// Write an index to a file through a checksum filter
+IndexFileResult write_index_file(const std::function<ErrorCode(std::ostream&)>& serialize,
+                                 const std::string& path) {
+    IndexFileResult written;
+    std::filebuf file;
+    if (!file.open(path, std::ios::out | std::ios::binary | std::ios::trunc)) {
+        written.result = ErrorCode::IOError;
+        return written;
+    }
+    {
+        ChecksumOutputBuffer checked(&file);
+        std::ostream stream(&checked);
+        written.result = serialize(stream);
+        if (checked.pubsync() != 0 && written.result == ErrorCode::Ok) {
+            written.result = ErrorCode::IOError;
+        }
+        written.size = checked.bytes();
+        written.crc = checked.crc();
+    }
+    if (!file.close() && written.result == ErrorCode::Ok) {
+        written.result = ErrorCode::IOError;
+    }
+    return written;
+}
+
+/// Deserialize an index from a file through a checksum filter; the rest of
+/// the file is drained so the CRC covers all of it
+IndexFileResult read_index_file(IVectorIndex& index, const std::string& path) {
+    IndexFileResult read;
+    std::filebuf file;
+    if (!file.open(path, std::ios::in | std::ios::binary)) {
+        read.result = ErrorCode::IOError;
+        return read;
+    }
+    ChecksumInputBuffer checked(&file);
+    std::istream stream(&checked);
+    read.result = index.deserialize(stream);
+    stream.clear();
+    stream.ignore(std::numeric_limits<std::streamsize>::max());
+    read.size = checked.bytes();
+    read.crc = checked.crc();
+    return read;
+}
+
+/// CRC-32C of `size` bytes of a file starting at `offset`, or nullopt if
+/// they cannot be read
+std::optional<std::uint32_t> checksum_file_range(const std::string& path, std::uint64_t offset,
+                                                 std::uint64_t size) {
+    std::ifstream in(path, std::ios::binary);
+    in.seekg(static_cast<std::streamoff>(offset));
+    std::vector<char> chunk(kChecksumBufferSize);
+    std::uint32_t crc = 0;
+    while (size > 0 && in) {
+        const std::size_t bytes = std::min<std::uint64_t>(size, chunk.size());
+        in.read(chunk.data(), static_cast<std::streamsize>(bytes));
+        crc = utils::crc32c(chunk.data(), bytes, crc);
+        size -= bytes;
+    }
+    if (!in) {
+        return std::nullopt;
+    }
+    return crc;
+}
+
+} // namespace
+
 // =============================================================================
 // Constructor and Index Factory
 // =============================================================================
@@ -29,33 +136,58 @@ VectorDatabase::VectorDatabase(const Config& config)
     if (config_.dimension == 0) {
         throw std::invalid_argument("Dimension must be greater than 0");
     }
+
+    // The log file itself is opened on first use (write, save or load)
+    if (config_.enable_wal && !config_.data_path.empty()) {
+        wal_ = std::make_unique<WriteAheadLog>(
+            config_.dimension,
+            std::chrono::milliseconds(config_.wal_sync_interval_ms)
+        );
+    }
 }
 
 std::shared_ptr<IVectorIndex> VectorDatabase::create_index() {
-    switch (config_.index_type) {
-        case IndexType::Flat:
-            return std::make_shared<FlatIndex>(
-                config_.dimension,
-                config_.distance_metric
-            );
-
-        case IndexType::HNSW:
-            return std::make_shared<HNSWIndex>(
-                config_.dimension,
-                config_.distance_metric,
-                config_.hnsw_params
-            );
-
-        case IndexType::IVF:
-            return std::make_shared<IVFIndex>(
-                config_.dimension,
-                config_.distance_metric,
-                config_.ivf_params
-            );
+    auto make_index = [config = config_]() -> std::shared_ptr<IVectorIndex> {
+        switch (config.index_type) {
+            case IndexType::Flat:
+                return std::make_shared<FlatIndex>(
+                    config.dimension,
+                    config.distance_metric,
+                    config.num_query_threads
+                );
+
+            case IndexType::HNSW:
+                return std::make_shared<HNSWIndex>(
+                    config.dimension,
+                    config.distance_metric,
+                    config.hnsw_params
+                );
+
+            case IndexType::IVF:
+                return std::make_shared<IVFIndex>(
+                    config.dimension,
+                    config.distance_metric,
+                    config.ivf_params
+                );
+
+            default:
+                throw std::invalid_argument("Unknown index type");
+        }
+    };
 
-        default:
-            throw std::invalid_argument("Unknown index type");
+    if (config_.memtable_capacity == 0) {
+        return make_index();
     }
+
+    // Validate the index type now rather than on the background thread
+    make_index();
+    return std::make_shared<SegmentedIndex>(
+        config_.dimension,
+        config_.distance_metric,
+        config_.memtable_capacity,
+        config_.max_sealed_segments,
+        make_index
+    );
 }
 
 // =============================================================================
@@ -69,87 +201,117 @@ ErrorCode VectorDatabase::insert(const VectorRecord& record) {
         return validation;
     }
 
-    // Acquire exclusive lock for write access
+    // Inserts are serialized among themselves. The index is updated under
+    // a shared lock, so searches and reads go on meanwhile; only publishing
+    // the ID takes mutex_ exclusively
+    std::unique_lock insert_lock(insert_mutex_);
     {
-        std::unique_lock lock(vectors_mutex_);
+        std::shared_lock lock(mutex_);
 
         // Check for duplicate ID - INSERT should reject duplicates
-        if (vectors_.contains(record.id)) {
+        if (records_.contains(record.id)) {
             return ErrorCode::InvalidParameter;
         }
 
-        // Store vector in vectors_
-        vectors_[record.id] = record;
-    } // Release lock before calling into index
+        if (wal_) {
+            ErrorCode opened = open_wal();
+            if (opened != ErrorCode::Ok) {
+                return opened;
+            }
+        }
 
-    // Delegate to index (index has its own locking)
-    ErrorCode result = index_->add(record.id, record.vector);
-    if (result != ErrorCode::Ok) {
-        // Rollback: remove from vectors_
-        std::unique_lock lock(vectors_mutex_);
-        vectors_.erase(record.id);
-        return result;
+        // The index keeps the only copy of the vector
+        ErrorCode result = index_->add(record.id, record.vector);
+        if (result != ErrorCode::Ok) {
+            return result;
+        }
+    }
+
+    std::unique_lock lock(mutex_);
+
+    // A batch insert of the same ID got in between; its vector replaced ours
+    if (records_.contains(record.id)) {
+        return ErrorCode::InvalidParameter;
+    }
+
+    // The index was rebuilt or reloaded in between
+    if (!index_->contains(record.id)) {
+        ErrorCode result = index_->add(record.id, record.vector);
+        if (result != ErrorCode::Ok) {
+            return result;
+        }
     }
+    records_.emplace(record.id, metadata_.add(record.metadata));
+    track_insert(record.id);
 
     // Update statistics
     total_inserts_.fetch_add(1, std::memory_order_relaxed);
 
+    // Log under the lock (log order = apply order), commit after releasing it
+    if (wal_) {
+        WriteAheadLog::Lsn lsn = wal_->append_insert(record.id, record.vector, record.metadata);
+        lock.unlock();
+        insert_lock.unlock();
+        return commit_wal(lsn);
+    }
     return ErrorCode::Ok;
 }
 
 ErrorCode VectorDatabase::remove(std::uint64_t id) {
-    // Atomically check existence and remove from vectors_
-    // This fixes race condition between check and removal
-    VectorRecord record_backup;
-    {
-        std::unique_lock lock(vectors_mutex_);
-        auto it = vectors_.find(id);
-        if (it == vectors_.end()) {
-            return ErrorCode::VectorNotFound;
-        }
-
-        // Save record for potential rollback
-        record_backup = it->second;
+    // Check and removal happen under one exclusive lock
+    std::unique_lock lock(mutex_);
+    if (!records_.contains(id)) {
+        return ErrorCode::VectorNotFound;
+    }
 
-        // Remove from vectors_ immediately
-        vectors_.erase(it);
-    } // Release lock before calling into index
+    if (wal_) {
+        ErrorCode opened = open_wal();
+        if (opened != ErrorCode::Ok) {
+            return opened;
+        }
+    }
 
-    // Remove from index (index has its own locking)
-    ErrorCode result = index_->remove(id);
+    ErrorCode result = erase_record_locked(id);
     if (result != ErrorCode::Ok) {
-        // Rollback: restore the record to vectors_
-        std::unique_lock lock(vectors_mutex_);
-        vectors_[id] = std::move(record_backup);
         return result;
     }
 
+    if (wal_) {
+        WriteAheadLog::Lsn lsn = wal_->append_remove(id);
+        lock.unlock();
+        return commit_wal(lsn);
+    }
     return ErrorCode::Ok;
 }
 
 bool VectorDatabase::contains(std::uint64_t id) const {
-    std::shared_lock lock(vectors_mutex_);
-    return vectors_.contains(id);
+    std::shared_lock lock(mutex_);
+    return records_.contains(id);
 }
 
 std::optional<VectorRecord> VectorDatabase::get(std::uint64_t id) const {
-    std::shared_lock lock(vectors_mutex_);
-    auto it = vectors_.find(id);
-    if (it == vectors_.end()) {
+    std::shared_lock lock(mutex_);
+    auto it = records_.find(id);
+    if (it == records_.end()) {
+        return std::nullopt;
+    }
+
+    // Read the vector back from the index
+    VectorRecord record{id, std::vector<float>(config_.dimension), metadata_.get(it->second)};
+    if (!index_->get_vector(id, record.vector)) {
         return std::nullopt;
     }
-    return it->second;
+    return record;
 }
 
 RecordRange VectorDatabase::all_records() const {
     // Create a shared lock that will be kept alive by the iterators
-    auto lock = std::make_shared<std::shared_lock<std::shared_mutex>>(vectors_mutex_);
+    auto lock = std::make_shared<std::shared_lock<std::shared_mutex>>(mutex_);
 
-    // Create locked iterators that hold the lock for their lifetime
-    auto begin_impl = std::make_shared<LockedIteratorImpl<decltype(vectors_), std::shared_mutex>>(
-        vectors_.begin(), lock);
-    auto end_impl = std::make_shared<LockedIteratorImpl<decltype(vectors_), std::shared_mutex>>(
-        vectors_.end(), lock);
+    // Iterators walk the ID map and read each vector from the index
+    using IteratorImpl = IndexRecordIteratorImpl<decltype(records_), std::shared_mutex>;
+    auto begin_impl = std::make_shared<IteratorImpl>(records_.begin(), index_, metadata_, lock);
+    auto end_impl = std::make_shared<IteratorImpl>(records_.end(), index_, metadata_, lock);
 
     return RecordRange(
         RecordIterator(begin_impl),
@@ -179,17 +341,17 @@ SearchResult VectorDatabase::search(std::span<const float> query,
     // Start timing
     auto start = std::chrono::high_resolution_clock::now();
 
-    // Acquire shared lock for read access
-    std::shared_lock lock(vectors_mutex_);
+    // Pin the index and capture the vector count, then search without the
+    // lock: indexes are thread-safe, and a writer waiting for mutex_ does
+    // not wait for the search
+    std::shared_lock lock(mutex_);
+    const std::shared_ptr<IVectorIndex> index = index_;
+    std::size_t total_candidates = records_.size();
+    lock.unlock();
 
     // Delegate to index
-    std::vector<SearchResultItem> items = index_->search(query, k, params);
-
-    // Capture vector count while holding lock
-    std::size_t total_candidates = vectors_.size();
-
-    // Release lock before timing calculations
-    lock.unlock();
+    IndexSearchStats index_stats;
+    std::vector<SearchResultItem> items = index->search_with_stats(query, k, params, index_stats);
 
     // Calculate timing
     auto end = std::chrono::high_resolution_clock::now();
@@ -210,6 +372,7 @@ SearchResult VectorDatabase::search(std::span<const float> query,
     result.total_candidates = total_candidates;  // Use captured value (thread-safe)
     result.items = std::move(items);
     result.query_time_ms = elapsed_ms;
+    result.clusters_probed = index_stats.clusters_probed;
 
     return result;
 }
@@ -223,52 +386,6 @@ ErrorCode VectorDatabase::batch_insert(std::span<const VectorRecord> records) {
         return ErrorCode::Ok;
     }
 
-    // Optimization: If database is empty, use bulk build for better performance
-    // This is especially important for HNSW which can construct the graph more efficiently
-    bool is_empty = false;
-    {
-        std::shared_lock read_lock(vectors_mutex_);
-        is_empty = vectors_.empty();
-    }
-
-    if (is_empty) {
-        // Validate and prepare records with lock
-        std::unordered_set<std::uint64_t> seen_ids;
-        for (const auto& record : records) {
-            // Validate dimension
-            if (record.vector.size() != config_.dimension) {
-                return ErrorCode::DimensionMismatch;
-            }
-            if (!seen_ids.insert(record.id).second) {
-                return ErrorCode::InvalidParameter;  // Duplicate within batch
-            }
-        }
-
-        // Store all records in vectors_
-        {
-            std::unique_lock lock(vectors_mutex_);
-            for (const auto& record : records) {
-                vectors_[record.id] = record;
-            }
-        } // Release lock before calling into index
-
-        // Build index (index has its own locking)
-        ErrorCode result = index_->build(records);
-        if (result == ErrorCode::Ok) {
-            total_inserts_.fetch_add(records.size(), std::memory_order_relaxed);
-            return ErrorCode::Ok;
-        } else {
-            // Rollback: remove all records from vectors_
-            std::unique_lock lock(vectors_mutex_);
-            for (const auto& record : records) {
-                vectors_.erase(record.id);
-            }
-            return result;
-        }
-    }
-
-    // For non-empty database, use incremental insert with atomic semantics
-
     // Step 1: Validate ALL records before inserting ANY of them
     // This ensures no partial inserts occur if validation fails
     std::unordered_set<std::uint64_t> seen_ids;
@@ -285,52 +402,93 @@ ErrorCode VectorDatabase::batch_insert(std::span<const VectorRecord> records) {
         }
     }
 
-    // Step 2: Atomically check for existing IDs and insert into vectors_
-    // This fixes TOCTOU race: we hold exclusive lock from check through insert
-    {
-        std::unique_lock lock(vectors_mutex_);
+    // Hold the exclusive lock from the ID checks through the index update
+    std::unique_lock lock(mutex_);
 
-        // Check for existing IDs in database
+    if (wal_) {
+        ErrorCode opened = open_wal();
+        if (opened != ErrorCode::Ok) {
+            return opened;
+        }
+    }
+
+    ErrorCode result = insert_records_locked(records);
+    if (result != ErrorCode::Ok) {
+        return result;
+    }
+    total_inserts_.fetch_add(records.size(), std::memory_order_relaxed);
+
+    // One commit covers the whole batch
+    if (wal_) {
+        WriteAheadLog::Lsn lsn = 0;
+        for (const auto& record : records) {
+            lsn = wal_->append_insert(record.id, record.vector, record.metadata);
+        }
+        lock.unlock();
+        return commit_wal(lsn);
+    }
+    return ErrorCode::Ok;
+}
+
+ErrorCode VectorDatabase::insert_records_locked(std::span<const VectorRecord> records) {
+    if (records_.empty()) {
+        // Optimization: If database is empty, use bulk build for better performance
+        // This is especially important for HNSW which can construct the graph more efficiently
+        ErrorCode result = index_->build(records);
+        if (result != ErrorCode::Ok) {
+            return result;
+        }
+    } else {
+        // Step 2: Check for existing IDs in database
         for (const auto& record : records) {
-            if (vectors_.contains(record.id)) {
+            if (records_.contains(record.id)) {
                 return ErrorCode::InvalidParameter;
             }
         }
 
-        // All checks passed, insert all records into vectors_
+        // Step 3: Insert into index one by one, with full rollback on failure
+        // Track all successfully inserted IDs for potential rollback
+        std::vector<std::uint64_t> inserted_ids;
+        inserted_ids.reserve(records.size());
+
         for (const auto& record : records) {
-            vectors_[record.id] = record;
+            ErrorCode result = index_->add(record.id, record.vector);
+            if (result != ErrorCode::Ok) {
+                // Rollback ALL: remove all previously inserted records from index
+                index_->remove_batch(inserted_ids);
+                return result;
+            }
+            inserted_ids.push_back(record.id);
         }
-    } // Release lock before calling into index
-
-    // Step 3: Insert into index one by one, with full rollback on failure
-    // Track all successfully inserted IDs for potential rollback
-    std::vector<std::uint64_t> inserted_ids;
-    inserted_ids.reserve(records.size());
+    }
 
+    // All inserts successful
     for (const auto& record : records) {
-        // Add to index (index has its own locking)
-        ErrorCode result = index_->add(record.id, record.vector);
-        if (result != ErrorCode::Ok) {
-            // Rollback ALL: remove all previously inserted records from index
-            for (std::uint64_t rollback_id : inserted_ids) {
-                index_->remove(rollback_id);
-            }
+        records_.emplace(record.id, metadata_.add(record.metadata));
+        track_insert(record.id);
+    }
+    return ErrorCode::Ok;
+}
 
-            // Remove ALL records from vectors_ (atomic all-or-nothing)
-            std::unique_lock lock(vectors_mutex_);
-            for (const auto& r : records) {
-                vectors_.erase(r.id);
-            }
+ErrorCode VectorDatabase::erase_record_locked(std::uint64_t id) {
+    auto it = records_.find(id);
 
-            return result;
+    // Copy on write: a running save() still needs the record as captured
+    if (capture_active_ && !capture_preimages_.contains(id)) {
+        VectorRecord preimage{id, std::vector<float>(config_.dimension), metadata_.get(it->second)};
+        if (!index_->get_vector(id, preimage.vector)) {
+            return ErrorCode::InvalidState;
         }
-
-        inserted_ids.push_back(record.id);
+        capture_preimages_.emplace(id, std::move(preimage));
     }
 
-    // All inserts successful
-    total_inserts_.fetch_add(records.size(), std::memory_order_relaxed);
+    ErrorCode result = index_->remove(id);
+    if (result != ErrorCode::Ok) {
+        return result;
+    }
+    metadata_.remove(it->second);
+    records_.erase(it);
+    track_remove(id);
     return ErrorCode::Ok;
 }
 
@@ -339,8 +497,8 @@ ErrorCode VectorDatabase::batch_insert(std::span<const VectorRecord> records) {
 // =============================================================================
 
 std::size_t VectorDatabase::size() const {
-    std::shared_lock lock(vectors_mutex_);
-    return vectors_.size();
+    std::shared_lock lock(mutex_);
+    return records_.size();
 }
 
 std::size_t VectorDatabase::dimension() const {
@@ -348,21 +506,21 @@ std::size_t VectorDatabase::dimension() const {
 }
 
 DatabaseStats VectorDatabase::stats() const {
-    std::shared_lock lock(vectors_mutex_);
+    std::shared_lock lock(mutex_);
 
     DatabaseStats stats;
-    stats.vector_count = vectors_.size();
+    stats.vector_count = records_.size();
     stats.dimension = config_.dimension;
 
-    // Index memory
+    // Index memory (includes the vectors themselves)
     stats.index_memory_bytes = index_->memory_usage();
 
-    // Vector storage memory (approximate)
-    std::size_t vector_memory = vectors_.size() * (
-        sizeof(VectorRecord) +
-        config_.dimension * sizeof(float)
-    );
-    stats.memory_usage_bytes = vector_memory + stats.index_memory_bytes;
+    // Record storage memory: ID map entries plus the metadata arena (approximate)
+    std::size_t record_memory = records_.size() * (
+        sizeof(std::uint64_t) +
+        sizeof(MetadataStore::Slot)
+    ) + metadata_.memory_usage();
+    stats.memory_usage_bytes = record_memory + stats.index_memory_bytes;
 
     // Query statistics (atomics don't need locking)
     stats.total_queries = total_queries_.load(std::memory_order_relaxed);
@@ -381,9 +539,9 @@ DatabaseStats VectorDatabase::stats() const {
 // =============================================================================
 
 ErrorCode VectorDatabase::flush() {
-    // If WAL is enabled, flush WAL (not yet implemented)
-    if (config_.enable_wal) {
-        return ErrorCode::NotImplemented;
+    // With a WAL, committing the log is enough for durability
+    if (wal_) {
+        return wal_->sync();
     }
 
     // If no data path, flush is a no-op (in-memory only)
@@ -400,68 +558,260 @@ ErrorCode VectorDatabase::save() {
         return ErrorCode::InvalidParameter;
     }
 
-    // Acquire shared lock for read access (persistence doesn't modify data)
-    std::shared_lock lock(vectors_mutex_);
+    // Concurrent saves are serialized as they share the delta bookkeeping
+    std::lock_guard save_lock(save_mutex_);
 
+    // Few changes on top of files that are otherwise current: write them
+    // as a delta instead of rewriting everything
+    SnapshotDelta delta;
+    std::uint64_t delta_wal_position = 0;
+    {
+        std::unique_lock lock(mutex_);
+        if (snapshot_current_ && delta_files_ < config_.max_snapshot_deltas &&
+            (changed_ids_.size() + removed_ids_.size()) * kDeltaFoldDivisor <= records_.size()) {
+            if (changed_ids_.empty() && removed_ids_.empty()) {
+                return ErrorCode::Ok;
+            }
+            ErrorCode result = capture_delta_locked(delta, delta_wal_position);
+            if (result != ErrorCode::Ok) {
+                return result;
+            }
+        }
+    }
+    if (delta.sequence != 0) {
+        return write_delta(delta, delta_wal_position);
+    }
+
+    // 1. Capture a point-in-time view under a shared lock; writers wait for
+    // this step only, not for the files to be written
+    std::vector<std::uint64_t> order;
+    std::shared_ptr<IVectorIndex> captured_index;
+    std::optional<IndexCapture> index_capture;
+    std::vector<std::pair<std::uint64_t, std::string>> deltas;
+    std::uint64_t sequence = 0;
+    std::uint64_t wal_position = 0;
     try {
+        // Inserts update the index before taking mutex_ exclusively, so
+        // they are held off as well
+        std::lock_guard insert_lock(insert_mutex_);
+        std::shared_lock lock(mutex_);
+
         // Create directory if it doesn't exist
         std::filesystem::create_directories(config_.data_path);
 
-        // 1. Save index
-        std::string index_path = config_.data_path + "/index.bin";
-        std::ofstream index_file(index_path, std::ios::binary);
-        if (!index_file) {
-            return ErrorCode::IOError;
+        // A segmented index pins its immutable segments; the others copy
+        // their IDs and keep what changes until the capture is released,
+        // reading the rest from the index (held here) as it is written.
+        // Only an index that cannot capture itself is serialized now, to
+        // memory. Records are copied on write either way (see
+        // erase_record_locked)
+        captured_index = index_;
+        index_capture = captured_index->capture();
+        if (!index_capture) {
+            // Rows of vectors.bin follow the index's storage order so that a
+            // mapped load can hand the vector block to the index unchanged
+            order = index_->storage_order();
+            if (order.size() != records_.size()) {
+                order.clear();
+                order.reserve(records_.size());
+                for (const auto& entry : records_) {
+                    order.push_back(entry.first);
+                }
+            }
+
+            std::ostringstream image;
+            ErrorCode result = index_->serialize(image);
+            if (result != ErrorCode::Ok) {
+                return result;
+            }
+            auto index_image = std::make_shared<const std::string>(std::move(image).str());
+            index_capture = IndexCapture{
+                [index_image](std::ostream& out) {
+                    out.write(index_image->data(), static_cast<std::streamsize>(index_image->size()));
+                    return out.good() ? ErrorCode::Ok : ErrorCode::IOError;
+                },
+                {}};
         }
 
-        ErrorCode result = index_->serialize(index_file);
-        if (result != ErrorCode::Ok) {
-            return result;
+        // Deltas already on disk are folded into this snapshot and deleted
+        // once it is in place; until then the header tells load() to skip them
+        deltas = list_delta_files();
+        sequence = delta_sequence_;
+        if (!deltas.empty()) {
+            sequence = std::max(sequence, deltas.back().first);
         }
-        index_file.close();
 
-        // 2. Save vectors (with metadata)
-        std::string vectors_path = config_.data_path + "/vectors.bin";
-        std::ofstream vectors_file(vectors_path, std::ios::binary);
-        if (!vectors_file) {
-            return ErrorCode::IOError;
+        // Log entries from here on are not in the snapshot
+        if (wal_) {
+            ErrorCode result = open_wal();
+            if (result != ErrorCode::Ok) {
+                return result;
+            }
+            wal_position = wal_->end_position();
         }
 
-        // Write header
-        std::uint32_t magic = kMagicNumber;
-        std::uint32_t version = kVersion;
-        std::uint64_t count = vectors_.size();
+        // Writes from here on are tracked against this snapshot
+        drop_delta_tracking();
+        snapshot_current_ = config_.max_snapshot_deltas > 0;
+        capture_active_ = true;
+
+    } catch (const std::exception&) {
+        return ErrorCode::IOError;
+    }
 
-        vectors_file.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
-        vectors_file.write(reinterpret_cast<const char*>(&version), sizeof(version));
-        vectors_file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    // 2. Write the files while inserts and removes continue
+    if (index_capture->ids) {
+        order = index_capture->ids();
+    }
+    ErrorCode result = write_snapshot_files(order, index_capture->serialize, sequence);
 
-        // Write dimension
-        std::uint64_t dim = config_.dimension;
-        vectors_file.write(reinterpret_cast<const char*>(&dim), sizeof(dim));
+    // 3. Publish or abandon the snapshot under a short exclusive lock
+    std::unique_lock lock(mutex_);
+    capture_active_ = false;
+    capture_preimages_.clear();
+    if (result != ErrorCode::Ok) {
+        drop_delta_tracking();
+        return result;
+    }
 
-        // Write vectors with metadata
-        for (const auto& [id, record] : vectors_) {
-            // Write ID
-            vectors_file.write(reinterpret_cast<const char*>(&id), sizeof(id));
+    std::error_code ignored;
+    for (const auto& delta : deltas) {
+        std::filesystem::remove(delta.second, ignored);
+    }
+    delta_sequence_ = sequence;
+    delta_files_ = 0;
 
-            // Write vector data
-            vectors_file.write(
-                reinterpret_cast<const char*>(record.vector.data()),
-                record.vector.size() * sizeof(float)
-            );
+    // The snapshot covers every entry logged before the capture; entries
+    // logged while it was written are kept
+    if (wal_) {
+        return wal_->discard_before(wal_position);
+    }
+    return ErrorCode::Ok;
+}
 
-            // Write metadata length and data
-            std::uint32_t meta_len = record.metadata.has_value()
-                ? static_cast<std::uint32_t>(record.metadata->size()) : 0;
-            vectors_file.write(reinterpret_cast<const char*>(&meta_len), sizeof(meta_len));
+ErrorCode VectorDatabase::write_snapshot_files(
+    std::span<const std::uint64_t> order,
+    const std::function<ErrorCode(std::ostream&)>& write_index,
+    std::uint64_t sequence) {
+    try {
+        // Files are written next to their final name and renamed into place,
+        // so a process still mapping the previous vectors.bin keeps valid pages
+        const std::string index_path = config_.data_path + "/index.bin";
+        const std::string vectors_path = config_.data_path + "/vectors.bin";
+        const std::string index_tmp = index_path + ".tmp";
+        const std::string vectors_tmp = vectors_path + ".tmp";
+
+        // 1. Save index on a helper thread while this one writes vectors.bin
+        auto index_task = std::async(std::launch::async, [&write_index, &index_tmp] {
+            return write_index_file(write_index, index_tmp);
+        });
+
+        // 2. Save vectors (with metadata), each block with one large write
+        // or a few chunked ones; the header is written last, once the
+        // checksums are known
+        const std::size_t count = order.size();
+        const std::size_t dimension = config_.dimension;
+        VectorFileHeader header;
+        header.magic = kMagicNumber;
+        header.version = kVersion;
+        header.count = count;
+        header.dimension = dimension;
+        header.ids_offset = kPageSize;
+        header.vectors_offset = align_to_page(header.ids_offset + count * sizeof(std::uint64_t));
+        header.metadata_offset = header.vectors_offset + count * dimension * sizeof(float);
+        header.delta_sequence = sequence;
+
+        std::ofstream vectors_file(vectors_tmp, std::ios::binary);
+        if (!vectors_file) {
+            return ErrorCode::IOError;
+        }
+
+        // Header page (placeholder)
+        std::vector<char> padding(kPageSize, 0);
+        vectors_file.write(padding.data(), kPageSize);
+
+        // ID block, padded to the page-aligned vector block
+        const std::size_t ids_bytes = count * sizeof(std::uint64_t);
+        header.ids_crc = utils::crc32c(order.data(), ids_bytes);
+        vectors_file.write(reinterpret_cast<const char*>(order.data()),
+                           static_cast<std::streamsize>(ids_bytes));
+        vectors_file.write(padding.data(), static_cast<std::streamsize>(
+            header.vectors_offset - header.ids_offset - ids_bytes));
+
+        // Vector block, read back a chunk of rows at a time under a short
+        // shared lock so writers interleave with the save; the metadata
+        // block (length and bytes per row) is encoded along the way
+        const std::size_t row_bytes = dimension * sizeof(float);
+        const std::size_t chunk_rows = std::max<std::size_t>(1, kChecksumBufferSize / row_bytes);
+        std::vector<float> chunk(chunk_rows * dimension);
+        std::string metadata_block;
+        auto append_metadata = [&metadata_block](std::optional<std::string_view> metadata) {
+            std::uint32_t meta_len = metadata.has_value()
+                ? static_cast<std::uint32_t>(metadata->size()) : 0;
+            metadata_block.append(reinterpret_cast<const char*>(&meta_len), sizeof(meta_len));
             if (meta_len > 0) {
-                vectors_file.write(record.metadata->data(), meta_len);
+                metadata_block.append(*metadata);
+            }
+        };
+        for (std::size_t begin = 0; begin < count; begin += chunk_rows) {
+            const std::size_t rows = std::min(chunk_rows, count - begin);
+            {
+                std::shared_lock lock(mutex_);
+                for (std::size_t r = 0; r < rows; ++r) {
+                    const std::uint64_t id = order[begin + r];
+                    std::span<float> row = std::span<float>(chunk).subspan(r * dimension, dimension);
+
+                    // Removed since the capture: use the preserved copy
+                    auto preimage = capture_preimages_.find(id);
+                    if (preimage != capture_preimages_.end()) {
+                        std::copy(preimage->second.vector.begin(), preimage->second.vector.end(),
+                                  row.begin());
+                        append_metadata(preimage->second.metadata);
+                        continue;
+                    }
+
+                    auto record = records_.find(id);
+                    if (record == records_.end() || !index_->get_vector(id, row)) {
+                        return ErrorCode::InvalidState;
+                    }
+                    append_metadata(metadata_.view(record->second));
+                }
             }
+            header.vectors_crc = utils::crc32c(chunk.data(), rows * row_bytes, header.vectors_crc);
+            vectors_file.write(reinterpret_cast<const char*>(chunk.data()),
+                               static_cast<std::streamsize>(rows * row_bytes));
         }
 
+        header.metadata_size = metadata_block.size();
+        header.metadata_crc = utils::crc32c(metadata_block.data(), metadata_block.size());
+        vectors_file.write(metadata_block.data(),
+                           static_cast<std::streamsize>(metadata_block.size()));
+
+        // 3. Wait for the index and record both files' checksums
+        const IndexFileResult index_file = index_task.get();
+        if (index_file.result != ErrorCode::Ok) {
+            return index_file.result;
+        }
+        header.index_size = index_file.size;
+        header.index_crc = index_file.crc;
+        vectors_file.seekp(0);
+        vectors_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
         vectors_file.close();
+        if (!vectors_file) {
+            return ErrorCode::IOError;
+        }
 
+        // With a WAL the snapshot, and the renames that publish it, must be
+        // on disk before the log it supersedes is cut
+        if (wal_ && (!sync_file(index_tmp) || !sync_file(vectors_tmp))) {
+            return ErrorCode::IOError;
+        }
+        std::filesystem::rename(index_tmp, index_path);
+        std::filesystem::rename(vectors_tmp, vectors_path);
+        if (wal_ && !sync_directory(config_.data_path)) {
+            return ErrorCode::IOError;
+        }
         return ErrorCode::Ok;
 
     } catch (const std::exception&) {
@@ -474,81 +824,286 @@ ErrorCode VectorDatabase::load() {
         return ErrorCode::InvalidParameter;
     }
 
-    // Acquire exclusive lock for write access (loading modifies data)
-    std::unique_lock lock(vectors_mutex_);
+    // Acquire exclusive lock for write access (loading modifies data),
+    // after any running save() has finished with the current state
+    std::lock_guard save_lock(save_mutex_);
+    std::unique_lock lock(mutex_);
+
+    if (!wal_) {
+        return load_snapshot();
+    }
+
+    // Entries this session has logged but not yet committed must be on disk
+    // before the log is replayed
+    ErrorCode result = wal_->sync();
+    if (result != ErrorCode::Ok) {
+        return result;
+    }
 
+    // Start from the last snapshot, or from empty if only a log exists
+    const bool has_snapshot = std::filesystem::exists(config_.data_path + "/vectors.bin");
+    if (has_snapshot) {
+        result = load_snapshot();
+    } else if (std::filesystem::exists(wal_path())) {
+        index_ = create_index();
+        records_.clear();
+        metadata_.clear();
+        drop_delta_tracking();
+    } else {
+        result = ErrorCode::IOError;
+    }
+
+    if (result == ErrorCode::Ok) {
+        result = replay_wal();
+    }
+    if (result == ErrorCode::Ok) {
+        result = open_wal();
+    }
+    total_inserts_.store(records_.size(), std::memory_order_relaxed);
+    return result;
+}
+
+ErrorCode VectorDatabase::load_snapshot() {
     try {
-        // 1. Load index
-        std::string index_path = config_.data_path + "/index.bin";
-        std::ifstream index_file(index_path, std::ios::binary);
-        if (!index_file) {
+        const std::string index_path = config_.data_path + "/index.bin";
+        const std::string vectors_path = config_.data_path + "/vectors.bin";
+
+        const bool rebuild = config_.rebuild_index_on_load;
+        const bool has_index = std::filesystem::exists(index_path);
+        drop_delta_tracking();
+        std::ifstream vectors_file(vectors_path, std::ios::binary);
+        if (!vectors_file || (!has_index && !rebuild)) {
             return ErrorCode::IOError;
         }
 
-        ErrorCode result = index_->deserialize(index_file);
-        if (result != ErrorCode::Ok) {
-            return result;
+        // Read header (older versions end it early)
+        VectorFileHeader header;
+        vectors_file.read(reinterpret_cast<char*>(&header), kLegacyHeaderSize);
+        if (!vectors_file || header.magic != kMagicNumber ||
+            (header.version != kVersion && header.version != kUncheckedVersion &&
+             header.version != kLegacyVersion)) {
+            return ErrorCode::IOError;
+        }
+        if (header.dimension != config_.dimension) {
+            return ErrorCode::DimensionMismatch;
+        }
+        if (header.version != kLegacyVersion) {
+            const std::size_t header_size =
+                header.version == kVersion ? sizeof(header) : kUncheckedHeaderSize;
+            vectors_file.read(reinterpret_cast<char*>(&header) + kLegacyHeaderSize,
+                              static_cast<std::streamsize>(header_size - kLegacyHeaderSize));
+        }
+        const bool checked = header.version == kVersion;
+        const bool mapped = config_.enable_mmap && header.version != kLegacyVersion;
+
+        // With rebuild_index_on_load the index is rebuilt from the vector
+        // block when index.bin is missing, fails to load or does not match
+        // the checksum recorded by save()
+        bool stale = !has_index;
+
+        // 1. Load index. With enable_mmap it is served from a mapping of
+        // index.bin if it can be, and otherwise serves vectors from the
+        // mapped vector block instead of reading its own copy (the mapping
+        // is also held here: ids point into it). Otherwise it is read on a
+        // helper thread while this one reads the rest of vectors.bin.
+        std::shared_ptr<MappedFile> mapping;
+        std::vector<std::uint64_t> id_buffer;
+        std::span<const std::uint64_t> ids;
+        std::future<IndexFileResult> index_task;
+        std::future<std::optional<std::uint32_t>> vectors_task;
+        if (mapped) {
+            mapping = MappedFile::open(vectors_path);
+            const std::size_t vector_bytes = header.count * config_.dimension * sizeof(float);
+            if (!mapping ||
+                header.ids_offset + header.count * sizeof(std::uint64_t) > mapping->size() ||
+                header.vectors_offset % kPageSize != 0 ||
+                header.vectors_offset + vector_bytes > mapping->size()) {
+                return ErrorCode::IOError;
+            }
+            ids = {reinterpret_cast<const std::uint64_t*>(mapping->data() + header.ids_offset),
+                   header.count};
+
+            if (has_index) {
+                std::ifstream index_file(index_path, std::ios::binary);
+                ErrorCode result = index_->open_mapped(MappedFile::open(index_path));
+                if (result == ErrorCode::NotImplemented) {
+                    result = index_->deserialize_mapped(
+                        index_file, MappedVectors{mapping, header.vectors_offset, ids});
+                }
+                if (result != ErrorCode::Ok) {
+                    if (!rebuild) {
+                        return result;
+                    }
+                    stale = true;
+                }
+            }
+        } else if (has_index) {
+            index_task = std::async(std::launch::async, [this, &index_path] {
+                return read_index_file(*index_, index_path);
+            });
+            if (checked && config_.verify_on_load) {
+                // Not read by a heap load: verified only on request
+                vectors_task = std::async(std::launch::async, [&vectors_path, &header] {
+                    return checksum_file_range(vectors_path, header.vectors_offset,
+                                               header.count * header.dimension * sizeof(float));
+                });
+            }
         }
-        index_file.close();
 
-        // 2. Load vectors
-        std::string vectors_path = config_.data_path + "/vectors.bin";
-        std::ifstream vectors_file(vectors_path, std::ios::binary);
-        if (!vectors_file) {
-            return ErrorCode::IOError;
+        // 2. Read IDs and metadata blocks; version 1 interleaves ID, vector
+        // and metadata per record and is regrouped into the same form (its
+        // vectors are kept only if the index may have to be rebuilt)
+        const std::size_t dimension = config_.dimension;
+        std::string metadata_block;
+        std::vector<float> vector_buffer;
+        if (header.version == kLegacyVersion) {
+            id_buffer.resize(header.count);
+            if (rebuild) {
+                vector_buffer.resize(header.count * dimension);
+            }
+            for (std::uint64_t i = 0; i < header.count && vectors_file; ++i) {
+                vectors_file.read(reinterpret_cast<char*>(&id_buffer[i]), sizeof(std::uint64_t));
+                if (rebuild) {
+                    vectors_file.read(reinterpret_cast<char*>(vector_buffer.data() + i * dimension),
+                                      static_cast<std::streamsize>(dimension * sizeof(float)));
+                } else {
+                    vectors_file.seekg(static_cast<std::streamoff>(dimension * sizeof(float)),
+                                       std::ios::cur);
+                }
+                std::uint32_t meta_len = 0;
+                vectors_file.read(reinterpret_cast<char*>(&meta_len), sizeof(meta_len));
+                const std::size_t at = metadata_block.size();
+                metadata_block.resize(at + sizeof(meta_len) + meta_len);
+                std::memcpy(metadata_block.data() + at, &meta_len, sizeof(meta_len));
+                vectors_file.read(metadata_block.data() + at + sizeof(meta_len), meta_len);
+            }
+            ids = id_buffer;
+        } else {
+            if (!mapped) {
+                id_buffer.resize(header.count);
+                vectors_file.seekg(static_cast<std::streamoff>(header.ids_offset));
+                vectors_file.read(reinterpret_cast<char*>(id_buffer.data()),
+                                  static_cast<std::streamsize>(header.count * sizeof(std::uint64_t)));
+                ids = id_buffer;
+            }
+            const std::uint64_t metadata_size = checked
+                ? header.metadata_size
+                : std::filesystem::file_size(vectors_path) - header.metadata_offset;
+            metadata_block.resize(metadata_size);
+            vectors_file.seekg(static_cast<std::streamoff>(header.metadata_offset));
+            vectors_file.read(metadata_block.data(), static_cast<std::streamsize>(metadata_size));
+        }
+        bool intact = static_cast<bool>(vectors_file);
+        if (checked && intact) {
+            intact = utils::crc32c(ids.data(), ids.size_bytes()) == header.ids_crc &&
+                     utils::crc32c(metadata_block.data(), metadata_block.size()) ==
+                         header.metadata_crc;
+        }
+
+        // 3. Wait for the helper threads
+        if (index_task.valid()) {
+            const IndexFileResult index_file = index_task.get();
+            const bool matches = !checked || (index_file.size == header.index_size &&
+                                              index_file.crc == header.index_crc);
+            if (rebuild && (index_file.result != ErrorCode::Ok || !matches)) {
+                stale = true;
+            } else if (index_file.result != ErrorCode::Ok) {
+                return index_file.result;
+            } else if (!matches) {
+                intact = false;
+            }
+        }
+        if (vectors_task.valid() && vectors_task.get() != header.vectors_crc) {
+            intact = false;
         }
 
-        // Read header
-        std::uint32_t magic, version;
-        std::uint64_t count;
-        vectors_file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
-        vectors_file.read(reinterpret_cast<char*>(&version), sizeof(version));
-        vectors_file.read(reinterpret_cast<char*>(&count), sizeof(count));
+        // A mapped block is verified once something reads all of it: a
+        // rebuild, or verify_on_load (pages are otherwise faulted in lazily)
+        if (checked && intact && mapping && (stale || config_.verify_on_load)) {
+            intact = utils::crc32c(mapping->data() + header.vectors_offset,
+                                   header.count * dimension * sizeof(float)) == header.vectors_crc;
+        }
 
-        if (magic != kMagicNumber) {
+        // 4. Rebuild a stale index straight from the vector block: mapped in
+        // place, or read with one large read (version 1 rows were gathered
+        // in step 2)
+        if (intact && stale) {
+            MatrixView vectors(vector_buffer.data(), header.count, dimension);
+            if (mapping) {
+                vectors = MatrixView(
+                    reinterpret_cast<const float*>(mapping->data() + header.vectors_offset),
+                    header.count, dimension);
+            } else if (header.version != kLegacyVersion) {
+                vector_buffer.resize(header.count * dimension);
+                vectors_file.seekg(static_cast<std::streamoff>(header.vectors_offset));
+                vectors_file.read(reinterpret_cast<char*>(vector_buffer.data()),
+                                  static_cast<std::streamsize>(vector_buffer.size() * sizeof(float)));
+                intact = static_cast<bool>(vectors_file) &&
+                         (!checked || utils::crc32c(vector_buffer.data(),
+                                                    vector_buffer.size() * sizeof(float)) ==
+                                          header.vectors_crc);
+                vectors = MatrixView(vector_buffer.data(), header.count, dimension);
+            }
+            if (intact) {
+                ErrorCode result = rebuild_index_locked(ids, vectors);
+                if (result != ErrorCode::Ok) {
+                    index_ = create_index();
+                    records_.clear();
+                    metadata_.clear();
+                    return result;
+                }
+            }
+        }
+        if (!intact) {
+            index_ = create_index();
+            records_.clear();
+            metadata_.clear();
             return ErrorCode::IOError;
         }
 
-        // Read dimension
-        std::uint64_t dim;
-        vectors_file.read(reinterpret_cast<char*>(&dim), sizeof(dim));
-        if (dim != config_.dimension) {
-            return ErrorCode::DimensionMismatch;
-        }
+        // 5. Rebuild records; the vectors themselves were restored with the index
+        records_.clear();
+        metadata_.clear();
+        std::size_t position = 0;
+        for (std::uint64_t id : ids) {
+            std::uint32_t meta_len = 0;
+            if (position + sizeof(meta_len) <= metadata_block.size()) {
+                std::memcpy(&meta_len, metadata_block.data() + position, sizeof(meta_len));
+            }
+            position += sizeof(meta_len);
+            if (position + meta_len > metadata_block.size() || !index_->contains(id)) {
+                records_.clear();
+                metadata_.clear();
+                return ErrorCode::IOError;
+            }
 
-        // Read vectors
-        vectors_.clear();
-        for (std::uint64_t i = 0; i < count; ++i) {
-            // Read ID
-            std::uint64_t id;
-            vectors_file.read(reinterpret_cast<char*>(&id), sizeof(id));
-
-            // Read vector data
-            std::vector<float> vector(config_.dimension);
-            vectors_file.read(
-                reinterpret_cast<char*>(vector.data()),
-                config_.dimension * sizeof(float)
-            );
-
-            // Read metadata
-            std::uint32_t meta_len;
-            vectors_file.read(reinterpret_cast<char*>(&meta_len), sizeof(meta_len));
-            std::optional<std::string> metadata;
+            // Copy metadata straight into the arena
+            std::optional<std::string_view> metadata;
             if (meta_len > 0) {
-                std::string meta_str(meta_len, '\0');
-                vectors_file.read(meta_str.data(), meta_len);
-                metadata = meta_str;
+                metadata = std::string_view(metadata_block.data() + position, meta_len);
+            }
+            position += meta_len;
+
+            // Store record (a repeated ID keeps its last metadata)
+            const MetadataStore::Slot slot = metadata_.add(metadata);
+            auto [it, inserted] = records_.try_emplace(id, slot);
+            if (!inserted) {
+                metadata_.remove(it->second);
+                it->second = slot;
             }
-
-            // Store record
-            VectorRecord record{id, std::move(vector), metadata};
-            vectors_[id] = std::move(record);
         }
 
-        vectors_file.close();
+        // 6. Apply the deltas saved after this snapshot
+        ErrorCode result = apply_delta_files(header.delta_sequence);
+        if (result != ErrorCode::Ok) {
+            index_ = create_index();
+            records_.clear();
+            metadata_.clear();
+            return result;
+        }
 
         // Update statistics
-        total_inserts_.store(count, std::memory_order_relaxed);
+        total_inserts_.store(records_.size(), std::memory_order_relaxed);
 
         return ErrorCode::Ok;
 
@@ -557,6 +1112,294 @@ ErrorCode VectorDatabase::load() {
     }
 }
 
+ErrorCode VectorDatabase::rebuild_index_locked(std::span<const std::uint64_t> ids,
+                                               MatrixView vectors) {
+    index_ = create_index();
+
+    // save() writes each ID once; older files may repeat one, in which case
+    // its last row wins (as its last metadata does)
+    std::unordered_map<std::uint64_t, std::size_t> last_row;
+    last_row.reserve(ids.size());
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        last_row[ids[i]] = i;
+    }
+    if (last_row.size() == ids.size()) {
+        return index_->build(ids, vectors);
+    }
+
+    std::vector<std::uint64_t> unique_ids;
+    std::vector<const float*> rows;
+    unique_ids.reserve(last_row.size());
+    rows.reserve(last_row.size());
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        if (last_row[ids[i]] == i) {
+            unique_ids.push_back(ids[i]);
+            rows.push_back(vectors.row_data(i));
+        }
+    }
+    return index_->build(unique_ids, MatrixView(rows, vectors.dim()));
+}
+
+// =============================================================================
+// Delta Snapshots
+// =============================================================================
+
+std::string VectorDatabase::delta_path(std::uint64_t sequence) const {
+    std::string digits = std::to_string(sequence);
+    digits.insert(0, digits.size() < 10 ? 10 - digits.size() : 0, '0');
+    return config_.data_path + "/delta-" + digits + ".bin";
+}
+
+std::vector<std::pair<std::uint64_t, std::string>> VectorDatabase::list_delta_files() const {
+    std::vector<std::pair<std::uint64_t, std::string>> files;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(config_.data_path, ec)) {
+        // delta-<sequence>.bin; unfinished .tmp files are not listed
+        const std::string name = entry.path().filename().string();
+        if (name.size() <= 10 || !name.starts_with("delta-") || !name.ends_with(".bin")) {
+            continue;
+        }
+        const std::string digits = name.substr(6, name.size() - 10);
+        if (std::all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            files.emplace_back(std::stoull(digits), entry.path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+ErrorCode VectorDatabase::apply_delta_files(std::uint64_t snapshot_sequence) {
+    delta_sequence_ = snapshot_sequence;
+    delta_files_ = 0;
+
+    for (const auto& [sequence, path] : list_delta_files()) {
+        // Older deltas were folded into the snapshot (save() stopped before
+        // deleting them)
+        if (sequence <= snapshot_sequence) {
+            continue;
+        }
+        SnapshotDelta delta;
+        ErrorCode result = read_snapshot_delta(path, config_.dimension, delta);
+        if (result != ErrorCode::Ok) {
+            return result;
+        }
+
+        // Removals first, then new and replaced records as one batch
+        for (std::uint64_t id : delta.removed_ids) {
+            if (records_.contains(id)) {
+                result = erase_record_locked(id);
+                if (result != ErrorCode::Ok) {
+                    return result;
+                }
+            }
+        }
+        const std::size_t dim = config_.dimension;
+        std::vector<VectorRecord> records;
+        records.reserve(delta.ids.size());
+        for (std::size_t i = 0; i < delta.ids.size(); ++i) {
+            if (records_.contains(delta.ids[i])) {
+                result = erase_record_locked(delta.ids[i]);
+                if (result != ErrorCode::Ok) {
+                    return result;
+                }
+            }
+            records.push_back(VectorRecord{
+                delta.ids[i],
+                std::vector<float>(delta.vectors.begin() + i * dim,
+                                   delta.vectors.begin() + (i + 1) * dim),
+                std::move(delta.metadata[i])
+            });
+        }
+        if (!records.empty()) {
+            result = insert_records_locked(records);
+            if (result != ErrorCode::Ok) {
+                return result;
+            }
+        }
+
+        delta_sequence_ = sequence;
+        ++delta_files_;
+    }
+
+    // Changes from here on (including a replayed log) go into the next delta
+    snapshot_current_ = config_.max_snapshot_deltas > 0;
+    return ErrorCode::Ok;
+}
+
+ErrorCode VectorDatabase::capture_delta_locked(SnapshotDelta& delta, std::uint64_t& wal_position) {
+    // Current vector and metadata of every changed ID, plus tombstones
+    const std::size_t dim = config_.dimension;
+    delta.sequence = delta_sequence_ + 1;
+    delta.removed_ids.assign(removed_ids_.begin(), removed_ids_.end());
+    delta.ids.assign(changed_ids_.begin(), changed_ids_.end());
+    delta.vectors.resize(delta.ids.size() * dim);
+    delta.metadata.reserve(delta.ids.size());
+    for (std::size_t i = 0; i < delta.ids.size(); ++i) {
+        if (!index_->get_vector(delta.ids[i], std::span<float>(delta.vectors).subspan(i * dim, dim))) {
+            delta = SnapshotDelta{};
+            return ErrorCode::InvalidState;
+        }
+        delta.metadata.push_back(metadata_.get(records_.at(delta.ids[i])));
+    }
+
+    // Log entries from here on are not in the delta
+    if (wal_) {
+        ErrorCode result = open_wal();
+        if (result != ErrorCode::Ok) {
+            delta = SnapshotDelta{};
+            return result;
+        }
+        wal_position = wal_->end_position();
+    }
+
+    // Writes from here on go into the next delta
+    changed_ids_.clear();
+    removed_ids_.clear();
+    return ErrorCode::Ok;
+}
+
+ErrorCode VectorDatabase::write_delta(const SnapshotDelta& delta, std::uint64_t wal_position) {
+    const std::string path = delta_path(delta.sequence);
+    const std::string tmp = path + ".tmp";
+    ErrorCode result = ErrorCode::Ok;
+    try {
+        std::filesystem::create_directories(config_.data_path);
+        result = write_snapshot_delta(tmp, config_.dimension, delta);
+
+        // As for a full save, the delta and its name must be on disk before
+        // the log it supersedes is cut
+        if (result == ErrorCode::Ok && wal_ && !sync_file(tmp)) {
+            result = ErrorCode::IOError;
+        }
+        if (result == ErrorCode::Ok) {
+            std::filesystem::rename(tmp, path);
+            if (wal_ && !sync_directory(config_.data_path)) {
+                result = ErrorCode::IOError;
+            }
+        }
+    } catch (const std::exception&) {
+        result = ErrorCode::IOError;
+    }
+
+    if (result != ErrorCode::Ok) {
+        // The captured changes are no longer tracked: the next save is full
+        std::unique_lock lock(mutex_);
+        drop_delta_tracking();
+        return result;
+    }
+
+    delta_sequence_ = delta.sequence;
+    ++delta_files_;
+
+    // Writers log under mutex_ exclusive; holding it keeps them from
+    // appending while the log is cut, as in save()
+    if (wal_) {
+        std::unique_lock lock(mutex_);
+        return wal_->discard_before(wal_position);
+    }
+    return ErrorCode::Ok;
+}
+
+void VectorDatabase::track_insert(std::uint64_t id) {
+    if (!snapshot_current_) {
+        return;
+    }
+    changed_ids_.insert(id);
+    // Beyond this the next save() is a full one anyway
+    if (changed_ids_.size() + removed_ids_.size() > records_.size()) {
+        drop_delta_tracking();
+    }
+}
+
+void VectorDatabase::track_remove(std::uint64_t id) {
+    if (!snapshot_current_) {
+        return;
+    }
+    changed_ids_.erase(id);
+    removed_ids_.insert(id);
+    if (changed_ids_.size() + removed_ids_.size() > records_.size()) {
+        drop_delta_tracking();
+    }
+}
+
+void VectorDatabase::drop_delta_tracking() {
+    snapshot_current_ = false;
+    changed_ids_.clear();
+    removed_ids_.clear();
+}
+
+// =============================================================================
+// Write-Ahead Log
+// =============================================================================
+
+std::string VectorDatabase::wal_path() const {
+    return config_.data_path + "/wal.log";
+}
+
+ErrorCode VectorDatabase::open_wal() {
+    if (wal_->is_open()) {
+        return ErrorCode::Ok;
+    }
+    try {
+        std::filesystem::create_directories(config_.data_path);
+    } catch (const std::exception&) {
+        return ErrorCode::IOError;
+    }
+    return wal_->open(wal_path());
+}
+
+ErrorCode VectorDatabase::commit_wal(WriteAheadLog::Lsn lsn) {
+    // With a sync interval the background flusher commits; durability of
+    // this write then lags by at most one interval
+    if (config_.wal_sync_interval_ms > 0) {
+        return ErrorCode::Ok;
+    }
+    return wal_->wait_durable(lsn);
+}
+
+ErrorCode VectorDatabase::replay_wal() {
+    std::vector<VectorRecord> pending;
+    std::unordered_set<std::uint64_t> pending_ids;
+
+    auto apply_pending = [&]() {
+        ErrorCode result = pending.empty() ? ErrorCode::Ok : insert_records_locked(pending);
+        pending.clear();
+        pending_ids.clear();
+        return result;
+    };
+
+    ErrorCode result = WriteAheadLog::replay(wal_path(), config_.dimension,
+                                             [&](const WalEntry& entry) {
+        // Entries touching a queued ID must see the queue applied first
+        if (pending_ids.contains(entry.id)) {
+            ErrorCode applied = apply_pending();
+            if (applied != ErrorCode::Ok) {
+                return applied;
+            }
+        }
+
+        // An insert of an existing ID replaces it (the log may predate the
+        // snapshot it is replayed onto); a remove of a missing ID is a no-op
+        if (records_.contains(entry.id)) {
+            ErrorCode erased = erase_record_locked(entry.id);
+            if (erased != ErrorCode::Ok) {
+                return erased;
+            }
+        }
+
+        if (entry.type == WalEntry::Type::Insert) {
+            pending.push_back(VectorRecord{entry.id, entry.vector, entry.metadata});
+            pending_ids.insert(entry.id);
+        }
+        return ErrorCode::Ok;
+    });
+
+    if (result != ErrorCode::Ok) {
+        return result;
+    }
+    return apply_pending();
+}
+
 // =============================================================================
 // Helper Methods
 // =============================================================================
@@ -577,7 +1420,7 @@ double VectorDatabase::get_time_ms() const {
 bool VectorDatabase::should_rebuild_ivf(std::size_t batch_size) const {
     // Rebuild if batch adds >50% more data
     // Rationale: k-means clustering with all data produces better centroids
-    return batch_size > vectors_.size() * 0.5;
+    return batch_size > records_.size() * 0.5;
 }
 
 ErrorCode VectorDatabase::bulk_build(std::span<const VectorRecord> records) {
@@ -594,50 +1437,58 @@ ErrorCode VectorDatabase::bulk_build(std::span<const VectorRecord> records) {
         }
     }
 
-    // Store all records in vectors_
-    for (const auto& record : records) {
-        vectors_[record.id] = record;
-    }
-
     // Build index from all records (index has its own locking)
     ErrorCode result = index_->build(records);
     if (result == ErrorCode::Ok) {
-        total_inserts_.fetch_add(records.size(), std::memory_order_relaxed);
-    } else {
-        // Rollback: remove all records from vectors_
         for (const auto& record : records) {
-            vectors_.erase(record.id);
+            records_[record.id] = metadata_.add(record.metadata);
         }
+        total_inserts_.fetch_add(records.size(), std::memory_order_relaxed);
     }
     return result;
 }
 
 ErrorCode VectorDatabase::rebuild_with_merge(std::span<const VectorRecord> records) {
-    // Check for duplicate IDs in new records vs existing
+    // Check dimensions and duplicate IDs in new records vs existing
     for (const auto& record : records) {
-        if (vectors_.contains(record.id)) {
+        if (record.vector.size() != config_.dimension) {
+            return ErrorCode::DimensionMismatch;
+        }
+        if (records_.contains(record.id)) {
             return ErrorCode::InvalidParameter;
         }
     }
 
-    // Merge existing + new vectors
-    std::vector<VectorRecord> all_records;
-    all_records.reserve(vectors_.size() + records.size());
+    // Existing vectors live only in the index that is about to be rebuilt,
+    // so copy them into one temporary block; new vectors are referenced
+    const std::size_t dim = config_.dimension;
+    std::vector<float> existing(records_.size() * dim);
+    std::vector<std::uint64_t> all_ids;
+    std::vector<const float*> all_rows;
+    all_ids.reserve(records_.size() + records.size());
+    all_rows.reserve(records_.size() + records.size());
 
     // Add existing vectors
-    for (const auto& [id, record] : vectors_) {
-        all_records.push_back(record);
+    for (const auto& [id, slot] : records_) {
+        std::span<float> row(existing.data() + all_rows.size() * dim, dim);
+        if (!index_->get_vector(id, row)) {
+            return ErrorCode::InvalidState;
+        }
+        all_ids.push_back(id);
+        all_rows.push_back(row.data());
     }
 
     // Add new vectors
-    all_records.insert(all_records.end(), records.begin(), records.end());
+    for (const auto& record : records) {
+        all_ids.push_back(record.id);
+        all_rows.push_back(record.vector.data());
+    }
 
     // Rebuild index with all data
-    ErrorCode result = index_->build(all_records);
+    ErrorCode result = index_->build(all_ids, MatrixView(all_rows, dim));
     if (result == ErrorCode::Ok) {
-        // Update vector storage
         for (const auto& record : records) {
-            vectors_[record.id] = record;
+            records_[record.id] = metadata_.add(record.metadata);
         }
         total_inserts_.fetch_add(records.size(), std::memory_order_relaxed);
     }
@@ -653,23 +1504,17 @@ ErrorCode VectorDatabase::incremental_insert(std::span<const VectorRecord> recor
             return validation;
         }
 
-        // Check for duplicate ID and store vector (with lock)
-        {
-            std::unique_lock lock(vectors_mutex_);
-            if (vectors_.contains(record.id)) {
-                return ErrorCode::InvalidParameter;
-            }
-            vectors_[record.id] = record;
-        } // Release lock before calling into index
+        std::unique_lock lock(mutex_);
+        if (records_.contains(record.id)) {
+            return ErrorCode::InvalidParameter;
+        }
 
-        // Add to index (index has its own locking)
+        // Add to index, then record the ID
         ErrorCode result = index_->add(record.id, record.vector);
         if (result != ErrorCode::Ok) {
-            // Rollback this insert
-            std::unique_lock lock(vectors_mutex_);
-            vectors_.erase(record.id);
             return result;
         }
+        records_.emplace(record.id, metadata_.add(record.metadata));
 
         total_inserts_.fetch_add(1, std::memory_order_relaxed);
     }
@@ -7,8 +7,10 @@
  *
  * Thread Safety:
  * - Uses std::shared_mutex for readers-writer lock pattern
- * - Multiple concurrent readers (search, get, contains, all_records, stats)
- * - Exclusive writer access (insert, remove, batch_insert, save, load)
+ * - Multiple concurrent readers (search, get, contains, all_records, stats);
+ *   search holds the lock only to pin the index
+ * - Exclusive writer access (remove, batch_insert, save, load); insert
+ *   updates the index under a shared lock and publishes the ID exclusively
  *
  * @copyright MIT License
  */
@@ -19,10 +21,15 @@
 #include "../include/lynx/lynx.h"
 #include "lynx_intern.h"
 #include "record_iterator_impl.h"
+#include "metadata_store.h"
+#include "snapshot_delta.h"
+#include "write_ahead_log.h"
 #include <unordered_map>
+#include <unordered_set>
 #include <memory>
 #include <atomic>
 #include <chrono>
+#include <mutex>
 #include <shared_mutex>
 
 namespace lynx {
@@ -34,15 +41,25 @@ namespace lynx {
  * that works with any IVectorIndex implementation (Flat, HNSW, IVF).
  *
  * Features:
- * - In-memory vector storage
+ * - Single copy of each vector: the index owns vector data; the database
+ *   keeps IDs and reads vectors back through the index
+ * - Metadata packed into an arena (MetadataStore), only read by get()
+ *   and iteration
  * - Delegates search operations to pluggable index implementations
  * - Statistics tracking (queries, inserts, memory usage)
- * - Persistence support (save/load)
+ * - Persistence support (save/load), optionally with a write-ahead log so
+ *   durable writes do not require a full save()
  *
  * Thread Safety:
  * - Thread-safe using std::shared_mutex (readers-writer lock)
  * - Read operations use shared locks (concurrent reads allowed)
- * - Write operations use exclusive locks (serialized writes)
+ * - Write operations use exclusive locks (serialized writes), held until
+ *   the index has been updated so readers never see an ID without its vector.
+ *   insert() is the exception: it adds the vector under a shared lock, then
+ *   records the ID under a short exclusive one, so a search may return an
+ *   ID just before get() finds it
+ * - Searches copy the index pointer under the shared lock and search after
+ *   releasing it; the indexes are thread-safe themselves
  * - Statistics use atomic operations for lock-free updates
  */
 class VectorDatabase : public IVectorDatabase {
@@ -132,6 +149,147 @@ private:
      */
     double get_time_ms() const;
 
+    /**
+     * @brief Insert validated records into the index and ID map.
+     *
+     * Builds the index when the database is empty, otherwise adds the
+     * records one by one and rolls back on failure. Caller holds mutex_
+     * exclusively.
+     *
+     * @param records Records with valid dimensions and unique IDs
+     * @return ErrorCode::InvalidParameter if an ID already exists, else the
+     *         index result
+     */
+    ErrorCode insert_records_locked(std::span<const VectorRecord> records);
+
+    /**
+     * @brief Remove an existing ID from the index, ID map and metadata.
+     *        Caller holds mutex_ exclusively.
+     *
+     * While a save() is writing, the record is first copied for it.
+     */
+    ErrorCode erase_record_locked(std::uint64_t id);
+
+    /**
+     * @brief Read index.bin, vectors.bin and the delta files written after
+     *        them. Caller holds mutex_ exclusively.
+     *
+     * The index is read on a helper thread while this one reads the IDs and
+     * metadata; every block that is read is checked against its CRC-32C.
+     * With enable_mmap, vectors.bin is mapped and indexes that support it
+     * serve their vectors from the mapping instead of reading them; mapped
+     * blocks are not checksummed, as that would read them in full.
+     * With rebuild_index_on_load, a missing or stale index.bin is replaced
+     * by an index built from the vector block.
+     */
+    ErrorCode load_snapshot();
+
+    /**
+     * @brief Replace the index with one bulk-built from `vectors`.
+     *
+     * Rows are read in place (no VectorRecords are materialized). If an ID
+     * repeats, its last row is kept. Caller holds mutex_ exclusively.
+     *
+     * @param ids One ID per row of vectors
+     * @param vectors Vector data, e.g. the mapped or read vector block
+     */
+    ErrorCode rebuild_index_locked(std::span<const std::uint64_t> ids, MatrixView vectors);
+
+    /**
+     * @brief Path of the delta file with the given sequence number.
+     */
+    std::string delta_path(std::uint64_t sequence) const;
+
+    /**
+     * @brief Delta files in data_path as (sequence, path), in sequence order.
+     */
+    std::vector<std::pair<std::uint64_t, std::string>> list_delta_files() const;
+
+    /**
+     * @brief Apply the delta files newer than the snapshot just loaded and
+     *        start tracking changes against them. Caller holds mutex_
+     *        exclusively.
+     *
+     * @param snapshot_sequence Last delta folded into the snapshot
+     */
+    ErrorCode apply_delta_files(std::uint64_t snapshot_sequence);
+
+    /**
+     * @brief Copy the changes since the last save() or load() into the next
+     *        delta and restart change tracking. Caller holds save_mutex_ and
+     *        mutex_ exclusively.
+     *
+     * @param delta Filled with the changes (left empty on failure)
+     * @param wal_position Set to the end of the log at the capture
+     */
+    ErrorCode capture_delta_locked(SnapshotDelta& delta, std::uint64_t& wal_position);
+
+    /**
+     * @brief Write a captured delta file and cut the log it supersedes.
+     *        Caller holds save_mutex_ only.
+     *
+     * @param delta Captured changes
+     * @param wal_position End of the log at the capture
+     */
+    ErrorCode write_delta(const SnapshotDelta& delta, std::uint64_t wal_position);
+
+    /**
+     * @brief Write index.bin and vectors.bin for a captured snapshot and
+     *        rename them into place. Caller holds save_mutex_ only.
+     *
+     * Rows are read a chunk at a time under short shared locks; records
+     * removed since the capture are read from capture_preimages_.
+     *
+     * @param order Captured IDs, in the index's storage order if it has one
+     * @param write_index Writes the index as captured (IndexCapture::serialize)
+     * @param sequence Last delta folded into the snapshot
+     */
+    ErrorCode write_snapshot_files(std::span<const std::uint64_t> order,
+                                   const std::function<ErrorCode(std::ostream&)>& write_index,
+                                   std::uint64_t sequence);
+
+    /**
+     * @brief Record an inserted or removed ID for the next delta.
+     *
+     * Only tracked while the files on disk match the state before the
+     * changes. Caller holds mutex_ exclusively.
+     */
+    void track_insert(std::uint64_t id);
+    void track_remove(std::uint64_t id);
+
+    /**
+     * @brief Stop tracking changes; the next save() writes a full snapshot.
+     */
+    void drop_delta_tracking();
+
+    /**
+     * @brief Path of the write-ahead log file.
+     */
+    std::string wal_path() const;
+
+    /**
+     * @brief Open the write-ahead log, creating data_path if needed.
+     */
+    ErrorCode open_wal();
+
+    /**
+     * @brief Make a logged write durable according to wal_sync_interval_ms.
+     *
+     * Called after mutex_ is released so concurrent writers share fsyncs.
+     *
+     * @param lsn LSN of the write's last log entry
+     */
+    ErrorCode commit_wal(WriteAheadLog::Lsn lsn);
+
+    /**
+     * @brief Apply the write-ahead log on top of the current state.
+     *
+     * Consecutive inserts are applied as one batch so an empty index is
+     * built rather than grown one vector at a time. Caller holds mutex_
+     * exclusively.
+     */
+    ErrorCode replay_wal();
+
     /**
      * @brief Check if IVF index should be rebuilt with new data
      * @param batch_size Size of batch to insert
@@ -170,11 +328,36 @@ private:
     // Index (polymorphic - Flat, HNSW, or IVF)
     std::shared_ptr<IVectorIndex> index_;                    ///< Index implementation
 
-    // Vector storage
-    std::unordered_map<std::uint64_t, VectorRecord> vectors_; ///< Vector storage
+    // Record storage (vector data lives only in index_)
+    std::unordered_map<std::uint64_t, MetadataStore::Slot> records_; ///< ID -> metadata slot
+    MetadataStore metadata_;                                  ///< Packed metadata values
+
+    // Durability (enable_wal with a data_path; null otherwise)
+    std::unique_ptr<WriteAheadLog> wal_;                      ///< Log of writes since the last save()
+
+    // Delta snapshots (max_snapshot_deltas > 0). snapshot_current_ and the
+    // change sets are written under mutex_ held exclusively, with one
+    // exception: the capture of a full save() resets them under save_mutex_,
+    // insert_mutex_ and mutex_ shared. That is safe because every other
+    // writer touches them with mutex_ exclusive, saves exclude each other,
+    // and readers never look at these members. delta_sequence_ and delta_files_ belong to save()
+    // and load() and are guarded by save_mutex_ alone.
+    bool snapshot_current_ = false;                           ///< Files on disk = state before the tracked changes
+    std::uint64_t delta_sequence_ = 0;                        ///< Sequence of the newest delta on disk
+    std::size_t delta_files_ = 0;                             ///< Deltas on top of the full snapshot
+    std::unordered_set<std::uint64_t> changed_ids_;           ///< Inserted since the last save or load
+    std::unordered_set<std::uint64_t> removed_ids_;           ///< Removed since the last save or load
+
+    // Online save. While a full save() writes its files, records removed
+    // are copied here first so it reads them as of the capture; both are
+    // guarded by mutex_ (capture_active_ is set like the change sets above).
+    bool capture_active_ = false;                             ///< A full save() is writing
+    std::unordered_map<std::uint64_t, VectorRecord> capture_preimages_; ///< Removed since the capture
 
     // Thread safety
-    mutable std::shared_mutex vectors_mutex_;                 ///< Protects vectors_ map
+    mutable std::shared_mutex mutex_;                         ///< Protects records_, metadata_ and index_ contents
+    std::mutex save_mutex_;                                   ///< Serializes save() and load(); taken before mutex_
+    std::mutex insert_mutex_;                                 ///< Serializes insert(), which adds to the index under mutex_ shared; taken after save_mutex_, before mutex_
 
     // Statistics (using atomics for lock-free updates)
     // Marked mutable to allow updates in const methods (search, stats)
@@ -184,7 +367,52 @@ private:
 
     // Constants for persistence
     static constexpr std::uint32_t kMagicNumber = 0x4C594E58;  ///< "LYNX" in hex
-    static constexpr std::uint32_t kVersion = 1;               ///< File format version
+    static constexpr std::uint32_t kVersion = 3;               ///< File format version (checksummed sections)
+    static constexpr std::uint32_t kUncheckedVersion = 2;      ///< Page-aligned blocks, no checksums (still loadable)
+    static constexpr std::uint32_t kLegacyVersion = 1;         ///< Interleaved records (still loadable)
+    static constexpr std::size_t kPageSize = 4096;             ///< Alignment of vectors.bin blocks
+    static constexpr std::size_t kLegacyHeaderSize = 24;       ///< Version 1 header bytes
+    static constexpr std::size_t kUncheckedHeaderSize = 48;    ///< Version 2 header bytes
+    static constexpr std::size_t kDeltaFoldDivisor = 10;       ///< Deltas only while changes <= records / this
+
+    /**
+     * @brief First page of vectors.bin.
+     *
+     * Layout: header page, ID block (count u64), vector block (count x
+     * dimension floats, page aligned so it can be mapped as the index's
+     * vector storage), then per-row metadata (u32 length + bytes). Rows
+     * follow IVectorIndex::storage_order() when the index has one.
+     * Version 3 adds the size of the metadata block and CRC-32C checksums of each
+     * block and of index.bin, and the sequence number of the last delta
+     * file folded into the snapshot (zero in files written before delta
+     * snapshots: the header page is zero padded). Version 2 ends the header after
+     * `metadata_offset`; version 1 ends it after `dimension` and
+     * interleaves ID, vector and metadata per record.
+     */
+    struct VectorFileHeader {
+        std::uint32_t magic = 0;
+        std::uint32_t version = 0;
+        std::uint64_t count = 0;
+        std::uint64_t dimension = 0;
+        std::uint64_t ids_offset = 0;        ///< Version 2 only
+        std::uint64_t vectors_offset = 0;    ///< Version 2 only
+        std::uint64_t metadata_offset = 0;   ///< Version 2 only
+        std::uint64_t metadata_size = 0;     ///< Version 3 only
+        std::uint64_t index_size = 0;        ///< Version 3: bytes in index.bin
+        std::uint32_t index_crc = 0;         ///< Version 3: CRC-32C of index.bin
+        std::uint32_t ids_crc = 0;           ///< Version 3: CRC-32C of the ID block
+        std::uint32_t vectors_crc = 0;       ///< Version 3: CRC-32C of the vector block
+        std::uint32_t metadata_crc = 0;      ///< Version 3: CRC-32C of the metadata block
+        std::uint64_t delta_sequence = 0;    ///< Version 3: last delta folded into this snapshot
+    };
+    static_assert(sizeof(VectorFileHeader) == kUncheckedHeaderSize + 5 * sizeof(std::uint64_t));
+
+    /**
+     * @brief Round a file offset up to the next page boundary.
+     */
+    static constexpr std::uint64_t align_to_page(std::uint64_t offset) {
+        return (offset + kPageSize - 1) / kPageSize * kPageSize;
+    }
 };
 
 } // namespace lynx
@@ -0,0 +1,549 @@
+/**
+ * @file write_ahead_log.cpp
+ * @brief Implementation of WriteAheadLog class
+ *
+ * @copyright MIT License
+ */
+
+#include "write_ahead_log.h"
+#include "utils.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace lynx {
+
+namespace {
+
+constexpr std::uint32_t kWalMagic = 0x4C57414C;   ///< "LWAL" in hex
+constexpr std::uint32_t kWalVersion = 1;
+constexpr std::size_t kHeaderSize = sizeof(std::uint32_t) * 2 + sizeof(std::uint64_t);
+constexpr std::size_t kFrameHeaderSize = sizeof(std::uint32_t) * 2;
+constexpr std::uint32_t kMaxPayload = 1u << 30;   ///< Larger lengths are treated as corruption
+
+template <typename T>
+void put(std::vector<char>& out, const T& value) {
+    const auto at = out.size();
+    out.resize(at + sizeof(T));
+    std::memcpy(out.data() + at, &value, sizeof(T));
+}
+
+template <typename T>
+bool take(const char*& p, const char* end, T& value) {
+    if (static_cast<std::size_t>(end - p) < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&value, p, sizeof(T));
+    p += sizeof(T);
+    return true;
+}
+
+std::vector<char> make_header(std::size_t dimension) {
+    std::vector<char> header;
+    put(header, kWalMagic);
+    put(header, kWalVersion);
+    put(header, static_cast<std::uint64_t>(dimension));
+    return header;
+}
+
+bool write_all(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+/// fsync the directory holding `path`, so a rename onto it survives a crash
+bool sync_parent_directory(const std::string& path) {
+    const std::string::size_type slash = path.find_last_of('/');
+    const std::string dir = slash == std::string::npos ? "." : path.substr(0, std::max<std::size_t>(slash, 1));
+    int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    const bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+}
+
+/**
+ * @brief Sequential reader over a file descriptor with a large buffer, so
+ *        replaying millions of small frames does not cost a syscall each.
+ */
+class BufferedReader {
+public:
+    explicit BufferedReader(int fd) : fd_(fd), buffer_(1 << 20) {}
+
+    /// Read exactly size bytes; false on EOF or error.
+    bool read(char* out, std::size_t size) {
+        while (size > 0) {
+            if (pos_ == end_) {
+                ssize_t n = ::read(fd_, buffer_.data(), buffer_.size());
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n <= 0) {
+                    return false;
+                }
+                pos_ = 0;
+                end_ = static_cast<std::size_t>(n);
+            }
+            std::size_t chunk = std::min(size, end_ - pos_);
+            std::memcpy(out, buffer_.data() + pos_, chunk);
+            pos_ += chunk;
+            out += chunk;
+            size -= chunk;
+            consumed_ += chunk;
+        }
+        return true;
+    }
+
+    [[nodiscard]] std::uint64_t consumed() const { return consumed_; }
+
+private:
+    int fd_;
+    std::vector<char> buffer_;
+    std::size_t pos_ = 0;
+    std::size_t end_ = 0;
+    std::uint64_t consumed_ = 0;
+};
+
+} // namespace
+
+// =============================================================================
+// Constructor and Destructor
+// =============================================================================
+
+WriteAheadLog::WriteAheadLog(std::size_t dimension, std::chrono::milliseconds sync_interval)
+    : dimension_(dimension), sync_interval_(sync_interval) {}
+
+WriteAheadLog::~WriteAheadLog() {
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    flusher_cv_.notify_all();
+    if (flusher_.joinable()) {
+        flusher_.join();
+    }
+
+    sync();
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+// =============================================================================
+// Opening and Replay
+// =============================================================================
+
+ErrorCode WriteAheadLog::open(const std::string& path) {
+    std::lock_guard lock(mutex_);
+    if (fd_ >= 0) {
+        return ErrorCode::Ok;
+    }
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return ErrorCode::IOError;
+    }
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return ErrorCode::IOError;
+    }
+
+    if (st.st_size == 0) {
+        // New log: write the header
+        const std::vector<char> header = make_header(dimension_);
+        if (!write_all(fd, header.data(), header.size()) || ::fsync(fd) != 0) {
+            ::close(fd);
+            return ErrorCode::IOError;
+        }
+        end_position_ = kHeaderSize;
+    } else {
+        // Existing log: validate it and cut off a torn tail
+        ErrorCode result = read_header(fd, dimension_);
+        std::uint64_t valid_end = kHeaderSize;
+        if (result == ErrorCode::Ok) {
+            result = read_frames(fd, dimension_, {}, valid_end);
+        }
+        if (result != ErrorCode::Ok) {
+            ::close(fd);
+            return result;
+        }
+        if (valid_end < static_cast<std::uint64_t>(st.st_size) &&
+            (::ftruncate(fd, static_cast<off_t>(valid_end)) != 0 || ::fsync(fd) != 0)) {
+            ::close(fd);
+            return ErrorCode::IOError;
+        }
+        end_position_ = valid_end;
+    }
+
+    fd_ = fd;
+    path_ = path;
+    error_ = ErrorCode::Ok;
+    if (sync_interval_.count() > 0 && !flusher_.joinable()) {
+        flusher_ = std::thread(&WriteAheadLog::flusher_loop, this);
+    }
+    return ErrorCode::Ok;
+}
+
+bool WriteAheadLog::is_open() const {
+    std::lock_guard lock(mutex_);
+    return fd_ >= 0;
+}
+
+ErrorCode WriteAheadLog::replay(const std::string& path, std::size_t dimension,
+                                const std::function<ErrorCode(const WalEntry&)>& apply) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return errno == ENOENT ? ErrorCode::Ok : ErrorCode::IOError;
+    }
+
+    struct stat st {};
+    ErrorCode result = ::fstat(fd, &st) == 0 ? ErrorCode::Ok : ErrorCode::IOError;
+    if (result == ErrorCode::Ok && st.st_size > 0) {
+        result = read_header(fd, dimension);
+        std::uint64_t valid_end = kHeaderSize;
+        if (result == ErrorCode::Ok) {
+            result = read_frames(fd, dimension, apply, valid_end);
+        }
+    }
+    ::close(fd);
+    return result;
+}
+
+ErrorCode WriteAheadLog::read_header(int fd, std::size_t dimension) {
+    if (::lseek(fd, 0, SEEK_SET) != 0) {
+        return ErrorCode::IOError;
+    }
+
+    char header[kHeaderSize];
+    BufferedReader reader(fd);
+    if (!reader.read(header, kHeaderSize)) {
+        return ErrorCode::IOError;
+    }
+
+    const char* p = header;
+    std::uint32_t magic = 0;
+    std::uint32_t version = 0;
+    std::uint64_t dim = 0;
+    take(p, header + kHeaderSize, magic);
+    take(p, header + kHeaderSize, version);
+    take(p, header + kHeaderSize, dim);
+    if (magic != kWalMagic || version != kWalVersion) {
+        return ErrorCode::IOError;
+    }
+    if (dim != dimension) {
+        return ErrorCode::DimensionMismatch;
+    }
+
+    // Leave the file positioned at the first frame
+    return ::lseek(fd, static_cast<off_t>(kHeaderSize), SEEK_SET) ==
+                   static_cast<off_t>(kHeaderSize)
+               ? ErrorCode::Ok
+               : ErrorCode::IOError;
+}
+
+ErrorCode WriteAheadLog::read_frames(int fd, std::size_t dimension,
+                                     const std::function<ErrorCode(const WalEntry&)>& apply,
+                                     std::uint64_t& valid_end) {
+    BufferedReader reader(fd);
+    std::vector<char> payload;
+    WalEntry entry;
+    valid_end = kHeaderSize;
+
+    while (true) {
+        char frame_header[kFrameHeaderSize];
+        if (!reader.read(frame_header, kFrameHeaderSize)) {
+            break;
+        }
+        std::uint32_t length = 0;
+        std::uint32_t checksum = 0;
+        std::memcpy(&length, frame_header, sizeof(length));
+        std::memcpy(&checksum, frame_header + sizeof(length), sizeof(checksum));
+        if (length > kMaxPayload) {
+            break;
+        }
+
+        payload.resize(length);
+        if (!reader.read(payload.data(), length) ||
+            utils::crc32(payload.data(), length) != checksum) {
+            break;
+        }
+
+        // Decode
+        const char* p = payload.data();
+        const char* end = p + length;
+        std::uint8_t type = 0;
+        if (!take(p, end, type) || !take(p, end, entry.id)) {
+            break;
+        }
+        entry.type = static_cast<WalEntry::Type>(type);
+        if (entry.type == WalEntry::Type::Insert) {
+            const std::size_t vector_bytes = dimension * sizeof(float);
+            if (static_cast<std::size_t>(end - p) < vector_bytes) {
+                break;
+            }
+            entry.vector.resize(dimension);
+            std::memcpy(entry.vector.data(), p, vector_bytes);
+            p += vector_bytes;
+
+            std::uint8_t has_metadata = 0;
+            if (!take(p, end, has_metadata)) {
+                break;
+            }
+            entry.metadata.reset();
+            if (has_metadata != 0) {
+                std::uint32_t meta_len = 0;
+                if (!take(p, end, meta_len) || static_cast<std::size_t>(end - p) < meta_len) {
+                    break;
+                }
+                entry.metadata.emplace(p, meta_len);
+                p += meta_len;
+            }
+        } else if (entry.type != WalEntry::Type::Remove) {
+            break;
+        }
+        if (p != end) {
+            break;
+        }
+
+        if (apply) {
+            ErrorCode result = apply(entry);
+            if (result != ErrorCode::Ok) {
+                return result;
+            }
+        }
+        valid_end = kHeaderSize + reader.consumed();
+    }
+    return ErrorCode::Ok;
+}
+
+// =============================================================================
+// Appending
+// =============================================================================
+
+std::size_t WriteAheadLog::begin_frame() {
+    const std::size_t offset = buffer_.size();
+    buffer_.resize(offset + kFrameHeaderSize);  // Length and checksum filled by end_frame()
+    return offset;
+}
+
+void WriteAheadLog::end_frame(std::size_t offset) {
+    const char* payload = buffer_.data() + offset + kFrameHeaderSize;
+    const auto length = static_cast<std::uint32_t>(buffer_.size() - offset - kFrameHeaderSize);
+    const std::uint32_t checksum = utils::crc32(payload, length);
+    std::memcpy(buffer_.data() + offset, &length, sizeof(length));
+    std::memcpy(buffer_.data() + offset + sizeof(length), &checksum, sizeof(checksum));
+    end_position_ += kFrameHeaderSize + length;
+}
+
+WriteAheadLog::Lsn WriteAheadLog::append_insert(std::uint64_t id, std::span<const float> vector,
+                                                const std::optional<std::string>& metadata) {
+    std::lock_guard lock(mutex_);
+    const std::size_t offset = begin_frame();
+    put(buffer_, static_cast<std::uint8_t>(WalEntry::Type::Insert));
+    put(buffer_, id);
+    const auto* bytes = reinterpret_cast<const char*>(vector.data());
+    buffer_.insert(buffer_.end(), bytes, bytes + vector.size_bytes());
+    put(buffer_, static_cast<std::uint8_t>(metadata.has_value() ? 1 : 0));
+    if (metadata.has_value()) {
+        put(buffer_, static_cast<std::uint32_t>(metadata->size()));
+        buffer_.insert(buffer_.end(), metadata->begin(), metadata->end());
+    }
+    end_frame(offset);
+    return ++appended_lsn_;
+}
+
+WriteAheadLog::Lsn WriteAheadLog::append_remove(std::uint64_t id) {
+    std::lock_guard lock(mutex_);
+    const std::size_t offset = begin_frame();
+    put(buffer_, static_cast<std::uint8_t>(WalEntry::Type::Remove));
+    put(buffer_, id);
+    end_frame(offset);
+    return ++appended_lsn_;
+}
+
+// =============================================================================
+// Group Commit
+// =============================================================================
+
+ErrorCode WriteAheadLog::wait_durable(Lsn lsn) {
+    std::unique_lock lock(mutex_);
+    while (durable_lsn_ < lsn && error_ == ErrorCode::Ok) {
+        if (committing_) {
+            // Another writer is leading a commit; it or the next leader covers us
+            durable_cv_.wait(lock);
+        } else {
+            commit_locked(lock);
+        }
+    }
+    return error_;
+}
+
+ErrorCode WriteAheadLog::sync() {
+    Lsn target;
+    {
+        std::lock_guard lock(mutex_);
+        target = appended_lsn_;
+    }
+    return wait_durable(target);
+}
+
+void WriteAheadLog::commit_locked(std::unique_lock<std::mutex>& lock) {
+    if (fd_ < 0) {
+        error_ = ErrorCode::InvalidState;
+        durable_cv_.notify_all();
+        return;
+    }
+
+    // Take everything appended so far; new appends go to a fresh buffer_
+    committing_ = true;
+    write_buffer_.swap(buffer_);
+    const Lsn target = appended_lsn_;
+    const int fd = fd_;
+    lock.unlock();
+
+    const bool ok = write_all(fd, write_buffer_.data(), write_buffer_.size()) && ::fsync(fd) == 0;
+    write_buffer_.clear();
+
+    lock.lock();
+    committing_ = false;
+    if (ok) {
+        durable_lsn_ = target;
+    } else {
+        error_ = ErrorCode::IOError;
+    }
+    durable_cv_.notify_all();
+}
+
+ErrorCode WriteAheadLog::reset() {
+    std::unique_lock lock(mutex_);
+    while (committing_) {
+        durable_cv_.wait(lock);
+    }
+    return truncate_locked();
+}
+
+ErrorCode WriteAheadLog::truncate_locked() {
+    if (fd_ < 0) {
+        return ErrorCode::InvalidState;
+    }
+
+    buffer_.clear();
+    if (::ftruncate(fd_, static_cast<off_t>(kHeaderSize)) != 0 || ::fsync(fd_) != 0) {
+        error_ = ErrorCode::IOError;
+    } else {
+        durable_lsn_ = appended_lsn_;
+        end_position_ = kHeaderSize;
+    }
+    durable_cv_.notify_all();
+    return error_;
+}
+
+std::uint64_t WriteAheadLog::end_position() const {
+    std::lock_guard lock(mutex_);
+    return end_position_;
+}
+
+ErrorCode WriteAheadLog::discard_before(std::uint64_t position) {
+    std::unique_lock lock(mutex_);
+    while (committing_) {
+        durable_cv_.wait(lock);
+    }
+
+    // Checked under the same lock as the truncation, so an entry appended
+    // after the snapshot cannot be dropped with the old ones
+    if (position >= end_position_) {
+        return truncate_locked();
+    }
+    if (fd_ < 0) {
+        return ErrorCode::InvalidState;
+    }
+    if (error_ != ErrorCode::Ok) {
+        return error_;
+    }
+
+    // Commit what is still buffered, then read back the frames to keep;
+    // they were appended while the snapshot was written, so there are few
+    if (!write_all(fd_, buffer_.data(), buffer_.size())) {
+        error_ = ErrorCode::IOError;
+        durable_cv_.notify_all();
+        return error_;
+    }
+    buffer_.clear();
+
+    std::vector<char> kept = make_header(dimension_);
+    const std::size_t tail = static_cast<std::size_t>(end_position_ - position);
+    kept.resize(kHeaderSize + tail);
+    std::size_t done = 0;
+    while (done < tail) {
+        ssize_t n = ::pread(fd_, kept.data() + kHeaderSize + done, tail - done,
+                            static_cast<off_t>(position + done));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            error_ = ErrorCode::IOError;
+            durable_cv_.notify_all();
+            return error_;
+        }
+        done += static_cast<std::size_t>(n);
+    }
+
+    // Write the new log next to the old one and rename it into place, so a
+    // crash leaves one of the two complete
+    const std::string tmp = path_ + ".tmp";
+    int fd = ::open(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        error_ = ErrorCode::IOError;
+        durable_cv_.notify_all();
+        return error_;
+    }
+    if (!write_all(fd, kept.data(), kept.size()) || ::fsync(fd) != 0 ||
+        ::rename(tmp.c_str(), path_.c_str()) != 0) {
+        ::close(fd);
+        ::unlink(tmp.c_str());
+        error_ = ErrorCode::IOError;
+        durable_cv_.notify_all();
+        return error_;
+    }
+
+    ::close(fd_);
+    fd_ = fd;
+    end_position_ = kept.size();
+    durable_lsn_ = appended_lsn_;
+
+    // Until the rename is on disk a crash may bring back the old log
+    if (!sync_parent_directory(path_)) {
+        error_ = ErrorCode::IOError;
+    }
+    durable_cv_.notify_all();
+    return error_;
+}
+
+void WriteAheadLog::flusher_loop() {
+    std::unique_lock lock(mutex_);
+    while (!stop_) {
+        flusher_cv_.wait_for(lock, sync_interval_, [this] { return stop_; });
+        if (!stop_ && !committing_ && durable_lsn_ < appended_lsn_ && error_ == ErrorCode::Ok) {
+            commit_locked(lock);
+        }
+    }
+}
+
+} // namespace lynx
@@ -0,0 +1,234 @@
+/**
+ * @file write_ahead_log.h
+ * @brief Append-only write-ahead log with group commit
+ *
+ * Logs inserts and removes between snapshots so that a database can be
+ * recovered as "last save() + log replay" without rewriting every vector on
+ * each durable write.
+ *
+ * File layout:
+ * - Header: magic (u32), version (u32), dimension (u64)
+ * - Frames: payload length (u32), CRC-32 of payload (u32), payload
+ * - Payload: type (u8), id (u64), and for inserts the vector
+ *   (dimension floats) followed by a metadata flag (u8) and, if set, the
+ *   metadata length (u32) and bytes
+ *
+ * A torn or corrupt frame ends the log; everything before it is replayed.
+ *
+ * @copyright MIT License
+ */
+
+#ifndef LYNX_WRITE_AHEAD_LOG_H
+#define LYNX_WRITE_AHEAD_LOG_H
+
+#include "../include/lynx/lynx.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lynx {
+
+/**
+ * @brief One logged mutation, as handed to the replay callback.
+ */
+struct WalEntry {
+    enum class Type : std::uint8_t {
+        Insert = 1,
+        Remove = 2
+    };
+
+    Type type = Type::Insert;
+    std::uint64_t id = 0;
+    std::vector<float> vector;              ///< Insert only
+    std::optional<std::string> metadata;    ///< Insert only
+};
+
+/**
+ * @brief Write-ahead log with batched fsync.
+ *
+ * Appends only encode into an in-memory buffer and return a log sequence
+ * number (LSN). Durability is reached by writing and fsync-ing the buffer:
+ * - wait_durable(lsn) blocks until the entry is on disk. The first waiter
+ *   becomes the leader and commits everything appended so far; writers that
+ *   arrive meanwhile queue behind it and are committed together by the next
+ *   leader (group commit), so one fsync covers many writes.
+ * - With a non-zero sync interval a background thread commits the buffer
+ *   periodically and callers may skip waiting, bounding data loss to one
+ *   interval.
+ *
+ * The first write error is sticky: later commits report it.
+ *
+ * Thread-safety: All member functions are thread-safe.
+ */
+class WriteAheadLog {
+public:
+    using Lsn = std::uint64_t;
+
+    /**
+     * @brief Construct a closed log.
+     * @param dimension Vector dimensionality recorded in the header
+     * @param sync_interval Background commit period (0 = no background thread)
+     */
+    WriteAheadLog(std::size_t dimension, std::chrono::milliseconds sync_interval);
+
+    /**
+     * @brief Commits pending entries and closes the file.
+     */
+    ~WriteAheadLog();
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    /**
+     * @brief Open (or create) the log file for appending.
+     *
+     * An existing file is kept; a torn tail is cut off so new frames follow
+     * the last valid one. Opening an already open log is a no-op.
+     *
+     * @param path Log file path
+     * @return ErrorCode::Ok, ErrorCode::IOError, or
+     *         ErrorCode::DimensionMismatch if the file has another dimension
+     */
+    ErrorCode open(const std::string& path);
+
+    /**
+     * @brief Check whether the log file is open.
+     */
+    [[nodiscard]] bool is_open() const;
+
+    /**
+     * @brief Append an insert.
+     * @return LSN of the entry
+     */
+    Lsn append_insert(std::uint64_t id, std::span<const float> vector,
+                      const std::optional<std::string>& metadata);
+
+    /**
+     * @brief Append a remove.
+     * @return LSN of the entry
+     */
+    Lsn append_remove(std::uint64_t id);
+
+    /**
+     * @brief Block until the entry with the given LSN is on disk.
+     * @return ErrorCode::Ok or the sticky write error
+     */
+    ErrorCode wait_durable(Lsn lsn);
+
+    /**
+     * @brief Commit everything appended so far.
+     */
+    ErrorCode sync();
+
+    /**
+     * @brief Drop all entries (they are covered by a new snapshot).
+     *
+     * Callers must ensure no appends run concurrently.
+     */
+    ErrorCode reset();
+
+    /**
+     * @brief Position just past the last appended entry.
+     *
+     * Entries appended later lie after it, committed or not.
+     */
+    [[nodiscard]] std::uint64_t end_position() const;
+
+    /**
+     * @brief Drop the entries before a position (they are covered by a new
+     *        snapshot) and keep the ones after it.
+     *
+     * The kept entries are committed and copied into a new log file that
+     * replaces the old one. Callers must ensure no appends run concurrently.
+     *
+     * @param position Value of end_position() when the snapshot was taken
+     */
+    ErrorCode discard_before(std::uint64_t position);
+
+    /**
+     * @brief Apply every valid entry of a log file in order.
+     *
+     * @param path Log file path (a missing file replays nothing)
+     * @param dimension Expected vector dimensionality
+     * @param apply Callback for each entry; a non-Ok result stops replay
+     * @return ErrorCode::Ok, the callback's error, ErrorCode::IOError for an
+     *         unreadable file, or ErrorCode::DimensionMismatch
+     */
+    static ErrorCode replay(const std::string& path, std::size_t dimension,
+                            const std::function<ErrorCode(const WalEntry&)>& apply);
+
+private:
+    /**
+     * @brief Read frames from an open log file.
+     *
+     * @param fd Readable file descriptor positioned after the header
+     * @param dimension Expected vector dimensionality
+     * @param apply Callback for each entry (may be empty to only validate)
+     * @param valid_end Receives the offset just past the last valid frame
+     */
+    static ErrorCode read_frames(int fd, std::size_t dimension,
+                                 const std::function<ErrorCode(const WalEntry&)>& apply,
+                                 std::uint64_t& valid_end);
+
+    /**
+     * @brief Validate the header of an open log and seek to the first frame.
+     */
+    static ErrorCode read_header(int fd, std::size_t dimension);
+
+    /**
+     * @brief Begin a frame in buffer_; returns its offset.
+     */
+    std::size_t begin_frame();
+
+    /**
+     * @brief Fill in length and checksum of the frame starting at offset.
+     */
+    void end_frame(std::size_t offset);
+
+    /**
+     * @brief Write and fsync buffer_ as the leader (lock is released meanwhile).
+     */
+    void commit_locked(std::unique_lock<std::mutex>& lock);
+
+    /**
+     * @brief Drop every entry, buffered or on disk. Caller holds mutex_ and
+     *        no leader is committing.
+     */
+    ErrorCode truncate_locked();
+
+    /**
+     * @brief Background commit loop (sync_interval_ > 0 only).
+     */
+    void flusher_loop();
+
+    std::size_t dimension_;
+    std::chrono::milliseconds sync_interval_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable durable_cv_;   ///< Signals a finished commit
+    std::condition_variable flusher_cv_;   ///< Wakes the flusher on shutdown
+
+    int fd_ = -1;                          ///< Log file (append mode)
+    std::string path_;                     ///< Log file path
+    std::uint64_t end_position_ = 0;       ///< File offset past the last appended frame
+    std::vector<char> buffer_;             ///< Frames appended but not yet written
+    std::vector<char> write_buffer_;       ///< Frames being written by the leader
+    Lsn appended_lsn_ = 0;                 ///< Last appended entry
+    Lsn durable_lsn_ = 0;                  ///< Last entry known to be on disk
+    bool committing_ = false;              ///< A leader is writing
+    bool stop_ = false;                    ///< Flusher shutdown request
+    ErrorCode error_ = ErrorCode::Ok;      ///< First write error (sticky)
+
+    std::thread flusher_;
+};
+
+} // namespace lynx
+
+#endif // LYNX_WRITE_AHEAD_LOG_H
@@ -0,0 +1,113 @@
+/**
+ * @file test_checksum_stream.cpp
+ * @brief Unit tests for the CRC-32 functions and the checksum stream filters
+ *
+ * @copyright MIT License
+ */
+
+#include "../src/lib/checksum_stream.h"
+#include "../src/lib/utils.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <sstream>
+#include <string>
+
+using namespace lynx;
+
+namespace {
+
+std::string random_bytes(std::size_t size) {
+    std::mt19937 rng(17);
+    std::string bytes(size, '\0');
+    for (auto& c : bytes) {
+        c = static_cast<char>(rng());
+    }
+    return bytes;
+}
+
+} // namespace
+
+// ============================================================================
+// CRC-32
+// ============================================================================
+
+TEST(Crc32Test, MatchesReferenceValues) {
+    const std::string check = "123456789";
+    EXPECT_EQ(utils::crc32(check.data(), check.size()), 0xCBF43926u);
+    EXPECT_EQ(utils::crc32c(check.data(), check.size()), 0xE3069283u);
+    EXPECT_EQ(utils::crc32(check.data(), 0), 0u);
+    EXPECT_EQ(utils::crc32c(check.data(), 0), 0u);
+}
+
+TEST(Crc32Test, ChainedCallsEqualOneCall) {
+    const std::string data = random_bytes(1000);
+    const std::uint32_t whole = utils::crc32(data.data(), data.size());
+    const std::uint32_t whole_c = utils::crc32c(data.data(), data.size());
+    for (std::size_t split : {0, 1, 7, 8, 9, 500, 999}) {
+        std::uint32_t crc = utils::crc32(data.data(), split);
+        crc = utils::crc32(data.data() + split, data.size() - split, crc);
+        EXPECT_EQ(crc, whole) << "split at " << split;
+
+        std::uint32_t crc_c = utils::crc32c(data.data(), split);
+        crc_c = utils::crc32c(data.data() + split, data.size() - split, crc_c);
+        EXPECT_EQ(crc_c, whole_c) << "split at " << split;
+    }
+}
+
+// ============================================================================
+// Stream Filters
+// ============================================================================
+
+TEST(ChecksumStreamTest, OutputForwardsBytesAndChecksumsThem) {
+    const std::string data = random_bytes(10000);
+    std::stringbuf target;
+    {
+        ChecksumOutputBuffer checked(&target, 64);
+        std::ostream out(&checked);
+
+        // Mix of small writes, single characters and writes larger than the buffer
+        out.write(data.data(), 3);
+        out.put(data[3]);
+        out.write(data.data() + 4, 50);
+        out.write(data.data() + 54, 5000);
+        out.write(data.data() + 5054, data.size() - 5054);
+        out.flush();
+
+        EXPECT_EQ(checked.bytes(), data.size());
+        EXPECT_EQ(checked.crc(), utils::crc32c(data.data(), data.size()));
+    }
+    EXPECT_EQ(target.str(), data);
+}
+
+TEST(ChecksumStreamTest, DestructorForwardsPendingBytes) {
+    std::stringbuf target;
+    {
+        ChecksumOutputBuffer checked(&target);
+        std::ostream out(&checked);
+        out << "pending";
+    }
+    EXPECT_EQ(target.str(), "pending");
+}
+
+TEST(ChecksumStreamTest, InputReadsBytesAndChecksumsThem) {
+    const std::string data = random_bytes(10000);
+    std::stringbuf source(data);
+    ChecksumInputBuffer checked(&source, 64);
+    std::istream in(&checked);
+
+    std::string read(data.size(), '\0');
+    in.read(read.data(), 3);
+    read[3] = static_cast<char>(in.get());
+    in.read(read.data() + 4, 50);
+    in.ignore(100);
+    in.read(read.data() + 154, 5000);
+    in.read(read.data() + 5154, static_cast<std::streamsize>(data.size() - 5154));
+    ASSERT_TRUE(in.good());
+    EXPECT_EQ(read.substr(0, 54), data.substr(0, 54));
+    EXPECT_EQ(read.substr(154), data.substr(154));
+
+    // Reading past the end fails but the checksum covers the whole source
+    EXPECT_EQ(in.get(), std::char_traits<char>::eof());
+    EXPECT_EQ(checked.bytes(), data.size());
+    EXPECT_EQ(checked.crc(), utils::crc32c(data.data(), data.size()));
+}
@@ -50,6 +50,23 @@ TEST(ConfigTest, DefaultEnableMmap) {
     EXPECT_FALSE(config.enable_mmap);
 }
 
+TEST(ConfigTest, DefaultRebuildIndexOnLoad) {
+    lynx::Config config;
+    EXPECT_FALSE(config.rebuild_index_on_load);
+    EXPECT_FALSE(config.verify_on_load);
+}
+
+TEST(ConfigTest, DefaultMaxSnapshotDeltas) {
+    lynx::Config config;
+    EXPECT_EQ(config.max_snapshot_deltas, 0); // Every save() is a full snapshot
+}
+
+TEST(ConfigTest, DefaultSegmentedStorage) {
+    lynx::Config config;
+    EXPECT_EQ(config.memtable_capacity, 0); // A single index
+    EXPECT_EQ(config.max_sealed_segments, 4);
+}
+
 // ============================================================================
 // HNSW Params Default Values Tests
 // ============================================================================
@@ -98,6 +115,29 @@ TEST(IVFParamsTest, DefaultPQSubvectors) {
     EXPECT_EQ(params.pq_subvectors, 8);
 }
 
+TEST(IVFParamsTest, DefaultRebalance) {
+    lynx::IVFParams params;
+    EXPECT_FALSE(params.auto_rebalance);
+    EXPECT_FLOAT_EQ(params.split_factor, 4.0f);
+    EXPECT_FLOAT_EQ(params.merge_factor, 0.1f);
+}
+
+TEST(IVFParamsTest, DefaultHnswQuantizer) {
+    lynx::IVFParams params;
+    EXPECT_FALSE(params.use_hnsw_quantizer);
+    EXPECT_EQ(params.quantizer_ef_search, 64);
+}
+
+TEST(IVFParamsTest, DefaultTrainingSamplesPerCluster) {
+    lynx::IVFParams params;
+    EXPECT_EQ(params.training_samples_per_cluster, 256);
+}
+
+TEST(IVFParamsTest, DefaultBalanceFactor) {
+    lynx::IVFParams params;
+    EXPECT_FLOAT_EQ(params.balance_factor, 0.0f);
+}
+
 // ============================================================================
 // Search Params Default Values Tests
 // ============================================================================
@@ -112,6 +152,14 @@ TEST(SearchParamsTest, DefaultNProbe) {
     EXPECT_EQ(params.n_probe, 10);
 }
 
+TEST(SearchParamsTest, DefaultAdaptiveNProbe) {
+    lynx::SearchParams params;
+    EXPECT_FALSE(params.adaptive_n_probe);
+    EXPECT_EQ(params.min_n_probe, 1);
+    EXPECT_EQ(params.max_n_probe, 64);
+    EXPECT_FLOAT_EQ(params.probe_distance_ratio, 1.5f);
+}
+
 TEST(SearchParamsTest, DefaultFilter) {
     lynx::SearchParams params;
     EXPECT_FALSE(params.filter.has_value());
@@ -213,6 +213,32 @@ TEST(FlatIndexTest, RemoveFromMultipleVectors) {
     EXPECT_TRUE(index.contains(5));
 }
 
+TEST(FlatIndexTest, RemoveKeepsOtherVectorsIntact) {
+    FlatIndex index(8, DistanceMetric::L2);
+    auto vectors = generate_random_vectors(10, 8);
+
+    for (std::size_t i = 0; i < vectors.size(); ++i) {
+        index.add(i, vectors[i]);
+    }
+
+    // Remove from the middle, the end and the front; overwrite one vector
+    EXPECT_EQ(index.remove(4), ErrorCode::Ok);
+    EXPECT_EQ(index.remove(9), ErrorCode::Ok);
+    EXPECT_EQ(index.remove(0), ErrorCode::Ok);
+    index.add(8, vectors[1]);
+    vectors[8] = vectors[1];
+
+    SearchParams params;
+    for (std::uint64_t id : {1, 2, 3, 5, 6, 7, 8}) {
+        auto results = index.search(vectors[id], 2, params);
+        ASSERT_EQ(results.size(), 2);
+        EXPECT_FLOAT_EQ(results[0].distance, 0.0f);
+        // IDs 1 and 8 hold the same vector; ties are ordered by ID
+        EXPECT_EQ(results[0].id, id == 8 ? 1 : id);
+    }
+    EXPECT_EQ(index.size(), 7);
+}
+
 // ============================================================================
 // Contains Tests
 // ============================================================================
@@ -310,6 +336,31 @@ TEST(FlatIndexTest, SearchL2LimitK) {
     }
 }
 
+TEST(FlatIndexTest, SearchVaryingKReturnsConsistentPrefixes) {
+    FlatIndex index(8, DistanceMetric::L2);
+    auto vectors = generate_random_vectors(200, 8);
+    for (std::size_t i = 0; i < vectors.size(); ++i) {
+        index.add(i, vectors[i]);
+    }
+
+    std::vector<float> query(8, 0.1f);
+    SearchParams params;
+    auto full = index.search(query, 1000, params);
+    ASSERT_EQ(full.size(), 200);
+    EXPECT_TRUE(std::is_sorted(full.begin(), full.end(),
+        [](const auto& a, const auto& b) { return a.distance < b.distance; }));
+
+    // Shrinking and growing k reuses the search scratch space
+    for (std::size_t k : {50, 1, 10, 199, 3}) {
+        auto results = index.search(query, k, params);
+        ASSERT_EQ(results.size(), k);
+        for (std::size_t i = 0; i < k; ++i) {
+            EXPECT_EQ(results[i].id, full[i].id);
+        }
+    }
+    EXPECT_TRUE(index.search(query, 0, params).empty());
+}
+
 TEST(FlatIndexTest, SearchL2DimensionMismatch) {
     FlatIndex index(8, DistanceMetric::L2);
     std::vector<float> vec(8, 1.0f);
@@ -441,6 +492,33 @@ TEST(FlatIndexTest, SearchWithFilterNoMatches) {
     EXPECT_TRUE(results.empty());
 }
 
+TEST(FlatIndexTest, ParallelScanMatchesSingleThread) {
+    // Large enough that the scan is split across threads
+    const std::size_t dim = 64;
+    auto vectors = generate_random_vectors(20000, dim);
+    FlatIndex serial(dim, DistanceMetric::L2, 1);
+    FlatIndex parallel(dim, DistanceMetric::L2, 4);
+    for (std::size_t i = 0; i < vectors.size(); ++i) {
+        serial.add(i, vectors[i]);
+        parallel.add(i, vectors[i]);
+    }
+
+    SearchParams params;
+    params.filter = [](std::uint64_t id) { return id % 3 != 0; };
+    auto queries = generate_random_vectors(5, dim, 7);
+    for (const auto& query : queries) {
+        auto expected = serial.search(query, 10, params);
+        auto actual = parallel.search(query, 10, params);
+        ASSERT_EQ(actual.size(), 10);
+        ASSERT_EQ(expected.size(), actual.size());
+        for (std::size_t i = 0; i < expected.size(); ++i) {
+            EXPECT_EQ(actual[i].id, expected[i].id);
+            EXPECT_EQ(actual[i].distance, expected[i].distance);
+            EXPECT_NE(actual[i].id % 3, 0);
+        }
+    }
+}
+
 // ============================================================================
 // Build Tests
 // ============================================================================
@@ -506,6 +584,33 @@ TEST(FlatIndexTest, BuildDimensionMismatch) {
     EXPECT_EQ(index.size(), 0);  // Should be cleared on error
 }
 
+TEST(FlatIndexTest, BuildFromStridedMatrixView) {
+    FlatIndex index(4, DistanceMetric::L2);
+
+    // Rows of 4 floats padded to a stride of 6
+    std::vector<float> buffer(3 * 6, -1.0f);
+    for (std::size_t r = 0; r < 3; ++r) {
+        for (std::size_t d = 0; d < 4; ++d) {
+            buffer[r * 6 + d] = static_cast<float>(r * 10 + d);
+        }
+    }
+    std::vector<std::uint64_t> ids = {7, 8, 9};
+
+    EXPECT_EQ(index.build(ids, MatrixView(buffer.data(), 3, 4, 6)), ErrorCode::Ok);
+    EXPECT_EQ(index.size(), 3);
+
+    std::vector<float> query = {10.0f, 11.0f, 12.0f, 13.0f};
+    auto results = index.search(query, 1, SearchParams{});
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_EQ(results[0].id, 8);
+    EXPECT_FLOAT_EQ(results[0].distance, 0.0f);
+
+    // Row count must match the IDs, and the view must match the dimension
+    EXPECT_EQ(index.build(std::span(ids).first(2), MatrixView(buffer.data(), 3, 4, 6)),
+              ErrorCode::InvalidParameter);
+    EXPECT_EQ(index.build(ids, MatrixView(buffer.data(), 3, 5, 6)), ErrorCode::DimensionMismatch);
+}
+
 // ============================================================================
 // Serialization Tests
 // ============================================================================
@@ -630,6 +735,47 @@ TEST(FlatIndexTest, SerializeDifferentMetrics) {
     }
 }
 
+TEST(FlatIndexTest, CaptureIsPointInTime) {
+    const std::size_t dim = 16;
+    auto vectors = generate_random_vectors(300, dim);
+    FlatIndex index(dim, DistanceMetric::L2);
+    for (std::size_t i = 0; i < 200; ++i) {
+        ASSERT_EQ(index.add(i, vectors[i]), ErrorCode::Ok);
+    }
+    std::ostringstream expected;
+    ASSERT_EQ(index.serialize(expected), ErrorCode::Ok);
+    const auto order = index.storage_order();
+
+    const std::optional<IndexCapture> captured = index.capture();
+    ASSERT_TRUE(captured.has_value());
+
+    // Removals move rows, overwrites replace them, a build drops them all;
+    // none of it reaches the capture
+    for (std::uint64_t i = 0; i < 50; ++i) {
+        ASSERT_EQ(index.remove(i), ErrorCode::Ok);
+    }
+    for (std::uint64_t i = 50; i < 100; ++i) {
+        ASSERT_EQ(index.add(i, vectors[i + 200]), ErrorCode::Ok);
+    }
+    for (std::uint64_t i = 200; i < 250; ++i) {
+        ASSERT_EQ(index.add(i, vectors[i]), ErrorCode::Ok);
+    }
+    std::ostringstream before_build;
+    ASSERT_EQ(captured->serialize(before_build), ErrorCode::Ok);
+    EXPECT_EQ(before_build.str(), expected.str());
+
+    std::vector<VectorRecord> records;
+    for (std::uint64_t i = 100; i < 120; ++i) {
+        records.push_back({i, vectors[i + 150], ""});
+    }
+    ASSERT_EQ(index.build(records), ErrorCode::Ok);
+
+    std::ostringstream after_build;
+    ASSERT_EQ(captured->serialize(after_build), ErrorCode::Ok);
+    EXPECT_EQ(after_build.str(), expected.str());
+    EXPECT_EQ(captured->ids(), order);
+}
+
 // ============================================================================
 // Properties Tests
 // ============================================================================
@@ -10,6 +10,9 @@
 #include <random>
 #include <algorithm>
 #include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
 
 using namespace lynx;
 
@@ -331,6 +334,49 @@ TEST_F(HNSWIndexTest, RemoveAndSearchAgain) {
     EXPECT_EQ(results[1].id, 3);
 }
 
+TEST_F(HNSWIndexTest, RemoveAndReinsertKeepsRecall) {
+    constexpr std::size_t dim = 16;
+    constexpr std::size_t num_vectors = 1000;
+    constexpr std::size_t k = 10;
+
+    std::mt19937 rng(42);
+    HNSWIndex index(dim, DistanceMetric::L2, params_);
+    std::vector<std::pair<std::uint64_t, std::vector<float>>> vectors;
+    for (std::uint64_t i = 0; i < num_vectors; ++i) {
+        vectors.push_back({i, generate_random_vector(dim, rng)});
+        ASSERT_EQ(index.add(i, vectors.back().second), ErrorCode::Ok);
+    }
+
+    // Churn: replace a tenth of the vectors under the same IDs, round after round
+    std::uniform_int_distribution<std::size_t> pick(0, num_vectors - 1);
+    for (int round = 0; round < 10; ++round) {
+        for (int j = 0; j < 100; ++j) {
+            auto& [id, vec] = vectors[pick(rng)];
+            ASSERT_EQ(index.remove(id), ErrorCode::Ok);
+            vec = generate_random_vector(dim, rng);
+            ASSERT_EQ(index.add(id, vec), ErrorCode::Ok);
+        }
+    }
+    EXPECT_EQ(index.size(), num_vectors);
+
+    std::size_t total_recall = 0;
+    constexpr std::size_t num_queries = 50;
+    for (std::size_t q = 0; q < num_queries; ++q) {
+        auto query = generate_random_vector(dim, rng);
+        auto hnsw_results = index.search(query, k, SearchParams{});
+        std::unordered_set<std::uint64_t> true_ids;
+        for (const auto& item : brute_force_search(query, vectors, k)) {
+            true_ids.insert(item.id);
+        }
+        for (const auto& item : hnsw_results) {
+            total_recall += true_ids.count(item.id);
+        }
+    }
+
+    double avg_recall = static_cast<double>(total_recall) / (num_queries * k);
+    EXPECT_GT(avg_recall, 0.90) << "Average recall: " << avg_recall;
+}
+
 // ============================================================================
 // Batch Build Tests
 // ============================================================================
@@ -1038,3 +1084,252 @@ TEST_F(HNSWIndexTest, SerializeDeserializePreservesParameters) {
     EXPECT_TRUE(index2.contains(1));
     EXPECT_EQ(index2.size(), 1);
 }
+
+// ============================================================================
+// CSR File Format Tests
+// ============================================================================
+
+namespace {
+
+void expect_same_results(const HNSWIndex& expected, const HNSWIndex& actual, std::size_t dim) {
+    std::mt19937 rng(321);
+    for (int q = 0; q < 20; ++q) {
+        auto query = generate_random_vector(dim, rng);
+        auto a = expected.search(query, 10, SearchParams{});
+        auto b = actual.search(query, 10, SearchParams{});
+        ASSERT_EQ(a.size(), b.size());
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            EXPECT_EQ(a[i].id, b[i].id);
+            EXPECT_FLOAT_EQ(a[i].distance, b[i].distance);
+        }
+    }
+}
+
+} // namespace
+
+TEST_F(HNSWIndexTest, LoadedGraphSearchesLikeTheOriginal) {
+    constexpr std::size_t dim = 16;
+    HNSWIndex index1(dim, DistanceMetric::L2, params_);
+    std::mt19937 rng(123);
+    for (std::uint64_t i = 0; i < 500; ++i) {
+        index1.add(i * 5 + 1, generate_random_vector(dim, rng));
+    }
+
+    std::stringstream ss;
+    ASSERT_EQ(index1.serialize(ss), ErrorCode::Ok);
+    HNSWIndex index2(dim, DistanceMetric::L2, params_);
+    ASSERT_EQ(index2.deserialize(ss), ErrorCode::Ok);
+
+    EXPECT_EQ(index2.size(), index1.size());
+    EXPECT_EQ(index2.max_layer(), index1.max_layer());
+    expect_same_results(index1, index2, dim);
+}
+
+TEST_F(HNSWIndexTest, LoadedGraphAcceptsWrites) {
+    constexpr std::size_t dim = 8;
+    HNSWIndex index1(dim, DistanceMetric::L2, params_);
+    std::mt19937 rng(5);
+    for (std::uint64_t i = 0; i < 200; ++i) {
+        index1.add(i, generate_random_vector(dim, rng));
+    }
+
+    std::stringstream ss;
+    ASSERT_EQ(index1.serialize(ss), ErrorCode::Ok);
+    HNSWIndex index2(dim, DistanceMetric::L2, params_);
+    ASSERT_EQ(index2.deserialize(ss), ErrorCode::Ok);
+
+    // The first write converts the loaded graph back into its mutable form
+    for (std::uint64_t i = 0; i < 50; ++i) {
+        ASSERT_EQ(index2.remove(i), ErrorCode::Ok);
+    }
+    std::vector<float> added(dim, 3.0f);
+    ASSERT_EQ(index2.add(1000, added), ErrorCode::Ok);
+    EXPECT_EQ(index2.size(), 151);
+
+    auto results = index2.search(added, 1, SearchParams{});
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_EQ(results[0].id, 1000);
+
+    // And survives another round trip
+    std::stringstream ss2;
+    ASSERT_EQ(index2.serialize(ss2), ErrorCode::Ok);
+    HNSWIndex index3(dim, DistanceMetric::L2, params_);
+    ASSERT_EQ(index3.deserialize(ss2), ErrorCode::Ok);
+    EXPECT_FALSE(index3.contains(0));
+    EXPECT_TRUE(index3.contains(1000));
+    expect_same_results(index2, index3, dim);
+}
+
+TEST_F(HNSWIndexTest, CaptureIsPointInTime) {
+    constexpr std::size_t dim = 8;
+    HNSWIndex index(dim, DistanceMetric::L2, params_);
+    std::mt19937 rng(17);
+    for (std::uint64_t i = 0; i < 300; ++i) {
+        index.add(i, generate_random_vector(dim, rng));
+    }
+    std::stringstream expected;
+    ASSERT_EQ(index.serialize(expected), ErrorCode::Ok);
+
+    const std::optional<IndexCapture> captured = index.capture();
+    ASSERT_TRUE(captured.has_value());
+
+    // Inserts and removals relink neighbors, removals move rows and the
+    // entry point; maintenance rewrites links everywhere
+    for (std::uint64_t i = 0; i < 100; ++i) {
+        ASSERT_EQ(index.remove(i), ErrorCode::Ok);
+    }
+    for (std::uint64_t i = 300; i < 500; ++i) {
+        ASSERT_EQ(index.add(i, generate_random_vector(dim, rng)), ErrorCode::Ok);
+    }
+    ASSERT_EQ(index.add(0, generate_random_vector(dim, rng)), ErrorCode::Ok);
+    ASSERT_EQ(index.optimize_graph(), ErrorCode::Ok);
+    ASSERT_EQ(index.compact_index(), ErrorCode::Ok);
+
+    std::stringstream actual;
+    ASSERT_EQ(captured->serialize(actual), ErrorCode::Ok);
+    EXPECT_EQ(actual.str(), expected.str());
+    EXPECT_EQ(captured->ids().size(), 300);
+}
+
+TEST_F(HNSWIndexTest, CaptureOfLoadedGraphIsPointInTime) {
+    constexpr std::size_t dim = 8;
+    HNSWIndex original(dim, DistanceMetric::L2, params_);
+    std::mt19937 rng(23);
+    for (std::uint64_t i = 0; i < 300; ++i) {
+        original.add(i, generate_random_vector(dim, rng));
+    }
+    std::stringstream image;
+    ASSERT_EQ(original.serialize(image), ErrorCode::Ok);
+    const std::string expected = image.str();
+
+    // One capture of the graph as loaded, one of its mutable form
+    HNSWIndex index(dim, DistanceMetric::L2, params_);
+    ASSERT_EQ(index.deserialize(image), ErrorCode::Ok);
+    const std::optional<IndexCapture> loaded = index.capture();
+    ASSERT_TRUE(loaded.has_value());
+    ASSERT_EQ(index.remove(5), ErrorCode::Ok);
+    std::stringstream thawed_image;
+    ASSERT_EQ(index.serialize(thawed_image), ErrorCode::Ok);
+    const std::optional<IndexCapture> thawed = index.capture();
+    ASSERT_TRUE(thawed.has_value());
+
+    // Writes, then a load replacing everything
+    for (std::uint64_t i = 0; i < 50; ++i) {
+        ASSERT_EQ(index.remove(i * 2), ErrorCode::Ok);
+    }
+    std::stringstream other_image;
+    ASSERT_EQ(HNSWIndex(dim, DistanceMetric::L2, params_).serialize(other_image), ErrorCode::Ok);
+    ASSERT_EQ(index.deserialize(other_image), ErrorCode::Ok);
+    EXPECT_EQ(index.size(), 0);
+
+    std::stringstream actual;
+    ASSERT_EQ(loaded->serialize(actual), ErrorCode::Ok);
+    EXPECT_EQ(actual.str(), expected);
+    std::stringstream thawed_actual;
+    ASSERT_EQ(thawed->serialize(thawed_actual), ErrorCode::Ok);
+    EXPECT_EQ(thawed_actual.str(), thawed_image.str());
+}
+
+TEST_F(HNSWIndexTest, OpenMappedServesIndexInPlace) {
+    constexpr std::size_t dim = 32;
+    HNSWIndex index1(dim, DistanceMetric::L2, params_);
+    std::mt19937 rng(9);
+    for (std::uint64_t i = 0; i < 1000; ++i) {
+        index1.add(i, generate_random_vector(dim, rng));
+    }
+
+    const std::string path = "/tmp/lynx_hnsw_csr_" + std::to_string(std::random_device{}());
+    {
+        std::ofstream out(path, std::ios::binary);
+        ASSERT_EQ(index1.serialize(out), ErrorCode::Ok);
+    }
+
+    HNSWIndex index2(dim, DistanceMetric::L2, params_);
+    ASSERT_EQ(index2.open_mapped(MappedFile::open(path)), ErrorCode::Ok);
+    std::filesystem::remove(path);  // The mapping stays valid
+
+    EXPECT_EQ(index2.size(), index1.size());
+    expect_same_results(index1, index2, dim);
+
+    // Vectors and graph stay in the mapping; only the ID table is on the heap
+    EXPECT_LT(index2.memory_usage(), index1.memory_usage() / 4);
+
+    std::vector<float> vec(dim);
+    ASSERT_TRUE(index2.get_vector(7, vec));
+    std::vector<float> expected(dim);
+    ASSERT_TRUE(index1.get_vector(7, expected));
+    EXPECT_EQ(vec, expected);
+
+    // Writes patch the private mapping
+    ASSERT_EQ(index2.remove(7), ErrorCode::Ok);
+    ASSERT_EQ(index2.add(5000, expected), ErrorCode::Ok);
+    auto results = index2.search(expected, 1, SearchParams{});
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_EQ(results[0].id, 5000);
+}
+
+TEST_F(HNSWIndexTest, OpenMappedRejectsOtherFiles) {
+    const std::string path = "/tmp/lynx_hnsw_csr_" + std::to_string(std::random_device{}());
+    HNSWIndex index(4, DistanceMetric::L2, params_);
+
+    // Older format versions are left to deserialize_mapped()
+    {
+        std::ofstream out(path, std::ios::binary);
+        const std::uint32_t header[2] = {0x484E5357, 2};
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+        out.write(std::string(256, '\0').data(), 256);
+    }
+    EXPECT_EQ(index.open_mapped(MappedFile::open(path)), ErrorCode::NotImplemented);
+
+    // A truncated file
+    std::vector<float> vec = {1.0f, 2.0f, 3.0f, 4.0f};
+    HNSWIndex source(4, DistanceMetric::L2, params_);
+    source.add(1, vec);
+    {
+        std::ofstream out(path, std::ios::binary);
+        ASSERT_EQ(source.serialize(out), ErrorCode::Ok);
+    }
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+    EXPECT_EQ(index.open_mapped(MappedFile::open(path)), ErrorCode::IOError);
+    EXPECT_EQ(index.size(), 0);
+
+    EXPECT_EQ(index.open_mapped(nullptr), ErrorCode::IOError);
+    std::filesystem::remove(path);
+}
+
+TEST_F(HNSWIndexTest, DeserializesVersion2Stream) {
+    // Two connected nodes in the per-node layout of format version 2
+    std::stringstream ss;
+    auto put = [&ss](const auto& value) {
+        ss.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+    put(std::uint32_t{0x484E5357});
+    put(std::uint32_t{2});
+    put(std::size_t{2});                                    // dimension
+    put(static_cast<std::uint8_t>(DistanceMetric::L2));
+    put(std::size_t{16});                                   // m
+    put(std::size_t{200});                                  // ef_construction
+    put(std::size_t{50});                                   // ef_search
+    put(std::size_t{1000});                                 // max_elements
+    put(std::uint64_t{10});                                 // entry point
+    put(std::size_t{0});                                    // entry point layer
+    put(std::size_t{2});                                    // vectors
+    for (std::uint64_t id : {10, 20}) {
+        put(id);
+        put(static_cast<float>(id));
+        put(0.0f);
+        put(std::size_t{0});                                // max layer
+        put(std::size_t{1});                                // neighbors at layer 0
+        put(std::uint64_t{id == 10 ? 20u : 10u});
+    }
+
+    HNSWIndex index(2, DistanceMetric::L2, params_);
+    ASSERT_EQ(index.deserialize(ss), ErrorCode::Ok);
+    EXPECT_EQ(index.size(), 2);
+
+    std::vector<float> query = {19.0f, 0.0f};
+    auto results = index.search(query, 2, SearchParams{});
+    ASSERT_EQ(results.size(), 2);
+    EXPECT_EQ(results[0].id, 20);
+    EXPECT_EQ(results[1].id, 10);
+}
@@ -9,11 +9,15 @@
 
 #include "../src/lib/ivf_index.h"
 #include <gtest/gtest.h>
+#include <atomic>
 #include <vector>
 #include <cmath>
 #include <random>
 #include <thread>
 #include <algorithm>
+#include <numeric>
+#include <chrono>
+#include <sstream>
 
 using namespace lynx;
 
@@ -699,6 +703,36 @@ TEST(IVFIndexTest, SearchCosineMetric) {
     EXPECT_EQ(results[0].id, 1);  // Same direction (smallest cosine distance)
 }
 
+TEST(IVFIndexTest, BuildCosineUsesUnitCentroids) {
+    IVFParams params;
+    params.n_clusters = 4;
+
+    // Same directions as the test centroids, with lengths varying 1..8
+    auto centroids = generate_test_centroids(4, 16);
+    std::vector<VectorRecord> records;
+    std::uint64_t id = 0;
+    for (const auto& centroid : centroids) {
+        for (auto& vec : generate_vectors_near_centroid(centroid, 50, 0.1f)) {
+            const float length = static_cast<float>(1 + id % 8);
+            for (auto& x : vec) {
+                x *= length;
+            }
+            records.push_back({id++, std::move(vec), std::nullopt});
+        }
+    }
+
+    IVFIndex index(16, DistanceMetric::Cosine, params);
+    ASSERT_EQ(index.build(records), ErrorCode::Ok);
+
+    for (const auto& centroid : index.centroids()) {
+        float norm_sq = 0.0f;
+        for (float x : centroid) {
+            norm_sq += x * x;
+        }
+        EXPECT_NEAR(norm_sq, 1.0f, 1e-4f);
+    }
+}
+
 TEST(IVFIndexTest, SearchDotProductMetric) {
     IVFParams params;
     params.n_clusters = 2;
@@ -904,6 +938,572 @@ TEST(IVFIndexTest, RemoveAndSearch) {
     }
 }
 
+TEST(IVFIndexTest, RemoveManyKeepsLocationsConsistent) {
+    IVFParams params;
+    params.n_clusters = 2;
+
+    IVFIndex index(8, DistanceMetric::L2, params);
+    index.set_centroids(generate_test_centroids(2, 8, 100.0f));
+
+    auto vectors = generate_random_vectors_ivf(200, 8);
+    for (std::size_t i = 0; i < vectors.size(); ++i) {
+        ASSERT_EQ(index.add(i, vectors[i]), ErrorCode::Ok);
+    }
+
+    // Remove from the front, back and middle of the lists so that swap-remove
+    // relocates entries repeatedly
+    for (std::size_t i = 0; i < vectors.size(); i += 3) {
+        ASSERT_EQ(index.remove(i), ErrorCode::Ok);
+    }
+    for (std::size_t i = vectors.size() - 1; i > 100; i -= 3) {
+        index.remove(i);
+    }
+
+    SearchParams search_params;
+    search_params.n_probe = 2;
+    for (std::size_t i = 0; i < vectors.size(); ++i) {
+        if (!index.contains(i)) {
+            EXPECT_EQ(index.remove(i), ErrorCode::VectorNotFound);
+            continue;
+        }
+        // Every remaining vector must still be found at distance 0
+        auto results = index.search(vectors[i], 1, search_params);
+        ASSERT_EQ(results.size(), 1);
+        EXPECT_EQ(results[0].id, i);
+        EXPECT_EQ(index.remove(i), ErrorCode::Ok);
+    }
+    EXPECT_EQ(index.size(), 0);
+}
+
+TEST(IVFIndexTest, RemoveBatch) {
+    IVFParams params;
+    params.n_clusters = 3;
+
+    IVFIndex index(8, DistanceMetric::L2, params);
+    index.set_centroids(generate_test_centroids(3, 8));
+
+    auto vectors = generate_random_vectors_ivf(50, 8);
+    for (std::size_t i = 0; i < vectors.size(); ++i) {
+        index.add(i, vectors[i]);
+    }
+
+    std::vector<std::uint64_t> ids = {1, 7, 7, 20, 49, 0};
+    EXPECT_EQ(index.remove_batch(ids), ErrorCode::Ok);
+    EXPECT_EQ(index.size(), 45);
+    for (std::uint64_t id : ids) {
+        EXPECT_FALSE(index.contains(id));
+    }
+    EXPECT_TRUE(index.contains(2));
+}
+
+TEST(IVFIndexTest, RemoveBatchMissingIdRemovesNothing) {
+    IVFParams params;
+    params.n_clusters = 3;
+
+    IVFIndex index(8, DistanceMetric::L2, params);
+    index.set_centroids(generate_test_centroids(3, 8));
+
+    auto vectors = generate_random_vectors_ivf(10, 8);
+    for (std::size_t i = 0; i < vectors.size(); ++i) {
+        index.add(i, vectors[i]);
+    }
+
+    std::vector<std::uint64_t> ids = {1, 2, 999};
+    EXPECT_EQ(index.remove_batch(ids), ErrorCode::VectorNotFound);
+    EXPECT_EQ(index.size(), 10);
+    EXPECT_TRUE(index.contains(1));
+    EXPECT_TRUE(index.contains(2));
+}
+
+// ============================================================================
+// Rebalancing Tests
+// ============================================================================
+
+TEST(IVFIndexTest, ConstructorInvalidRebalanceFactors) {
+    IVFParams params;
+    params.split_factor = 1.0f;
+    params.merge_factor = 0.5f;
+
+    EXPECT_THROW(IVFIndex(8, DistanceMetric::L2, params), std::invalid_argument);
+}
+
+TEST(IVFIndexTest, RebalanceSplitsOversizedAndMergesEmptyLists) {
+    IVFParams params;
+    params.n_clusters = 8;
+
+    IVFIndex index(8, DistanceMetric::L2, params);
+    index.set_centroids(generate_test_centroids(2, 8, 100.0f));
+
+    // Everything lands in cluster 0; cluster 1 stays empty
+    auto vectors = generate_random_vectors_ivf(400, 8);
+    for (std::size_t i = 0; i < vectors.size(); ++i) {
+        index.add(i, vectors[i]);
+    }
+    ASSERT_EQ(index.list_sizes()[0], 400);
+
+    EXPECT_GT(index.rebalance(), 0);
+
+    // Target list size is 400 / 8 = 50, so no list may exceed 4 * 50
+    auto sizes = index.list_sizes();
+    EXPECT_EQ(sizes.size(), index.num_clusters());
+    EXPECT_GT(sizes.size(), 2);
+    std::size_t total = 0;
+    for (std::size_t size : sizes) {
+        EXPECT_LE(size, 200);
+        EXPECT_GT(size, 0);
+        total += size;
+    }
+    EXPECT_EQ(total, 400);
+    EXPECT_EQ(index.size(), 400);
+
+    // Nothing is lost and every vector is still reachable
+    SearchParams search_params;
+    search_params.n_probe = sizes.size();
+    for (std::size_t i = 0; i < vectors.size(); i += 7) {
+        auto results = index.search(vectors[i], 1, search_params);
+        ASSERT_EQ(results.size(), 1);
+        EXPECT_EQ(results[0].id, i);
+        EXPECT_EQ(index.remove(i), ErrorCode::Ok);
+    }
+
+    // Already balanced: nothing more to do
+    EXPECT_EQ(index.rebalance(), 0);
+}
+
+TEST(IVFIndexTest, CaptureIsPointInTime) {
+    IVFParams params;
+    params.n_clusters = 8;
+
+    IVFIndex index(8, DistanceMetric::L2, params);
+    index.set_centroids(generate_test_centroids(2, 8, 100.0f));
+    auto vectors = generate_random_vectors_ivf(600, 8);
+    for (std::size_t i = 0; i < 400; ++i) {
+        ASSERT_EQ(index.add(i, vectors[i]), ErrorCode::Ok);
+    }
+
+    // The ID map is written in hash order, so images are compared after a
+    // round trip through identically loaded indexes
+    auto reloaded = [](const std::string& image) {
+        IVFIndex loaded(8, DistanceMetric::L2, IVFParams{});
+        std::istringstream in(image);
+        EXPECT_EQ(loaded.deserialize(in), ErrorCode::Ok);
+        std::ostringstream out;
+        EXPECT_EQ(loaded.serialize(out), ErrorCode::Ok);
+        return out.str();
+    };
+    std::ostringstream expected;
+    ASSERT_EQ(index.serialize(expected), ErrorCode::Ok);
+
+    const std::optional<IndexCapture> captured = index.capture();
+    ASSERT_TRUE(captured.has_value());
+
+    // Removals move entries, rebalancing splits and merges lists, new
+    // centroids drop them all
+    for (std::uint64_t i = 0; i < 100; ++i) {
+        ASSERT_EQ(index.remove(i), ErrorCode::Ok);
+    }
+    for (std::uint64_t i = 400; i < 600; ++i) {
+        ASSERT_EQ(index.add(i, vectors[i]), ErrorCode::Ok);
+    }
+    EXPECT_GT(index.rebalance(), 0);
+    ASSERT_EQ(index.set_centroids(generate_test_centroids(3, 8, 10.0f)), ErrorCode::Ok);
+
+    std::ostringstream actual;
+    ASSERT_EQ(captured->serialize(actual), ErrorCode::Ok);
+    EXPECT_EQ(reloaded(actual.str()), reloaded(expected.str()));
+    EXPECT_EQ(captured->ids().size(), 400);
+}
+
+TEST(IVFIndexTest, ParamsReadableDuringRebalance) {
+    IVFParams params;
+    params.n_clusters = 8;
+
+    IVFIndex index(8, DistanceMetric::L2, params);
+    index.set_centroids(generate_test_centroids(2, 8, 100.0f));
+    auto vectors = generate_random_vectors_ivf(400, 8);
+    for (std::size_t i = 0; i < vectors.size(); ++i) {
+        index.add(i, vectors[i]);
+    }
+
+    // Splits rewrite n_clusters while this thread reads it
+    std::atomic<bool> done{false};
+    std::thread reader([&index, &done] {
+        while (!done) {
+            const IVFParams current = index.params();
+            EXPECT_GE(current.n_clusters, 2);
+            EXPECT_GE(index.num_clusters(), 2);
+        }
+    });
+    EXPECT_GT(index.rebalance(), 0);
+    done = true;
+    reader.join();
+
+    EXPECT_EQ(index.params().n_clusters, index.num_clusters());
+    EXPECT_GT(index.num_clusters(), 2);
+}
+
+TEST(IVFIndexTest, RebalanceNoopWhenBalanced) {
+    IVFParams params;
+    params.n_clusters = 3;
+
+    IVFIndex index(8, DistanceMetric::L2, params);
+    auto centroids = generate_test_centroids(3, 8, 100.0f);
+    index.set_centroids(centroids);
+
+    for (std::size_t c = 0; c < 3; ++c) {
+        auto vecs = generate_vectors_near_centroid(centroids[c], 50, 0.5f, c);
+        for (std::size_t i = 0; i < vecs.size(); ++i) {
+            index.add(c * 100 + i, vecs[i]);
+        }
+    }
+
+    EXPECT_EQ(index.rebalance(), 0);
+    EXPECT_EQ(index.num_clusters(), 3);
+}
+
+TEST(IVFIndexTest, AutoRebalanceInBackground) {
+    IVFParams params;
+    params.n_clusters = 8;
+    params.auto_rebalance = true;
+
+    IVFIndex index(8, DistanceMetric::L2, params);
+    index.set_centroids(generate_test_centroids(2, 8, 100.0f));
+
+    auto vectors = generate_random_vectors_ivf(400, 8);
+    for (std::size_t i = 0; i < vectors.size(); ++i) {
+        ASSERT_EQ(index.add(i, vectors[i]), ErrorCode::Ok);
+    }
+
+    // Wait for the background thread to bring the lists within bounds
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    std::size_t largest = 0;
+    do {
+        auto sizes = index.list_sizes();
+        largest = *std::max_element(sizes.begin(), sizes.end());
+        if (largest <= 200) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    } while (std::chrono::steady_clock::now() < deadline);
+
+    EXPECT_LE(largest, 200);
+    EXPECT_EQ(index.size(), 400);
+}
+
+TEST(IVFIndexTest, BuildUsesConfiguredClusterCountAfterDrift) {
+    IVFParams params;
+    params.n_clusters = 8;
+
+    IVFIndex index(8, DistanceMetric::L2, params);
+    index.set_centroids(generate_test_centroids(2, 8, 100.0f));
+    ASSERT_EQ(index.num_clusters(), 2);
+
+    auto vectors = generate_random_vectors_ivf(400, 8);
+    std::vector<VectorRecord> records;
+    for (std::size_t i = 0; i < vectors.size(); ++i) {
+        records.push_back({i, vectors[i], std::nullopt});
+    }
+    ASSERT_EQ(index.build(records), ErrorCode::Ok);
+    EXPECT_EQ(index.num_clusters(), 8);
+}
+
+TEST(IVFIndexTest, RoundTripKeepsConfiguredClusterCount) {
+    IVFParams params;
+    params.n_clusters = 8;
+
+    IVFIndex index(8, DistanceMetric::L2, params);
+    index.set_centroids(generate_test_centroids(2, 8, 100.0f));
+    auto vectors = generate_random_vectors_ivf(400, 8);
+    for (std::size_t i = 0; i < vectors.size(); ++i) {
+        ASSERT_EQ(index.add(i, vectors[i]), ErrorCode::Ok);
+    }
+
+    std::stringstream stream;
+    ASSERT_EQ(index.serialize(stream), ErrorCode::Ok);
+    IVFParams other = params;
+    other.n_clusters = 3;
+    IVFIndex loaded(8, DistanceMetric::L2, other);
+    ASSERT_EQ(loaded.deserialize(stream), ErrorCode::Ok);
+
+    // Thresholds still follow the saved target of 8 (400 / 8 = 50 per list)
+    EXPECT_GT(loaded.rebalance(), 0);
+    for (std::size_t size : loaded.list_sizes()) {
+        EXPECT_LE(size, 200);
+    }
+}
+
+// ============================================================================
+// HNSW Coarse Quantizer Tests
+// ============================================================================
+
+TEST(IVFIndexTest, HnswQuantizerMatchesLinearScan) {
+    const std::size_t dim = 16;
+    auto centroids = generate_random_vectors_ivf(256, dim, 7);
+    auto vectors = generate_random_vectors_ivf(2000, dim, 8);
+
+    IVFParams linear_params;
+    linear_params.n_clusters = centroids.size();
+    IVFParams graph_params = linear_params;
+    graph_params.use_hnsw_quantizer = true;
+
+    IVFIndex linear(dim, DistanceMetric::L2, linear_params);
+    IVFIndex graph(dim, DistanceMetric::L2, graph_params);
+    linear.set_centroids(centroids);
+    graph.set_centroids(centroids);
+
+    for (std::size_t i = 0; i < vectors.size(); ++i) {
+        ASSERT_EQ(linear.add(i, vectors[i]), ErrorCode::Ok);
+        ASSERT_EQ(graph.add(i, vectors[i]), ErrorCode::Ok);
+    }
+
+    // Graph-selected probes should find nearly the same neighbors
+    SearchParams search_params;
+    search_params.n_probe = 8;
+    auto queries = generate_random_vectors_ivf(50, dim, 9);
+    std::size_t hits = 0;
+    std::size_t total = 0;
+    for (const auto& query : queries) {
+        auto expected = linear.search(query, 10, search_params);
+        auto actual = graph.search(query, 10, search_params);
+        for (const auto& e : expected) {
+            for (const auto& a : actual) {
+                if (a.id == e.id) {
+                    ++hits;
+                    break;
+                }
+            }
+        }
+        total += expected.size();
+    }
+    EXPECT_GE(static_cast<double>(hits) / total, 0.9);
+}
+
+TEST(IVFIndexTest, HnswQuantizerBuildRebalanceAndRoundTrip) {
+    const std::size_t dim = 8;
+    IVFParams params;
+    params.n_clusters = 16;
+    params.use_hnsw_quantizer = true;
+
+    IVFIndex index(dim, DistanceMetric::L2, params);
+
+    auto vectors = generate_random_vectors_ivf(500, dim);
+    std::vector<VectorRecord> records;
+    for (std::size_t i = 0; i < vectors.size(); ++i) {
+        records.push_back({i, vectors[i], std::nullopt});
+    }
+    ASSERT_EQ(index.build(records), ErrorCode::Ok);
+    index.rebalance();
+
+    std::stringstream stream;
+    ASSERT_EQ(index.serialize(stream), ErrorCode::Ok);
+    IVFIndex loaded(dim, DistanceMetric::L2, params);
+    ASSERT_EQ(loaded.deserialize(stream), ErrorCode::Ok);
+
+    SearchParams search_params;
+    search_params.n_probe = 4;
+    for (std::size_t i = 0; i < vectors.size(); i += 25) {
+        auto results = loaded.search(vectors[i], 1, search_params);
+        ASSERT_EQ(results.size(), 1);
+        EXPECT_EQ(results[0].id, i);
+    }
+}
+
+TEST(IVFIndexTest, HnswQuantizerKeepsRecallThroughSplitMergeCycles) {
+    const std::size_t dim = 16;
+    IVFParams params;
+    params.n_clusters = 256;
+    params.use_hnsw_quantizer = true;
+    params.quantizer_ef_search = 16;  // Narrow search: relies on a healthy graph
+
+    IVFIndex index(dim, DistanceMetric::L2, params);
+    auto initial = generate_random_vectors_ivf(8000, dim, 1);
+    std::vector<VectorRecord> records;
+    for (std::size_t i = 0; i < initial.size(); ++i) {
+        records.push_back({i, initial[i], std::nullopt});
+    }
+    ASSERT_EQ(index.build(records), ErrorCode::Ok);
+
+    // Each cycle crowds a new region (splits), then empties the previous
+    // one (merges); every split and merge updates the centroid graph
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> center(-1.0f, 1.0f);
+    std::uint64_t next_id = initial.size();
+    std::vector<std::uint64_t> previous;
+    std::size_t steps = 0;
+    for (std::size_t cycle = 0; cycle < 30; ++cycle) {
+        std::vector<float> hotspot(dim);
+        for (float& value : hotspot) {
+            value = center(rng);
+        }
+        std::vector<std::uint64_t> current;
+        for (const auto& vec : generate_vectors_near_centroid(hotspot, 2000, 0.05f, cycle)) {
+            ASSERT_EQ(index.add(next_id, vec), ErrorCode::Ok);
+            current.push_back(next_id++);
+        }
+        for (std::uint64_t id : previous) {
+            ASSERT_EQ(index.remove(id), ErrorCode::Ok);
+        }
+        steps += index.rebalance();
+        previous = std::move(current);
+    }
+    ASSERT_GT(steps, 100);
+
+    // The graph must still find the true nearest centroid
+    const auto& centroids = index.centroids();
+    std::size_t hits = 0;
+    const auto queries = generate_random_vectors_ivf(500, dim, 11);
+    for (const auto& query : queries) {
+        std::size_t best = 0;
+        float best_distance = std::numeric_limits<float>::max();
+        for (std::size_t c = 0; c < centroids.size(); ++c) {
+            float distance = 0.0f;
+            for (std::size_t d = 0; d < dim; ++d) {
+                distance += (query[d] - centroids[c][d]) * (query[d] - centroids[c][d]);
+            }
+            if (distance < best_distance) {
+                best_distance = distance;
+                best = c;
+            }
+        }
+        hits += index.nearest_cluster(query) == best ? 1 : 0;
+    }
+    EXPECT_GE(static_cast<double>(hits) / queries.size(), 0.95);
+}
+
+// ============================================================================
+// Triangle-Inequality Pruning Tests
+// ============================================================================
+
+TEST(IVFIndexTest, PrunedScanMatchesExhaustiveSearch) {
+    const std::size_t dim = 16;
+    auto vectors = generate_random_vectors_ivf(1500, dim, 11);
+
+    for (auto metric : {DistanceMetric::L2, DistanceMetric::Cosine}) {
+        IVFParams params;
+        params.n_clusters = 20;
+        IVFIndex index(dim, metric, params);
+
+        std::vector<VectorRecord> records;
+        for (std::size_t i = 0; i < vectors.size(); ++i) {
+            records.push_back({i, vectors[i], std::nullopt});
+        }
+        ASSERT_EQ(index.build(records), ErrorCode::Ok);
+
+        // Swap-removes and rebalancing must keep stored distances in sync
+        for (std::size_t i = 0; i < vectors.size(); i += 5) {
+            index.remove(i);
+        }
+        index.rebalance();
+
+        SearchParams search_params;
+        search_params.n_probe = index.num_clusters();
+        auto queries = generate_random_vectors_ivf(20, dim, 12);
+        for (const auto& query : queries) {
+            // Exhaustive reference over the remaining vectors
+            std::vector<SearchResultItem> expected;
+            for (std::size_t i = 0; i < vectors.size(); ++i) {
+                if (i % 5 != 0) {
+                    expected.push_back({i, calculate_distance(query, vectors[i], metric)});
+                }
+            }
+            std::sort(expected.begin(), expected.end(),
+                      [](const auto& a, const auto& b) { return a.distance < b.distance; });
+
+            auto results = index.search(query, 10, search_params);
+            ASSERT_EQ(results.size(), 10);
+            for (std::size_t r = 0; r < results.size(); ++r) {
+                EXPECT_EQ(results[r].id, expected[r].id);
+                EXPECT_FLOAT_EQ(results[r].distance, expected[r].distance);
+            }
+        }
+    }
+}
+
+// ============================================================================
+// Adaptive n_probe Tests
+// ============================================================================
+
+TEST(IVFIndexTest, FixedNProbeReportsClustersProbed) {
+    IVFParams params;
+    params.n_clusters = 5;
+
+    IVFIndex index(8, DistanceMetric::L2, params);
+    index.set_centroids(generate_test_centroids(5, 8));
+    auto vectors = generate_random_vectors_ivf(50, 8);
+    for (std::size_t i = 0; i < vectors.size(); ++i) {
+        index.add(i, vectors[i]);
+    }
+
+    SearchParams search_params;
+    search_params.n_probe = 3;
+    IndexSearchStats stats;
+    auto results = index.search_with_stats(vectors[0], 5, search_params, stats);
+    EXPECT_EQ(results.size(), 5);
+    EXPECT_EQ(stats.clusters_probed, 3);
+}
+
+TEST(IVFIndexTest, AdaptiveNProbeStopsEarlyForEasyQueries) {
+    IVFParams params;
+    params.n_clusters = 10;
+
+    IVFIndex index(8, DistanceMetric::L2, params);
+    auto centroids = generate_test_centroids(10, 8, 100.0f);
+    index.set_centroids(centroids);
+    for (std::size_t c = 0; c < centroids.size(); ++c) {
+        auto vecs = generate_vectors_near_centroid(centroids[c], 20, 0.5f, c);
+        for (std::size_t i = 0; i < vecs.size(); ++i) {
+            index.add(c * 100 + i, vecs[i]);
+        }
+    }
+
+    SearchParams search_params;
+    search_params.adaptive_n_probe = true;
+    search_params.min_n_probe = 1;
+    search_params.max_n_probe = 10;
+
+    // A query inside cluster 3 only needs that cluster
+    std::vector<float> query = centroids[3];
+    query[1] = 0.1f;
+    IndexSearchStats stats;
+    auto results = index.search_with_stats(query, 5, search_params, stats);
+    ASSERT_EQ(results.size(), 5);
+    EXPECT_EQ(stats.clusters_probed, 1);
+    for (const auto& result : results) {
+        EXPECT_EQ(result.id / 100, 3);
+    }
+
+    // min_n_probe is always honored
+    search_params.min_n_probe = 4;
+    results = index.search_with_stats(query, 5, search_params, stats);
+    EXPECT_EQ(results.size(), 5);
+    EXPECT_EQ(stats.clusters_probed, 4);
+}
+
+TEST(IVFIndexTest, AdaptiveNProbeKeepsProbingUntilTopKIsFull) {
+    IVFParams params;
+    params.n_clusters = 4;
+
+    IVFIndex index(8, DistanceMetric::L2, params);
+    auto centroids = generate_test_centroids(4, 8, 100.0f);
+    index.set_centroids(centroids);
+    for (std::size_t c = 0; c < centroids.size(); ++c) {
+        auto vecs = generate_vectors_near_centroid(centroids[c], 3, 0.5f, c);
+        for (std::size_t i = 0; i < vecs.size(); ++i) {
+            index.add(c * 100 + i, vecs[i]);
+        }
+    }
+
+    SearchParams search_params;
+    search_params.adaptive_n_probe = true;
+    search_params.max_n_probe = 3;
+
+    // k = 10 needs at least four lists of 3, but max_n_probe caps at 3
+    IndexSearchStats stats;
+    auto results = index.search_with_stats(centroids[0], 10, search_params, stats);
+    EXPECT_EQ(stats.clusters_probed, 3);
+    EXPECT_EQ(results.size(), 9);
+}
+
 // ============================================================================
 // Build Tests (Ticket #2004)
 // ============================================================================
@@ -977,6 +1577,117 @@ TEST(IVFIndexTest, BuildAndSearch) {
     EXPECT_EQ(results[0].id, 0);  // Should find itself as nearest
 }
 
+TEST(IVFIndexTest, BuildWithTrainingSampleCapIndexesAllVectors) {
+    IVFParams params;
+    params.n_clusters = 8;
+    params.training_samples_per_cluster = 16;  // Train on 128 of 2000
+
+    IVFIndex index(16, DistanceMetric::L2, params);
+
+    std::vector<VectorRecord> records;
+    auto vectors = generate_random_vectors_ivf(2000, 16, 42);
+    for (std::size_t i = 0; i < vectors.size(); ++i) {
+        records.push_back({i, vectors[i], std::nullopt});
+    }
+
+    ASSERT_EQ(index.build(records), ErrorCode::Ok);
+    EXPECT_EQ(index.size(), 2000);
+    EXPECT_EQ(index.num_clusters(), 8);
+
+    auto sizes = index.list_sizes();
+    EXPECT_EQ(std::accumulate(sizes.begin(), sizes.end(), std::size_t{0}), 2000);
+
+    // Exhaustive probing finds every vector
+    SearchParams search_params;
+    search_params.n_probe = 8;
+    for (std::size_t i = 0; i < vectors.size(); i += 97) {
+        auto results = index.search(vectors[i], 1, search_params);
+        ASSERT_EQ(results.size(), 1);
+        EXPECT_EQ(results[0].id, i);
+    }
+}
+
+TEST(IVFIndexTest, BuildFromStridedMatrixView) {
+    IVFParams params;
+    params.n_clusters = 6;
+
+    const std::size_t dim = 16;
+    const std::size_t stride = 20;
+    auto vectors = generate_random_vectors_ivf(600, dim, 5);
+
+    // Rows padded to a stride, as in a memory-mapped file with row headers
+    std::vector<std::uint64_t> ids;
+    std::vector<float> buffer(vectors.size() * stride, 0.0f);
+    for (std::size_t i = 0; i < vectors.size(); ++i) {
+        ids.push_back(i + 1000);
+        std::copy(vectors[i].begin(), vectors[i].end(), buffer.begin() + i * stride);
+    }
+
+    IVFIndex index(dim, DistanceMetric::L2, params);
+    ASSERT_EQ(index.build(ids, MatrixView(buffer.data(), vectors.size(), dim, stride)), ErrorCode::Ok);
+    EXPECT_EQ(index.size(), 600);
+    EXPECT_EQ(index.num_clusters(), 6);
+
+    auto sizes = index.list_sizes();
+    EXPECT_EQ(std::accumulate(sizes.begin(), sizes.end(), std::size_t{0}), 600);
+
+    // Every vector is stored with its own ID and exact values
+    SearchParams search_params;
+    search_params.n_probe = 6;
+    for (std::size_t i = 0; i < vectors.size(); i += 37) {
+        auto results = index.search(vectors[i], 1, search_params);
+        ASSERT_EQ(results.size(), 1);
+        EXPECT_EQ(results[0].id, i + 1000);
+        EXPECT_FLOAT_EQ(results[0].distance, 0.0f);
+    }
+
+    EXPECT_EQ(index.build(std::span(ids).first(10), MatrixView(buffer.data(), 600, dim, stride)),
+              ErrorCode::InvalidParameter);
+    EXPECT_EQ(index.build(ids, MatrixView(buffer.data(), 600, dim + 1, stride)),
+              ErrorCode::DimensionMismatch);
+}
+
+TEST(IVFIndexTest, BalancedBuildBoundsListSizes) {
+    IVFParams params;
+    params.n_clusters = 8;
+    params.balance_factor = 1.25f;
+
+    // Skewed data: most vectors near one centroid
+    auto centroids = generate_test_centroids(8, 16);
+    std::vector<VectorRecord> records;
+    std::uint64_t id = 0;
+    for (std::size_t c = 0; c < 8; ++c) {
+        auto near = generate_vectors_near_centroid(centroids[c], c == 0 ? 1200 : 100, 0.1f);
+        for (auto& vec : near) {
+            records.push_back({id++, std::move(vec), std::nullopt});
+        }
+    }
+
+    IVFIndex index(16, DistanceMetric::L2, params);
+    ASSERT_EQ(index.build(records), ErrorCode::Ok);
+    EXPECT_EQ(index.size(), records.size());
+
+    auto sizes = index.list_sizes();
+    const std::size_t cap = static_cast<std::size_t>(std::ceil(1.25 * records.size() / 8));
+    EXPECT_LE(*std::max_element(sizes.begin(), sizes.end()), cap);
+    EXPECT_EQ(std::accumulate(sizes.begin(), sizes.end(), std::size_t{0}), records.size());
+
+    // Every vector remains reachable
+    SearchParams search_params;
+    search_params.n_probe = 8;
+    for (std::size_t i = 0; i < records.size(); i += 101) {
+        auto results = index.search(records[i].vector, 1, search_params);
+        ASSERT_EQ(results.size(), 1);
+        EXPECT_EQ(results[0].id, records[i].id);
+    }
+}
+
+TEST(IVFIndexTest, ConstructorInvalidBalanceFactor) {
+    IVFParams params;
+    params.balance_factor = 0.9f;
+    EXPECT_THROW(IVFIndex(8, DistanceMetric::L2, params), std::invalid_argument);
+}
+
 TEST(IVFIndexTest, BuildOverwritesExistingData) {
     IVFParams params;
     params.n_clusters = 3;
@@ -6,11 +6,13 @@
  */
 
 #include "../src/lib/kmeans.h"
+#include "../src/lib/utils.h"
 #include <gtest/gtest.h>
 #include <vector>
 #include <cmath>
 #include <random>
 #include <algorithm>
+#include <limits>
 
 using namespace lynx;
 using namespace lynx::clustering;
@@ -267,6 +269,139 @@ TEST(KMeansTest, ClusteringQualityL2) {
     EXPECT_GT(purity, 0.95f);
 }
 
+TEST(KMeansTest, SubsampledTrainingKeepsQuality) {
+    KMeansParams params;
+    params.random_seed = 42;
+    params.max_training_samples = 60;  // 20 per cluster out of 1000
+
+    KMeans kmeans(3, 2, DistanceMetric::L2, params);
+    auto vectors = generate_clustered_data(1000, 3, 2, 10.0f, 42);
+
+    std::vector<std::size_t> ground_truth;
+    for (std::size_t c = 0; c < 3; ++c) {
+        ground_truth.insert(ground_truth.end(), 1000, c);
+    }
+
+    kmeans.fit(vectors);
+    EXPECT_EQ(kmeans.centroids().size(), 3);
+
+    // Prediction still covers every input vector
+    auto assignments = kmeans.predict(vectors);
+    ASSERT_EQ(assignments.size(), vectors.size());
+    EXPECT_GT(calculate_purity(assignments, ground_truth), 0.95f);
+}
+
+TEST(KMeansTest, SampleCapBelowKKeepsK) {
+    KMeansParams params;
+    params.random_seed = 42;
+    params.max_training_samples = 2;  // Raised to k internally
+
+    KMeans kmeans(5, 4, DistanceMetric::L2, params);
+    kmeans.fit(generate_random_vectors(100, 4));
+    EXPECT_EQ(kmeans.k(), 5);
+    EXPECT_EQ(kmeans.centroids().size(), 5);
+}
+
+TEST(KMeansTest, MiniBatchClusteringQuality) {
+    KMeansParams params;
+    params.random_seed = 42;
+    params.max_iterations = 50;
+    params.mini_batch_size = 64;
+
+    KMeans kmeans(3, 2, DistanceMetric::L2, params);
+    auto vectors = generate_clustered_data(500, 3, 2, 10.0f, 42);
+
+    std::vector<std::size_t> ground_truth;
+    for (std::size_t c = 0; c < 3; ++c) {
+        ground_truth.insert(ground_truth.end(), 500, c);
+    }
+
+    kmeans.fit(vectors);
+    auto assignments = kmeans.predict(vectors);
+    EXPECT_GT(calculate_purity(assignments, ground_truth), 0.95f);
+
+    // Mini-batch runs are reproducible for a fixed seed
+    KMeans again(3, 2, DistanceMetric::L2, params);
+    again.fit(vectors);
+    EXPECT_EQ(kmeans.centroids(), again.centroids());
+}
+
+TEST(KMeansTest, ParallelInitClusteringQuality) {
+    KMeansParams params;
+    params.random_seed = 42;
+    params.init = InitMethod::Parallel;
+
+    KMeans kmeans(5, 4, DistanceMetric::L2, params);
+    auto vectors = generate_clustered_data(200, 5, 4, 10.0f, 42);
+
+    std::vector<std::size_t> ground_truth;
+    for (std::size_t c = 0; c < 5; ++c) {
+        ground_truth.insert(ground_truth.end(), 200, c);
+    }
+
+    kmeans.fit(vectors);
+    ASSERT_EQ(kmeans.centroids().size(), 5);
+    auto assignments = kmeans.predict(vectors);
+    EXPECT_GT(calculate_purity(assignments, ground_truth), 0.95f);
+}
+
+TEST(KMeansTest, ParallelInitWithKEqualToN) {
+    KMeansParams params;
+    params.random_seed = 7;
+    params.init = InitMethod::Parallel;
+    params.init_rounds = 1;
+
+    // Oversampling cannot produce k candidates; top-up must cover the rest
+    auto vectors = generate_random_vectors(10, 3, 5);
+    KMeans kmeans(10, 3, DistanceMetric::L2, params);
+    kmeans.fit(vectors);
+    EXPECT_EQ(kmeans.centroids().size(), 10);
+}
+
+TEST(KMeansTest, BalancedModeCapsClusterSizes) {
+    // One dominant blob and four small ones: plain Lloyd gives skewed sizes
+    std::mt19937 rng(3);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    std::vector<std::vector<float>> vectors;
+    for (std::size_t blob = 0; blob < 5; ++blob) {
+        const std::size_t count = blob == 0 ? 900 : 25;
+        for (std::size_t i = 0; i < count; ++i) {
+            std::vector<float> vec(4);
+            for (auto& x : vec) {
+                x = noise(rng);
+            }
+            vec[0] += static_cast<float>(blob) * 20.0f;
+            vectors.push_back(std::move(vec));
+        }
+    }
+    KMeansParams params;
+    params.random_seed = 42;
+    params.balance_factor = 1.25f;
+
+    auto rows = collect_row_pointers(vectors, [](const auto& v) -> const auto& { return v; });
+    KMeans kmeans(5, 4, DistanceMetric::L2, params);
+    kmeans.fit(vectors);
+
+    const std::size_t cap = static_cast<std::size_t>(std::ceil(1.25 * 1000 / 5));
+    auto assignments = kmeans.predict_balanced(MatrixView(rows, 4));
+    ASSERT_EQ(assignments.size(), vectors.size());
+    std::vector<std::size_t> sizes(5, 0);
+    for (std::size_t a : assignments) {
+        sizes[a]++;
+    }
+    EXPECT_LE(*std::max_element(sizes.begin(), sizes.end()), cap);
+
+    // Unconstrained nearest-centroid assignment is still available
+    auto nearest = kmeans.predict(vectors);
+    EXPECT_EQ(nearest.size(), vectors.size());
+}
+
+TEST(KMeansTest, InvalidBalanceFactorThrows) {
+    KMeansParams params;
+    params.balance_factor = 0.5f;
+    EXPECT_THROW(KMeans(4, 8, DistanceMetric::L2, params), std::invalid_argument);
+}
+
 TEST(KMeansTest, ClusteringQualityCosine) {
     KMeansParams params;
     params.random_seed = 42;
@@ -291,6 +426,50 @@ TEST(KMeansTest, ClusteringQualityCosine) {
     }
 }
 
+TEST(KMeansTest, CosineCentroidsAreUnitMeanDirections) {
+    // One cluster at +/-30 degrees around the x axis; the +30 degree points
+    // are 100x longer, which would drag an arithmetic mean towards them
+    const float angle = 0.5235988f;
+    std::vector<std::vector<float>> vectors;
+    for (int i = 0; i < 10; ++i) {
+        vectors.push_back({100.0f * std::cos(angle), 100.0f * std::sin(angle)});
+        vectors.push_back({std::cos(angle), -std::sin(angle)});
+    }
+
+    KMeansParams params;
+    params.random_seed = 42;
+    KMeans kmeans(1, 2, DistanceMetric::Cosine, params);
+    kmeans.fit(vectors);
+
+    const auto& centroid = kmeans.centroids()[0];
+    EXPECT_NEAR(centroid[0], 1.0f, 1e-5f);
+    EXPECT_NEAR(centroid[1], 0.0f, 1e-5f);
+}
+
+TEST(KMeansTest, CosineCentroidsHaveUnitNorm) {
+    auto vectors = generate_clustered_data(50, 4, 8, 5.0f, 42);
+    for (std::size_t i = 0; i < vectors.size(); ++i) {
+        for (auto& x : vectors[i]) {
+            x *= static_cast<float>(1 + i % 7);
+        }
+    }
+
+    for (std::size_t batch : {std::size_t{0}, std::size_t{32}}) {
+        KMeansParams params;
+        params.random_seed = 42;
+        params.mini_batch_size = batch;
+        KMeans kmeans(4, 8, DistanceMetric::Cosine, params);
+        kmeans.fit(vectors);
+        for (const auto& centroid : kmeans.centroids()) {
+            float norm_sq = 0.0f;
+            for (float x : centroid) {
+                norm_sq += x * x;
+            }
+            EXPECT_NEAR(norm_sq, 1.0f, 1e-4f);
+        }
+    }
+}
+
 TEST(KMeansTest, ClusteringQualityDotProduct) {
     KMeansParams params;
     params.random_seed = 42;
@@ -431,6 +610,77 @@ TEST(KMeansTest, ReproducibilityWithSeed) {
     }
 }
 
+TEST(KMeansTest, ThreadCountDoesNotChangeResult) {
+    // Large enough that the multi-threaded run actually splits the work
+    auto vectors = generate_clustered_data(2000, 16, 32, 3.0f, 7);
+
+    KMeansParams serial;
+    serial.random_seed = 42;
+    serial.max_iterations = 20;
+    serial.num_threads = 1;
+
+    KMeansParams parallel = serial;
+    parallel.num_threads = 4;
+
+    KMeans kmeans1(16, 32, DistanceMetric::L2, serial);
+    KMeans kmeans2(16, 32, DistanceMetric::L2, parallel);
+    kmeans1.fit(vectors);
+    kmeans2.fit(vectors);
+
+    // Centroid sums are reduced in the same order for any thread count,
+    // so results must be bit-identical, not merely close
+    const auto& centroids1 = kmeans1.centroids();
+    const auto& centroids2 = kmeans2.centroids();
+    ASSERT_EQ(centroids1.size(), centroids2.size());
+    for (std::size_t c = 0; c < centroids1.size(); ++c) {
+        EXPECT_EQ(centroids1[c], centroids2[c]) << "centroid " << c;
+    }
+    EXPECT_EQ(kmeans1.predict(vectors), kmeans2.predict(vectors));
+}
+
+TEST(KMeansTest, ParallelInitThreadCountDoesNotChangeResult) {
+    auto vectors = generate_clustered_data(2000, 16, 32, 3.0f, 11);
+
+    KMeansParams serial;
+    serial.random_seed = 42;
+    serial.max_iterations = 10;
+    serial.init = InitMethod::Parallel;
+    serial.num_threads = 1;
+
+    KMeansParams parallel = serial;
+    parallel.num_threads = 4;
+
+    KMeans kmeans1(16, 32, DistanceMetric::L2, serial);
+    KMeans kmeans2(16, 32, DistanceMetric::L2, parallel);
+    kmeans1.fit(vectors);
+    kmeans2.fit(vectors);
+
+    EXPECT_EQ(kmeans1.centroids(), kmeans2.centroids());
+}
+
+TEST(KMeansTest, BoundedLloydMatchesPlainLloyd) {
+    // Overlapping clusters so many points change assignment across iterations
+    auto vectors = generate_random_vectors(3000, 16, 17);
+
+    KMeansParams plain;
+    plain.random_seed = 42;
+    plain.max_iterations = 30;
+    plain.convergence_threshold = 0.0f;
+    plain.use_bounds = false;
+
+    KMeansParams bounded = plain;
+    bounded.use_bounds = true;
+
+    KMeans kmeans1(24, 16, DistanceMetric::L2, plain);
+    KMeans kmeans2(24, 16, DistanceMetric::L2, bounded);
+    kmeans1.fit(vectors);
+    kmeans2.fit(vectors);
+
+    // Hamerly's bounds only skip provably unnecessary distance evaluations
+    EXPECT_EQ(kmeans1.centroids(), kmeans2.centroids());
+    EXPECT_EQ(kmeans1.predict(vectors), kmeans2.predict(vectors));
+}
+
 // ============================================================================
 // Different Dimensions Tests
 // ============================================================================
@@ -481,6 +731,69 @@ TEST(KMeansTest, PredictAfterFit) {
     }
 }
 
+TEST(KMeansTest, BlockedPredictMatchesBruteForce) {
+    // Sizes that leave partial kernel rows, panels and tiles
+    const std::size_t dim = 19;
+    const std::size_t k = 13;
+    auto train = generate_random_vectors(500, dim, 3);
+    auto queries = generate_random_vectors(203, dim, 4);
+
+    for (auto metric : {DistanceMetric::L2, DistanceMetric::Cosine, DistanceMetric::DotProduct}) {
+        KMeansParams params;
+        params.random_seed = 42;
+        params.max_iterations = 5;
+        KMeans kmeans(k, dim, metric, params);
+        kmeans.fit(train);
+
+        auto assignments = kmeans.predict(queries);
+        ASSERT_EQ(assignments.size(), queries.size());
+
+        const auto& centroids = kmeans.centroids();
+        for (std::size_t i = 0; i < queries.size(); ++i) {
+            float best = std::numeric_limits<float>::max();
+            for (const auto& centroid : centroids) {
+                best = std::min(best, utils::calculate_distance(queries[i], centroid, metric));
+            }
+            // Inner-product scores may round differently; accept near-ties
+            float chosen = utils::calculate_distance(queries[i], centroids[assignments[i]], metric);
+            EXPECT_NEAR(chosen, best, 1e-4f * (1.0f + std::abs(best)))
+                << "metric " << static_cast<int>(metric) << " query " << i;
+        }
+    }
+}
+
+TEST(KMeansTest, FitFromStridedMatrixMatchesVectorInput) {
+    const std::size_t dim = 6;
+    const std::size_t stride = 9;
+    auto vectors = generate_clustered_data(100, 3, dim, 5.0f, 21);
+
+    // Same data in one padded row-major buffer
+    std::vector<float> buffer(vectors.size() * stride, 0.0f);
+    for (std::size_t i = 0; i < vectors.size(); ++i) {
+        std::copy(vectors[i].begin(), vectors[i].end(), buffer.begin() + i * stride);
+    }
+    MatrixView view(buffer.data(), vectors.size(), dim, stride);
+
+    KMeansParams params;
+    params.random_seed = 42;
+    params.max_training_samples = 150;
+
+    KMeans from_vectors(3, dim, DistanceMetric::L2, params);
+    KMeans from_view(3, dim, DistanceMetric::L2, params);
+    from_vectors.fit(vectors);
+    from_view.fit(view);
+
+    EXPECT_EQ(from_vectors.centroids(), from_view.centroids());
+    EXPECT_EQ(from_vectors.predict(vectors), from_view.predict(view));
+}
+
+TEST(KMeansTest, FitMatrixDimensionMismatch) {
+    std::vector<float> buffer(40, 1.0f);
+    KMeans kmeans(2, 8, DistanceMetric::L2);
+    EXPECT_THROW(kmeans.fit(MatrixView(buffer.data(), 10, 4)), std::invalid_argument);
+    EXPECT_THROW(kmeans.fit(MatrixView()), std::invalid_argument);
+}
+
 TEST(KMeansTest, PredictDimensionMismatch) {
     KMeansParams params;
     params.random_seed = 42;
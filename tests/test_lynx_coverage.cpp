@@ -44,6 +44,10 @@ public:
         return false;
     }
 
+    bool get_vector(std::uint64_t id, std::span<float> out) const override {
+        return false;
+    }
+
     // Search Operations
     std::vector<SearchResultItem> search(
         std::span<const float> query,
@@ -0,0 +1,90 @@
+/**
+ * @file test_metadata_store.cpp
+ * @brief Unit tests for the arena-backed metadata store
+ *
+ * @copyright MIT License
+ */
+
+#include "../src/lib/metadata_store.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace lynx;
+
+// ============================================================================
+// Basic Operations
+// ============================================================================
+
+TEST(MetadataStoreTest, AddAndGet) {
+    MetadataStore store;
+    auto a = store.add(std::string_view("alpha"));
+    auto b = store.add(std::string_view("beta"));
+
+    EXPECT_NE(a, b);
+    EXPECT_EQ(store.get(a), std::optional<std::string>("alpha"));
+    EXPECT_EQ(store.get(b), std::optional<std::string>("beta"));
+    ASSERT_TRUE(store.view(b).has_value());
+    EXPECT_EQ(*store.view(b), "beta");
+}
+
+TEST(MetadataStoreTest, AbsentAndEmptyValues) {
+    MetadataStore store;
+    auto none = store.add(std::nullopt);
+    auto empty = store.add(std::string_view(""));
+
+    EXPECT_FALSE(store.get(none).has_value());
+    EXPECT_FALSE(store.view(none).has_value());
+    ASSERT_TRUE(store.get(empty).has_value());
+    EXPECT_TRUE(store.get(empty)->empty());
+}
+
+TEST(MetadataStoreTest, RemoveReusesSlot) {
+    MetadataStore store;
+    auto a = store.add(std::string_view("first"));
+    store.add(std::string_view("second"));
+
+    store.remove(a);
+    auto c = store.add(std::string_view("third"));
+
+    EXPECT_EQ(c, a);
+    EXPECT_EQ(store.get(c), std::optional<std::string>("third"));
+}
+
+TEST(MetadataStoreTest, CompactionKeepsLiveValues) {
+    MetadataStore store;
+    std::vector<MetadataStore::Slot> slots;
+    for (int i = 0; i < 200; ++i) {
+        slots.push_back(store.add("value_" + std::to_string(i)));
+    }
+
+    // Removing most values pushes dead bytes past half the arena
+    for (int i = 0; i < 200; ++i) {
+        if (i % 5 != 0) {
+            store.remove(slots[i]);
+        }
+    }
+
+    for (int i = 0; i < 200; i += 5) {
+        EXPECT_EQ(store.get(slots[i]), std::optional<std::string>("value_" + std::to_string(i)));
+    }
+}
+
+TEST(MetadataStoreTest, ClearDropsEverything) {
+    MetadataStore store;
+    store.add(std::string_view("x"));
+    store.add(std::string_view("y"));
+    store.clear();
+
+    auto slot = store.add(std::string_view("z"));
+    EXPECT_EQ(slot, 0u);
+    EXPECT_EQ(store.get(slot), std::optional<std::string>("z"));
+}
+
+TEST(MetadataStoreTest, MemoryUsageCountsArena) {
+    MetadataStore store;
+    const std::size_t empty_usage = store.memory_usage();
+    store.add(std::string(1024, 'm'));
+
+    EXPECT_GE(store.memory_usage(), empty_usage + 1024);
+}
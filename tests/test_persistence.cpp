@@ -7,11 +7,15 @@
 
 #include <gtest/gtest.h>
 #include "../src/include/lynx/lynx.h"
+#include <atomic>
 #include <filesystem>
 #include <fstream>
 #include <vector>
 #include <cmath>
 #include <random>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
 
 using namespace lynx;
 
@@ -290,7 +294,7 @@ TEST_F(PersistenceTest, FlushWithoutWAL) {
     EXPECT_EQ(result, ErrorCode::Ok);
 }
 
-TEST_F(PersistenceTest, FlushWithWALNotImplemented) {
+TEST_F(PersistenceTest, FlushWithWAL) {
     Config config;
     config.dimension = 4;
     config.enable_wal = true;
@@ -299,9 +303,122 @@ TEST_F(PersistenceTest, FlushWithWALNotImplemented) {
     auto db = IVectorDatabase::create(config);
     ASSERT_NE(db, nullptr);
 
-    // Flush should return NotImplemented with WAL enabled
+    // Flush commits the log
     ErrorCode result = db->flush();
-    EXPECT_EQ(result, ErrorCode::NotImplemented);
+    EXPECT_EQ(result, ErrorCode::Ok);
+}
+
+// ============================================================================
+// Write-Ahead Log Recovery Tests
+// ============================================================================
+
+TEST_F(PersistenceTest, WALRecoversWritesWithoutSave) {
+    Config config;
+    config.dimension = 4;
+    config.index_type = IndexType::Flat;
+    config.enable_wal = true;
+    config.data_path = test_data_path_;
+
+    {
+        auto db = IVectorDatabase::create(config);
+        ASSERT_EQ(db->insert({1, {1.0f, 0.0f, 0.0f, 0.0f}, "one"}), ErrorCode::Ok);
+        ASSERT_EQ(db->insert({2, {0.0f, 1.0f, 0.0f, 0.0f}, std::nullopt}), ErrorCode::Ok);
+        ASSERT_EQ(db->insert({3, {0.0f, 0.0f, 1.0f, 0.0f}, "three"}), ErrorCode::Ok);
+        ASSERT_EQ(db->remove(2), ErrorCode::Ok);
+        // No save(): the log alone must restore the state
+    }
+
+    auto db = IVectorDatabase::create(config);
+    ASSERT_EQ(db->load(), ErrorCode::Ok);
+    EXPECT_EQ(db->size(), 2);
+    EXPECT_FALSE(db->contains(2));
+
+    auto record = db->get(3);
+    ASSERT_TRUE(record.has_value());
+    EXPECT_EQ(record->vector, (std::vector<float>{0.0f, 0.0f, 1.0f, 0.0f}));
+    EXPECT_EQ(record->metadata, std::optional<std::string>("three"));
+}
+
+TEST_F(PersistenceTest, WALReplaysOnTopOfSnapshot) {
+    Config config;
+    config.dimension = 4;
+    config.index_type = IndexType::HNSW;
+    config.enable_wal = true;
+    config.data_path = test_data_path_;
+
+    {
+        auto db = IVectorDatabase::create(config);
+        std::vector<VectorRecord> records;
+        for (std::uint64_t i = 0; i < 50; ++i) {
+            records.push_back({i, {static_cast<float>(i), 1.0f, 0.0f, 0.0f}, std::nullopt});
+        }
+        ASSERT_EQ(db->batch_insert(records), ErrorCode::Ok);
+        ASSERT_EQ(db->save(), ErrorCode::Ok);
+
+        // Writes after the snapshot live only in the log
+        ASSERT_EQ(db->remove(10), ErrorCode::Ok);
+        ASSERT_EQ(db->insert({100, {100.0f, 1.0f, 0.0f, 0.0f}, "late"}), ErrorCode::Ok);
+    }
+
+    auto db = IVectorDatabase::create(config);
+    ASSERT_EQ(db->load(), ErrorCode::Ok);
+    EXPECT_EQ(db->size(), 50);
+    EXPECT_FALSE(db->contains(10));
+    EXPECT_TRUE(db->contains(49));
+
+    auto result = db->search(std::vector<float>{100.0f, 1.0f, 0.0f, 0.0f}, 1);
+    ASSERT_EQ(result.items.size(), 1);
+    EXPECT_EQ(result.items[0].id, 100);
+
+    // Writes after load() keep extending the log
+    ASSERT_EQ(db->insert({200, {200.0f, 1.0f, 0.0f, 0.0f}, std::nullopt}), ErrorCode::Ok);
+    db.reset();
+    db = IVectorDatabase::create(config);
+    ASSERT_EQ(db->load(), ErrorCode::Ok);
+    EXPECT_EQ(db->size(), 51);
+    EXPECT_TRUE(db->contains(200));
+}
+
+TEST_F(PersistenceTest, WALIsTruncatedBySave) {
+    Config config;
+    config.dimension = 4;
+    config.index_type = IndexType::Flat;
+    config.enable_wal = true;
+    config.data_path = test_data_path_;
+
+    auto db = IVectorDatabase::create(config);
+    for (std::uint64_t i = 0; i < 100; ++i) {
+        ASSERT_EQ(db->insert({i, {1.0f, 2.0f, 3.0f, 4.0f}, std::nullopt}), ErrorCode::Ok);
+    }
+    const std::string wal_path = test_data_path_ + "/wal.log";
+    const auto before = std::filesystem::file_size(wal_path);
+
+    ASSERT_EQ(db->save(), ErrorCode::Ok);
+    EXPECT_LT(std::filesystem::file_size(wal_path), before);
+}
+
+TEST_F(PersistenceTest, WALWithSyncIntervalRecoversAfterFlush) {
+    Config config;
+    config.dimension = 4;
+    config.index_type = IndexType::IVF;
+    config.ivf_params.n_clusters = 4;
+    config.enable_wal = true;
+    config.wal_sync_interval_ms = 5;
+    config.data_path = test_data_path_;
+
+    {
+        auto db = IVectorDatabase::create(config);
+        for (std::uint64_t i = 0; i < 200; ++i) {
+            float x = static_cast<float>(i % 7);
+            ASSERT_EQ(db->insert({i, {x, 1.0f, x, 0.0f}, std::nullopt}), ErrorCode::Ok);
+        }
+        ASSERT_EQ(db->flush(), ErrorCode::Ok);
+    }
+
+    auto db = IVectorDatabase::create(config);
+    ASSERT_EQ(db->load(), ErrorCode::Ok);
+    EXPECT_EQ(db->size(), 200);
+    EXPECT_TRUE(db->get(123).has_value());
 }
 
 TEST_F(PersistenceTest, SaveAndLoadWithDifferentDistanceMetrics) {
@@ -485,3 +602,851 @@ TEST_F(PersistenceTest, SaveAndLoadVectorsWithoutMetadata) {
         EXPECT_EQ(db->size(), num_vectors);
     }
 }
+
+// ============================================================================
+// Memory-Mapped Storage Tests
+// ============================================================================
+
+class MmapPersistenceTest : public PersistenceTest,
+                            public ::testing::WithParamInterface<IndexType> {
+protected:
+    Config make_config(bool enable_mmap) const {
+        Config config;
+        config.dimension = 16;
+        config.index_type = GetParam();
+        config.ivf_params.n_clusters = 8;
+        config.ivf_params.n_probe = 8;
+        config.data_path = test_data_path_;
+        config.enable_mmap = enable_mmap;
+        return config;
+    }
+
+    static std::vector<VectorRecord> make_records(std::size_t count, std::size_t dimension) {
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+        std::vector<VectorRecord> records;
+        for (std::size_t i = 0; i < count; ++i) {
+            std::vector<float> vec(dimension);
+            for (auto& x : vec) {
+                x = dist(rng);
+            }
+            records.push_back({i * 3, std::move(vec), "m" + std::to_string(i)});
+        }
+        return records;
+    }
+};
+
+TEST_P(MmapPersistenceTest, MappedLoadMatchesHeapLoad) {
+    auto records = make_records(500, 16);
+    {
+        auto db = IVectorDatabase::create(make_config(false));
+        ASSERT_EQ(db->batch_insert(records), ErrorCode::Ok);
+        ASSERT_EQ(db->save(), ErrorCode::Ok);
+    }
+
+    auto heap_db = IVectorDatabase::create(make_config(false));
+    auto mapped_db = IVectorDatabase::create(make_config(true));
+    ASSERT_EQ(heap_db->load(), ErrorCode::Ok);
+    ASSERT_EQ(mapped_db->load(), ErrorCode::Ok);
+    ASSERT_EQ(mapped_db->size(), records.size());
+
+    for (std::size_t q = 0; q < 20; ++q) {
+        const auto& query = records[q * 7].vector;
+        auto expected = heap_db->search(query, 10);
+        auto actual = mapped_db->search(query, 10);
+        ASSERT_EQ(actual.items.size(), expected.items.size());
+        for (std::size_t i = 0; i < actual.items.size(); ++i) {
+            EXPECT_EQ(actual.items[i].id, expected.items[i].id);
+        }
+    }
+
+    auto record = mapped_db->get(records[42].id);
+    ASSERT_TRUE(record.has_value());
+    EXPECT_EQ(record->vector, records[42].vector);
+    EXPECT_EQ(record->metadata, records[42].metadata);
+}
+
+TEST_P(MmapPersistenceTest, MappedDatabaseAcceptsWritesAndResaves) {
+    auto records = make_records(300, 16);
+    {
+        auto db = IVectorDatabase::create(make_config(false));
+        ASSERT_EQ(db->batch_insert(records), ErrorCode::Ok);
+        ASSERT_EQ(db->save(), ErrorCode::Ok);
+    }
+
+    {
+        auto db = IVectorDatabase::create(make_config(true));
+        ASSERT_EQ(db->load(), ErrorCode::Ok);
+
+        // Removing patches mapped rows, inserting appends to the heap
+        for (std::size_t i = 0; i < 100; ++i) {
+            ASSERT_EQ(db->remove(records[i].id), ErrorCode::Ok);
+        }
+        ASSERT_EQ(db->insert({100000, records[0].vector, "new"}), ErrorCode::Ok);
+
+        // Saving over the file the database is mapped from
+        ASSERT_EQ(db->save(), ErrorCode::Ok);
+        auto moved = db->get(records[299].id);
+        ASSERT_TRUE(moved.has_value());
+        EXPECT_EQ(moved->vector, records[299].vector);
+    }
+
+    auto db = IVectorDatabase::create(make_config(true));
+    ASSERT_EQ(db->load(), ErrorCode::Ok);
+    EXPECT_EQ(db->size(), 201);
+    EXPECT_FALSE(db->contains(records[0].id));
+    auto added = db->get(100000);
+    ASSERT_TRUE(added.has_value());
+    EXPECT_EQ(added->vector, records[0].vector);
+    for (std::size_t i = 100; i < records.size(); ++i) {
+        auto record = db->get(records[i].id);
+        ASSERT_TRUE(record.has_value());
+        EXPECT_EQ(record->vector, records[i].vector);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    AllIndexTypes,
+    MmapPersistenceTest,
+    ::testing::Values(IndexType::Flat, IndexType::HNSW, IndexType::IVF),
+    [](const ::testing::TestParamInfo<IndexType>& info) {
+        switch (info.param) {
+            case IndexType::Flat: return std::string("Flat");
+            case IndexType::HNSW: return std::string("HNSW");
+            default: return std::string("IVF");
+        }
+    }
+);
+
+TEST_F(PersistenceTest, MappedFlatLoadKeepsVectorsOffHeap) {
+    Config config;
+    config.dimension = 64;
+    config.index_type = IndexType::Flat;
+    config.data_path = test_data_path_;
+
+    std::vector<VectorRecord> records;
+    for (std::uint64_t i = 0; i < 2000; ++i) {
+        records.push_back({i, std::vector<float>(config.dimension, static_cast<float>(i)),
+                           std::nullopt});
+    }
+    {
+        auto db = IVectorDatabase::create(config);
+        ASSERT_EQ(db->batch_insert(records), ErrorCode::Ok);
+        ASSERT_EQ(db->save(), ErrorCode::Ok);
+    }
+
+    auto heap_db = IVectorDatabase::create(config);
+    ASSERT_EQ(heap_db->load(), ErrorCode::Ok);
+    config.enable_mmap = true;
+    auto mapped_db = IVectorDatabase::create(config);
+    ASSERT_EQ(mapped_db->load(), ErrorCode::Ok);
+
+    const std::size_t vector_bytes = records.size() * config.dimension * sizeof(float);
+    EXPECT_GE(heap_db->stats().index_memory_bytes, vector_bytes);
+    EXPECT_LT(mapped_db->stats().index_memory_bytes, vector_bytes);
+}
+
+TEST_F(PersistenceTest, LoadsVersion1VectorFile) {
+    Config config;
+    config.dimension = 4;
+    config.index_type = IndexType::Flat;
+    config.data_path = test_data_path_;
+
+    std::vector<VectorRecord> records = {
+        {5, {1.0f, 2.0f, 3.0f, 4.0f}, "five"},
+        {9, {4.0f, 3.0f, 2.0f, 1.0f}, std::nullopt},
+    };
+    {
+        auto db = IVectorDatabase::create(config);
+        ASSERT_EQ(db->batch_insert(records), ErrorCode::Ok);
+        ASSERT_EQ(db->save(), ErrorCode::Ok);
+    }
+
+    // Rewrite vectors.bin in the interleaved version 1 layout
+    {
+        std::ofstream out(test_data_path_ + "/vectors.bin", std::ios::binary | std::ios::trunc);
+        const std::uint32_t magic = 0x4C594E58;
+        const std::uint32_t version = 1;
+        const std::uint64_t count = records.size();
+        const std::uint64_t dim = config.dimension;
+        out.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+        out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+        out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        out.write(reinterpret_cast<const char*>(&dim), sizeof(dim));
+        for (const auto& record : records) {
+            out.write(reinterpret_cast<const char*>(&record.id), sizeof(record.id));
+            out.write(reinterpret_cast<const char*>(record.vector.data()),
+                      record.vector.size() * sizeof(float));
+            const std::uint32_t meta_len = record.metadata ? record.metadata->size() : 0;
+            out.write(reinterpret_cast<const char*>(&meta_len), sizeof(meta_len));
+            if (meta_len > 0) {
+                out.write(record.metadata->data(), meta_len);
+            }
+        }
+    }
+
+    for (bool enable_mmap : {false, true}) {
+        config.enable_mmap = enable_mmap;
+        auto db = IVectorDatabase::create(config);
+        ASSERT_EQ(db->load(), ErrorCode::Ok);
+        EXPECT_EQ(db->size(), 2);
+        auto record = db->get(5);
+        ASSERT_TRUE(record.has_value());
+        EXPECT_EQ(record->vector, records[0].vector);
+        EXPECT_EQ(record->metadata, std::optional<std::string>("five"));
+    }
+
+    // Without index.bin the index is rebuilt from the interleaved vectors
+    std::filesystem::remove(test_data_path_ + "/index.bin");
+    config.enable_mmap = false;
+    config.rebuild_index_on_load = true;
+    auto db = IVectorDatabase::create(config);
+    ASSERT_EQ(db->load(), ErrorCode::Ok);
+    auto record = db->get(9);
+    ASSERT_TRUE(record.has_value());
+    EXPECT_EQ(record->vector, records[1].vector);
+    EXPECT_FALSE(record->metadata.has_value());
+}
+
+TEST_F(PersistenceTest, LoadsVersion2VectorFile) {
+    Config config;
+    config.dimension = 4;
+    config.index_type = IndexType::Flat;
+    config.data_path = test_data_path_;
+    {
+        auto db = IVectorDatabase::create(config);
+        ASSERT_EQ(db->insert({5, {1.0f, 2.0f, 3.0f, 4.0f}, "five"}), ErrorCode::Ok);
+        ASSERT_EQ(db->save(), ErrorCode::Ok);
+    }
+
+    // Version 2 has the same blocks; its header simply ends before the
+    // checksums, which a version 2 reader never looks at
+    {
+        std::fstream file(test_data_path_ + "/vectors.bin",
+                          std::ios::binary | std::ios::in | std::ios::out);
+        const std::uint32_t version = 2;
+        file.seekp(4);
+        file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    }
+
+    for (bool enable_mmap : {false, true}) {
+        config.enable_mmap = enable_mmap;
+        auto db = IVectorDatabase::create(config);
+        ASSERT_EQ(db->load(), ErrorCode::Ok);
+        auto record = db->get(5);
+        ASSERT_TRUE(record.has_value());
+        EXPECT_EQ(record->metadata, std::optional<std::string>("five"));
+    }
+}
+
+// ============================================================================
+// Checksum Tests
+// ============================================================================
+
+class ChecksumPersistenceTest : public PersistenceTest,
+                                public ::testing::WithParamInterface<IndexType> {
+protected:
+    Config make_config() const {
+        Config config;
+        config.dimension = 8;
+        config.index_type = GetParam();
+        config.ivf_params.n_clusters = 4;
+        config.data_path = test_data_path_;
+        return config;
+    }
+
+    void save_records() {
+        std::vector<VectorRecord> records;
+        for (std::uint64_t i = 0; i < 200; ++i) {
+            records.push_back({i, std::vector<float>(8, static_cast<float>(i)),
+                               "meta" + std::to_string(i)});
+        }
+        auto db = IVectorDatabase::create(make_config());
+        ASSERT_EQ(db->batch_insert(records), ErrorCode::Ok);
+        ASSERT_EQ(db->save(), ErrorCode::Ok);
+    }
+
+    /// Flip one byte of a saved file, `from_end` bytes before its end
+    void corrupt(const std::string& file_name, std::uintmax_t from_end) {
+        const std::string path = test_data_path_ + "/" + file_name;
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekg(static_cast<std::streamoff>(std::filesystem::file_size(path) - from_end));
+        char byte = 0;
+        file.read(&byte, 1);
+        byte = static_cast<char>(byte ^ 0x5A);
+        file.seekp(static_cast<std::streamoff>(std::filesystem::file_size(path) - from_end));
+        file.write(&byte, 1);
+    }
+};
+
+TEST_P(ChecksumPersistenceTest, IntactFilesLoad) {
+    save_records();
+    auto db = IVectorDatabase::create(make_config());
+    ASSERT_EQ(db->load(), ErrorCode::Ok);
+    EXPECT_EQ(db->size(), 200);
+}
+
+TEST_P(ChecksumPersistenceTest, CorruptIndexFileIsRejected) {
+    save_records();
+    corrupt("index.bin", 5);
+    auto db = IVectorDatabase::create(make_config());
+    EXPECT_NE(db->load(), ErrorCode::Ok);
+    EXPECT_EQ(db->size(), 0);
+}
+
+TEST_P(ChecksumPersistenceTest, CorruptMetadataIsRejected) {
+    save_records();
+    corrupt("vectors.bin", 2);  // Inside the last metadata value
+    auto db = IVectorDatabase::create(make_config());
+    EXPECT_EQ(db->load(), ErrorCode::IOError);
+    EXPECT_EQ(db->size(), 0);
+}
+
+TEST_P(ChecksumPersistenceTest, CorruptVectorBlockIsRejectedWhenVerified) {
+    save_records();
+    // The vector block ends where the metadata block (200 x "metaN") begins
+    const std::uintmax_t metadata_bytes = 200 * sizeof(std::uint32_t) + 10 * 5 + 90 * 6 + 100 * 7;
+    corrupt("vectors.bin", metadata_bytes + 1);
+    for (bool enable_mmap : {false, true}) {
+        Config config = make_config();
+        config.verify_on_load = true;
+        config.enable_mmap = enable_mmap;
+        auto db = IVectorDatabase::create(config);
+        EXPECT_EQ(db->load(), ErrorCode::IOError);
+    }
+}
+
+TEST_P(ChecksumPersistenceTest, HeapLoadDoesNotReadVectorBlock) {
+    save_records();
+    const std::uintmax_t metadata_bytes = 200 * sizeof(std::uint32_t) + 10 * 5 + 90 * 6 + 100 * 7;
+    corrupt("vectors.bin", metadata_bytes + 1);
+
+    // The index holds its own (checksummed) copy of every vector
+    auto db = IVectorDatabase::create(make_config());
+    ASSERT_EQ(db->load(), ErrorCode::Ok);
+    auto record = db->get(199);
+    ASSERT_TRUE(record.has_value());
+    EXPECT_EQ(record->vector, std::vector<float>(8, 199.0f));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    AllIndexTypes,
+    ChecksumPersistenceTest,
+    ::testing::Values(IndexType::Flat, IndexType::HNSW, IndexType::IVF),
+    [](const ::testing::TestParamInfo<IndexType>& info) {
+        switch (info.param) {
+            case IndexType::Flat: return std::string("Flat");
+            case IndexType::HNSW: return std::string("HNSW");
+            default: return std::string("IVF");
+        }
+    }
+);
+
+// ============================================================================
+// Index Rebuild Tests
+// ============================================================================
+
+class IndexRebuildTest : public ChecksumPersistenceTest {
+protected:
+    /// Load with rebuild_index_on_load and check every saved record
+    void expect_rebuilt(bool enable_mmap) {
+        Config config = make_config();
+        config.rebuild_index_on_load = true;
+        config.enable_mmap = enable_mmap;
+        auto db = IVectorDatabase::create(config);
+        ASSERT_EQ(db->load(), ErrorCode::Ok);
+        ASSERT_EQ(db->size(), 200);
+        for (std::uint64_t id : {0, 57, 199}) {
+            auto record = db->get(id);
+            ASSERT_TRUE(record.has_value());
+            EXPECT_EQ(record->vector, std::vector<float>(8, static_cast<float>(id)));
+            EXPECT_EQ(record->metadata, std::optional<std::string>("meta" + std::to_string(id)));
+        }
+        std::vector<float> query(8, 57.0f);
+        auto result = db->search(query, 1);
+        ASSERT_EQ(result.items.size(), 1);
+        EXPECT_EQ(result.items[0].id, 57);
+    }
+};
+
+TEST_P(IndexRebuildTest, MissingIndexFailsWithoutRebuild) {
+    save_records();
+    std::filesystem::remove(test_data_path_ + "/index.bin");
+    auto db = IVectorDatabase::create(make_config());
+    EXPECT_EQ(db->load(), ErrorCode::IOError);
+}
+
+TEST_P(IndexRebuildTest, RebuildsMissingIndex) {
+    save_records();
+    std::filesystem::remove(test_data_path_ + "/index.bin");
+    expect_rebuilt(false);
+    expect_rebuilt(true);
+}
+
+TEST_P(IndexRebuildTest, RebuildsCorruptIndex) {
+    save_records();
+    corrupt("index.bin", 5);
+    expect_rebuilt(false);
+}
+
+TEST_P(IndexRebuildTest, RebuildsIndexFromEarlierSave) {
+    // index.bin from a smaller save no longer matches vectors.bin
+    {
+        auto db = IVectorDatabase::create(make_config());
+        ASSERT_EQ(db->insert({0, std::vector<float>(8, 0.0f), "meta0"}), ErrorCode::Ok);
+        ASSERT_EQ(db->save(), ErrorCode::Ok);
+    }
+    const std::string index_path = test_data_path_ + "/index.bin";
+    std::filesystem::copy_file(index_path, index_path + ".old");
+    save_records();
+    std::filesystem::rename(index_path + ".old", index_path);
+    expect_rebuilt(false);
+}
+
+TEST_P(IndexRebuildTest, CorruptVectorBlockIsStillRejected) {
+    save_records();
+    std::filesystem::remove(test_data_path_ + "/index.bin");
+    const std::uintmax_t metadata_bytes = 200 * sizeof(std::uint32_t) + 10 * 5 + 90 * 6 + 100 * 7;
+    corrupt("vectors.bin", metadata_bytes + 1);
+    for (bool enable_mmap : {false, true}) {
+        Config config = make_config();
+        config.rebuild_index_on_load = true;
+        config.enable_mmap = enable_mmap;
+        auto db = IVectorDatabase::create(config);
+        EXPECT_EQ(db->load(), ErrorCode::IOError);
+        EXPECT_EQ(db->size(), 0);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    AllIndexTypes,
+    IndexRebuildTest,
+    ::testing::Values(IndexType::Flat, IndexType::HNSW, IndexType::IVF),
+    [](const ::testing::TestParamInfo<IndexType>& info) {
+        switch (info.param) {
+            case IndexType::Flat: return std::string("Flat");
+            case IndexType::HNSW: return std::string("HNSW");
+            default: return std::string("IVF");
+        }
+    }
+);
+
+// ============================================================================
+// Delta Snapshot Tests
+// ============================================================================
+
+class DeltaSnapshotTest : public ChecksumPersistenceTest {
+protected:
+    Config delta_config(std::size_t max_deltas = 3) const {
+        Config config = make_config();
+        config.max_snapshot_deltas = max_deltas;
+        return config;
+    }
+
+    std::size_t count_delta_files() const {
+        std::size_t count = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(test_data_path_)) {
+            if (entry.path().filename().string().starts_with("delta-")) {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    std::string read_file(const std::string& file_name) const {
+        std::ifstream in(test_data_path_ + "/" + file_name, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), {});
+    }
+
+    /// Check the state left by apply_small_changes()
+    void expect_changed_state(IVectorDatabase& db, std::size_t expected_size = 200) {
+        EXPECT_EQ(db.size(), expected_size);
+        EXPECT_FALSE(db.contains(3));
+        auto added = db.get(500);
+        ASSERT_TRUE(added.has_value());
+        EXPECT_EQ(added->vector, std::vector<float>(8, 500.0f));
+        EXPECT_EQ(added->metadata, std::optional<std::string>("new"));
+        auto replaced = db.get(7);
+        ASSERT_TRUE(replaced.has_value());
+        EXPECT_EQ(replaced->vector, std::vector<float>(8, -7.0f));
+        EXPECT_FALSE(replaced->metadata.has_value());
+        auto kept = db.get(42);
+        ASSERT_TRUE(kept.has_value());
+        EXPECT_EQ(kept->metadata, std::optional<std::string>("meta42"));
+    }
+
+    /// Remove one record, add one, replace one
+    static void apply_small_changes(IVectorDatabase& db) {
+        ASSERT_EQ(db.remove(3), ErrorCode::Ok);
+        ASSERT_EQ(db.insert({500, std::vector<float>(8, 500.0f), "new"}), ErrorCode::Ok);
+        ASSERT_EQ(db.remove(7), ErrorCode::Ok);
+        ASSERT_EQ(db.insert({7, std::vector<float>(8, -7.0f), std::nullopt}), ErrorCode::Ok);
+    }
+};
+
+TEST_P(DeltaSnapshotTest, SmallChangesAreSavedAsDelta) {
+    save_records();
+    const std::string vectors_before = read_file("vectors.bin");
+    const std::string index_before = read_file("index.bin");
+    {
+        auto db = IVectorDatabase::create(delta_config());
+        ASSERT_EQ(db->load(), ErrorCode::Ok);
+        apply_small_changes(*db);
+        ASSERT_EQ(db->save(), ErrorCode::Ok);
+    }
+
+    // The snapshot is untouched; the changes are in one delta file
+    EXPECT_EQ(read_file("vectors.bin"), vectors_before);
+    EXPECT_EQ(read_file("index.bin"), index_before);
+    EXPECT_EQ(count_delta_files(), 1);
+
+    for (bool enable_mmap : {false, true}) {
+        Config config = delta_config();
+        config.enable_mmap = enable_mmap;
+        auto db = IVectorDatabase::create(config);
+        ASSERT_EQ(db->load(), ErrorCode::Ok);
+        expect_changed_state(*db);
+        auto result = db->search(std::vector<float>(8, 500.0f), 1);
+        ASSERT_EQ(result.items.size(), 1);
+        EXPECT_EQ(result.items[0].id, 500);
+    }
+}
+
+TEST_P(DeltaSnapshotTest, SaveWithoutChangesWritesNothing) {
+    save_records();
+    auto db = IVectorDatabase::create(delta_config());
+    ASSERT_EQ(db->load(), ErrorCode::Ok);
+    ASSERT_EQ(db->save(), ErrorCode::Ok);
+    EXPECT_EQ(count_delta_files(), 0);
+}
+
+TEST_P(DeltaSnapshotTest, DeltasAreFoldedAtTheLimit) {
+    save_records();
+    {
+        auto db = IVectorDatabase::create(delta_config(2));
+        ASSERT_EQ(db->load(), ErrorCode::Ok);
+        ASSERT_EQ(db->remove(3), ErrorCode::Ok);
+        ASSERT_EQ(db->save(), ErrorCode::Ok);
+        ASSERT_EQ(db->insert({500, std::vector<float>(8, 500.0f), "new"}), ErrorCode::Ok);
+        ASSERT_EQ(db->save(), ErrorCode::Ok);
+        EXPECT_EQ(count_delta_files(), 2);
+
+        // Third save: full snapshot, deltas deleted
+        ASSERT_EQ(db->remove(7), ErrorCode::Ok);
+        ASSERT_EQ(db->insert({7, std::vector<float>(8, -7.0f), std::nullopt}), ErrorCode::Ok);
+        ASSERT_EQ(db->save(), ErrorCode::Ok);
+        EXPECT_EQ(count_delta_files(), 0);
+    }
+
+    auto db = IVectorDatabase::create(delta_config(2));
+    ASSERT_EQ(db->load(), ErrorCode::Ok);
+    expect_changed_state(*db);
+}
+
+TEST_P(DeltaSnapshotTest, LargeChangesWriteFullSnapshot) {
+    save_records();
+    auto db = IVectorDatabase::create(delta_config());
+    ASSERT_EQ(db->load(), ErrorCode::Ok);
+    for (std::uint64_t id = 0; id < 50; ++id) {
+        ASSERT_EQ(db->remove(id), ErrorCode::Ok);
+    }
+    ASSERT_EQ(db->save(), ErrorCode::Ok);
+    EXPECT_EQ(count_delta_files(), 0);
+
+    auto loaded = IVectorDatabase::create(delta_config());
+    ASSERT_EQ(loaded->load(), ErrorCode::Ok);
+    EXPECT_EQ(loaded->size(), 150);
+}
+
+TEST_P(DeltaSnapshotTest, FoldedDeltaLeftOnDiskIsIgnored) {
+    save_records();
+    const std::string stale_copy = test_data_path_ + "/stale.tmp";
+    {
+        auto db = IVectorDatabase::create(delta_config(1));
+        ASSERT_EQ(db->load(), ErrorCode::Ok);
+        ASSERT_EQ(db->insert({500, std::vector<float>(8, 500.0f), "new"}), ErrorCode::Ok);
+        ASSERT_EQ(db->save(), ErrorCode::Ok);
+        std::filesystem::copy_file(test_data_path_ + "/delta-0000000001.bin", stale_copy);
+
+        // Fold, then remove the record the delta had added
+        ASSERT_EQ(db->remove(500), ErrorCode::Ok);
+        ASSERT_EQ(db->save(), ErrorCode::Ok);
+        ASSERT_EQ(count_delta_files(), 0);
+    }
+
+    // As if save() had stopped before deleting the folded delta
+    std::filesystem::rename(stale_copy, test_data_path_ + "/delta-0000000001.bin");
+    auto db = IVectorDatabase::create(delta_config(1));
+    ASSERT_EQ(db->load(), ErrorCode::Ok);
+    EXPECT_FALSE(db->contains(500));
+    EXPECT_EQ(db->size(), 200);
+}
+
+TEST_P(DeltaSnapshotTest, CorruptDeltaFailsLoad) {
+    save_records();
+    {
+        auto db = IVectorDatabase::create(delta_config());
+        ASSERT_EQ(db->load(), ErrorCode::Ok);
+        apply_small_changes(*db);
+        ASSERT_EQ(db->save(), ErrorCode::Ok);
+    }
+    corrupt("delta-0000000001.bin", 2);
+    auto db = IVectorDatabase::create(delta_config());
+    EXPECT_EQ(db->load(), ErrorCode::IOError);
+    EXPECT_EQ(db->size(), 0);
+}
+
+TEST_P(DeltaSnapshotTest, WalIsReplayedOnTopOfDeltas) {
+    save_records();
+    Config config = delta_config();
+    config.enable_wal = true;
+    {
+        auto db = IVectorDatabase::create(config);
+        ASSERT_EQ(db->load(), ErrorCode::Ok);
+        apply_small_changes(*db);
+        ASSERT_EQ(db->save(), ErrorCode::Ok);
+        EXPECT_EQ(count_delta_files(), 1);
+
+        // Logged only
+        ASSERT_EQ(db->remove(42), ErrorCode::Ok);
+        ASSERT_EQ(db->insert({42, std::vector<float>(8, 42.0f), "meta42"}), ErrorCode::Ok);
+        ASSERT_EQ(db->insert({501, std::vector<float>(8, 501.0f), std::nullopt}), ErrorCode::Ok);
+    }
+
+    auto db = IVectorDatabase::create(config);
+    ASSERT_EQ(db->load(), ErrorCode::Ok);
+    EXPECT_TRUE(db->contains(501));
+    EXPECT_EQ(db->size(), 201);
+
+    // The replayed entries go into the next delta
+    ASSERT_EQ(db->save(), ErrorCode::Ok);
+    EXPECT_EQ(count_delta_files(), 2);
+    config.enable_wal = false;
+    auto reloaded = IVectorDatabase::create(config);
+    ASSERT_EQ(reloaded->load(), ErrorCode::Ok);
+    EXPECT_TRUE(reloaded->contains(501));
+    expect_changed_state(*reloaded, 201);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    AllIndexTypes,
+    DeltaSnapshotTest,
+    ::testing::Values(IndexType::Flat, IndexType::HNSW, IndexType::IVF),
+    [](const ::testing::TestParamInfo<IndexType>& info) {
+        switch (info.param) {
+            case IndexType::Flat: return std::string("Flat");
+            case IndexType::HNSW: return std::string("HNSW");
+            default: return std::string("IVF");
+        }
+    }
+);
+
+// ============================================================================
+// Online Save Tests
+// ============================================================================
+
+class OnlineSaveTest : public ChecksumPersistenceTest {
+protected:
+    static constexpr std::uint64_t kRecords = 5000;
+    static constexpr std::uint64_t kChanges = 500;
+
+    static VectorRecord make_record(std::uint64_t id) {
+        return {id, std::vector<float>(8, static_cast<float>(id)), "meta" + std::to_string(id)};
+    }
+
+    std::shared_ptr<IVectorDatabase> make_database(const Config& config) {
+        std::vector<VectorRecord> records;
+        for (std::uint64_t i = 0; i < kRecords; ++i) {
+            records.push_back(make_record(i));
+        }
+        auto db = IVectorDatabase::create(config);
+        EXPECT_EQ(db->batch_insert(records), ErrorCode::Ok);
+        return db;
+    }
+
+    /// Save while another thread replaces ID i by ID kRecords + i, in order
+    static void save_while_writing(IVectorDatabase& db) {
+        std::atomic<bool> failed{false};
+        std::thread writer([&db, &failed] {
+            for (std::uint64_t i = 0; i < kChanges; ++i) {
+                if (db.remove(i) != ErrorCode::Ok || db.insert(make_record(kRecords + i)) != ErrorCode::Ok) {
+                    failed = true;
+                }
+            }
+        });
+        const ErrorCode saved = db.save();
+        writer.join();
+        EXPECT_EQ(saved, ErrorCode::Ok);
+        EXPECT_FALSE(failed);
+    }
+
+    /// Check a snapshot written by save_while_writing()
+    static void expect_point_in_time(const std::shared_ptr<IVectorDatabase>& loaded) {
+        // The writer's first `removed` steps happened before the capture: the
+        // snapshot lacks IDs [0, removed) and has the replacements of all but
+        // possibly the last of them
+        std::uint64_t removed = 0;
+        while (removed < kChanges && !loaded->contains(removed)) {
+            ++removed;
+        }
+        std::uint64_t inserted = 0;
+        while (inserted < kChanges && loaded->contains(kRecords + inserted)) {
+            ++inserted;
+        }
+        EXPECT_TRUE(inserted == removed || inserted + 1 == removed);
+        EXPECT_EQ(loaded->size(), kRecords - removed + inserted);
+
+        // Every record is intact, including those removed while saving
+        auto expect_intact = [&loaded](std::uint64_t id) {
+            auto record = loaded->get(id);
+            ASSERT_TRUE(record.has_value()) << id;
+            EXPECT_EQ(record->vector, make_record(id).vector);
+            EXPECT_EQ(record->metadata, make_record(id).metadata);
+        };
+        for (std::uint64_t id = removed; id < kRecords; ++id) {
+            expect_intact(id);
+        }
+        for (std::uint64_t id = kRecords; id < kRecords + inserted; ++id) {
+            expect_intact(id);
+        }
+    }
+};
+
+TEST_P(OnlineSaveTest, SnapshotIsPointInTime) {
+    Config config = make_config();
+    auto db = make_database(config);
+    save_while_writing(*db);
+
+    auto loaded = IVectorDatabase::create(config);
+    ASSERT_EQ(loaded->load(), ErrorCode::Ok);
+    expect_point_in_time(loaded);
+}
+
+TEST_P(OnlineSaveTest, SegmentedSnapshotIsPointInTime) {
+    // The capture pins the segments instead of serializing the index
+    Config config = make_config();
+    config.memtable_capacity = 256;
+    auto db = make_database(config);
+    save_while_writing(*db);
+
+    auto loaded = IVectorDatabase::create(config);
+    ASSERT_EQ(loaded->load(), ErrorCode::Ok);
+    expect_point_in_time(loaded);
+}
+
+TEST_P(OnlineSaveTest, WalKeepsWritesMadeDuringSave) {
+    Config config = make_config();
+    config.enable_wal = true;
+    {
+        auto db = make_database(config);
+        save_while_writing(*db);
+    }
+
+    auto loaded = IVectorDatabase::create(config);
+    ASSERT_EQ(loaded->load(), ErrorCode::Ok);
+    EXPECT_EQ(loaded->size(), kRecords);
+    for (std::uint64_t i = 0; i < kChanges; ++i) {
+        EXPECT_FALSE(loaded->contains(i));
+        EXPECT_TRUE(loaded->contains(kRecords + i));
+    }
+    auto record = loaded->get(kRecords + kChanges - 1);
+    ASSERT_TRUE(record.has_value());
+    EXPECT_EQ(record->metadata, make_record(kRecords + kChanges - 1).metadata);
+}
+
+TEST_P(OnlineSaveTest, WalKeepsWritesMadeDuringDeltaSave) {
+    Config config = make_config();
+    config.enable_wal = true;
+    config.max_snapshot_deltas = 3;
+    {
+        auto db = make_database(config);
+        ASSERT_EQ(db->save(), ErrorCode::Ok);
+        ASSERT_EQ(db->insert(make_record(2 * kRecords)), ErrorCode::Ok);
+        save_while_writing(*db);
+    }
+    ASSERT_TRUE(std::filesystem::exists(test_data_path_ + "/delta-0000000001.bin"));
+
+    auto loaded = IVectorDatabase::create(config);
+    ASSERT_EQ(loaded->load(), ErrorCode::Ok);
+    EXPECT_EQ(loaded->size(), kRecords + 1);
+    EXPECT_TRUE(loaded->contains(2 * kRecords));
+    for (std::uint64_t i = 0; i < kChanges; ++i) {
+        EXPECT_FALSE(loaded->contains(i));
+        EXPECT_TRUE(loaded->contains(kRecords + i));
+    }
+}
+
+TEST_P(OnlineSaveTest, DeltaSavesKeepAcknowledgedInserts) {
+    Config config = make_config();
+    config.enable_wal = true;
+    config.max_snapshot_deltas = 1000;
+    auto db = make_database(config);
+    ASSERT_EQ(db->save(), ErrorCode::Ok);
+
+    // Writers insert while delta saves run; the gate lets the test stop
+    // them between inserts
+    constexpr std::uint64_t kWriters = 4;
+    std::shared_mutex gate;
+    std::vector<std::uint64_t> acknowledged;
+    std::mutex acknowledged_mutex;
+    std::atomic<std::uint64_t> finished{0};
+    std::vector<std::thread> writers;
+    for (std::uint64_t w = 0; w < kWriters; ++w) {
+        writers.emplace_back([&, w] {
+            for (std::uint64_t id = kRecords + w; id < kRecords + kChanges; id += kWriters) {
+                {
+                    std::shared_lock lock(gate);
+                    if (db->insert(make_record(id)) == ErrorCode::Ok) {
+                        std::lock_guard guard(acknowledged_mutex);
+                        acknowledged.push_back(id);
+                    }
+                }
+
+                // Sparse inserts: some saves see none during their write and
+                // cut the whole log
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+            ++finished;
+        });
+    }
+
+    // After each save, "crash": copy the files with the writers stopped and
+    // load the copy. Every acknowledged insert is in a delta or in the log
+    const std::string crashed_path = test_data_path_ + "_crashed";
+    Config crashed = config;
+    crashed.data_path = crashed_path;
+    for (int round = 0; round < 20 && finished < kWriters; ++round) {
+        ASSERT_EQ(db->save(), ErrorCode::Ok);
+        std::vector<std::uint64_t> expected;
+        {
+            std::unique_lock lock(gate);
+            std::filesystem::remove_all(crashed_path);
+            std::filesystem::copy(test_data_path_, crashed_path);
+            std::lock_guard guard(acknowledged_mutex);
+            expected = acknowledged;
+        }
+        auto loaded = IVectorDatabase::create(crashed);
+        ASSERT_EQ(loaded->load(), ErrorCode::Ok);
+        for (std::uint64_t id : expected) {
+            EXPECT_TRUE(loaded->contains(id)) << "round " << round << ", id " << id;
+        }
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    std::filesystem::remove_all(crashed_path);
+    EXPECT_EQ(acknowledged.size(), kChanges);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    AllIndexTypes,
+    OnlineSaveTest,
+    ::testing::Values(IndexType::Flat, IndexType::HNSW, IndexType::IVF),
+    [](const ::testing::TestParamInfo<IndexType>& info) {
+        switch (info.param) {
+            case IndexType::Flat: return std::string("Flat");
+            case IndexType::HNSW: return std::string("HNSW");
+            default: return std::string("IVF");
+        }
+    }
+);
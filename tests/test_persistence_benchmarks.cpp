@@ -0,0 +1,165 @@
+/**
+ * @file test_persistence_benchmarks.cpp
+ * @brief Throughput benchmarks for save() and load()
+ *
+ * Reports GB/s as the bytes of index.bin plus vectors.bin over the best of
+ * a few timed runs. Files mostly stay in the page cache, so the numbers
+ * measure serialization and checksumming rather than the disk. The rebuild
+ * benchmarks compare loading index.bin with rebuilding the index from
+ * vectors.bin (rebuild_index_on_load) up to the first query.
+ *
+ * @copyright MIT License
+ */
+
+#include <gtest/gtest.h>
+#include "../src/lib/vector_database.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace lynx;
+
+namespace {
+
+std::vector<VectorRecord> make_records(std::size_t count, std::size_t dimension) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<VectorRecord> records;
+    records.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::vector<float> vec(dimension);
+        for (auto& x : vec) {
+            x = dist(rng);
+        }
+        records.push_back({i, std::move(vec), "record-" + std::to_string(i)});
+    }
+    return records;
+}
+
+template <typename Func>
+double best_time_s(int runs, Func&& func) {
+    double best = std::numeric_limits<double>::max();
+    for (int run = 0; run < runs; ++run) {
+        const auto start = std::chrono::high_resolution_clock::now();
+        func();
+        const auto end = std::chrono::high_resolution_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - start).count());
+    }
+    return best;
+}
+
+void run_persistence_benchmark(IndexType index_type, std::size_t count, std::size_t dimension) {
+    const std::string path = "/tmp/lynx_persist_bench_" + std::to_string(std::random_device{}());
+    Config config;
+    config.dimension = dimension;
+    config.index_type = index_type;
+    config.data_path = path;
+    config.ivf_params.n_clusters = 64;  // Keeps the build short; save/load cost is per vector
+
+    VectorDatabase db(config);
+    ASSERT_EQ(db.batch_insert(make_records(count, dimension)), ErrorCode::Ok);
+
+    constexpr int kRuns = 3;
+    const double save_s = best_time_s(kRuns, [&] {
+        ASSERT_EQ(db.save(), ErrorCode::Ok);
+    });
+    const double bytes = static_cast<double>(std::filesystem::file_size(path + "/index.bin") +
+                                             std::filesystem::file_size(path + "/vectors.bin"));
+
+    VectorDatabase loaded(config);
+    const double load_s = best_time_s(kRuns, [&] {
+        ASSERT_EQ(loaded.load(), ErrorCode::Ok);
+    });
+    EXPECT_EQ(loaded.size(), count);
+
+    const char* name = index_type == IndexType::Flat ? "Flat"
+                     : index_type == IndexType::HNSW ? "HNSW" : "IVF";
+    std::cout << "\n[BENCHMARK] " << name << " persistence (" << count << " vectors, dim "
+              << dimension << ", " << std::fixed << std::setprecision(0) << bytes / 1e6
+              << " MB on disk):\n"
+              << std::setprecision(2)
+              << "  save: " << save_s * 1000 << " ms  " << bytes / save_s / 1e9 << " GB/s\n"
+              << "  load: " << load_s * 1000 << " ms  " << bytes / load_s / 1e9 << " GB/s\n";
+
+    std::filesystem::remove_all(path);
+}
+
+void run_rebuild_benchmark(IndexType index_type, std::size_t count, std::size_t dimension) {
+    const std::string path = "/tmp/lynx_rebuild_bench_" + std::to_string(std::random_device{}());
+    Config config;
+    config.dimension = dimension;
+    config.index_type = index_type;
+    config.data_path = path;
+    config.ivf_params.n_clusters = 64;
+    {
+        VectorDatabase db(config);
+        ASSERT_EQ(db.batch_insert(make_records(count, dimension)), ErrorCode::Ok);
+        ASSERT_EQ(db.save(), ErrorCode::Ok);
+    }
+    const std::vector<float> query = make_records(1, dimension)[0].vector;
+
+    // Time from load() to the first answered query
+    auto time_to_first_query = [&](double& load_s, double& first_query_s) {
+        const auto start = std::chrono::high_resolution_clock::now();
+        VectorDatabase db(config);
+        ASSERT_EQ(db.load(), ErrorCode::Ok);
+        load_s = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        EXPECT_FALSE(db.search(query, 10).items.empty());
+        first_query_s =
+            std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    };
+
+    double load_s = 0.0;
+    double loaded_first_query_s = 0.0;
+    time_to_first_query(load_s, loaded_first_query_s);
+
+    std::filesystem::remove(path + "/index.bin");
+    config.rebuild_index_on_load = true;
+    double rebuild_s = 0.0;
+    double rebuilt_first_query_s = 0.0;
+    time_to_first_query(rebuild_s, rebuilt_first_query_s);
+
+    const char* name = index_type == IndexType::Flat ? "Flat"
+                     : index_type == IndexType::HNSW ? "HNSW" : "IVF";
+    std::cout << "\n[BENCHMARK] " << name << " index rebuild on load (" << count
+              << " vectors, dim " << dimension << "):\n" << std::fixed << std::setprecision(2)
+              << "  index.bin load: " << load_s * 1000 << " ms, first query after "
+              << loaded_first_query_s * 1000 << " ms\n"
+              << "  rebuild:        " << rebuild_s * 1000 << " ms ("
+              << std::setprecision(0) << static_cast<double>(count) / rebuild_s
+              << " vectors/s), first query after " << std::setprecision(2)
+              << rebuilt_first_query_s * 1000 << " ms\n";
+
+    std::filesystem::remove_all(path);
+}
+
+} // namespace
+
+TEST(PersistenceBenchmark, Flat_200K_Dim128) {
+    run_persistence_benchmark(IndexType::Flat, 200000, 128);
+}
+
+TEST(PersistenceBenchmark, IVF_100K_Dim128) {
+    run_persistence_benchmark(IndexType::IVF, 100000, 128);
+}
+
+TEST(PersistenceBenchmark, HNSW_20K_Dim64) {
+    run_persistence_benchmark(IndexType::HNSW, 20000, 64);
+}
+
+TEST(PersistenceBenchmark, RebuildFlat_200K_Dim128) {
+    run_rebuild_benchmark(IndexType::Flat, 200000, 128);
+}
+
+TEST(PersistenceBenchmark, RebuildIVF_100K_Dim128) {
+    run_rebuild_benchmark(IndexType::IVF, 100000, 128);
+}
+
+TEST(PersistenceBenchmark, RebuildHNSW_5K_Dim64) {
+    run_rebuild_benchmark(IndexType::HNSW, 5000, 64);
+}
@@ -0,0 +1,462 @@
+/**
+ * @file test_segmented_index.cpp
+ * @brief Unit tests for the memtable + segments index
+ *
+ * @copyright MIT License
+ */
+
+#include "../src/lib/segmented_index.h"
+#include "../src/lib/hnsw_index.h"
+#include "../src/lib/ivf_index.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <filesystem>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace lynx;
+
+// ============================================================================
+// Test Fixture
+// ============================================================================
+
+class SegmentedIndexTest : public ::testing::TestWithParam<IndexType> {
+protected:
+    static constexpr std::size_t kDim = 8;
+
+    std::unique_ptr<SegmentedIndex> make_index(std::size_t memtable_capacity,
+                                               std::size_t max_sealed_segments = 4) const {
+        const IndexType type = GetParam();
+        return std::make_unique<SegmentedIndex>(
+            kDim, DistanceMetric::L2, memtable_capacity, max_sealed_segments,
+            [type]() -> std::shared_ptr<IVectorIndex> {
+                switch (type) {
+                    case IndexType::HNSW:
+                        return std::make_shared<HNSWIndex>(kDim, DistanceMetric::L2, HNSWParams{});
+                    case IndexType::IVF: {
+                        IVFParams params;
+                        params.n_clusters = 4;
+                        params.n_probe = 4;  // All clusters: exact results
+                        return std::make_shared<IVFIndex>(kDim, DistanceMetric::L2, params);
+                    }
+                    default:
+                        return std::make_shared<FlatIndex>(kDim, DistanceMetric::L2, 1);
+                }
+            });
+    }
+
+    // Vector i sits at (i, 0, ..., 0), so the nearest neighbours of a query
+    // are known exactly
+    static std::vector<float> point(std::uint64_t i) {
+        std::vector<float> v(kDim, 0.0f);
+        v[0] = static_cast<float>(i);
+        return v;
+    }
+
+    static void fill(SegmentedIndex& index, std::uint64_t first, std::uint64_t count) {
+        for (std::uint64_t i = first; i < first + count; ++i) {
+            ASSERT_EQ(index.add(i, point(i)), ErrorCode::Ok);
+        }
+    }
+};
+
+// ============================================================================
+// Segment Lifecycle
+// ============================================================================
+
+TEST_P(SegmentedIndexTest, FullMemtableBecomesSegment) {
+    auto index = make_index(50);
+    fill(*index, 0, 120);
+    index->wait_idle();
+
+    EXPECT_EQ(index->segment_count(), 2);  // 100 in segments, 20 in the memtable
+    EXPECT_EQ(index->size(), 120);
+    for (std::uint64_t i = 0; i < 120; ++i) {
+        EXPECT_TRUE(index->contains(i));
+    }
+
+    std::vector<float> out(kDim);
+    ASSERT_TRUE(index->get_vector(7, out));
+    EXPECT_EQ(out, point(7));
+}
+
+TEST_P(SegmentedIndexTest, SearchMergesSegmentsAndMemtable) {
+    auto index = make_index(50);
+    fill(*index, 0, 120);
+    index->wait_idle();
+
+    // Neighbours of 49 straddle the first segment and the second
+    auto results = index->search(point(49), 4, SearchParams{});
+    ASSERT_EQ(results.size(), 4);
+    EXPECT_EQ(results[0].id, 49);
+    std::vector<std::uint64_t> ids;
+    for (const auto& item : results) {
+        ids.push_back(item.id);
+    }
+    std::sort(ids.begin(), ids.end());
+    EXPECT_EQ(ids, (std::vector<std::uint64_t>{47, 48, 49, 50}));
+
+    // And the memtable
+    results = index->search(point(119), 1, SearchParams{});
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_EQ(results[0].id, 119);
+}
+
+TEST_P(SegmentedIndexTest, RemoveTombstonesSegmentVectors) {
+    auto index = make_index(50);
+    fill(*index, 0, 60);
+    index->wait_idle();
+
+    EXPECT_EQ(index->remove(10), ErrorCode::Ok);   // In a segment
+    EXPECT_EQ(index->remove(55), ErrorCode::Ok);   // In the memtable
+    EXPECT_EQ(index->remove(10), ErrorCode::VectorNotFound);
+    EXPECT_EQ(index->size(), 58);
+    EXPECT_FALSE(index->contains(10));
+
+    auto results = index->search(point(10), 1, SearchParams{});
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_NE(results[0].id, 10);
+}
+
+TEST_P(SegmentedIndexTest, AddReplacesSegmentVector) {
+    auto index = make_index(50);
+    fill(*index, 0, 50);
+    index->wait_idle();
+
+    ASSERT_EQ(index->add(5, point(1000)), ErrorCode::Ok);
+    EXPECT_EQ(index->size(), 50);
+
+    std::vector<float> out(kDim);
+    ASSERT_TRUE(index->get_vector(5, out));
+    EXPECT_EQ(out, point(1000));
+    auto results = index->search(point(1000), 1, SearchParams{});
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_EQ(results[0].id, 5);
+}
+
+TEST_P(SegmentedIndexTest, FailedReAddKeepsSegmentVector) {
+    auto index = make_index(50);
+    fill(*index, 0, 50);
+    index->wait_idle();
+
+    const std::vector<float> wrong(kDim + 1, 1.0f);
+    EXPECT_EQ(index->add(5, wrong), ErrorCode::DimensionMismatch);
+    EXPECT_EQ(index->size(), 50);
+    EXPECT_TRUE(index->contains(5));
+
+    auto results = index->search(point(5), 1, SearchParams{});
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_EQ(results[0].id, 5);
+}
+
+TEST_P(SegmentedIndexTest, CompactionMergesSegments) {
+    auto index = make_index(20, 2);
+    fill(*index, 0, 100);
+    index->wait_idle();
+
+    // Five memtables: either one tier of five merged into one segment, or
+    // three merged and two left in the lowest tier
+    EXPECT_LE(index->segment_count(), 3);
+    EXPECT_EQ(index->size(), 100);
+    for (std::uint64_t i = 0; i < 100; ++i) {
+        EXPECT_TRUE(index->contains(i));
+    }
+}
+
+TEST_P(SegmentedIndexTest, CompactionLeavesLargerTiersAlone) {
+    auto index = make_index(20, 2);
+    std::vector<VectorRecord> records;
+    for (std::uint64_t i = 0; i < 1000; ++i) {
+        records.push_back({i, point(i), std::nullopt});
+    }
+    ASSERT_EQ(index->build(records), ErrorCode::Ok);
+
+    // Three small segments are merged with each other, not with the built one
+    fill(*index, 1000, 60);
+    index->wait_idle();
+
+    EXPECT_EQ(index->segment_count(), 2);
+    EXPECT_EQ(index->size(), 1060);
+    EXPECT_TRUE(index->contains(0));
+    EXPECT_TRUE(index->contains(1059));
+}
+
+TEST_P(SegmentedIndexTest, CompactionDropsTombstones) {
+    auto index = make_index(40);
+    fill(*index, 0, 40);
+    index->wait_idle();
+
+    for (std::uint64_t i = 0; i < 30; ++i) {
+        ASSERT_EQ(index->remove(i), ErrorCode::Ok);
+    }
+    index->wait_idle();
+
+    EXPECT_EQ(index->size(), 10);
+    EXPECT_EQ(index->segment_count(), 1);
+    auto results = index->search(point(0), 3, SearchParams{});
+    ASSERT_EQ(results.size(), 3);
+    EXPECT_EQ(results[0].id, 30);
+}
+
+TEST_P(SegmentedIndexTest, SearchSkipsTombstonedNeighbours) {
+    auto index = make_index(50);
+    std::vector<VectorRecord> records;
+    for (std::uint64_t i = 0; i < 100; ++i) {
+        records.push_back({i, point(i), std::nullopt});
+    }
+    ASSERT_EQ(index->build(records), ErrorCode::Ok);
+
+    // More tombstones than k + k around the query, too few to compact
+    for (std::uint64_t i = 0; i < 20; ++i) {
+        ASSERT_EQ(index->remove(i), ErrorCode::Ok);
+    }
+    index->wait_idle();
+    ASSERT_EQ(index->segment_count(), 1);
+
+    auto results = index->search(point(0), 5, SearchParams{});
+    ASSERT_EQ(results.size(), 5);
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        EXPECT_EQ(results[i].id, 20 + i);
+    }
+}
+
+TEST_P(SegmentedIndexTest, SearchHonoursFilter) {
+    auto index = make_index(50);
+    fill(*index, 0, 100);
+    index->wait_idle();
+    ASSERT_EQ(index->remove(21), ErrorCode::Ok);
+
+    SearchParams params;
+    params.filter = [](std::uint64_t id) { return id % 2 == 1; };
+    auto results = index->search(point(20), 2, params);
+    ASSERT_FALSE(results.empty());
+    EXPECT_EQ(results[0].id, 19);  // 21 is removed
+}
+
+// ============================================================================
+// Bulk Build and Serialization
+// ============================================================================
+
+TEST_P(SegmentedIndexTest, BuildReplacesContents) {
+    auto index = make_index(50);
+    fill(*index, 1000, 10);
+
+    std::vector<VectorRecord> records;
+    for (std::uint64_t i = 0; i < 200; ++i) {
+        records.push_back({i, point(i), std::nullopt});
+    }
+    ASSERT_EQ(index->build(records), ErrorCode::Ok);
+    EXPECT_EQ(index->size(), 200);
+    EXPECT_EQ(index->segment_count(), 1);
+    EXPECT_FALSE(index->contains(1000));
+}
+
+TEST_P(SegmentedIndexTest, SerializeRoundTrip) {
+    auto index = make_index(50);
+    fill(*index, 0, 130);
+    index->wait_idle();
+    ASSERT_EQ(index->remove(3), ErrorCode::Ok);
+
+    std::stringstream stream;
+    ASSERT_EQ(index->serialize(stream), ErrorCode::Ok);
+
+    auto loaded = make_index(50);
+    ASSERT_EQ(loaded->deserialize(stream), ErrorCode::Ok);
+    EXPECT_EQ(loaded->size(), 129);
+    EXPECT_EQ(loaded->segment_count(), index->segment_count());
+    EXPECT_FALSE(loaded->contains(3));
+    EXPECT_TRUE(loaded->contains(129));
+
+    auto results = loaded->search(point(3), 1, SearchParams{});
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_NE(results[0].id, 3);
+}
+
+TEST_P(SegmentedIndexTest, CaptureIsPointInTime) {
+    auto index = make_index(50, 2);
+    fill(*index, 0, 130);
+    index->wait_idle();
+
+    const std::optional<IndexCapture> captured = index->capture();
+    ASSERT_TRUE(captured.has_value());
+
+    // Writes, tombstones and compactions after the capture are not in it
+    fill(*index, 130, 300);
+    for (std::uint64_t i = 0; i < 60; ++i) {
+        ASSERT_EQ(index->remove(i), ErrorCode::Ok);
+    }
+    index->wait_idle();
+
+    std::vector<std::uint64_t> ids = captured->ids();
+    std::sort(ids.begin(), ids.end());
+    ASSERT_EQ(ids.size(), 130);
+    EXPECT_EQ(ids.front(), 0);
+    EXPECT_EQ(ids.back(), 129);
+
+    std::stringstream stream;
+    ASSERT_EQ(captured->serialize(stream), ErrorCode::Ok);
+    auto loaded = make_index(50, 2);
+    ASSERT_EQ(loaded->deserialize(stream), ErrorCode::Ok);
+    EXPECT_EQ(loaded->size(), 130);
+    EXPECT_TRUE(loaded->contains(0));
+    EXPECT_FALSE(loaded->contains(130));
+
+    std::vector<float> out(kDim);
+    ASSERT_TRUE(loaded->get_vector(42, out));
+    EXPECT_EQ(out, point(42));
+}
+
+TEST_P(SegmentedIndexTest, DeserializeRejectsOtherFormats) {
+    std::stringstream stream("not a segmented index");
+    auto index = make_index(50);
+    EXPECT_EQ(index->deserialize(stream), ErrorCode::IOError);
+}
+
+// ============================================================================
+// Concurrency
+// ============================================================================
+
+TEST_P(SegmentedIndexTest, SearchWhileInserting) {
+    auto index = make_index(64, 2);
+    fill(*index, 0, 64);
+
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (std::uint64_t i = 64; i < 1000; ++i) {
+            index->add(i, point(i));
+        }
+        done = true;
+    });
+
+    do {
+        auto results = index->search(point(10), 1, SearchParams{});
+        EXPECT_EQ(results.size(), 1);
+        if (!results.empty()) {
+            EXPECT_EQ(results[0].id, 10);
+        }
+    } while (!done);
+    writer.join();
+    index->wait_idle();
+
+    EXPECT_EQ(index->size(), 1000);
+}
+
+TEST_P(SegmentedIndexTest, SearchWhileRemoving) {
+    auto index = make_index(64, 2);
+    fill(*index, 0, 1000);
+    index->wait_idle();
+
+    // A search never returns an ID whose removal finished before it started
+    std::atomic<std::uint64_t> removed{0};
+    std::thread writer([&] {
+        for (std::uint64_t i = 0; i < 800; ++i) {
+            index->remove(i);
+            removed = i + 1;
+        }
+    });
+
+    std::uint64_t seen = 0;
+    while (seen < 800) {
+        seen = removed;
+        for (const auto& item : index->search(point(0), 5, SearchParams{})) {
+            EXPECT_GE(item.id, seen);
+        }
+    }
+    writer.join();
+    index->wait_idle();
+
+    EXPECT_EQ(index->size(), 200);
+    auto results = index->search(point(0), 1, SearchParams{});
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_EQ(results[0].id, 800);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    IndexTypes, SegmentedIndexTest,
+    ::testing::Values(IndexType::Flat, IndexType::HNSW, IndexType::IVF),
+    [](const ::testing::TestParamInfo<IndexType>& info) {
+        switch (info.param) {
+            case IndexType::HNSW: return std::string("HNSW");
+            case IndexType::IVF: return std::string("IVF");
+            default: return std::string("Flat");
+        }
+    });
+
+// ============================================================================
+// Database Integration
+// ============================================================================
+
+TEST(SegmentedDatabaseTest, InsertSearchSaveLoad) {
+    const std::string dir = "/tmp/lynx_segmented_test_" + std::to_string(std::random_device{}());
+
+    Config config;
+    config.dimension = 8;
+    config.index_type = IndexType::HNSW;
+    config.memtable_capacity = 100;
+    config.data_path = dir;
+
+    {
+        auto db = IVectorDatabase::create(config);
+        for (std::uint64_t i = 0; i < 350; ++i) {
+            std::vector<float> v(8, 0.0f);
+            v[0] = static_cast<float>(i);
+            ASSERT_EQ(db->insert({i, v, std::nullopt}), ErrorCode::Ok);
+        }
+        ASSERT_EQ(db->remove(42), ErrorCode::Ok);
+        EXPECT_EQ(db->size(), 349);
+        ASSERT_EQ(db->save(), ErrorCode::Ok);
+    }
+
+    auto db = IVectorDatabase::create(config);
+    ASSERT_EQ(db->load(), ErrorCode::Ok);
+    EXPECT_EQ(db->size(), 349);
+    EXPECT_FALSE(db->contains(42));
+
+    std::vector<float> query(8, 0.0f);
+    query[0] = 342.0f;
+    auto result = db->search(query, 1);
+    ASSERT_EQ(result.items.size(), 1);
+    EXPECT_EQ(result.items[0].id, 342);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(SegmentedDatabaseTest, ConcurrentInsertsAndSearches) {
+    Config config;
+    config.dimension = 8;
+    config.index_type = IndexType::HNSW;
+    config.memtable_capacity = 64;
+    config.max_sealed_segments = 2;
+    auto db = IVectorDatabase::create(config);
+
+    constexpr std::uint64_t kWriters = 4;
+    constexpr std::uint64_t kPerWriter = 500;
+    std::atomic<std::uint64_t> finished{0};
+    std::vector<std::thread> threads;
+    for (std::uint64_t w = 0; w < kWriters; ++w) {
+        threads.emplace_back([&db, &finished, w] {
+            for (std::uint64_t i = w * kPerWriter; i < (w + 1) * kPerWriter; ++i) {
+                std::vector<float> v(8, 0.0f);
+                v[0] = static_cast<float>(i);
+                EXPECT_EQ(db->insert({i, v, std::nullopt}), ErrorCode::Ok);
+            }
+            ++finished;
+        });
+    }
+    std::vector<float> query(8, 0.0f);
+    while (finished < kWriters) {
+        auto result = db->search(query, 3);
+        EXPECT_LE(result.items.size(), 3);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(db->size(), kWriters * kPerWriter);
+    EXPECT_EQ(db->insert({0, query, std::nullopt}), ErrorCode::InvalidParameter);
+    auto result = db->search(query, 1);
+    ASSERT_EQ(result.items.size(), 1);
+    EXPECT_EQ(result.items[0].id, 0);
+}
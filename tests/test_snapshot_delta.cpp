@@ -0,0 +1,112 @@
+/**
+ * @file test_snapshot_delta.cpp
+ * @brief Unit tests for snapshot delta files
+ *
+ * @copyright MIT License
+ */
+
+#include "../src/lib/snapshot_delta.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <vector>
+
+using namespace lynx;
+
+// ============================================================================
+// Test Fixture
+// ============================================================================
+
+class SnapshotDeltaTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = "/tmp/lynx_delta_test_" + std::to_string(std::random_device{}());
+        std::filesystem::create_directories(dir_);
+        path_ = dir_ + "/delta-0000000001.bin";
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(dir_);
+    }
+
+    static SnapshotDelta make_delta() {
+        SnapshotDelta delta;
+        delta.sequence = 4;
+        delta.removed_ids = {3, 11};
+        delta.ids = {11, 12};
+        delta.vectors = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+        delta.metadata = {std::string("eleven"), std::nullopt};
+        return delta;
+    }
+
+    std::string dir_;
+    std::string path_;
+};
+
+// ============================================================================
+// Round Trip
+// ============================================================================
+
+TEST_F(SnapshotDeltaTest, RoundTrip) {
+    const SnapshotDelta written = make_delta();
+    ASSERT_EQ(write_snapshot_delta(path_, 3, written), ErrorCode::Ok);
+
+    SnapshotDelta read;
+    ASSERT_EQ(read_snapshot_delta(path_, 3, read), ErrorCode::Ok);
+    EXPECT_EQ(read.sequence, 4);
+    EXPECT_EQ(read.removed_ids, written.removed_ids);
+    EXPECT_EQ(read.ids, written.ids);
+    EXPECT_EQ(read.vectors, written.vectors);
+    EXPECT_EQ(read.metadata, written.metadata);
+}
+
+TEST_F(SnapshotDeltaTest, EmptyDeltaRoundTrips) {
+    SnapshotDelta written;
+    written.sequence = 1;
+    ASSERT_EQ(write_snapshot_delta(path_, 3, written), ErrorCode::Ok);
+
+    SnapshotDelta read;
+    ASSERT_EQ(read_snapshot_delta(path_, 3, read), ErrorCode::Ok);
+    EXPECT_TRUE(read.removed_ids.empty());
+    EXPECT_TRUE(read.ids.empty());
+}
+
+TEST_F(SnapshotDeltaTest, InconsistentSizesAreRejected) {
+    SnapshotDelta delta = make_delta();
+    delta.vectors.pop_back();
+    EXPECT_EQ(write_snapshot_delta(path_, 3, delta), ErrorCode::InvalidParameter);
+}
+
+// ============================================================================
+// Validation
+// ============================================================================
+
+TEST_F(SnapshotDeltaTest, MissingFileIsIOError) {
+    SnapshotDelta read;
+    EXPECT_EQ(read_snapshot_delta(path_, 3, read), ErrorCode::IOError);
+}
+
+TEST_F(SnapshotDeltaTest, DimensionMismatch) {
+    ASSERT_EQ(write_snapshot_delta(path_, 3, make_delta()), ErrorCode::Ok);
+    SnapshotDelta read;
+    EXPECT_EQ(read_snapshot_delta(path_, 4, read), ErrorCode::DimensionMismatch);
+}
+
+TEST_F(SnapshotDeltaTest, CorruptBodyIsRejected) {
+    ASSERT_EQ(write_snapshot_delta(path_, 3, make_delta()), ErrorCode::Ok);
+    {
+        std::fstream file(path_, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(60);
+        file.put('\x7F');
+    }
+    SnapshotDelta read;
+    EXPECT_EQ(read_snapshot_delta(path_, 3, read), ErrorCode::IOError);
+}
+
+TEST_F(SnapshotDeltaTest, TruncatedFileIsRejected) {
+    ASSERT_EQ(write_snapshot_delta(path_, 3, make_delta()), ErrorCode::Ok);
+    std::filesystem::resize_file(path_, std::filesystem::file_size(path_) - 3);
+    SnapshotDelta read;
+    EXPECT_EQ(read_snapshot_delta(path_, 3, read), ErrorCode::IOError);
+}
@@ -5,11 +5,13 @@
 
 #include <gtest/gtest.h>
 #include <lynx/lynx.h>
+#include "../src/lib/utils.h"
 #include <thread>
 #include <vector>
 #include <atomic>
 #include <random>
 #include <chrono>
+#include <stdexcept>
 
 using namespace lynx;
 
@@ -422,3 +424,46 @@ INSTANTIATE_TEST_SUITE_P(
         }
     }
 );
+
+// Every index is visited exactly once, also with more chunks than threads
+TEST(ParallelForTest, CoversEveryIndexOnce) {
+    std::vector<std::atomic<int>> visits(10007);
+    const std::size_t chunks = utils::parallel_for(visits.size(), 64,
+        [&](std::size_t, std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                ++visits[i];
+            }
+        });
+
+    EXPECT_EQ(chunks, 64);
+    for (const auto& count : visits) {
+        ASSERT_EQ(count.load(), 1);
+    }
+}
+
+// A throwing chunk reaches the caller once the other chunks are done
+TEST(ParallelForTest, RethrowsOnCaller) {
+    std::atomic<std::size_t> completed{0};
+    EXPECT_THROW(utils::parallel_for(16, 16,
+        [&](std::size_t chunk, std::size_t, std::size_t) {
+            if (chunk == 5) {
+                throw std::runtime_error("chunk failed");
+            }
+            ++completed;
+        }), std::runtime_error);
+    EXPECT_EQ(completed.load(), 15);
+
+    // The pool is still usable
+    EXPECT_EQ(utils::parallel_for(4, 4, [](std::size_t, std::size_t, std::size_t) {}), 4);
+}
+
+// Calls from inside a chunk finish even when every pool thread is busy
+TEST(ParallelForTest, NestedCallsComplete) {
+    std::atomic<std::size_t> total{0};
+    utils::parallel_for(32, 32, [&](std::size_t, std::size_t, std::size_t) {
+        utils::parallel_for(100, 8, [&](std::size_t, std::size_t begin, std::size_t end) {
+            total += end - begin;
+        });
+    });
+    EXPECT_EQ(total.load(), 3200);
+}
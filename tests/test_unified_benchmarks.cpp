@@ -12,6 +12,8 @@
  */
 
 #include "../src/lib/vector_database.h"
+#include "../src/lib/ivf_index.h"
+#include "../src/lib/utils.h"
 #include <gtest/gtest.h>
 #include <vector>
 #include <random>
@@ -20,6 +22,10 @@
 #include <iostream>
 #include <iomanip>
 #include <atomic>
+#include <cmath>
+#include <numeric>
+#include <filesystem>
+#include <thread>
 
 using namespace lynx;
 
@@ -459,3 +465,227 @@ INSTANTIATE_TEST_SUITE_P(
         return index_type_name(info.param);
     }
 );
+
+// ============================================================================
+// IVF List Balance Benchmark
+// ============================================================================
+
+TEST(IVFBalanceBenchmark, BalancedListSizesAndTailLatency_20K_Dim64) {
+    const std::size_t num_vectors = 20000;
+    const std::size_t dimension = 64;
+    const std::size_t num_clusters = 64;
+    const std::size_t num_queries = 200;
+    const std::size_t k = 10;
+
+    // Skewed blobs: half of the data falls into 4 of 32 blobs
+    std::mt19937 rng(7);
+    std::normal_distribution<float> noise(0.0f, 0.15f);
+    auto blob_centers = generate_random_vectors(32, dimension, 11);
+    std::vector<VectorRecord> records;
+    records.reserve(num_vectors);
+    for (std::size_t i = 0; i < num_vectors; ++i) {
+        const std::size_t blob = (i % 2 == 0) ? (i / 2) % 4 : 4 + (i / 2) % 28;
+        std::vector<float> vec(blob_centers[blob]);
+        for (auto& x : vec) {
+            x += noise(rng);
+        }
+        records.push_back({i, std::move(vec), std::nullopt});
+    }
+
+    std::vector<std::vector<float>> queries;
+    for (std::size_t q = 0; q < num_queries; ++q) {
+        queries.push_back(records[(q * 97) % num_vectors].vector);
+        for (auto& x : queries.back()) {
+            x += noise(rng);
+        }
+    }
+
+    // Exact top-k for recall
+    std::vector<std::vector<std::uint64_t>> truth(num_queries);
+    for (std::size_t q = 0; q < num_queries; ++q) {
+        std::vector<std::pair<float, std::uint64_t>> all;
+        all.reserve(num_vectors);
+        for (const auto& record : records) {
+            all.emplace_back(utils::calculate_distance(queries[q], record.vector,
+                                                       DistanceMetric::L2), record.id);
+        }
+        std::partial_sort(all.begin(), all.begin() + k, all.end());
+        for (std::size_t i = 0; i < k; ++i) {
+            truth[q].push_back(all[i].second);
+        }
+    }
+
+    std::cout << "\n[BENCHMARK] IVF list balance (" << num_vectors << " vectors, "
+              << num_clusters << " clusters, skewed data):\n";
+
+    for (float balance_factor : {0.0f, 2.0f, 1.25f}) {
+        IVFParams params;
+        params.n_clusters = num_clusters;
+        params.balance_factor = balance_factor;
+        IVFIndex index(dimension, DistanceMetric::L2, params);
+
+        double build_ms = measure_time_ms([&] {
+            ASSERT_EQ(index.build(records), ErrorCode::Ok);
+        });
+
+        auto sizes = index.list_sizes();
+        std::sort(sizes.begin(), sizes.end());
+        ASSERT_EQ(std::accumulate(sizes.begin(), sizes.end(), std::size_t{0}), num_vectors);
+        if (balance_factor > 0.0f) {
+            const auto cap = static_cast<std::size_t>(
+                std::ceil(balance_factor * num_vectors / num_clusters));
+            EXPECT_LE(sizes.back(), cap);
+        }
+
+        SearchParams search_params;
+        search_params.n_probe = 4;
+        std::vector<double> latencies;
+        std::size_t hits = 0;
+        for (std::size_t q = 0; q < num_queries; ++q) {
+            std::vector<SearchResultItem> results;
+            latencies.push_back(measure_time_ms([&] {
+                results = index.search(queries[q], k, search_params);
+            }));
+            for (const auto& item : results) {
+                hits += std::count(truth[q].begin(), truth[q].end(), item.id);
+            }
+        }
+        std::sort(latencies.begin(), latencies.end());
+        const double mean = std::accumulate(latencies.begin(), latencies.end(), 0.0) /
+                            latencies.size();
+        const double p99 = latencies[latencies.size() * 99 / 100];
+
+        std::cout << "  balance_factor=" << std::fixed << std::setprecision(2) << balance_factor
+                  << "  build=" << std::setprecision(1) << build_ms << "ms"
+                  << "  lists min/p50/max=" << sizes.front() << "/"
+                  << sizes[sizes.size() / 2] << "/" << sizes.back()
+                  << "  search mean/p99=" << std::setprecision(3) << mean << "/" << p99 << "ms"
+                  << "  recall@" << k << "=" << std::setprecision(3)
+                  << static_cast<double>(hits) / (num_queries * k) << "\n";
+    }
+}
+
+// ============================================================================
+// Write-Ahead Log Ingest Benchmark
+// ============================================================================
+
+TEST(WALIngestBenchmark, DurableInsertThroughput_Dim64) {
+    const std::size_t dimension = 64;
+    const std::size_t num_threads = 8;
+    const std::size_t per_thread = 5000;
+    auto vectors = generate_random_vectors(num_threads * per_thread, dimension);
+
+    std::cout << "\n[BENCHMARK] Durable ingest (" << vectors.size() << " inserts, dim "
+              << dimension << ", Flat):\n";
+
+    struct Mode {
+        const char* name;
+        std::size_t sync_interval_ms;
+        std::size_t batch_size;   // 1 = single insert() calls
+    };
+    for (const Mode& mode : {Mode{"group commit, insert()", 0, 1},
+                             Mode{"group commit, batch_insert(256)", 0, 256},
+                             Mode{"10ms sync interval, insert()", 10, 1}}) {
+        const std::string path = "/tmp/lynx_wal_bench_" + std::to_string(std::random_device{}());
+        Config config;
+        config.dimension = dimension;
+        config.index_type = IndexType::Flat;
+        config.enable_wal = true;
+        config.wal_sync_interval_ms = mode.sync_interval_ms;
+        config.data_path = path;
+
+        {
+            VectorDatabase db(config);
+            double elapsed_ms = measure_time_ms([&] {
+                std::vector<std::thread> writers;
+                for (std::size_t t = 0; t < num_threads; ++t) {
+                    writers.emplace_back([&, t] {
+                        std::vector<VectorRecord> batch;
+                        for (std::size_t i = 0; i < per_thread; ++i) {
+                            const std::size_t id = t * per_thread + i;
+                            batch.push_back({id, vectors[id], std::nullopt});
+                            if (batch.size() == mode.batch_size || i + 1 == per_thread) {
+                                EXPECT_EQ(batch.size() == 1 ? db.insert(batch[0])
+                                                            : db.batch_insert(batch),
+                                          ErrorCode::Ok);
+                                batch.clear();
+                            }
+                        }
+                    });
+                }
+                for (auto& writer : writers) {
+                    writer.join();
+                }
+                EXPECT_EQ(db.flush(), ErrorCode::Ok);
+            });
+            EXPECT_EQ(db.size(), vectors.size());
+
+            std::cout << "  " << std::left << std::setw(34) << mode.name << std::right
+                      << std::fixed << std::setprecision(0)
+                      << vectors.size() / (elapsed_ms / 1000.0) << " inserts/s\n";
+        }
+
+        // Everything acknowledged must come back from the log
+        VectorDatabase recovered(config);
+        EXPECT_EQ(recovered.load(), ErrorCode::Ok);
+        EXPECT_EQ(recovered.size(), vectors.size());
+        std::filesystem::remove_all(path);
+    }
+}
+
+// ============================================================================
+// Memory-Mapped Load Benchmark
+// ============================================================================
+
+namespace {
+
+// Saves num_vectors random vectors, then times load() and the first query
+// with and without enable_mmap
+void run_load_benchmark(IndexType index_type, std::size_t num_vectors, std::size_t dimension) {
+    auto vectors = generate_random_vectors(num_vectors, dimension);
+
+    const std::string path = "/tmp/lynx_mmap_bench_" + std::to_string(std::random_device{}());
+    Config config;
+    config.dimension = dimension;
+    config.index_type = index_type;
+    config.data_path = path;
+    {
+        std::vector<VectorRecord> records;
+        records.reserve(num_vectors);
+        for (std::size_t i = 0; i < num_vectors; ++i) {
+            records.push_back({i, std::move(vectors[i]), std::nullopt});
+        }
+        VectorDatabase db(config);
+        ASSERT_EQ(db.batch_insert(records), ErrorCode::Ok);
+        ASSERT_EQ(db.save(), ErrorCode::Ok);
+    }
+
+    std::cout << "\n[BENCHMARK] " << index_type_name(index_type) << " load (" << num_vectors
+              << " vectors, dim " << dimension << "):\n";
+    for (bool enable_mmap : {false, true}) {
+        config.enable_mmap = enable_mmap;
+        VectorDatabase db(config);
+        double load_ms = measure_time_ms([&] {
+            ASSERT_EQ(db.load(), ErrorCode::Ok);
+        });
+        std::vector<float> query(dimension, 0.1f);
+        double first_query_ms = measure_time_ms([&] {
+            EXPECT_EQ(db.search(query, 10).items.size(), 10);
+        });
+        std::cout << "  " << (enable_mmap ? "mmap" : "heap") << "  load=" << std::fixed
+                  << std::setprecision(1) << load_ms << "ms  first query=" << first_query_ms
+                  << "ms  index heap=" << db.stats().index_memory_bytes / (1024 * 1024)
+                  << "MB\n";
+    }
+    std::filesystem::remove_all(path);
+}
+
+} // namespace
+
+TEST(MmapLoadBenchmark, StartupTime_100K_Dim128) {
+    run_load_benchmark(IndexType::Flat, 100000, 128);
+}
+
+TEST(MmapLoadBenchmark, HNSWStartupTime_20K_Dim64) {
+    run_load_benchmark(IndexType::HNSW, 20000, 64);
+}
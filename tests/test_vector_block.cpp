@@ -0,0 +1,103 @@
+/**
+ * @file test_vector_block.cpp
+ * @brief Unit tests for heap and memory-mapped vector storage
+ *
+ * @copyright MIT License
+ */
+
+#include "../src/lib/vector_block.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <vector>
+
+using namespace lynx;
+
+namespace {
+
+/// Write `rows` rows of `dim` floats (row r filled with r) after one page of padding.
+std::string write_block_file(std::size_t rows, std::size_t dim) {
+    const std::string path = "/tmp/lynx_block_" + std::to_string(std::random_device{}());
+    std::ofstream out(path, std::ios::binary);
+    std::vector<char> padding(4096, 0);
+    out.write(padding.data(), padding.size());
+    for (std::size_t r = 0; r < rows; ++r) {
+        std::vector<float> row(dim, static_cast<float>(r));
+        out.write(reinterpret_cast<const char*>(row.data()), dim * sizeof(float));
+    }
+    return path;
+}
+
+} // namespace
+
+TEST(VectorBlockTest, HeapAppendAssignAndRemove) {
+    VectorBlock block(2);
+    block.append(std::vector<float>{1.0f, 1.0f});
+    block.append(std::vector<float>{2.0f, 2.0f});
+    block.append(std::vector<float>{3.0f, 3.0f});
+    ASSERT_EQ(block.rows(), 3);
+
+    block.assign(1, std::vector<float>{5.0f, 5.0f});
+    EXPECT_EQ(block.row(1)[0], 5.0f);
+
+    block.move_last_to(0);
+    ASSERT_EQ(block.rows(), 2);
+    EXPECT_EQ(block.row(0)[0], 3.0f);
+    EXPECT_EQ(block.row(1)[0], 5.0f);
+    EXPECT_FALSE(block.is_mapped());
+}
+
+TEST(VectorBlockTest, MappedRowsThenHeapRows) {
+    const std::size_t dim = 4;
+    const std::string path = write_block_file(10, dim);
+    auto file = MappedFile::open(path);
+    ASSERT_NE(file, nullptr);
+    std::vector<std::uint64_t> ids(10);
+
+    VectorBlock block(dim);
+    block.attach(MappedVectors{file, 4096, ids});
+    ASSERT_TRUE(block.is_mapped());
+    ASSERT_EQ(block.rows(), 10);
+    EXPECT_EQ(block.row(7)[3], 7.0f);
+    EXPECT_EQ(block.memory_usage(), 0);
+
+    // Appends land on the heap after the mapped rows
+    block.append(std::vector<float>(dim, 42.0f));
+    ASSERT_EQ(block.rows(), 11);
+    EXPECT_EQ(block.row(10)[0], 42.0f);
+
+    // Moving a heap row into a mapped slot patches that row on the heap
+    block.move_last_to(2);
+    ASSERT_EQ(block.rows(), 10);
+    EXPECT_EQ(block.row(2)[0], 42.0f);
+    EXPECT_EQ(block.row(3)[0], 3.0f);
+    EXPECT_GT(block.memory_usage(), 0);
+
+    // Removing the last mapped row shrinks the mapped range
+    block.move_last_to(0);
+    ASSERT_EQ(block.rows(), 9);
+    EXPECT_EQ(block.row(0)[0], 9.0f);
+
+    // A patched last row moves like any other and its patch is dropped
+    block.assign(8, std::vector<float>(dim, 7.5f));
+    block.move_last_to(1);
+    ASSERT_EQ(block.rows(), 8);
+    EXPECT_EQ(block.row(1)[0], 7.5f);
+    EXPECT_EQ(block.row(2)[0], 42.0f);
+    block.append(std::vector<float>(dim, 99.0f));
+    EXPECT_EQ(block.row(8)[0], 99.0f);
+
+    // The file itself is untouched
+    auto reread = MappedFile::open(path);
+    ASSERT_NE(reread, nullptr);
+    const auto* rows = reinterpret_cast<const float*>(reread->data() + 4096);
+    EXPECT_EQ(rows[2 * dim], 2.0f);
+    EXPECT_EQ(rows[0], 0.0f);
+
+    std::filesystem::remove(path);
+}
+
+TEST(VectorBlockTest, MissingFileDoesNotMap) {
+    EXPECT_EQ(MappedFile::open("/tmp/lynx_block_does_not_exist"), nullptr);
+}
@@ -258,6 +258,37 @@ TEST_P(UnifiedVectorDatabaseTest, AllRecords) {
     EXPECT_EQ(count, 10);
 }
 
+TEST_P(UnifiedVectorDatabaseTest, AllRecordsReadVectorsFromIndex) {
+    // Vectors are served from index storage, including after removals
+    // have moved entries around inside the index
+    for (int i = 0; i < 20; ++i) {
+        VectorRecord record{
+            static_cast<uint64_t>(i),
+            {i * 1.0f, i * 2.0f, i * 3.0f, i * 4.0f},
+            "meta-" + std::to_string(i)
+        };
+        ASSERT_EQ(db_->insert(record), ErrorCode::Ok);
+    }
+    for (int i = 0; i < 20; i += 3) {
+        ASSERT_EQ(db_->remove(i), ErrorCode::Ok);
+    }
+
+    size_t count = 0;
+    for (const auto& [id, record] : db_->all_records()) {
+        EXPECT_NE(id % 3, 0);
+        const float f = static_cast<float>(id);
+        EXPECT_EQ(record.vector, (std::vector<float>{f, 2 * f, 3 * f, 4 * f}));
+        EXPECT_EQ(record.metadata, "meta-" + std::to_string(id));
+        count++;
+    }
+    EXPECT_EQ(count, 13);
+
+    auto record = db_->get(10);
+    ASSERT_TRUE(record.has_value());
+    EXPECT_EQ(record->vector, (std::vector<float>{10.0f, 20.0f, 30.0f, 40.0f}));
+    EXPECT_EQ(record->metadata, "meta-10");
+}
+
 TEST_P(UnifiedVectorDatabaseTest, AllRecordsEmpty) {
     auto records = db_->all_records();
     size_t count = 0;
@@ -301,6 +332,20 @@ TEST_P(UnifiedVectorDatabaseTest, Statistics) {
     EXPECT_GT(stats.memory_usage_bytes, 0);
 }
 
+TEST_P(UnifiedVectorDatabaseTest, StatisticsCountVectorsOnce) {
+    for (int i = 0; i < 100; ++i) {
+        VectorRecord record{static_cast<uint64_t>(i), {1.0f, 2.0f, 3.0f, 4.0f}, std::nullopt};
+        ASSERT_EQ(db_->insert(record), ErrorCode::Ok);
+    }
+
+    // Vector data is owned by the index; the database adds only the
+    // per-record ID and metadata slot
+    auto stats = db_->stats();
+    const std::size_t record_bytes = stats.memory_usage_bytes - stats.index_memory_bytes;
+    EXPECT_LE(record_bytes,
+              100 * (sizeof(std::uint64_t) + sizeof(std::optional<std::string>)));
+}
+
 TEST_P(UnifiedVectorDatabaseTest, Config) {
     const auto& cfg = db_->config();
 
@@ -433,6 +478,35 @@ INSTANTIATE_TEST_SUITE_P(
 // IVF-Specific Rebuild Tests
 // =============================================================================
 
+TEST(UnifiedVectorDatabaseIVFTest, SearchReportsClustersProbed) {
+    Config config;
+    config.dimension = 4;
+    config.index_type = IndexType::IVF;
+    config.ivf_params.n_clusters = 4;
+    config.ivf_params.n_probe = 2;
+
+    VectorDatabase db(config);
+    std::vector<VectorRecord> records;
+    for (std::uint64_t i = 0; i < 100; ++i) {
+        float v = static_cast<float>(i);
+        records.push_back({i, {v, v * 0.5f, 1.0f, -v}, std::nullopt});
+    }
+    ASSERT_EQ(db.batch_insert(records), ErrorCode::Ok);
+
+    std::vector<float> query = {10.0f, 5.0f, 1.0f, -10.0f};
+    auto result = db.search(query, 5);
+    EXPECT_EQ(result.clusters_probed, 2);
+
+    SearchParams params;
+    params.adaptive_n_probe = true;
+    params.max_n_probe = 4;
+    result = db.search(query, 5, params);
+    EXPECT_GE(result.clusters_probed, 1);
+    EXPECT_LE(result.clusters_probed, 4);
+    ASSERT_FALSE(result.items.empty());
+    EXPECT_EQ(result.items[0].id, 10);
+}
+
 TEST(UnifiedVectorDatabaseIVFTest, BatchInsertRebuild) {
     Config config;
     config.dimension = 4;
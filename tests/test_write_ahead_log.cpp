@@ -0,0 +1,207 @@
+/**
+ * @file test_write_ahead_log.cpp
+ * @brief Unit tests for the write-ahead log
+ *
+ * @copyright MIT License
+ */
+
+#include "../src/lib/write_ahead_log.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace lynx;
+
+// ============================================================================
+// Test Fixture
+// ============================================================================
+
+class WriteAheadLogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = "/tmp/lynx_wal_test_" + std::to_string(std::random_device{}());
+        std::filesystem::create_directories(dir_);
+        path_ = dir_ + "/wal.log";
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(dir_);
+    }
+
+    std::vector<WalEntry> replay_all(std::size_t dimension = 3) {
+        std::vector<WalEntry> entries;
+        ErrorCode result = WriteAheadLog::replay(path_, dimension, [&](const WalEntry& entry) {
+            entries.push_back(entry);
+            return ErrorCode::Ok;
+        });
+        EXPECT_EQ(result, ErrorCode::Ok);
+        return entries;
+    }
+
+    std::string dir_;
+    std::string path_;
+};
+
+// ============================================================================
+// Append and Replay
+// ============================================================================
+
+TEST_F(WriteAheadLogTest, ReplayReturnsEntriesInOrder) {
+    {
+        WriteAheadLog wal(3, std::chrono::milliseconds(0));
+        ASSERT_EQ(wal.open(path_), ErrorCode::Ok);
+        wal.append_insert(7, std::vector<float>{1.0f, 2.0f, 3.0f}, "meta");
+        wal.append_insert(8, std::vector<float>{4.0f, 5.0f, 6.0f}, std::nullopt);
+        auto lsn = wal.append_remove(7);
+        ASSERT_EQ(wal.wait_durable(lsn), ErrorCode::Ok);
+    }
+
+    auto entries = replay_all();
+    ASSERT_EQ(entries.size(), 3);
+    EXPECT_EQ(entries[0].type, WalEntry::Type::Insert);
+    EXPECT_EQ(entries[0].id, 7);
+    EXPECT_EQ(entries[0].vector, (std::vector<float>{1.0f, 2.0f, 3.0f}));
+    EXPECT_EQ(entries[0].metadata, std::optional<std::string>("meta"));
+    EXPECT_FALSE(entries[1].metadata.has_value());
+    EXPECT_EQ(entries[2].type, WalEntry::Type::Remove);
+    EXPECT_EQ(entries[2].id, 7);
+}
+
+TEST_F(WriteAheadLogTest, MissingFileReplaysNothing) {
+    EXPECT_TRUE(replay_all().empty());
+}
+
+TEST_F(WriteAheadLogTest, DimensionMismatchIsRejected) {
+    {
+        WriteAheadLog wal(3, std::chrono::milliseconds(0));
+        ASSERT_EQ(wal.open(path_), ErrorCode::Ok);
+    }
+
+    WriteAheadLog other(4, std::chrono::milliseconds(0));
+    EXPECT_EQ(other.open(path_), ErrorCode::DimensionMismatch);
+    EXPECT_EQ(WriteAheadLog::replay(path_, 4, [](const WalEntry&) { return ErrorCode::Ok; }),
+              ErrorCode::DimensionMismatch);
+}
+
+TEST_F(WriteAheadLogTest, TornTailIsDroppedAndOverwritten) {
+    {
+        WriteAheadLog wal(3, std::chrono::milliseconds(0));
+        ASSERT_EQ(wal.open(path_), ErrorCode::Ok);
+        wal.append_insert(1, std::vector<float>{1.0f, 1.0f, 1.0f}, std::nullopt);
+        wal.append_insert(2, std::vector<float>{2.0f, 2.0f, 2.0f}, std::nullopt);
+        ASSERT_EQ(wal.sync(), ErrorCode::Ok);
+    }
+
+    // Simulate a crash in the middle of the last frame
+    std::filesystem::resize_file(path_, std::filesystem::file_size(path_) - 5);
+    ASSERT_EQ(replay_all().size(), 1);
+
+    // Reopening cuts the torn frame so new entries are readable
+    {
+        WriteAheadLog wal(3, std::chrono::milliseconds(0));
+        ASSERT_EQ(wal.open(path_), ErrorCode::Ok);
+        wal.append_remove(1);
+        ASSERT_EQ(wal.sync(), ErrorCode::Ok);
+    }
+
+    auto entries = replay_all();
+    ASSERT_EQ(entries.size(), 2);
+    EXPECT_EQ(entries[1].type, WalEntry::Type::Remove);
+}
+
+TEST_F(WriteAheadLogTest, ResetDropsEntries) {
+    WriteAheadLog wal(3, std::chrono::milliseconds(0));
+    ASSERT_EQ(wal.open(path_), ErrorCode::Ok);
+    wal.append_insert(1, std::vector<float>{1.0f, 1.0f, 1.0f}, std::nullopt);
+    ASSERT_EQ(wal.sync(), ErrorCode::Ok);
+    wal.append_insert(2, std::vector<float>{2.0f, 2.0f, 2.0f}, std::nullopt);
+
+    ASSERT_EQ(wal.reset(), ErrorCode::Ok);
+    EXPECT_TRUE(replay_all().empty());
+
+    wal.append_insert(3, std::vector<float>{3.0f, 3.0f, 3.0f}, std::nullopt);
+    ASSERT_EQ(wal.sync(), ErrorCode::Ok);
+    auto entries = replay_all();
+    ASSERT_EQ(entries.size(), 1);
+    EXPECT_EQ(entries[0].id, 3);
+}
+
+TEST_F(WriteAheadLogTest, DiscardBeforeKeepsLaterEntries) {
+    WriteAheadLog wal(3, std::chrono::milliseconds(0));
+    ASSERT_EQ(wal.open(path_), ErrorCode::Ok);
+    wal.append_insert(1, std::vector<float>{1.0f, 1.0f, 1.0f}, std::nullopt);
+    ASSERT_EQ(wal.sync(), ErrorCode::Ok);
+    wal.append_remove(2);
+    const std::uint64_t position = wal.end_position();
+
+    // One entry after the position is on disk, one still buffered
+    wal.append_insert(3, std::vector<float>{3.0f, 3.0f, 3.0f}, "three");
+    ASSERT_EQ(wal.sync(), ErrorCode::Ok);
+    wal.append_remove(4);
+
+    ASSERT_EQ(wal.discard_before(position), ErrorCode::Ok);
+    auto entries = replay_all();
+    ASSERT_EQ(entries.size(), 2);
+    EXPECT_EQ(entries[0].id, 3);
+    EXPECT_EQ(entries[0].metadata, "three");
+    EXPECT_EQ(entries[1].id, 4);
+
+    // Appends continue in the new file
+    wal.append_insert(5, std::vector<float>{5.0f, 5.0f, 5.0f}, std::nullopt);
+    ASSERT_EQ(wal.sync(), ErrorCode::Ok);
+    entries = replay_all();
+    ASSERT_EQ(entries.size(), 3);
+    EXPECT_EQ(entries[2].id, 5);
+}
+
+TEST_F(WriteAheadLogTest, DiscardBeforeEndDropsEverything) {
+    WriteAheadLog wal(3, std::chrono::milliseconds(0));
+    ASSERT_EQ(wal.open(path_), ErrorCode::Ok);
+    wal.append_insert(1, std::vector<float>{1.0f, 1.0f, 1.0f}, std::nullopt);
+    ASSERT_EQ(wal.discard_before(wal.end_position()), ErrorCode::Ok);
+    EXPECT_TRUE(replay_all().empty());
+}
+
+// ============================================================================
+// Commit Modes
+// ============================================================================
+
+TEST_F(WriteAheadLogTest, ConcurrentWritersAllBecomeDurable) {
+    constexpr int kThreads = 8;
+    constexpr int kPerThread = 200;
+    {
+        WriteAheadLog wal(3, std::chrono::milliseconds(0));
+        ASSERT_EQ(wal.open(path_), ErrorCode::Ok);
+
+        std::vector<std::thread> writers;
+        for (int t = 0; t < kThreads; ++t) {
+            writers.emplace_back([&wal, t] {
+                for (int i = 0; i < kPerThread; ++i) {
+                    auto id = static_cast<std::uint64_t>(t * kPerThread + i);
+                    auto lsn = wal.append_insert(id, std::vector<float>{1.0f, 2.0f, 3.0f},
+                                                 std::nullopt);
+                    EXPECT_EQ(wal.wait_durable(lsn), ErrorCode::Ok);
+                }
+            });
+        }
+        for (auto& writer : writers) {
+            writer.join();
+        }
+    }
+
+    EXPECT_EQ(replay_all().size(), static_cast<std::size_t>(kThreads * kPerThread));
+}
+
+TEST_F(WriteAheadLogTest, BackgroundFlusherCommitsWithoutWaiting) {
+    WriteAheadLog wal(3, std::chrono::milliseconds(2));
+    ASSERT_EQ(wal.open(path_), ErrorCode::Ok);
+    wal.append_insert(1, std::vector<float>{1.0f, 1.0f, 1.0f}, std::nullopt);
+
+    // Nobody waits; the flusher must write the entry on its own
+    for (int attempt = 0; attempt < 500 && replay_all().empty(); ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    EXPECT_EQ(replay_all().size(), 1);
+}